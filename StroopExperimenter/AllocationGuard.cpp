@@ -0,0 +1,222 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "AllocationGuard.h"
+
+#ifndef QT_NO_DEBUG
+
+#include <cstdlib>
+#include <new>
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+#include <crtdbg.h>
+#endif
+
+
+// Per thread, so allocations of other threads do not fail a check
+static thread_local quint64 t_u64NumAllocations   = 0ULL;
+static thread_local int     t_nNumActiveSections = 0;
+
+
+#if defined(_MSC_VER) && defined(_DEBUG)
+
+/**
+ * @brief allocationHook
+ * The debug CRT reports every malloc/realloc, operator new included.
+ */
+static int allocationHook(int allocType, void*, size_t, int, long, const unsigned char*, int)
+{
+   if (t_nNumActiveSections > 0 && (allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC))
+   {
+      t_u64NumAllocations++;
+   }
+
+   return TRUE;
+}
+
+#elif defined(__GLIBC__)
+
+// Defined in the executable, these replace the C library's functions for
+// every library of the process, so Qt's allocations are counted as well.
+// free() and the aligned variants are left to the C library, which
+// allocates from the same heap.
+extern "C"
+{
+void* __libc_malloc(std::size_t size) noexcept;
+void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void* __libc_realloc(void* p, std::size_t size) noexcept;
+
+
+/**
+ * @brief malloc
+ * @param size
+ * @return
+ */
+void* malloc(std::size_t size) noexcept
+{
+   if (t_nNumActiveSections > 0) { t_u64NumAllocations++; }
+
+   return __libc_malloc(size);
+}
+
+
+/**
+ * @brief calloc
+ * @param count
+ * @param size
+ * @return
+ */
+void* calloc(std::size_t count, std::size_t size) noexcept
+{
+   if (t_nNumActiveSections > 0) { t_u64NumAllocations++; }
+
+   return __libc_calloc(count, size);
+}
+
+
+/**
+ * @brief realloc
+ * @param p
+ * @param size
+ * @return
+ */
+void* realloc(void* p, std::size_t size) noexcept
+{
+   if (t_nNumActiveSections > 0) { t_u64NumAllocations++; }
+
+   return __libc_realloc(p, size);
+}
+}
+
+#else
+
+/**
+ * @brief countedAllocation
+ * @param size
+ * @return
+ */
+static void* countedAllocation(std::size_t size)
+{
+   if (t_nNumActiveSections > 0) { t_u64NumAllocations++; }
+
+   if (void* p = std::malloc(size ? size : 1)) { return p; }
+
+   throw std::bad_alloc();
+}
+
+
+void* operator new(std::size_t size)   { return countedAllocation(size); }
+void* operator new[](std::size_t size) { return countedAllocation(size); }
+
+void operator delete(void* p) noexcept                { std::free(p); }
+void operator delete[](void* p) noexcept              { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept   { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#endif
+
+
+/**
+ * @brief AllocationGuard::AllocationGuard
+ */
+AllocationGuard::AllocationGuard()
+   : m_bArmed(false)
+   , m_u64NumAllocationsAtArm(0ULL)
+{
+#if defined(_MSC_VER) && defined(_DEBUG)
+   static const bool hookInstalled = (_CrtSetAllocHook(allocationHook), true);
+   Q_UNUSED(hookInstalled);
+#endif
+}
+
+
+/**
+ * @brief AllocationGuard::arm
+ * Starts the span; allocations in sections from now on fail check().
+ */
+void AllocationGuard::arm()
+{
+   m_bArmed = true;
+   m_u64NumAllocationsAtArm = t_u64NumAllocations;
+}
+
+
+/**
+ * @brief AllocationGuard::check
+ * @param where Name of the code that ends the span, shown if the assertion fails
+ */
+void AllocationGuard::check(const char* where)
+{
+   if (!m_bArmed) { return; }
+
+   m_bArmed = false;
+
+   Q_ASSERT_X(t_u64NumAllocations == m_u64NumAllocationsAtArm,
+              where, "heap allocation between stimulus onset and response");
+   Q_UNUSED(where);
+}
+
+
+/**
+ * @brief AllocationGuard::disarm
+ * Ends the span without a check, e.g. when the run is paused.
+ */
+void AllocationGuard::disarm()
+{
+   m_bArmed = false;
+}
+
+
+/**
+ * @brief AllocationGuard::numAllocations
+ * @return Allocations counted on this thread while a section was active
+ */
+quint64 AllocationGuard::numAllocations()
+{
+   return t_u64NumAllocations;
+}
+
+
+/**
+ * @brief AllocationGuard::Section::Section
+ */
+AllocationGuard::Section::Section()
+{
+   t_nNumActiveSections++;
+}
+
+
+/**
+ * @brief AllocationGuard::Section::~Section
+ */
+AllocationGuard::Section::~Section()
+{
+   t_nNumActiveSections--;
+}
+
+
+/**
+ * @brief AllocationGuard::Exemption::Exemption
+ */
+AllocationGuard::Exemption::Exemption()
+   : m_nNumActiveSections(t_nNumActiveSections)
+{
+   t_nNumActiveSections = 0;
+}
+
+
+/**
+ * @brief AllocationGuard::Exemption::~Exemption
+ */
+AllocationGuard::Exemption::~Exemption()
+{
+   t_nNumActiveSections = m_nNumActiveSections;
+}
+
+#endif
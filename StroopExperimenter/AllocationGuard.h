@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+
+/**
+ * @brief The AllocationGuard class
+ *
+ * Asserts that no heap allocation happens on the current thread between
+ * arm() and check(), e.g. from the display request of a stimulus to the
+ * recorded response. The span is interrupted by the event loop, so only
+ * the code in a Section is counted: the handlers that run during the span
+ * open one each. An Exemption inside a section excludes a call into Qt
+ * that allocates for the event loop, e.g. a repaint request.
+ *
+ * Debug builds count malloc, calloc and realloc (and thus operator new,
+ * Qt's containers and strings) with glibc, where they are interposed for
+ * the whole process, and with the MSVC debug runtime, where an allocation
+ * hook reports them. Elsewhere only operator new is counted. In release
+ * builds the guard does nothing.
+ */
+class AllocationGuard
+{
+   public:
+      /**
+       * @brief The Section class
+       * Allocations on the current thread are counted while in scope.
+       */
+      class Section
+      {
+         public:
+#ifndef QT_NO_DEBUG
+            Section();
+            ~Section();
+#else
+            Section() {}
+#endif
+            Section(const Section&) = delete;
+            Section& operator=(const Section&) = delete;
+      };
+
+      /**
+       * @brief The Exemption class
+       * Allocations are not counted while in scope, not even in a section.
+       */
+      class Exemption
+      {
+         public:
+#ifndef QT_NO_DEBUG
+            Exemption();
+            ~Exemption();
+#else
+            Exemption() {}
+#endif
+            Exemption(const Exemption&) = delete;
+            Exemption& operator=(const Exemption&) = delete;
+
+#ifndef QT_NO_DEBUG
+         private:
+            int m_nNumActiveSections;
+#endif
+      };
+
+#ifndef QT_NO_DEBUG
+      AllocationGuard();
+
+      void arm();
+      void check(const char* where);
+      void disarm();
+
+      static quint64 numAllocations();
+#else
+      AllocationGuard() {}
+
+      void arm() {}
+      void check(const char*) {}
+      void disarm() {}
+#endif
+
+      AllocationGuard(const AllocationGuard&) = delete;
+      AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+#ifndef QT_NO_DEBUG
+   private:
+      bool    m_bArmed;
+      quint64 m_u64NumAllocationsAtArm;
+#endif
+};
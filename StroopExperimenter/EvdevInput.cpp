@@ -0,0 +1,563 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "EvdevInput.h"
+#include "RealtimeSupport.h"
+
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFile>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <linux/input.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+
+// Upper bound of a poll, i.e. of the delay of shutdown() (ms)
+static constexpr int PollInterval = 50;
+
+
+#ifdef Q_OS_LINUX
+/**
+ * @brief keyColors
+ * @return Color of every evdev key code, Qt::color0 for keys without one
+ *
+ * The codes are positions on the keyboard, not characters: the Y key of a
+ * German layout sends KEY_Z, hence both are yellow.
+ */
+static const std::array<int, KEY_CNT>& keyColors()
+{
+   static const std::array<int, KEY_CNT> colors = []()
+   {
+      std::array<int, KEY_CNT> table;
+      table.fill(Qt::color0);
+
+      for (int code : {KEY_R, KEY_A, KEY_7, KEY_KP7})        { table[code] = Qt::red;    }
+      for (int code : {KEY_G, KEY_S, KEY_4, KEY_KP4})        { table[code] = Qt::green;  }
+      for (int code : {KEY_B, KEY_D, KEY_1, KEY_KP1})        { table[code] = Qt::blue;   }
+      for (int code : {KEY_Y, KEY_Z, KEY_F, KEY_0, KEY_KP0}) { table[code] = Qt::yellow; }
+
+      return table;
+   }();
+
+   return colors;
+}
+
+
+/**
+ * @brief eventTime
+ * @param event
+ * @return Time of the event in ns
+ */
+static qint64 eventTime(const input_event& event)
+{
+   return qint64(event.input_event_sec) * 1000000000LL + qint64(event.input_event_usec) * 1000LL;
+}
+#endif
+
+
+/**
+ * @brief KeyResponse::KeyResponse
+ */
+KeyResponse::KeyResponse()
+   : m_nColor(Qt::color0)
+   , m_i64Timestamp(0LL)
+   , m_bAutoRepeat(false)
+{
+}
+
+
+/**
+ * @brief KeyResponseQueue::KeyResponseQueue
+ */
+KeyResponseQueue::KeyResponseQueue()
+   : m_u32Head(0U)
+   , m_u32Tail(0U)
+{
+}
+
+
+/**
+ * @brief KeyResponseQueue::push
+ * @param response
+ * @return False if the queue is full
+ */
+bool KeyResponseQueue::push(const KeyResponse& response)
+{
+   const quint32 tail = m_u32Tail.load(std::memory_order_relaxed);
+   const quint32 head = m_u32Head.load(std::memory_order_acquire);
+
+   if (tail - head == Capacity) { return false; }
+
+   m_responses[tail & (Capacity - 1)] = response;
+   m_u32Tail.store(tail + 1, std::memory_order_release);
+
+   return true;
+}
+
+
+/**
+ * @brief KeyResponseQueue::pop
+ * @param response
+ * @return False if the queue is empty
+ */
+bool KeyResponseQueue::pop(KeyResponse& response)
+{
+   const quint32 head = m_u32Head.load(std::memory_order_relaxed);
+   const quint32 tail = m_u32Tail.load(std::memory_order_acquire);
+
+   if (head == tail) { return false; }
+
+   response = m_responses[head & (Capacity - 1)];
+   m_u32Head.store(head + 1, std::memory_order_release);
+
+   return true;
+}
+
+
+/**
+ * @brief EvdevInputThread::EvdevInputThread
+ * @param parent
+ */
+EvdevInputThread::EvdevInputThread(QObject* parent)
+   : QThread(parent)
+   , m_bNotified(false)
+   , m_bQuit(false)
+   , m_nRequestedPriority(0)
+   , m_nRequestedCpu(-1)
+   , m_bConfigured(false)
+   , m_bFifoScheduling(false)
+   , m_nCpu(-1)
+{
+}
+
+
+/**
+ * @brief EvdevInputThread::~EvdevInputThread
+ */
+EvdevInputThread::~EvdevInputThread()
+{
+   shutdown();
+   wait();
+
+   closeDevices();
+}
+
+
+/**
+ * @brief EvdevInputThread::open
+ * @param sources Device nodes (/dev/input/event*) and at most one recording
+ * @param problems Appended for every source that could not be used
+ * @param exclusive True: the devices are grabbed (EVIOCGRAB) until closed
+ * @return True if at least one source can be read; call start() then
+ */
+bool EvdevInputThread::open(const QStringList& sources, QStringList& problems, bool exclusive)
+{
+   if (isRunning()) { return false; }
+
+   closeDevices();
+
+#ifdef Q_OS_LINUX
+   for (const QString& source : sources)
+   {
+      const QByteArray path = QFile::encodeName(source);
+
+      struct stat info;
+      if (stat(path.constData(), &info) != 0)
+      {
+         problems.append(source + ": " + QString::fromLocal8Bit(std::strerror(errno)));
+         continue;
+      }
+
+      // Recording of struct input_event
+      if (S_ISREG(info.st_mode))
+      {
+         if (!m_qvecReplayCodes.isEmpty())
+         {
+            problems.append(source + ": only one recording can be replayed");
+            continue;
+         }
+
+         QFile file(source);
+         if (!file.open(QIODevice::ReadOnly))
+         {
+            problems.append(source + ": " + file.errorString());
+            continue;
+         }
+
+         const QByteArray data = file.readAll();
+         const int numEvents = data.size() / int(sizeof(input_event));
+
+         qint64 firstTime = -1LL;
+         for (int i=0; i<numEvents; i++)
+         {
+            input_event event;
+            std::memcpy(&event, data.constData() + i * sizeof(input_event), sizeof(input_event));
+
+            if (event.type != EV_KEY) { continue; }
+
+            const qint64 time = eventTime(event);
+            if (firstTime < 0LL) { firstTime = time; }
+
+            m_qvecReplayCodes.append(event.code);
+            m_qvecReplayValues.append(event.value);
+            m_qvecReplayOffsets.append(std::max(0LL, time - firstTime));
+         }
+
+         if (m_qvecReplayCodes.isEmpty()) { problems.append(source + ": no key events"); }
+         continue;
+      }
+
+      const int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+      if (fd < 0)
+      {
+         QString str = source + ": " + QString::fromLocal8Bit(std::strerror(errno));
+         if (errno == EACCES) { str += " (membership in group \"input\" needed)"; }
+
+         problems.append(str);
+         continue;
+      }
+
+      // Event times are on CLOCK_REALTIME by default
+      int clockId = CLOCK_MONOTONIC;
+      if (ioctl(fd, EVIOCSCLOCKID, &clockId) != 0)
+      {
+         problems.append(source + ": EVIOCSCLOCKID: " + QString::fromLocal8Bit(std::strerror(errno)));
+         ::close(fd);
+         continue;
+      }
+
+      // Released when the device is closed
+      if (exclusive && ioctl(fd, EVIOCGRAB, 1) != 0)
+      {
+         QString str = source + ": EVIOCGRAB: " + QString::fromLocal8Bit(std::strerror(errno));
+         if (errno == EBUSY) { str += " (already grabbed by another reader)"; }
+
+         problems.append(str);
+         ::close(fd);
+         continue;
+      }
+
+      m_qvecFds.append(fd);
+   }
+
+   return !m_qvecFds.isEmpty() || !m_qvecReplayCodes.isEmpty();
+#else
+   Q_UNUSED(sources);
+   Q_UNUSED(exclusive);
+   problems.append("evdev: only supported on Linux");
+   return false;
+#endif
+}
+
+
+/**
+ * @brief EvdevInputThread::shutdown
+ * Lets run() return within PollInterval; the caller waits for the thread.
+ */
+void EvdevInputThread::shutdown()
+{
+   m_bQuit = true;
+}
+
+
+/**
+ * @brief EvdevInputThread::takeResponse
+ * @param response Oldest press not taken yet
+ * @return False if there is none; the next press emits responsesAvailable()
+ */
+bool EvdevInputThread::takeResponse(KeyResponse& response)
+{
+   if (m_queue.pop(response)) { return true; }
+
+   // Checked once more for a press pushed while the flag was still set
+   m_bNotified = false;
+
+   return m_queue.pop(response);
+}
+
+
+/**
+ * @brief EvdevInputThread::monotonicNow
+ * @return Current time on the clock of KeyResponse::m_i64Timestamp (ns)
+ */
+qint64 EvdevInputThread::monotonicNow()
+{
+#ifdef Q_OS_LINUX
+   timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+
+   return qint64(now.tv_sec) * 1000000000LL + now.tv_nsec;
+#else
+   return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+
+/**
+ * @brief EvdevInputThread::findKeyboards
+ * @return Readable devices in /dev/input that have the color keys
+ */
+QStringList EvdevInputThread::findKeyboards()
+{
+   QStringList keyboards;
+
+#ifdef Q_OS_LINUX
+   const QDir inputDir("/dev/input");
+   const QStringList devices = inputDir.entryList(QStringList("event*"), QDir::System);
+
+   for (const QString& device : devices)
+   {
+      const QString path = inputDir.absoluteFilePath(device);
+
+      const int fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+      if (fd < 0) { continue; }
+
+      unsigned char keyBits[KEY_CNT / 8 + 1];
+      std::memset(keyBits, 0, sizeof(keyBits));
+
+      if (ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keyBits)), keyBits) >= 0)
+      {
+         const bool hasKey = keyBits[KEY_R / 8] & (1 << (KEY_R % 8));
+         if (hasKey) { keyboards.append(path); }
+      }
+
+      ::close(fd);
+   }
+#endif
+
+   return keyboards;
+}
+
+
+/**
+ * @brief EvdevInputThread::setRealtime
+ * @param priority SCHED_FIFO priority of the thread, 0: normal scheduling
+ * @param cpu CPU to pin the thread to, -1: no pinning
+ *
+ * Only takes effect if called before start().
+ */
+void EvdevInputThread::setRealtime(int priority, int cpu)
+{
+   if (isRunning()) { return; }
+
+   m_nRequestedPriority = priority;
+   m_nRequestedCpu = cpu;
+}
+
+
+/**
+ * @brief EvdevInputThread::waitUntilConfigured
+ * @return False if the thread did not apply its scheduling within 1 s
+ */
+bool EvdevInputThread::waitUntilConfigured()
+{
+   QMutexLocker locker(&m_mutex);
+
+   QDeadlineTimer timeout(1000);
+   while (!m_bConfigured)
+   {
+      if (!m_condition.wait(&m_mutex, timeout)) { return m_bConfigured; }
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief EvdevInputThread::getScheduling
+ * @param report Input fields are set, problems are appended
+ */
+void EvdevInputThread::getScheduling(RealtimeReport& report) const
+{
+   QMutexLocker locker(&m_mutex);
+
+   report.m_bInputFifoScheduling = m_bFifoScheduling;
+   report.m_nInputPriority = m_bFifoScheduling ? m_nRequestedPriority : 0;
+   report.m_nInputCpu = m_nCpu;
+
+   for (const QString& problem : m_strlProblems)
+   {
+      report.m_strlProblems.append("Input thread: " + problem);
+   }
+}
+
+
+/**
+ * @brief EvdevInputThread::configure
+ * Applies the scheduling requested by setRealtime() to the calling thread.
+ */
+void EvdevInputThread::configure()
+{
+   QStringList problems;
+   int cpu = m_nRequestedCpu;
+   bool fifo = false;
+
+   if (m_nRequestedPriority > 0)
+   {
+      fifo = RealtimeSupport::setCurrentThreadRealtime(m_nRequestedPriority, cpu, problems);
+      RealtimeSupport::prefaultStack();
+   }
+   else
+   {
+      cpu = -1;
+   }
+
+   QMutexLocker locker(&m_mutex);
+
+   m_bFifoScheduling = fifo;
+   m_nCpu = cpu;
+   m_strlProblems = problems;
+   m_bConfigured = true;
+   m_condition.wakeAll();
+}
+
+
+/**
+ * @brief EvdevInputThread::run
+ */
+void EvdevInputThread::run()
+{
+   configure();
+
+#ifdef Q_OS_LINUX
+   // Allocated once; a device that is unplugged is skipped from then on
+   QVector<pollfd> fds(m_qvecFds.count());
+   for (int i=0; i<fds.count(); i++)
+   {
+      fds[i].fd = m_qvecFds.at(i);
+      fds[i].events = POLLIN;
+      fds[i].revents = 0;
+   }
+
+   const qint64 replayStart = monotonicNow();
+   int nextReplay = 0;
+
+   while (!m_bQuit)
+   {
+      qint64 timeout = PollInterval * 1000000LL;
+
+      if (nextReplay < m_qvecReplayCodes.count())
+      {
+         const qint64 now = monotonicNow();
+         const qint64 due = replayStart + m_qvecReplayOffsets.at(nextReplay);
+
+         if (due <= now)
+         {
+            handleKey(m_qvecReplayCodes.at(nextReplay), m_qvecReplayValues.at(nextReplay), now);
+            nextReplay++;
+            continue;
+         }
+
+         timeout = std::min(timeout, due - now);
+      }
+
+      timespec wait;
+      wait.tv_sec = timeout / 1000000000LL;
+      wait.tv_nsec = timeout % 1000000000LL;
+
+      if (ppoll(fds.data(), nfds_t(fds.count()), &wait, nullptr) <= 0) { continue; }
+
+      for (pollfd& fd : fds)
+      {
+         if (fd.revents & POLLIN) { readDevice(fd.fd); }
+         if (fd.revents & (POLLERR | POLLHUP | POLLNVAL)) { fd.fd = -1; }
+      }
+   }
+#endif
+}
+
+
+/**
+ * @brief EvdevInputThread::readDevice
+ * @param fd Device with pending events
+ */
+void EvdevInputThread::readDevice(int fd)
+{
+#ifdef Q_OS_LINUX
+   input_event events[64];
+
+   for (;;)
+   {
+      const ssize_t numBytes = ::read(fd, events, sizeof(events));
+      if (numBytes <= 0) { return; }
+
+      const int numEvents = int(numBytes / ssize_t(sizeof(input_event)));
+      for (int i=0; i<numEvents; i++)
+      {
+         if (events[i].type == EV_KEY)
+         {
+            handleKey(events[i].code, events[i].value, eventTime(events[i]));
+         }
+      }
+   }
+#else
+   Q_UNUSED(fd);
+#endif
+}
+
+
+/**
+ * @brief EvdevInputThread::handleKey
+ * @param code evdev key code
+ * @param value 1: press, 0: release, 2: auto repeat
+ * @param timestamp ns on CLOCK_MONOTONIC
+ */
+void EvdevInputThread::handleKey(int code, int value, qint64 timestamp)
+{
+#ifdef Q_OS_LINUX
+   if (value == 0 || code < 0 || code >= KEY_CNT) { return; }
+
+   const int color = keyColors()[code];
+   if (color == Qt::color0) { return; }
+
+   KeyResponse response;
+   response.m_nColor = static_cast<Qt::GlobalColor>(color);
+   response.m_i64Timestamp = timestamp;
+   response.m_bAutoRepeat = (value == 2);
+
+   // A full queue means nobody takes responses; the press is dropped
+   if (!m_queue.push(response)) { return; }
+
+   if (!m_bNotified.exchange(true)) { emit responsesAvailable(); }
+#else
+   Q_UNUSED(code);
+   Q_UNUSED(value);
+   Q_UNUSED(timestamp);
+#endif
+}
+
+
+/**
+ * @brief EvdevInputThread::closeDevices
+ */
+void EvdevInputThread::closeDevices()
+{
+#ifdef Q_OS_LINUX
+   const QVector<int>& fds = m_qvecFds;
+   for (int fd : fds) { ::close(fd); }
+#endif
+
+   m_qvecFds.clear();
+   m_qvecReplayCodes.clear();
+   m_qvecReplayValues.clear();
+   m_qvecReplayOffsets.clear();
+}
@@ -0,0 +1,131 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QVector>
+#include <QStringList>
+
+#include <atomic>
+
+struct RealtimeReport;
+
+/**
+ * @brief The KeyResponse struct
+ * A color key press with its kernel timestamp.
+ */
+struct KeyResponse
+{
+   KeyResponse();
+
+   Qt::GlobalColor m_nColor;
+   qint64          m_i64Timestamp; // ns on CLOCK_MONOTONIC
+   bool            m_bAutoRepeat;  // Generated by holding the key
+};
+
+
+/**
+ * @brief The KeyResponseQueue class
+ *
+ * Fixed-size single-producer/single-consumer ring: the input thread pushes,
+ * the experiment pops. Neither side locks or allocates.
+ */
+class KeyResponseQueue
+{
+   public:
+      static constexpr quint32 Capacity = 64; // Power of two
+
+      KeyResponseQueue();
+
+      bool push(const KeyResponse& response);
+      bool pop(KeyResponse& response);
+
+   private:
+      KeyResponse m_responses[Capacity];
+      std::atomic<quint32> m_u32Head; // Next to pop, written by the consumer
+      std::atomic<quint32> m_u32Tail; // Next to push, written by the producer
+};
+
+
+/**
+ * @brief The EvdevInputThread class
+ *
+ * Reads the color keys from /dev/input/event* on its own thread, bypassing
+ * the window system and the event loop, and stamps every press with the
+ * kernel time of the event on CLOCK_MONOTONIC. The keys are mapped by a
+ * table indexed with the evdev key code (same bindings as
+ * StroopExperimentDialog::keyPressEvent()).
+ *
+ * A regular file given as source is a recording of struct input_event
+ * (e.g. "cat /dev/input/event3 > keys.evdev"); it is replayed with its
+ * original intervals, stamped at replay time. Opened exclusively, devices
+ * are grabbed, so neither the window system nor another reader gets their
+ * keys (one keyboard per station, see StationController). In real-time
+ * mode the thread runs with SCHED_FIFO priority, pinned to the CPU of the
+ * deadline thread (see RealtimeDeadlineThread), so a loaded system does
+ * not delay the keys on their way to the experiment. Only implemented on
+ * Linux.
+ */
+class EvdevInputThread : public QThread
+{
+      Q_OBJECT
+
+   public:
+      explicit EvdevInputThread(QObject* parent = nullptr);
+      virtual ~EvdevInputThread();
+
+      bool open(const QStringList& sources, QStringList& problems, bool exclusive = false);
+      void shutdown();
+
+      void setRealtime(int priority, int cpu);
+      bool waitUntilConfigured();
+      void getScheduling(RealtimeReport& report) const;
+
+      bool takeResponse(KeyResponse& response);
+
+      static qint64 monotonicNow();
+      static QStringList findKeyboards();
+
+   signals:
+      void responsesAvailable();
+
+   protected:
+      virtual void run();
+
+   private:
+      void readDevice(int fd);
+      void handleKey(int code, int value, qint64 timestamp);
+      void closeDevices();
+      void configure();
+
+      QVector<int> m_qvecFds;
+
+      // Recording to replay: key code, value and offset to the first event (ns)
+      QVector<int>    m_qvecReplayCodes;
+      QVector<int>    m_qvecReplayValues;
+      QVector<qint64> m_qvecReplayOffsets;
+
+      KeyResponseQueue m_queue;
+      std::atomic<bool> m_bNotified; // responsesAvailable() is pending
+      std::atomic<bool> m_bQuit;
+
+      // Real-time scheduling, requested before start(), applied in run()
+      int m_nRequestedPriority; // 0: normal scheduling
+      int m_nRequestedCpu;
+
+      mutable QMutex m_mutex;
+      QWaitCondition m_condition;
+      bool m_bConfigured;
+      bool m_bFifoScheduling;
+      int  m_nCpu;
+      QStringList m_strlProblems;
+};
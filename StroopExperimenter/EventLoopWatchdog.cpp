@@ -0,0 +1,224 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "EventLoopWatchdog.h"
+
+#include <algorithm>
+
+
+/**
+ * @brief EventLoopWatchdog::EventLoopWatchdog
+ * @param parent
+ *
+ * Must be created on the thread whose event loop is watched.
+ */
+EventLoopWatchdog::EventLoopWatchdog(QObject* parent)
+   : QThread(parent)
+   , m_i64LastBeat(0LL)
+   , m_bQuit(false)
+   , m_qvecStallStarts(StallHistorySize, -1LL)
+   , m_qvecStallEnds(StallHistorySize, -1LL)
+   , m_nNextStall(0)
+   , m_i64OpenStallStart(-1LL)
+   , m_i64StallThreshold(DefaultStallThreshold * 1000000LL)
+   , m_nNumStalls(0)
+   , m_i64MaxLatency(0LL)
+{
+   m_clock.start();
+
+   m_heartbeat.setTimerType(Qt::PreciseTimer);
+   m_heartbeat.setInterval(HeartbeatInterval);
+
+   connect(&m_heartbeat, &QTimer::timeout, this, &EventLoopWatchdog::onHeartbeat);
+}
+
+
+/**
+ * @brief EventLoopWatchdog::~EventLoopWatchdog
+ */
+EventLoopWatchdog::~EventLoopWatchdog()
+{
+   stopWatching();
+}
+
+
+/**
+ * @brief EventLoopWatchdog::startWatching
+ */
+void EventLoopWatchdog::startWatching()
+{
+   if (isRunning()) { return; }
+
+   m_i64LastBeat = now();
+   m_bQuit = false;
+
+   m_heartbeat.start();
+   start();
+}
+
+
+/**
+ * @brief EventLoopWatchdog::stopWatching
+ */
+void EventLoopWatchdog::stopWatching()
+{
+   m_heartbeat.stop();
+
+   m_bQuit = true;
+   wait();
+}
+
+
+/**
+ * @brief EventLoopWatchdog::setStallThreshold
+ * @param thresholdMs Event loop latency from which on a trial is flagged
+ */
+void EventLoopWatchdog::setStallThreshold(int thresholdMs)
+{
+   QMutexLocker locker(&m_mutex);
+
+   m_i64StallThreshold = std::max(1, thresholdMs) * 1000000LL;
+}
+
+
+/**
+ * @brief EventLoopWatchdog::getStallThreshold
+ * @return Milliseconds
+ */
+int EventLoopWatchdog::getStallThreshold() const
+{
+   QMutexLocker locker(&m_mutex);
+
+   return static_cast<int>(m_i64StallThreshold / 1000000LL);
+}
+
+
+/**
+ * @brief EventLoopWatchdog::now
+ * @return Nanoseconds on the watchdog's clock, for longestStall()
+ */
+qint64 EventLoopWatchdog::now() const
+{
+   return m_clock.nsecsElapsed();
+}
+
+
+/**
+ * @brief EventLoopWatchdog::longestStall
+ * @param fromNs Start of the window, see now()
+ * @param toNs End of the window
+ * @return Longest stall overlapping the window in milliseconds, 0 if none
+ *
+ * Includes a stall that is still in progress or has just ended without
+ * a heartbeat yet, e.g. when called from the event that ended it.
+ */
+int EventLoopWatchdog::longestStall(qint64 fromNs, qint64 toNs) const
+{
+   const qint64 current = now();
+   const qint64 lastBeat = m_i64LastBeat;
+
+   QMutexLocker locker(&m_mutex);
+
+   qint64 longest = 0LL;
+
+   for (int i=0; i<StallHistorySize; i++)
+   {
+      const qint64 start = m_qvecStallStarts.at(i);
+      const qint64 end = m_qvecStallEnds.at(i);
+
+      if (start >= 0LL && start < toNs && end > fromNs) { longest = std::max(longest, end - start); }
+   }
+
+   // Gap since the last beat
+   const qint64 gap = current - lastBeat - HeartbeatInterval * 1000000LL;
+   if (gap > m_i64StallThreshold && lastBeat < toNs) { longest = std::max(longest, gap); }
+
+   return static_cast<int>(longest / 1000000LL);
+}
+
+
+/**
+ * @brief EventLoopWatchdog::resetStatistics
+ */
+void EventLoopWatchdog::resetStatistics()
+{
+   QMutexLocker locker(&m_mutex);
+
+   m_nNumStalls = 0;
+   m_i64MaxLatency = 0LL;
+}
+
+
+/**
+ * @brief EventLoopWatchdog::getNumStalls
+ * @return Stalls above the threshold since resetStatistics()
+ */
+int EventLoopWatchdog::getNumStalls() const
+{
+   QMutexLocker locker(&m_mutex);
+
+   return m_nNumStalls;
+}
+
+
+/**
+ * @brief EventLoopWatchdog::getMaxLatency
+ * @return Highest event loop latency since resetStatistics() in milliseconds
+ */
+double EventLoopWatchdog::getMaxLatency() const
+{
+   QMutexLocker locker(&m_mutex);
+
+   return m_i64MaxLatency / 1.0e6;
+}
+
+
+/**
+ * @brief EventLoopWatchdog::onHeartbeat
+ */
+void EventLoopWatchdog::onHeartbeat()
+{
+   m_i64LastBeat = now();
+}
+
+
+/**
+ * @brief EventLoopWatchdog::run
+ */
+void EventLoopWatchdog::run()
+{
+   while (!m_bQuit)
+   {
+      const qint64 lastBeat = m_i64LastBeat;
+      const qint64 latency = now() - lastBeat - HeartbeatInterval * 1000000LL;
+
+      {
+         QMutexLocker locker(&m_mutex);
+
+         m_i64MaxLatency = std::max(m_i64MaxLatency, latency);
+
+         if (latency > m_i64StallThreshold)
+         {
+            if (m_i64OpenStallStart < 0LL) { m_i64OpenStallStart = lastBeat; }
+         }
+         else if (m_i64OpenStallStart >= 0LL)
+         {
+            // The beat that ended the stall
+            m_qvecStallStarts[m_nNextStall] = m_i64OpenStallStart;
+            m_qvecStallEnds[m_nNextStall] = lastBeat;
+            m_nNextStall = (m_nNextStall + 1) % StallHistorySize;
+
+            m_i64OpenStallStart = -1LL;
+            m_nNumStalls++;
+         }
+      }
+
+      msleep(1);
+   }
+}
@@ -0,0 +1,78 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QVector>
+
+#include <atomic>
+
+
+/**
+ * @brief The EventLoopWatchdog class
+ *
+ * A heartbeat timer on the GUI thread stamps the time of every beat; the
+ * watchdog thread compares the last beat with the clock once per
+ * millisecond. A gap longer than the threshold is a stall of the event
+ * loop. The most recent stalls are kept, so a trial can be checked for an
+ * overlap with a stall when its response is recorded.
+ */
+class EventLoopWatchdog : public QThread
+{
+      Q_OBJECT
+
+   public:
+      static constexpr int HeartbeatInterval     = 2;   // ms
+      static constexpr int DefaultStallThreshold = 20;  // ms
+      static constexpr int StallHistorySize      = 256; // Most recent stalls
+
+      explicit EventLoopWatchdog(QObject* parent = nullptr);
+      virtual ~EventLoopWatchdog();
+
+      void startWatching();
+      void stopWatching();
+
+      void setStallThreshold(int thresholdMs);
+      int getStallThreshold() const;
+
+      qint64 now() const;
+      int longestStall(qint64 fromNs, qint64 toNs) const;
+
+      void resetStatistics();
+      int getNumStalls() const;
+      double getMaxLatency() const;
+
+   protected:
+      virtual void run();
+
+   private slots:
+      void onHeartbeat();
+
+   private:
+      QElapsedTimer m_clock;
+      QTimer m_heartbeat;
+
+      std::atomic<qint64> m_i64LastBeat; // ns of m_clock
+      std::atomic<bool>   m_bQuit;
+
+      mutable QMutex m_mutex;
+      QVector<qint64> m_qvecStallStarts; // Ring of the recent stalls (ns)
+      QVector<qint64> m_qvecStallEnds;
+      int    m_nNextStall;
+      qint64 m_i64OpenStallStart;        // -1: no stall in progress
+      qint64 m_i64StallThreshold;        // ns
+
+      // Since resetStatistics()
+      int    m_nNumStalls;
+      qint64 m_i64MaxLatency;            // ns
+};
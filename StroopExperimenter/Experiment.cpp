@@ -72,6 +72,26 @@ void Experiment::setPersonID(const QString& strPersonID)
 }
 
 
+/**
+ * @brief Experiment::getFilePath
+ * @return
+ */
+QString Experiment::getFilePath() const
+{
+   return m_strFilePath;
+}
+
+
+/**
+ * @brief Experiment::setFilePath
+ * @param filePath
+ */
+void Experiment::setFilePath(const QString& filePath)
+{
+   m_strFilePath = filePath;
+}
+
+
 /**
  * @brief Experiment::getGlobalIndex
  * @return
@@ -249,6 +269,12 @@ Qt::GlobalColor Experiment::convertStringToColor(const QString& colorStr)
    else if (colorStr == "red")        { return Qt::red;        }
    else if (colorStr == "green")      { return Qt::green;      }
    else if (colorStr == "blue")       { return Qt::blue;       }
+   // German names as written by convertColorToString(color, true)
+   else if (colorStr == "weiß")       { return Qt::white;      }
+   else if (colorStr == "rot")        { return Qt::red;        }
+   else if (colorStr == "grün")       { return Qt::green;      }
+   else if (colorStr == "blau")       { return Qt::blue;       }
+   else if (colorStr == "gelb")       { return Qt::yellow;     }
    else if (colorStr == "darkgray")   { return Qt::darkGray;   }
    else if (colorStr == "gray")       { return Qt::gray;       }
    else if (colorStr == "lightgray")  { return Qt::lightGray;  }
@@ -275,3 +301,13 @@ void Experiment::setNumTrials(int nNumTrials)
 {
    m_nNumTrials = nNumTrials;
 }
+
+
+/**
+ * @brief Experiment::getNumTrials
+ * @return
+ */
+int Experiment::getNumTrials() const
+{
+   return m_nNumTrials;
+}
@@ -34,6 +34,9 @@ class Experiment : public QObject
       QString getPersonID() const;
       void setPersonID(const QString& getPersonID);
 
+      QString getFilePath() const;
+      void setFilePath(const QString& filePath);
+
       virtual QMap<QString, QVariant> getDataToSave() = 0;
       virtual void setLoadedData(const QMap<QString, QVariant>& data) = 0;
 
@@ -51,6 +54,7 @@ class Experiment : public QObject
       static QString convertColorForStylesheet(Qt::GlobalColor color);
 
       void setNumTrials(int nNumTrials);
+      int getNumTrials() const;
 
 signals:
       void started(int idx);
@@ -65,5 +69,6 @@ signals:
       bool m_bStopped;
       QString m_strExperimentName;
       QString m_strPersonID;
+      QString m_strFilePath; // Experiment file of the loaded person
       std::weak_ptr<DataReaderWriter> m_wpDataRW;
 };
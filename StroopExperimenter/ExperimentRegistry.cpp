@@ -0,0 +1,132 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "ExperimentRegistry.h"
+#include "Experiment.h"
+
+#include <QDir>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QPluginLoader>
+
+#include <iostream>
+
+
+/**
+ * @brief ExperimentRegistry::registerFactory
+ * @param type Lower-case file extension, e.g. "stroop"
+ * @param factory
+ */
+void ExperimentRegistry::registerFactory(const QString& type, const ExperimentFactory& factory)
+{
+   m_qmapFactories.insert(type.toLower(), factory);
+}
+
+
+/**
+ * @brief ExperimentRegistry::scanPlugins
+ * @param directory
+ * @return Number of experiment types found
+ *
+ * Only reads the metadata of the libraries in directory; a plugin is
+ * loaded by create() once one of its types is used.
+ */
+int ExperimentRegistry::scanPlugins(const QString& directory)
+{
+   int numTypes = 0;
+
+   const QDir dir(directory);
+   const QStringList files = dir.entryList(QDir::Files);
+   for (const QString& file : files)
+   {
+      const QString filePath = dir.absoluteFilePath(file);
+      if (!QLibrary::isLibrary(filePath)) { continue; }
+
+      QPluginLoader loader(filePath);
+      const QJsonObject metaData = loader.metaData();
+      if (metaData.value("IID").toString() != QLatin1String(ExperimentPlugin_iid)) { continue; }
+
+      const QJsonArray types = metaData.value("MetaData").toObject().value("types").toArray();
+      for (const QJsonValue& type : types)
+      {
+         const QString key = type.toString().toLower();
+         if (key.isEmpty() || m_qmapFactories.contains(key)) { continue; }
+
+         m_qmapPluginFiles.insert(key, filePath);
+         numTypes++;
+
+         std::cout << "Experiment plugin: " << key.toStdString()
+                   << " (" << file.toStdString() << ")" << std::endl;
+      }
+   }
+
+   return numTypes;
+}
+
+
+/**
+ * @brief ExperimentRegistry::contains
+ * @param type
+ * @return
+ */
+bool ExperimentRegistry::contains(const QString& type) const
+{
+   const QString key = type.toLower();
+   return m_qmapFactories.contains(key) || m_qmapPluginFiles.contains(key);
+}
+
+
+/**
+ * @brief ExperimentRegistry::types
+ * @return Registered types followed by those of plugins
+ */
+QStringList ExperimentRegistry::types() const
+{
+   QStringList result = m_qmapFactories.keys();
+   result.append(m_qmapPluginFiles.keys());
+
+   return result;
+}
+
+
+/**
+ * @brief ExperimentRegistry::create
+ * @param type
+ * @param globalIndex
+ * @param numTrials
+ * @param wpDataRW
+ * @return nullptr if the type is unknown or its plugin cannot be loaded
+ */
+std::shared_ptr<Experiment> ExperimentRegistry::create(const QString& type, int globalIndex,
+                                                       int numTrials,
+                                                       std::weak_ptr<DataReaderWriter> wpDataRW) const
+{
+   const QString key = type.toLower();
+
+   if (m_qmapFactories.contains(key))
+   {
+      return m_qmapFactories.value(key)(globalIndex, numTrials, wpDataRW);
+   }
+
+   if (m_qmapPluginFiles.contains(key))
+   {
+      // The loader keeps the plugin loaded for the rest of the session
+      QPluginLoader loader(m_qmapPluginFiles.value(key));
+      ExperimentPlugin* plugin = qobject_cast<ExperimentPlugin*>(loader.instance());
+      if (plugin)
+      {
+         return plugin->createExperiment(key, globalIndex, numTrials, wpDataRW);
+      }
+
+      std::cout << "Cannot load experiment plugin " << m_qmapPluginFiles.value(key).toStdString()
+                << ": " << loader.errorString().toStdString() << std::endl;
+   }
+
+   return nullptr;
+}
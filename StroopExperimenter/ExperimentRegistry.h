@@ -0,0 +1,75 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QMap>
+#include <QStringList>
+#include <QtPlugin>
+
+#include <functional>
+#include <memory>
+
+// Forward declarations
+class Experiment;
+class DataReaderWriter;
+
+
+// Creates the experiment of one paradigm (see Experimenter::getExperiment())
+using ExperimentFactory = std::function< std::shared_ptr<Experiment>(
+                                            int globalIndex, int numTrials,
+                                            std::weak_ptr<DataReaderWriter> wpDataRW) >;
+
+
+/**
+ * @brief The ExperimentPlugin class
+ *
+ * Interface of paradigms built as Qt plugins. The experiment they create
+ * derives from Experiment and thereby uses the same storage as the built-in
+ * paradigms. The plugin's metadata (Q_PLUGIN_METADATA ... FILE) lists the
+ * experiment types it provides, e.g. { "types": [ "flanker" ] }, so
+ * plugins are only loaded once one of their types is used.
+ */
+class ExperimentPlugin
+{
+   public:
+      virtual ~ExperimentPlugin() = default;
+
+      virtual std::shared_ptr<Experiment> createExperiment(const QString& type,
+                                                           int globalIndex, int numTrials,
+                                                           std::weak_ptr<DataReaderWriter> wpDataRW) = 0;
+};
+
+#define ExperimentPlugin_iid "de.uni-siegen.mi.StroopExperimenter.ExperimentPlugin/1.0"
+Q_DECLARE_INTERFACE(ExperimentPlugin, ExperimentPlugin_iid)
+
+
+/**
+ * @brief The ExperimentRegistry class
+ *
+ * Maps experiment types (the extension of the participant's file, see
+ * Experimenter::parseFileName()) to factories, either registered in code
+ * or provided by plugins. Nothing is instantiated before create().
+ */
+class ExperimentRegistry
+{
+   public:
+      void registerFactory(const QString& type, const ExperimentFactory& factory);
+      int scanPlugins(const QString& directory);
+
+      bool contains(const QString& type) const;
+      QStringList types() const;
+
+      std::shared_ptr<Experiment> create(const QString& type, int globalIndex, int numTrials,
+                                         std::weak_ptr<DataReaderWriter> wpDataRW) const;
+
+   private:
+      QMap<QString, ExperimentFactory> m_qmapFactories;
+      QMap<QString, QString> m_qmapPluginFiles; // Type -> plugin, loaded by create()
+};
@@ -11,11 +11,13 @@
 #include "Experimenter.h"
 #include "StroopExperiment.h"
 #include "DataReaderWriter.h"
+#include "StudyPlan.h"
 
 #include <QRegularExpression>
 #include <QFileInfo>
 #include <QCoreApplication>
 #include <QDir>
+#include <QtConcurrent>
 
 #include <iostream>
 
@@ -28,6 +30,7 @@ Experimenter::Experimenter(std::weak_ptr<DataReaderWriter> dataRW, QObject* pare
    : QObject(parent)
    , m_wpDataRW(dataRW)
    , m_nNumExperimentRuns(100)
+   , m_bLoading(false)
 {
    QString personID("default");
    QString expName("stroop");
@@ -37,6 +40,27 @@ Experimenter::Experimenter(std::weak_ptr<DataReaderWriter> dataRW, QObject* pare
 
    m_pairLastLoadedExperimentInfo =
          QPair<bool,QStringList>(false, fileInfo);
+
+   // Built-in paradigms; further ones can come from plugins
+   m_registry.registerFactory("stroop", [](int globalIndex, int numTrials,
+                                           std::weak_ptr<DataReaderWriter> wpDataRW)
+   {
+      return std::make_shared<StroopExperiment>(globalIndex, numTrials, wpDataRW);
+   });
+   m_strliExperimentNames = m_registry.types();
+
+   connect(&m_loadWatcher, &QFutureWatcher< QMap<QString, QVariant> >::finished,
+           this, &Experimenter::onLoadingFinished);
+}
+
+
+/**
+ * @brief Experimenter::~Experimenter
+ * A run that is still being saved is completed.
+ */
+Experimenter::~Experimenter()
+{
+   m_futureSave.waitForFinished();
 }
 
 
@@ -52,43 +76,66 @@ QStringList Experimenter::getExperimentNamesList() const
 
 /**
  * @brief Experimenter::setExperimentNamesList
- * @param qvecExperiments
+ * @param qvecExperiments Restricts the supported types (default: all registered)
  */
 void Experimenter::setExperimentNamesList(const QStringList& experimentNames)
 {
    m_strliExperimentNames = experimentNames;
+}
 
-   createExperiments();
+
+/**
+ * @brief Experimenter::getRegistry
+ * @return Factories of all paradigms, e.g. to register further ones
+ */
+ExperimentRegistry& Experimenter::getRegistry()
+{
+   return m_registry;
 }
 
 
 /**
- * @brief Experimenter::createExperiments
+ * @brief Experimenter::loadExperimentPlugins
+ * @param directory
+ * @return Number of experiment types found; their plugins are loaded on first use
  */
-void Experimenter::createExperiments()
+int Experimenter::loadExperimentPlugins(const QString& directory)
 {
-   int numExp = m_strliExperimentNames.count();
+   const int numTypes = m_registry.scanPlugins(directory);
 
-   for (int idx=0; idx<numExp; idx++)
+   const QStringList types = m_registry.types();
+   for (const QString& type : types)
    {
-      const QString& key = m_strliExperimentNames.at(idx);
-
-      if (key == "stroop")
-      {
-         std::shared_ptr<StroopExperiment> exp =
-               std::make_shared<StroopExperiment>(idx, m_nNumExperimentRuns,
-                                                  m_wpDataRW);
-
-         connect(exp.get(), &StroopExperiment::started,
-                 this, &Experimenter::experimentStarted);
-         connect(exp.get(), &StroopExperiment::stopped,
-                 this, &Experimenter::experimentStopped);   // (re-)send signal
-         connect(exp.get(), &StroopExperiment::stopped,
-                 this, &Experimenter::onExperimentStopped); // slot
-
-         m_qmapExperiments.insert(key, exp);
-      }
+      if (!m_strliExperimentNames.contains(type)) { m_strliExperimentNames.append(type); }
    }
+
+   return numTypes;
+}
+
+
+/**
+ * @brief Experimenter::createExperiment
+ * @param expName Supported type
+ * @return nullptr if it cannot be created
+ */
+std::shared_ptr<Experiment> Experimenter::createExperiment(const QString& expName)
+{
+   const int idx = m_strliExperimentNames.indexOf(expName);
+
+   std::shared_ptr<Experiment> exp = m_registry.create(expName, idx, m_nNumExperimentRuns,
+                                                       m_wpDataRW);
+   if (!exp) { return exp; }
+
+   connect(exp.get(), &Experiment::started,
+           this, &Experimenter::experimentStarted);
+   connect(exp.get(), &Experiment::stopped,
+           this, &Experimenter::experimentStopped);   // (re-)send signal
+   connect(exp.get(), &Experiment::stopped,
+           this, &Experimenter::onExperimentStopped); // slot
+
+   m_qmapExperiments.insert(expName, exp);
+
+   return exp;
 }
 
 
@@ -131,7 +178,11 @@ QStringList Experimenter::parseFileName(const QString& fileLocation)
 /**
  * @brief Experimenter::loadExperiment
  * @param fileName
- * @return
+ * @return False if the file name or experiment is not supported
+ *
+ * An existing file is read on the thread pool: loadingStarted() is emitted
+ * now, experimentLoaded() once the data is set. A later call supersedes a
+ * pending one.
  */
 bool Experimenter::loadExperiment(const QString& fileName)
 {
@@ -142,25 +193,17 @@ bool Experimenter::loadExperiment(const QString& fileName)
       return false;
    }
 
-   const QString& personID = fileInfo.at(0);
    const QString& expName = fileInfo.at(1);
    const QString& filePath = fileInfo.at(2);
 
    // Check if the experiment is supported
-   bool expSupported = m_strliExperimentNames.contains(expName, Qt::CaseInsensitive);
+   bool expSupported = m_strliExperimentNames.contains(expName, Qt::CaseInsensitive)
+                       && m_registry.contains(expName);
    if (!expSupported) {
       // QString("The specified type of experiment ('%1') is not supported.").arg(expName);
       return false;
    }
 
-   // Update matching Experiment instance and set it as active
-   std::shared_ptr<Experiment> exp = m_qmapExperiments.value(expName);
-   if (exp)
-   {
-      exp->setExperimentName(expName);
-      exp->setPersonID(personID);
-   }
-
    // Create empty file if the specified one doesn't exist.
    if ( !QFileInfo::exists(filePath) )
    {
@@ -169,16 +212,90 @@ bool Experimenter::loadExperiment(const QString& fileName)
       file.close();
 
       std::cout << "Created specified file: " << filePath.toStdString() << std::endl;
+
+      // Drop the runs of a previously loaded participant
+      m_bLoading = false;
+      finishLoading(fileInfo, QMap<QString, QVariant>());
+      return true;
    }
-   else
+
+   // Load data (for running statistics or visualization...) in the background
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   m_strlPendingFileInfo = fileInfo;
+   m_bLoading = true;
+   emit loadingStarted(filePath);
+
+   // Read after the last run is saved, it may have been this file
+   QFuture<bool> pendingSave = m_futureSave;
+
+   m_loadWatcher.setFuture(QtConcurrent::run([spDataRW, filePath, pendingSave]() mutable
    {
-      // Load data (for running statistics or visualization...)
-      if (std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock())
+      pendingSave.waitForFinished();
+
+      QMap<QString, QVariant> data;
+      spDataRW->loadData(filePath, data);
+      return data;
+   }));
+
+   return true;
+}
+
+
+/**
+ * @brief Experimenter::isLoading
+ * @return True while a participant file is read
+ */
+bool Experimenter::isLoading() const
+{
+   return m_bLoading;
+}
+
+
+/**
+ * @brief Experimenter::onLoadingFinished
+ */
+void Experimenter::onLoadingFinished()
+{
+   if (!m_bLoading) { return; } // Superseded by a new, empty file
+
+   m_bLoading = false;
+   finishLoading(m_strlPendingFileInfo, m_loadWatcher.result());
+}
+
+
+/**
+ * @brief Experimenter::finishLoading
+ * @param fileInfo See parseFileName()
+ * @param data Contents of the participant's file
+ */
+void Experimenter::finishLoading(const QStringList& fileInfo, const QMap<QString, QVariant>& data)
+{
+   const QString& personID = fileInfo.at(0);
+   const QString& expName = fileInfo.at(1);
+   const QString& filePath = fileInfo.at(2);
+
+   // Update matching Experiment instance (created now if first used) and set it as active
+   std::shared_ptr<Experiment> exp = getExperiment(expName);
+   if (exp)
+   {
+      exp->setExperimentName(expName);
+      exp->setPersonID(personID);
+      exp->setFilePath(filePath);
+      exp->setLoadedData(data);
+   }
+
+   // Participants of the study plan get their precomputed sequence
+   std::shared_ptr<StroopExperiment> stroopExp = std::dynamic_pointer_cast<StroopExperiment>(exp);
+   if (stroopExp && m_spStudyPlan)
+   {
+      StudyPlanEntry entry;
+      if (m_spStudyPlan->lookup(personID, entry))
       {
-         QMap<QString, QVariant> data;
-         spDataRW->loadData(filePath, data);
-         exp->setLoadedData(data);
+         std::cout << "Using the study plan sequence of " << personID.toStdString() << std::endl;
       }
+      stroopExp->setPlannedSequence(entry);
    }
    // Save info about currently loaded file.
    m_pairLastLoadedExperimentInfo = QPair<bool,QStringList>(true, fileInfo);
@@ -187,7 +304,23 @@ bool Experimenter::loadExperiment(const QString& fileName)
    QRegularExpression regExp(expName, QRegularExpression::CaseInsensitiveOption);
    int expID = m_strliExperimentNames.indexOf(regExp);
    emit experimentLoaded(expID);
+}
+
+
+/**
+ * @brief Experimenter::setStudyPlan
+ * @param filePath Plan file written by TrialSequencePlanner::precomputeStudy()
+ * @return
+ */
+bool Experimenter::setStudyPlan(const QString& filePath)
+{
+   std::shared_ptr<StudyPlan> spStudyPlan = std::make_shared<StudyPlan>();
+   if (!spStudyPlan->open(filePath))
+   {
+      return false;
+   }
 
+   m_spStudyPlan = spStudyPlan;
    return true;
 }
 
@@ -211,9 +344,10 @@ void Experimenter::saveExperiment(const QString& fileName, const QString& expNam
    if (std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock())
    {
       std::shared_ptr<Experiment> exp = m_qmapExperiments.value(expName);
+      if (!exp) { return; } // Never used, nothing to save
 
-      QMap<QString, QVariant> data = exp->getDataToSave();
-      spDataRW->saveData(fileName, data);
+      m_futureSave.waitForFinished();
+      spDataRW->saveData(fileName, exp->getDataToSave());
    }
 }
 
@@ -241,16 +375,42 @@ void Experimenter::onTabChanged(int tabID)
 
 
 /**
- * @brief Experimenter::saveCurrentFile
+ * @brief Experimenter::onExperimentStopped
+ * @param idx Global index of the stopped experiment
+ *
+ * Saves the run to the participant's file on the thread pool, so the GUI
+ * thread keeps serving other stations meanwhile; experimentSaved() is
+ * emitted when it is written. Saves are written in order.
  */
 void Experimenter::onExperimentStopped(int idx)
 {
-   Q_UNUSED(idx); // Use idx to double check signal sender if needed.
-
    const QString& expName = m_pairLastLoadedExperimentInfo.second.at(1);
    const QString& filePath = m_pairLastLoadedExperimentInfo.second.at(2);
 
-   saveExperiment(filePath, expName);
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   std::shared_ptr<Experiment> exp = m_qmapExperiments.value(expName);
+   if (!spDataRW || !exp)
+   {
+      emit experimentSaved(idx); // Nothing to save
+      return;
+   }
+
+   const QMap<QString, QVariant> data = exp->getDataToSave();
+   QFuture<bool> previousSave = m_futureSave;
+
+   m_futureSave = QtConcurrent::run([spDataRW, filePath, data, previousSave]() mutable
+   {
+      previousSave.waitForFinished();
+      return spDataRW->saveData(filePath, data);
+   });
+
+   QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+   connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher, idx]()
+   {
+      watcher->deleteLater();
+      emit experimentSaved(idx);
+   });
+   watcher->setFuture(m_futureSave);
 }
 
 
@@ -269,11 +429,19 @@ void Experimenter::addExperiment(const QString& name,
 /**
  * @brief Experimenter::getExperiment
  * @param name
- * @return
+ * @return The experiment of a supported type, created on first use
  */
-std::shared_ptr<Experiment> Experimenter::getExperiment(const QString& expName) const
+std::shared_ptr<Experiment> Experimenter::getExperiment(const QString& expName)
 {
-   return m_qmapExperiments.value(expName);
+   const QString key = expName.toLower();
+   std::shared_ptr<Experiment> exp = m_qmapExperiments.value(key);
+
+   if (!exp && m_strliExperimentNames.contains(key) && m_registry.contains(key))
+   {
+      exp = createExperiment(key);
+   }
+
+   return exp;
 }
 
 
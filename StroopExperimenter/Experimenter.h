@@ -13,10 +13,16 @@
 #include <QObject>
 #include <QMap>
 #include <QStringList>
+#include <QVariant>
+#include <QFuture>
+#include <QFutureWatcher>
+
+#include "ExperimentRegistry.h"
 
 // Forward declarations
 class DataReaderWriter;
 class Experiment;
+class StudyPlan;
 
 
 /**
@@ -28,8 +34,10 @@ class Experimenter : public QObject
 
    public:
       explicit Experimenter(std::weak_ptr<DataReaderWriter> dataRW, QObject* parent = nullptr);
+      virtual ~Experimenter();
 
       bool loadExperiment(const QString& fileName);
+      bool isLoading() const;
       QPair<bool, QStringList> getLastLoadedExperimentInfo();
       void saveExperiment(const QString& fileName, const QString& expName);
 
@@ -38,7 +46,18 @@ class Experimenter : public QObject
       QStringList getExperimentNamesList() const;
       void setExperimentNamesList(const QStringList& experiments);
 
-      std::shared_ptr<Experiment> getExperiment(const QString& expName) const;
+      std::shared_ptr<Experiment> getExperiment(const QString& expName);
+
+      template <class T>
+      std::shared_ptr<T> getExperimentAs(const QString& expName)
+      {
+         return std::dynamic_pointer_cast<T>(getExperiment(expName));
+      }
+
+      ExperimentRegistry& getRegistry();
+      int loadExperimentPlugins(const QString& directory);
+
+      bool setStudyPlan(const QString& filePath);
 
 
    public slots:
@@ -47,27 +66,32 @@ class Experimenter : public QObject
 
 
    signals:
+      void loadingStarted(const QString& filePath);
       void experimentLoaded(int idx);
       void experimentStarted(int idx);
       void experimentStopped(int idx);
+      void experimentSaved(int idx); // The stopped run is in its file
 
    private slots:
       void onExperimentStopped(int idx);
+      void onLoadingFinished();
 
    private:
       // Methods
-      void createExperiments();
+      std::shared_ptr<Experiment> createExperiment(const QString& expName);
 
       void addExperiment(const QString& name,
                          std::shared_ptr<Experiment> experiment);
       void removeExperiment(const QString& name);
 
       QStringList parseFileName(const QString& filePath);
+      void finishLoading(const QStringList& fileInfo, const QMap<QString, QVariant>& data);
 
       // Variables
-      QStringList m_strliExperimentNames;
+      QStringList m_strliExperimentNames; // Supported types, index is the global index
 
-      QMap< QString, std::shared_ptr<Experiment> > m_qmapExperiments;
+      ExperimentRegistry m_registry;
+      QMap< QString, std::shared_ptr<Experiment> > m_qmapExperiments; // Created on first use
 
       std::weak_ptr<DataReaderWriter> m_wpDataRW;
 
@@ -75,4 +99,15 @@ class Experimenter : public QObject
       QPair<bool, QStringList> m_pairLastLoadedExperimentInfo;
 
       int m_nNumExperimentRuns;
+
+      // Precomputed sequences, looked up by person ID on loading
+      std::shared_ptr<StudyPlan> m_spStudyPlan;
+
+      // Participant file read on the thread pool, see loadExperiment()
+      QFutureWatcher< QMap<QString, QVariant> > m_loadWatcher;
+      QStringList m_strlPendingFileInfo;
+      bool m_bLoading;
+
+      // Last run saved on the thread pool, see onExperimentStopped()
+      QFuture<bool> m_futureSave;
 };
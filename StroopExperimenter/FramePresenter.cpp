@@ -0,0 +1,226 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "FramePresenter.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QScreen>
+#include <QSurfaceFormat>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+
+/**
+ * @brief FramePresenter::FramePresenter
+ * @param parent Dialog whose window is swapped
+ */
+FramePresenter::FramePresenter(QWidget* parent)
+   : QOpenGLWidget(parent)
+   , m_i64LastSwap(0LL)
+   , m_i64Frame(0LL)
+   , m_i64FrameStart(0LL)
+   , m_bRunning(false)
+   , m_bMeasuring(false)
+   , m_bSynchronized(true)
+   , m_nNumSwaps(0)
+   , m_dRefreshInterval(1000.0 / 60.0)
+   , m_dRefreshDeviation(0.0)
+{
+   // Swaps wait for the vertical blank
+   QSurfaceFormat format = this->format();
+   format.setSwapInterval(1);
+   setFormat(format);
+
+   // Only the swaps are of interest, the widget itself is a pixel
+   setFixedSize(1, 1);
+   move(0, 0);
+
+   m_qvecIntervals.reserve(MeasuredFrames);
+
+   connect(this, &QOpenGLWidget::frameSwapped, this, &FramePresenter::onFrameSwapped);
+}
+
+
+/**
+ * @brief FramePresenter::measureRefreshInterval
+ * Starts the swap loop; refreshMeasured() is emitted after
+ * WarmupFrames + MeasuredFrames swaps, framePresented() from then on.
+ */
+void FramePresenter::measureRefreshInterval()
+{
+   m_qvecIntervals.clear();
+   m_nNumSwaps = 0;
+   m_i64Frame = 0LL;
+   m_bMeasuring = true;
+   m_bSynchronized = true;
+   m_bRunning = true;
+
+   m_eltiSwaps.start();
+   m_i64LastSwap = 0LL;
+
+   update();
+}
+
+
+/**
+ * @brief FramePresenter::stop
+ * Ends the swap loop, e.g. when the dialog is closed.
+ */
+void FramePresenter::stop()
+{
+   m_bRunning = false;
+   m_bMeasuring = false;
+}
+
+
+/**
+ * @brief FramePresenter::isRunning
+ * @return
+ */
+bool FramePresenter::isRunning() const
+{
+   return m_bRunning;
+}
+
+
+/**
+ * @brief FramePresenter::isSynchronized
+ * @return False if the measurement found swaps faster than the display
+ *         (frame numbers are derived from the time then)
+ */
+bool FramePresenter::isSynchronized() const
+{
+   return m_bSynchronized;
+}
+
+
+/**
+ * @brief FramePresenter::getRefreshInterval
+ * @return Measured refresh interval in ms
+ */
+double FramePresenter::getRefreshInterval() const
+{
+   return m_dRefreshInterval;
+}
+
+
+/**
+ * @brief FramePresenter::getRefreshDeviation
+ * @return Standard deviation of the measured swap intervals in ms
+ */
+double FramePresenter::getRefreshDeviation() const
+{
+   return m_dRefreshDeviation;
+}
+
+
+/**
+ * @brief FramePresenter::paintGL
+ * Same color as the background of the dialog.
+ */
+void FramePresenter::paintGL()
+{
+   QOpenGLFunctions* gl = QOpenGLContext::currentContext()->functions();
+   gl->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+   gl->glClear(GL_COLOR_BUFFER_BIT);
+}
+
+
+/**
+ * @brief FramePresenter::onFrameSwapped
+ * Called after the window has returned from swapping its buffers.
+ */
+void FramePresenter::onFrameSwapped()
+{
+   if (!m_bRunning) { return; }
+
+   const qint64 now = m_eltiSwaps.nsecsElapsed();
+   const double interval = (now - m_i64LastSwap) / 1000000.0;
+   m_i64LastSwap = now;
+
+   // The next frame is requested first, so receivers may take their time
+   // until the vertical blank
+   update();
+
+   if (m_bMeasuring)
+   {
+      m_nNumSwaps++;
+      if (m_nNumSwaps > WarmupFrames) { m_qvecIntervals.append(interval); }
+      if (m_qvecIntervals.count() >= MeasuredFrames) { finishMeasurement(); }
+      return;
+   }
+
+   int dropped = 0;
+   if (m_bSynchronized)
+   {
+      if (interval > 1.5 * m_dRefreshInterval)
+      {
+         dropped = qRound(interval / m_dRefreshInterval) - 1;
+      }
+
+      m_i64Frame += 1 + dropped;
+   }
+   else
+   {
+      // Several swaps per refresh: only the first one presents a frame
+      const qint64 frame = static_cast<qint64>((now - m_i64FrameStart) / (m_dRefreshInterval * 1000000.0));
+      if (frame <= m_i64Frame) { return; }
+
+      dropped = static_cast<int>(frame - m_i64Frame - 1);
+      m_i64Frame = frame;
+   }
+
+   emit framePresented(m_i64Frame, dropped);
+}
+
+
+/**
+ * @brief FramePresenter::finishMeasurement
+ * Swaps faster than 2 ms are not synchronized to the display (e.g. vsync
+ * disabled by the driver); the nominal rate of the screen is used then,
+ * and the frames are counted in time, see onFrameSwapped().
+ */
+void FramePresenter::finishMeasurement()
+{
+   double sum = 0.0;
+   for (double interval : m_qvecIntervals) { sum += interval; }
+   const double mean = sum / m_qvecIntervals.count();
+
+   double sumSq = 0.0;
+   for (double interval : m_qvecIntervals) { sumSq += (interval - mean) * (interval - mean); }
+   m_dRefreshDeviation = std::sqrt(sumSq / (m_qvecIntervals.count() - 1));
+
+   std::sort(m_qvecIntervals.begin(), m_qvecIntervals.end());
+   const double median = m_qvecIntervals.at(m_qvecIntervals.count() / 2);
+
+   m_bMeasuring = false;
+   m_i64FrameStart = m_i64LastSwap;
+   m_bSynchronized = (median >= 2.0 && median <= 100.0);
+
+   if (m_bSynchronized)
+   {
+      m_dRefreshInterval = median;
+   }
+   else
+   {
+      const double rate = screen() ? screen()->refreshRate() : 60.0;
+      m_dRefreshInterval = 1000.0 / (rate > 0.0 ? rate : 60.0);
+
+      std::cout << "Frame timing: swaps are not synchronized to the display ("
+                << median << " ms), frames are counted in nominal refresh intervals" << std::endl;
+   }
+
+   std::cout << "Frame timing: refresh interval " << m_dRefreshInterval << " ms ("
+             << 1000.0 / m_dRefreshInterval << " Hz)" << std::endl;
+
+   emit refreshMeasured(m_dRefreshInterval);
+}
@@ -0,0 +1,79 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QOpenGLWidget>
+#include <QElapsedTimer>
+#include <QVector>
+
+
+/**
+ * @brief The FramePresenter class
+ *
+ * An OpenGL widget makes its top-level window compose through OpenGL, so
+ * the whole window (labels included) is swapped with the vertical blank
+ * of the display. The presenter requests a repaint after every swap, so
+ * frameSwapped() comes once per refresh and stimulus changes made in
+ * framePresented() are on screen with the next swap.
+ *
+ * measureRefreshInterval() times the first swaps (median of the
+ * intervals after a warm-up); afterwards a swap that comes later than
+ * 1.5 refresh intervals counts the refreshes it missed as dropped frames.
+ * Frame numbers count refreshes, dropped ones included.
+ *
+ * If the swaps are not synchronized to the display, the frame number is
+ * the time since the measurement in nominal refresh intervals, and
+ * framePresented() only comes with the first swap of each refresh.
+ */
+class FramePresenter : public QOpenGLWidget
+{
+      Q_OBJECT
+
+   public:
+      static constexpr int WarmupFrames   = 10;
+      static constexpr int MeasuredFrames = 60;
+
+      explicit FramePresenter(QWidget* parent = nullptr);
+
+      void measureRefreshInterval();
+      void stop();
+
+      bool isRunning() const;
+      bool isSynchronized() const;
+      double getRefreshInterval() const;
+      double getRefreshDeviation() const;
+
+   signals:
+      void refreshMeasured(double intervalMs);
+      void framePresented(qint64 frame, int droppedFrames);
+
+   protected:
+      virtual void paintGL();
+
+   private slots:
+      void onFrameSwapped();
+
+   private:
+      void finishMeasurement();
+
+      QElapsedTimer m_eltiSwaps;
+      qint64 m_i64LastSwap;   // ns of m_eltiSwaps
+      qint64 m_i64Frame;      // Refreshes since the measurement
+      qint64 m_i64FrameStart; // ns of m_eltiSwaps at frame 0
+
+      bool m_bRunning;
+      bool m_bMeasuring;
+      bool m_bSynchronized; // Swaps wait for the vertical blank
+      int  m_nNumSwaps;     // Since measureRefreshInterval()
+      QVector<double> m_qvecIntervals; // ms
+
+      double m_dRefreshInterval;  // ms
+      double m_dRefreshDeviation; // ms, standard deviation of the measured intervals
+};
@@ -14,12 +14,19 @@
 #include "Experimenter.h"
 #include "StroopExperiment.h"
 #include "StroopExperimentDialog.h"
+#include "StroopReEvaluation.h"
+#include "StroopTrialTableModel.h"
+#include "StroopSessionHistoryModel.h"
+#include "StroopRTPlotWidget.h"
 
 #include <iostream>
 #include <QLabel>
 #include <QStringList>
 #include <QFileDialog>
 #include <QDateTime>
+#include <QHeaderView>
+#include <QProgressBar>
+#include <QTimer>
 
 
 /**
@@ -33,10 +40,31 @@ MainWindow::MainWindow(std::weak_ptr<Experimenter> experimenter,
    , m_wpExperimenter(experimenter)
    , m_pFileStatusLabel(new QLabel(this))
    , m_pExperimentProgressLabel(new QLabel(this))
+   , m_pCalibrationLabel(new QLabel(this))
+   , m_pLoadingProgressBar(new QProgressBar(this))
+   , m_pTrialModel(new StroopTrialTableModel(this))
+   , m_pTrialFilterModel(new StroopTrialFilterModel(this))
+   , m_pHistoryModel(new StroopSessionHistoryModel(this))
+   , m_pHistoryTrialModel(new StroopTrialTableModel(this))
+   , m_nHistorySession(0)
+   , m_nStartupMilestones(0)
+   , m_bFirstPaintDone(false)
 {
    /* GUI initialization */
    m_upUI->setupUi(this);
-   m_upUI->resultsTableWidget->resizeColumnsToContents();
+
+   // Cells are formatted by the model on demand, rows have a fixed height
+   m_pTrialFilterModel->setSourceModel(m_pTrialModel);
+   m_upUI->resultsTableView->setModel(m_pTrialFilterModel);
+   m_upUI->resultsTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+   m_upUI->resultsTableView->resizeColumnsToContents();
+
+   // History: sessions sorted and filtered in the background, trials loaded on selection
+   m_upUI->historyTableView->setModel(m_pHistoryModel);
+   m_upUI->historyTableView->sortByColumn(StroopSessionHistoryModel::SessionColumn, Qt::DescendingOrder);
+   m_upUI->historyTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+   m_upUI->historyTrialsTableView->setModel(m_pHistoryTrialModel);
+   m_upUI->historyTrialsTableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
    this->setWindowTitle(QCoreApplication::applicationName());
 
    //   m_strlColumnTitles << "Text" << "Angezeigte Farbe"
@@ -51,11 +79,32 @@ MainWindow::MainWindow(std::weak_ptr<Experimenter> experimenter,
    m_upUI->statusBar->addPermanentWidget(m_pExperimentProgressLabel, 1);
    m_pExperimentProgressLabel->setText("No experiment currently running.");
 
+   m_pCalibrationLabel->setStyleSheet("QLabel { color : red; }");
+   m_pCalibrationLabel->setVisible(false);
+   m_upUI->statusBar->addPermanentWidget(m_pCalibrationLabel);
+
+   m_pLoadingProgressBar->setRange(0, 0); // Busy indicator
+   m_pLoadingProgressBar->setMaximumWidth(160);
+   m_pLoadingProgressBar->setVisible(false);
+   m_upUI->statusBar->addPermanentWidget(m_pLoadingProgressBar);
+
    if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
    {
-      spExperimenter->setExperimentNamesList(QStringList("stroop"));
+      // Experiment dialog: created after the first paint, see finishStartup()
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      connect(spExp.get(), &StroopExperiment::statsComputed,
+              this, &MainWindow::onStroopAssessed);
+      connect(spExp.get(), &StroopExperiment::started,
+              this, &MainWindow::onExperimentStarted);
+      connect(spExp.get(), &StroopExperiment::stopped,
+              this, &MainWindow::onExperimentStopped);
+      connect(spExp.get(), &StroopExperiment::trialCompleted,
+              m_upUI->rtPlotWidget, &StroopRTPlotWidget::addTrial);
+      connect(spExp.get(), &StroopExperiment::calibrationChecked,
+              this, &MainWindow::onCalibrationChecked);
    }
-   createExperimentDialog();
 
    /* Connect signals to slots using function pointers */
    // Menu bar
@@ -69,6 +118,8 @@ MainWindow::MainWindow(std::weak_ptr<Experimenter> experimenter,
            this, &MainWindow::onActionExportCSVStats);
    connect(m_upUI->actionExportAllCSV, &QAction::triggered,
            this, &MainWindow::onActionExportAllCSV);
+   connect(m_upUI->actionExportReEvaluation, &QAction::triggered,
+           this, &MainWindow::onActionExportReEvaluation);
 //   connect(m_upUI->actionBlockOrder, &QAction::triggered,
 //           this, &MainWindow::onActionBlockOrder);
 //   connect(m_upUI->actionRandomOrder, &QAction::triggered,
@@ -77,8 +128,18 @@ MainWindow::MainWindow(std::weak_ptr<Experimenter> experimenter,
            this, &MainWindow::onActionEvalAllTrials);
    connect(m_upUI->actionEvalCorrectTrials, &QAction::toggled,
            this, &MainWindow::onActionEvalCorrectTrials);
+   connect(m_upUI->actionAdaptiveDeadline, &QAction::toggled,
+           this, &MainWindow::onActionAdaptiveDeadline);
    connect(m_upUI->numExpRunsSpinBox, SIGNAL(valueChanged(int)),
            this, SLOT(onNumTrialsSpinBoxValueChanged(int)));
+   connect(m_upUI->historyFilterLineEdit, &QLineEdit::textChanged,
+           m_pHistoryModel, &StroopSessionHistoryModel::setFilterText);
+   connect(m_upUI->historyTableView->selectionModel(), &QItemSelectionModel::currentRowChanged,
+           this, &MainWindow::onHistoryRowChanged);
+   connect(m_pHistoryModel, &StroopSessionHistoryModel::sessionLoaded,
+           this, &MainWindow::onHistorySessionLoaded);
+   connect(m_pHistoryModel, &QAbstractItemModel::modelReset,
+           this, &MainWindow::onHistoryReset);
    connect(m_upUI->pubuProband, &QPushButton::clicked,
               this, &MainWindow::onProbandSpecified);
 
@@ -87,15 +148,21 @@ MainWindow::MainWindow(std::weak_ptr<Experimenter> experimenter,
    {
       // connect(m_upUI->tabWidget, &QTabWidget::currentChanged,
       //         spExp.get(), &Experimenter::onTabChanged);
+      connect(spExp.get(), &Experimenter::loadingStarted,
+              this, &MainWindow::onLoadingStarted);
       connect(spExp.get(), &Experimenter::experimentLoaded,
-              this, &MainWindow::onExperimentLoaded);      
+              this, &MainWindow::onExperimentLoaded);
+      connect(spExp.get(), &Experimenter::experimentStopped,
+              this, &MainWindow::updateLifetimeStats);      
+      connect(spExp.get(), &Experimenter::experimentStopped,
+              this, &MainWindow::updateSessionHistory);
    }
 
    // Start buttons
    connect(m_upUI->stroopStartButton, &QPushButton::pressed,
            this, &MainWindow::startCurrentExperiment);
            
-   setTableWidgetVisuals();
+   setTableVisuals();
 }
 
 
@@ -108,31 +175,27 @@ MainWindow::~MainWindow()
 
 
 /**
- * @brief MainWindow::setTableWidgetVisuals
+ * @brief MainWindow::setTableVisuals
  */
-void MainWindow::setTableWidgetVisuals()
+void MainWindow::setTableVisuals()
 {
-   m_upUI->resultsTableWidget->setStyleSheet("QTableWidget { border: none; "
-                                             "background-color: #FFFFFF; "
-                                             "selection-background-color: #3388FF } "
-                                             "QTableWidget::item { color: #000000; } "
-                                             "QTableWidget::item:selected { color:#000000; }");
-
-   m_upUI->resultsTableWidget->resizeColumnsToContents();
+   m_upUI->resultsTableView->setStyleSheet("QTableView { border: none; "
+                                           "background-color: #FFFFFF; "
+                                           "selection-background-color: #3388FF } "
+                                           "QTableView::item { color: #000000; } "
+                                           "QTableView::item:selected { color:#000000; }");
+
+   // Only measures the rows in view, independent of the length of the run
+   m_upUI->resultsTableView->resizeColumnsToContents();
 }
 
 
 /**
- * @brief MainWindow::resetTableWidget
+ * @brief MainWindow::resetResultsTable
  */
-void MainWindow::resetTableWidget()
+void MainWindow::resetResultsTable()
 {
-   const int numRows = m_upUI->resultsTableWidget->rowCount();
-
-   for (int i=0; i<numRows; i++)
-   {
-      m_upUI->resultsTableWidget->removeRow(0);
-   }
+   m_pTrialModel->clear();
 }
 
 
@@ -158,7 +221,7 @@ void MainWindow::onProbandSpecified()
       /*bool loaded = */spExp->loadExperiment(fileName);
    }
 
-   resetTableWidget();
+   resetResultsTable();
 }
 
 
@@ -176,7 +239,7 @@ void MainWindow::onActionLoad()
       /*bool loaded = */spExp->loadExperiment(fileName);
    }
 
-   resetTableWidget();
+   resetResultsTable();
 }
 
 
@@ -226,18 +289,13 @@ void MainWindow::exportCSV(bool includeStats)
       QString fileName = QFileDialog::getSaveFileName(this, "Export CSV", filePath,
                                                       "CSV (*.csv)");
 
-      QStringList headers;
-      int numCols = m_upUI->resultsTableWidget->columnCount();
-      for(int col=0; col<numCols; col++)
-      {
-        headers.append(m_upUI->resultsTableWidget->horizontalHeaderItem(col)->text());
-      }
+      const QStringList headers = m_pTrialModel->headers();
 
       QVector<QStringList> dataToExport;
       if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
       {
          std::shared_ptr<StroopExperiment> spExp =
-               std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+               spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
          if (spExp) { dataToExport = spExp->exportLastRunToCSV(headers, includeStats); }
       }
@@ -284,21 +342,46 @@ void MainWindow::onActionExportAllCSV()
       QString fileName = QFileDialog::getSaveFileName(this, "Export All Experiments to CSV", filePath,
                                                       "CSV (*.csv)");
 
-      QStringList headers;
-      int numCols = m_upUI->resultsTableWidget->columnCount();
-      for(int col=0; col<numCols; col++)
-      {
-         headers.append(m_upUI->resultsTableWidget->horizontalHeaderItem(col)->text());
-      }
+      const QStringList headers = m_pTrialModel->headers();
 
       std::shared_ptr<StroopExperiment> spExp =
-            std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
       if (spExp) { spExp->exportAllExperimentsToCSV(fileName, headers); }
    }
 }
 
 
+/**
+ * @brief MainWindow::onActionExportReEvaluation
+ *
+ * Evaluates all stored runs of the participant with every default filter
+ * policy and writes the results side by side.
+ */
+void MainWindow::onActionExportReEvaluation()
+{
+   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
+   {
+      QPair<bool, QStringList> info = spExperimenter->getLastLoadedExperimentInfo();
+
+      const QString& personID = info.second.at(0);
+
+      QFileInfo fileInfo(info.second.at(2));
+      QString filePath = fileInfo.absolutePath()
+                       + QDir::separator() + personID + "_neuauswertung.csv";
+
+      QString fileName = QFileDialog::getSaveFileName(this, "Re-evaluate All Experiments", filePath,
+                                                      "CSV (*.csv)");
+      if (fileName.isEmpty()) { return; }
+
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp) { spExp->exportReEvaluationToCSV(fileName, StroopReEvaluation::defaultPolicies()); }
+   }
+}
+
+
 /**
  * @brief MainWindow::onActionEvalAllTrials
  * @param checked
@@ -312,9 +395,12 @@ void MainWindow::onActionEvalAllTrials(bool checked)
       if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
       {
          std::shared_ptr<StroopExperiment> exp =
-                     std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+                     spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
          exp->activateEvalAllTrialsMode();
+         updateLifetimeStats();
+
+         m_pTrialFilterModel->setFilters(StroopTrialFilterModel::NoFilter);
       }
    }
 }
@@ -333,14 +419,33 @@ void MainWindow::onActionEvalCorrectTrials(bool checked)
       if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
       {
          std::shared_ptr<StroopExperiment> exp =
-                     std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+                     spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
          exp->activateEvalCorrectTrialsOnlyMode();
+         updateLifetimeStats();
+
+         m_pTrialFilterModel->setFilters(StroopTrialFilterModel::CorrectOnly);
       }
    }
 }
 
 
+/**
+ * @brief MainWindow::onActionAdaptiveDeadline
+ * @param checked
+ */
+void MainWindow::onActionAdaptiveDeadline(bool checked)
+{
+   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
+   {
+      std::shared_ptr<StroopExperiment> exp =
+                  spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      exp->setAdaptiveDeadline(checked);
+   }
+}
+
+
 /**
  * @brief MainWindow::onActionEqualDistOrder
  */
@@ -351,7 +456,7 @@ void MainWindow::onActionEvalCorrectTrials(bool checked)
 //   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
 //   {
 //      std::shared_ptr<StroopExperiment> spExp =
-//            std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+//            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
 //      spExp->setIndexCreationMode(true);
 //   }
@@ -368,19 +473,93 @@ void MainWindow::onActionEvalCorrectTrials(bool checked)
 //   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
 //   {
 //      std::shared_ptr<StroopExperiment> spExp =
-//            std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
+//            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
 //      spExp->setIndexCreationMode(false);
 //   }
 //}
 
 
+/**
+ * @brief MainWindow::measureStartup
+ * @param sinceLaunch Started at the beginning of main()
+ *
+ * Prints the time until the window is painted, the experiment dialog is
+ * prepared and the participant's file is loaded.
+ */
+void MainWindow::measureStartup(const QElapsedTimer& sinceLaunch)
+{
+   m_eltiStartup = sinceLaunch;
+}
+
+
+/**
+ * @brief MainWindow::reportStartup
+ * @param milestone StartupMilestone
+ * @param description
+ */
+void MainWindow::reportStartup(int milestone, const char* description)
+{
+   if (!m_eltiStartup.isValid() || (m_nStartupMilestones & milestone)) { return; }
+
+   m_nStartupMilestones |= milestone;
+   std::cout << "Startup: " << description << " after "
+             << m_eltiStartup.elapsed() << " ms" << std::endl;
+
+   if (m_nStartupMilestones == AllMilestones) { m_eltiStartup.invalidate(); }
+}
+
+
+/**
+ * @brief MainWindow::paintEvent
+ * @param event
+ *
+ * Everything not needed for the first frame is prepared after it.
+ */
+void MainWindow::paintEvent(QPaintEvent* event)
+{
+   QMainWindow::paintEvent(event);
+
+   if (!m_bFirstPaintDone)
+   {
+      m_bFirstPaintDone = true;
+      reportStartup(FirstPaint, "first paint");
+      QTimer::singleShot(0, this, &MainWindow::finishStartup);
+   }
+}
+
+
+/**
+ * @brief MainWindow::finishStartup
+ */
+void MainWindow::finishStartup()
+{
+   if (!m_spStroopExperimentDialog) { createExperimentDialog(); }
+}
+
+
+/**
+ * @brief MainWindow::onLoadingStarted
+ * @param filePath
+ */
+void MainWindow::onLoadingStarted(const QString& filePath)
+{
+   m_pFileStatusLabel->setText(QString("Lade %1 ...").arg(QFileInfo(filePath).fileName()));
+   m_pLoadingProgressBar->setVisible(true);
+   m_upUI->stroopStartButton->setEnabled(false);
+}
+
+
 /**
  * @brief MainWindow::onExperimentLoaded
  * @param id
  */
 void MainWindow::onExperimentLoaded()
 {
+   m_pLoadingProgressBar->setVisible(false);
+   m_upUI->stroopStartButton->setEnabled(true);
+   reportStartup(FileLoaded, "participant file loaded");
+
    //   int numTabs = m_upUI->tabWidget->count();
    //   for (int i=0; i<numTabs; i++)
    //   {
@@ -401,6 +580,93 @@ void MainWindow::onExperimentLoaded()
 
       m_pExperimentProgressLabel->setText(loaded.second.first());
    }
+
+   updateLifetimeStats();
+   updateSessionHistory();
+}
+
+
+/**
+ * @brief MainWindow::updateLifetimeStats
+ *
+ * Shows the cached summary of all runs of the loaded participant.
+ */
+void MainWindow::updateLifetimeStats()
+{
+   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp)
+      {
+         m_upUI->lifetimeStatsLabel->setText(spExp->getLifetimeStatsStringList().join("\n"));
+      }
+   }
+}
+
+
+/**
+ * @brief MainWindow::updateSessionHistory
+ *
+ * Lists the runs of the loaded participant by their stored summaries; the
+ * trials are only decoded for the selected run.
+ */
+void MainWindow::updateSessionHistory()
+{
+   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp)
+      {
+         m_nHistorySession = 0;
+         m_pHistoryTrialModel->clear();
+         m_pHistoryModel->setStore(spExp->getDataToSave());
+      }
+   }
+}
+
+
+/**
+ * @brief MainWindow::onHistoryRowChanged
+ * @param current
+ */
+void MainWindow::onHistoryRowChanged(const QModelIndex& current)
+{
+   const int sessionNumber = m_pHistoryModel->sessionNumber(current.row());
+   if (sessionNumber == 0 || sessionNumber == m_nHistorySession) { return; }
+
+   m_pHistoryModel->loadSession(current.row());
+}
+
+
+/**
+ * @brief MainWindow::onHistorySessionLoaded
+ * @param sessionNumber
+ * @param trials
+ */
+void MainWindow::onHistorySessionLoaded(int sessionNumber, const QVector<StroopTrial>& trials)
+{
+   m_nHistorySession = sessionNumber;
+   m_pHistoryTrialModel->setTrials(trials);
+   m_upUI->historyTrialsTableView->resizeColumnsToContents();
+}
+
+
+/**
+ * @brief MainWindow::onHistoryReset
+ * Keeps the shown run selected when the sessions are sorted or filtered.
+ */
+void MainWindow::onHistoryReset()
+{
+   const int row = m_pHistoryModel->rowOfSession(m_nHistorySession);
+   if (row < 0) { return; }
+
+   m_upUI->historyTableView->selectionModel()->setCurrentIndex(
+            m_pHistoryModel->index(row, 0),
+            QItemSelectionModel::ClearAndSelect | QItemSelectionModel::Rows);
 }
 
 
@@ -414,6 +680,16 @@ void MainWindow::setNumExperimentRuns(int i)
 }
 
 
+/**
+ * @brief MainWindow::setAdaptiveDeadline
+ * @param adaptive
+ */
+void MainWindow::setAdaptiveDeadline(bool adaptive)
+{
+   m_upUI->actionAdaptiveDeadline->setChecked(adaptive);
+}
+
+
 /**
  * @brief MainWindow::onNumTrialsSpinBoxValueChanged
  * @param i
@@ -432,6 +708,13 @@ void MainWindow::onNumTrialsSpinBoxValueChanged(int i)
  */
 void MainWindow::startCurrentExperiment()
 {
+   // Pressed before the deferred parts of the startup are done
+   if (std::shared_ptr<Experimenter> spExp = m_wpExperimenter.lock())
+   {
+      if (spExp->isLoading()) { return; }
+   }
+   if (!m_spStroopExperimentDialog) { createExperimentDialog(); }
+
    // Make sure to have the currently specified value set.
    if (std::shared_ptr<Experimenter> spExp = m_wpExperimenter.lock())
    {
@@ -456,6 +739,9 @@ void MainWindow::onStroopAssessed(int numMatches, int numWrong, int numTotal, do
                .arg(QString::number(mean/1000.0, 'f', 3),
                     QString::number(stDev/1000.0, 'f', 3)));
 
+   // Draws the trials collected during the run
+   m_upUI->rtPlotWidget->setLiveRendering(true);
+
    showResultsInTable();
 
    m_upUI->tabWidget->setCurrentIndex(m_upUI->tabWidget->indexOf(m_upUI->resultsTab));
@@ -463,50 +749,71 @@ void MainWindow::onStroopAssessed(int numMatches, int numWrong, int numTotal, do
 
 
 /**
- * @brief MainWindow::showResultsInTable
+ * @brief MainWindow::onExperimentStarted
+ *
+ * The RT plot only collects the trials while the experiment dialog is
+ * full screen, on any screen: painting on another screen still competes
+ * with the stimuli for the GUI thread and the GPU. It is drawn when the
+ * statistics are computed or the run has stopped.
  */
-void MainWindow::showResultsInTable()
+void MainWindow::onExperimentStarted()
 {
-   resetTableWidget(); // Delete all rows completely, not just the contents
-
-   QVector<QStringList> results;
-   bool showCorrectOnly = false; 
    if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
    {
-      std::shared_ptr<StroopExperiment> spExp =
-            std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
-
-      results = spExp->currentExperimentSetToString(true);
-      showCorrectOnly = spExp->getEvalCorrectTrialsOnly();
+      m_upUI->rtPlotWidget->startRun(spExperimenter->getExperiment("stroop")->getNumTrials());
    }
 
-   int rows = results.count();
-   int cols = m_upUI->resultsTableWidget->columnCount();
+   const bool fullScreen = m_spStroopExperimentDialog
+                           && m_spStroopExperimentDialog->isFullScreen();
+   m_upUI->rtPlotWidget->setLiveRendering(!fullScreen);
+}
 
-   int row = 0;
-   for (int i=0; i<rows; i++)
-   {
-      const QStringList& result = results.at(i);
 
-      if (showCorrectOnly && result.at(4) == QString("0")) // "4" is index of serialized "m_bCorrect"
-      {
-         continue;
-      }
+/**
+ * @brief MainWindow::onExperimentStopped
+ *
+ * Draws the trials collected during the run, also of an aborted run
+ * without statistics.
+ */
+void MainWindow::onExperimentStopped()
+{
+   m_upUI->rtPlotWidget->setLiveRendering(true);
+}
 
-      m_upUI->resultsTableWidget->insertRow(row);
 
-      Q_ASSERT(result.count() == cols);
+/**
+ * @brief MainWindow::onCalibrationChecked
+ * @param problems Values of the timing calibration beyond the thresholds
+ *
+ * Shown until the next calibration; a modal message would take the focus
+ * from the experiment dialog.
+ */
+void MainWindow::onCalibrationChecked(const QStringList& problems)
+{
+   m_pCalibrationLabel->setText(QString("Timing-Warnung: %1").arg(problems.join(", ")));
+   m_pCalibrationLabel->setToolTip("Die Zeitmessung dieses Rechners liegt außerhalb der "
+                                   "Grenzwerte (siehe StroopSession_N/calibration).");
+   m_pCalibrationLabel->setVisible(!problems.isEmpty());
+}
 
-      for (int col=0; col<cols; col++)
-      {
-         m_upUI->resultsTableWidget->setItem(row, col, // add 1 to skip valid
-                                             new QTableWidgetItem(result.at(col)));
-      }
 
-      row++;
-   }   
+/**
+ * @brief MainWindow::showResultsInTable
+ */
+void MainWindow::showResultsInTable()
+{
+   if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      m_pTrialFilterModel->setFilters(spExp->getEvalCorrectTrialsOnly()
+                                      ? StroopTrialFilterModel::CorrectOnly
+                                      : StroopTrialFilterModel::NoFilter);
+      m_pTrialModel->setTrials(spExp->currentExperimentTrials());
+   }
 
-   setTableWidgetVisuals(); // Better safe than sorry...
+   setTableVisuals(); // Better safe than sorry...
 }
 
 
@@ -518,13 +825,14 @@ void MainWindow::createExperimentDialog()
    if (std::shared_ptr<Experimenter> spExperimenter = m_wpExperimenter.lock())
    {
       std::shared_ptr<StroopExperiment> spExp =
-            std::static_pointer_cast<StroopExperiment>(spExperimenter->getExperiment("stroop"));
-
-      connect(spExp.get(), &StroopExperiment::statsComputed,
-              this, &MainWindow::onStroopAssessed);
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
 
+      // Fonts, layout and quads at the size of the screen it will cover
       m_spStroopExperimentDialog = std::make_shared<StroopExperimentDialog>(spExp);
+      m_spStroopExperimentDialog->prepareStimuli(screen());
    }
+
+   reportStartup(DialogReady, "experiment dialog prepared");
 }
 
 // https://piktochart.com/blog/5-psychology-studies-that-tell-us-how-people-perceive-visual-information/
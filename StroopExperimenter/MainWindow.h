@@ -11,6 +11,7 @@
 #pragma once
 
 #include <QMainWindow>
+#include <QElapsedTimer>
 
 
 QT_BEGIN_NAMESPACE
@@ -20,7 +21,12 @@ QT_END_NAMESPACE
 
 // Forward declarations
 class QLabel;
+class QProgressBar;
 class Experimenter;
+class StroopTrialTableModel;
+class StroopTrialFilterModel;
+class StroopSessionHistoryModel;
+struct StroopTrial;
 class ExperimentDialog;
 
 
@@ -35,8 +41,14 @@ class MainWindow : public QMainWindow
       MainWindow(std::weak_ptr<Experimenter> experimenter, QWidget* parent = nullptr);
       ~MainWindow();
 
+      void measureStartup(const QElapsedTimer& sinceLaunch);
+
    public slots:
       void setNumExperimentRuns(int i);
+      void setAdaptiveDeadline(bool adaptive);
+
+   protected:
+      virtual void paintEvent(QPaintEvent* event);
 
    private slots:
       void onProbandSpecified();
@@ -45,22 +57,35 @@ class MainWindow : public QMainWindow
       void onActionExportCSV();
       void onActionExportCSVStats();
       void onActionExportAllCSV();
+      void onActionExportReEvaluation();
       //void onActionEqualDistOrder();
       //void onActionFullyRandomOrder();
       void onActionEvalAllTrials(bool checked);
       void onActionEvalCorrectTrials(bool checked);
+      void onActionAdaptiveDeadline(bool checked);
+      void onLoadingStarted(const QString& filePath);
       void onExperimentLoaded();
+      void finishStartup();
       void startCurrentExperiment();
       void onStroopAssessed(int numMatches, int numWrong, int numTotal, double mean, double stDev);
       void onNumTrialsSpinBoxValueChanged(int i);
+      void updateLifetimeStats();
+      void updateSessionHistory();
+      void onHistoryRowChanged(const QModelIndex& current);
+      void onHistorySessionLoaded(int sessionNumber, const QVector<StroopTrial>& trials);
+      void onHistoryReset();
+      void onExperimentStarted();
+      void onExperimentStopped();
+      void onCalibrationChecked(const QStringList& problems);
 
    private:
       // Methods
       void createExperimentDialog();
       void showResultsInTable();
-      void setTableWidgetVisuals();
-      void resetTableWidget();
+      void setTableVisuals();
+      void resetResultsTable();
       void exportCSV(bool includeStats);
+      void reportStartup(int milestone, const char* description);
 
       // References to UI implementation and logic (Experiments meta class)
       std::unique_ptr<Ui::MainWindow> m_upUI;
@@ -69,8 +94,21 @@ class MainWindow : public QMainWindow
       // Pointers managed by Qt via parenting
       QLabel* m_pFileStatusLabel;
       QLabel* m_pExperimentProgressLabel;
+      QLabel* m_pCalibrationLabel; // Warning if the station misses the timing thresholds
+      QProgressBar* m_pLoadingProgressBar; // Busy while the participant's file is read
+      StroopTrialTableModel*  m_pTrialModel;       // Trials of the last run...
+      StroopTrialFilterModel* m_pTrialFilterModel; // ...as shown by the results table
+      StroopSessionHistoryModel* m_pHistoryModel;  // All runs of the participant...
+      StroopTrialTableModel* m_pHistoryTrialModel; // ...and the trials of the selected one
+      int m_nHistorySession;                       // Shown by m_pHistoryTrialModel, 0: none
 
       // Other variables
       std::shared_ptr<class StroopExperimentDialog> m_spStroopExperimentDialog;
+
+      // Startup time, see measureStartup()
+      enum StartupMilestone { FirstPaint = 0x1, DialogReady = 0x2, FileLoaded = 0x4, AllMilestones = 0x7 };
+      QElapsedTimer m_eltiStartup;
+      int  m_nStartupMilestones; // Reached so far
+      bool m_bFirstPaintDone;
       //      QStringList m_strlColumnTitles;
 };
@@ -0,0 +1,377 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "RealtimeSupport.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef Q_OS_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+
+// Stack the trial loop may use without page faults
+static constexpr int StackPrefaultSize = 256 * 1024;
+
+// Runs holding the memory lock; several stations may run at once (see
+// StationController), all from the GUI thread
+static int s_nNumMemoryLocks = 0;
+
+
+#ifdef Q_OS_LINUX
+/**
+ * @brief errorString
+ * @param error errno value
+ * @return Description, with a hint for missing permissions
+ */
+static QString errorString(int error)
+{
+   QString str = QString::fromLocal8Bit(std::strerror(error));
+
+   if (error == EPERM) { str += " (CAP_SYS_NICE or RLIMIT_RTPRIO needed)"; }
+
+   return str;
+}
+#endif
+
+
+/**
+ * @brief RealtimeReport::RealtimeReport
+ */
+RealtimeReport::RealtimeReport()
+   : m_bMemoryLocked(false)
+   , m_bFifoScheduling(false)
+   , m_nPriority(0)
+   , m_nCpu(-1)
+   , m_bInputFifoScheduling(false)
+   , m_nInputPriority(0)
+   , m_nInputCpu(-1)
+   , m_i64MinorFaults(0LL)
+   , m_i64MajorFaults(0LL)
+{
+}
+
+
+/**
+ * @brief RealtimeSupport::lockMemory
+ * @param problems Appended if the memory could not be locked
+ * @return
+ *
+ * Locks all current and future pages of the process into RAM. The lock is
+ * process-wide, so it is counted: it stays until the last successful
+ * lockMemory() is matched by unlockMemory().
+ */
+bool RealtimeSupport::lockMemory(QStringList& problems)
+{
+#ifdef Q_OS_LINUX
+   if (s_nNumMemoryLocks > 0)
+   {
+      s_nNumMemoryLocks++;
+      return true;
+   }
+
+   if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+   {
+      const int error = errno;
+      QString str = "mlockall: " + QString::fromLocal8Bit(std::strerror(error));
+      if (error == ENOMEM || error == EPERM) { str += " (RLIMIT_MEMLOCK too small)"; }
+
+      problems.append(str);
+      return false;
+   }
+
+   s_nNumMemoryLocks = 1;
+   return true;
+#else
+   problems.append("mlockall: only supported on Linux");
+   return false;
+#endif
+}
+
+
+/**
+ * @brief RealtimeSupport::unlockMemory
+ * Only after a successful lockMemory(); the last one unlocks the pages.
+ */
+void RealtimeSupport::unlockMemory()
+{
+#ifdef Q_OS_LINUX
+   if (s_nNumMemoryLocks == 0) { return; }
+
+   if (--s_nNumMemoryLocks == 0) { munlockall(); }
+#endif
+}
+
+
+/**
+ * @brief RealtimeSupport::prefault
+ * @param data
+ * @param numBytes
+ *
+ * Reads one byte per page, so the pages are mapped before the run needs them.
+ */
+void RealtimeSupport::prefault(const void* data, qint64 numBytes)
+{
+   if (!data || numBytes <= 0) { return; }
+
+#ifdef Q_OS_LINUX
+   const qint64 pageSize = sysconf(_SC_PAGESIZE);
+#else
+   const qint64 pageSize = 4096;
+#endif
+
+   const volatile char* bytes = static_cast<const volatile char*>(data);
+   for (qint64 offset=0; offset<numBytes; offset+=pageSize)
+   {
+      (void)bytes[offset];
+   }
+   (void)bytes[numBytes - 1];
+}
+
+
+/**
+ * @brief RealtimeSupport::prefaultStack
+ * Touches the stack below the caller's frame.
+ */
+void RealtimeSupport::prefaultStack()
+{
+   volatile char stack[StackPrefaultSize];
+
+   for (int offset=0; offset<StackPrefaultSize; offset+=4096)
+   {
+      stack[offset] = 0;
+   }
+}
+
+
+/**
+ * @brief RealtimeSupport::setCurrentThreadRealtime
+ * @param priority SCHED_FIFO priority, clamped to the valid range
+ * @param cpu CPU to pin the thread to (-1: none); set to -1 if pinning failed
+ * @param problems Appended for everything that was not granted
+ * @return True if the thread runs with SCHED_FIFO
+ */
+bool RealtimeSupport::setCurrentThreadRealtime(int priority, int& cpu, QStringList& problems)
+{
+#ifdef Q_OS_LINUX
+   if (cpu >= 0)
+   {
+      cpu_set_t cpuSet;
+      CPU_ZERO(&cpuSet);
+      CPU_SET(cpu, &cpuSet);
+
+      const int error = pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+      if (error != 0)
+      {
+         problems.append(QString("CPU %1: %2").arg(cpu).arg(errorString(error)));
+         cpu = -1;
+      }
+   }
+
+   sched_param param;
+   std::memset(&param, 0, sizeof(param));
+   param.sched_priority = std::clamp(priority, sched_get_priority_min(SCHED_FIFO),
+                                     sched_get_priority_max(SCHED_FIFO));
+
+   const int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+   if (error != 0)
+   {
+      problems.append(QString("SCHED_FIFO %1: %2").arg(param.sched_priority).arg(errorString(error)));
+      return false;
+   }
+
+   return true;
+#else
+   Q_UNUSED(priority);
+   cpu = -1;
+   problems.append("SCHED_FIFO: only supported on Linux");
+   return false;
+#endif
+}
+
+
+/**
+ * @brief RealtimeSupport::pageFaults
+ * @param minorFaults Of the whole process so far
+ * @param majorFaults
+ * @return
+ */
+bool RealtimeSupport::pageFaults(qint64& minorFaults, qint64& majorFaults)
+{
+#ifdef Q_OS_LINUX
+   rusage usage;
+   if (getrusage(RUSAGE_SELF, &usage) != 0) { return false; }
+
+   minorFaults = usage.ru_minflt;
+   majorFaults = usage.ru_majflt;
+   return true;
+#else
+   minorFaults = 0LL;
+   majorFaults = 0LL;
+   return false;
+#endif
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::RealtimeDeadlineThread
+ * @param priority SCHED_FIFO priority, 0: normal scheduling
+ * @param cpu CPU to pin the thread to, -1: none (only with SCHED_FIFO)
+ * @param parent
+ */
+RealtimeDeadlineThread::RealtimeDeadlineThread(int priority, int cpu, QObject* parent)
+   : QThread(parent)
+   , m_nRequestedPriority(priority)
+   , m_nRequestedCpu(cpu)
+   , m_nArmedId(-1)
+   , m_bQuit(false)
+   , m_bConfigured(false)
+   , m_bFifoScheduling(false)
+   , m_nCpu(-1)
+{
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::~RealtimeDeadlineThread
+ */
+RealtimeDeadlineThread::~RealtimeDeadlineThread()
+{
+   shutdown();
+   wait();
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::arm
+ * @param id Identifies the interval to expired(), >= 0
+ * @param durationMs From now on; replaces an interval still armed
+ */
+void RealtimeDeadlineThread::arm(int id, int durationMs)
+{
+   QMutexLocker locker(&m_mutex);
+
+   m_deadline = QDeadlineTimer(durationMs, Qt::PreciseTimer);
+   m_nArmedId = id;
+
+   m_condition.wakeAll();
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::disarm
+ */
+void RealtimeDeadlineThread::disarm()
+{
+   QMutexLocker locker(&m_mutex);
+
+   m_nArmedId = -1;
+
+   m_condition.wakeAll();
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::shutdown
+ * Lets run() return; the caller waits for the thread.
+ */
+void RealtimeDeadlineThread::shutdown()
+{
+   QMutexLocker locker(&m_mutex);
+
+   m_bQuit = true;
+
+   m_condition.wakeAll();
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::waitUntilConfigured
+ * @return False if the thread did not apply its scheduling within 1 s
+ */
+bool RealtimeDeadlineThread::waitUntilConfigured()
+{
+   QMutexLocker locker(&m_mutex);
+
+   QDeadlineTimer timeout(1000);
+   while (!m_bConfigured)
+   {
+      if (!m_condition.wait(&m_mutex, timeout)) { return m_bConfigured; }
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::getScheduling
+ * @param report Scheduling fields are set, problems are appended
+ */
+void RealtimeDeadlineThread::getScheduling(RealtimeReport& report) const
+{
+   QMutexLocker locker(&m_mutex);
+
+   report.m_bFifoScheduling = m_bFifoScheduling;
+   report.m_nPriority = m_bFifoScheduling ? m_nRequestedPriority : 0;
+   report.m_nCpu = m_nCpu;
+   report.m_strlProblems.append(m_strlProblems);
+}
+
+
+/**
+ * @brief RealtimeDeadlineThread::run
+ */
+void RealtimeDeadlineThread::run()
+{
+   QStringList problems;
+   int cpu = -1;
+   bool fifo = false;
+
+   if (m_nRequestedPriority > 0)
+   {
+      cpu = m_nRequestedCpu;
+      fifo = RealtimeSupport::setCurrentThreadRealtime(m_nRequestedPriority, cpu, problems);
+   }
+
+   RealtimeSupport::prefaultStack();
+
+   QMutexLocker locker(&m_mutex);
+
+   m_bFifoScheduling = fifo;
+   m_nCpu = cpu;
+   m_strlProblems = problems;
+   m_bConfigured = true;
+   m_condition.wakeAll();
+
+   while (!m_bQuit)
+   {
+      if (m_nArmedId < 0)
+      {
+         m_condition.wait(&m_mutex);
+      }
+      else if (m_deadline.hasExpired())
+      {
+         const int id = m_nArmedId;
+         m_nArmedId = -1;
+
+         locker.unlock();
+         emit expired(id);
+         locker.relock();
+      }
+      else
+      {
+         m_condition.wait(&m_mutex, m_deadline);
+      }
+   }
+}
@@ -0,0 +1,111 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QDeadlineTimer>
+#include <QStringList>
+
+
+/**
+ * @brief The RealtimeReport struct
+ *
+ * What the real-time mode achieved for one run. Everything that was
+ * requested but not granted is listed in m_strlProblems.
+ */
+struct RealtimeReport
+{
+   RealtimeReport();
+
+   bool m_bMemoryLocked;
+   bool m_bFifoScheduling;
+   int  m_nPriority;      // SCHED_FIFO priority of the timing thread, 0 if not granted
+   int  m_nCpu;           // CPU the timing thread is pinned to, -1 if not pinned
+   bool m_bInputFifoScheduling; // Same for the evdev input thread, if used
+   int  m_nInputPriority;
+   int  m_nInputCpu;
+   qint64 m_i64MinorFaults; // Page faults of the process during the run
+   qint64 m_i64MajorFaults;
+   QStringList m_strlProblems;
+};
+
+
+/**
+ * @brief The RealtimeSupport class
+ *
+ * Memory locking, real-time scheduling and page fault counters. Only
+ * implemented on Linux; elsewhere every request fails with a problem
+ * description, so callers simply continue without real-time support.
+ */
+class RealtimeSupport
+{
+   public:
+      static bool lockMemory(QStringList& problems);
+      static void unlockMemory();
+
+      static void prefault(const void* data, qint64 numBytes);
+      static void prefaultStack();
+
+      static bool setCurrentThreadRealtime(int priority, int& cpu, QStringList& problems);
+
+      static bool pageFaults(qint64& minorFaults, qint64& majorFaults);
+};
+
+
+/**
+ * @brief The RealtimeDeadlineThread class
+ *
+ * Times one interval at a time on its own thread, optionally with SCHED_FIFO
+ * priority and pinned to one CPU, so background load on the GUI thread
+ * does not delay the end of a blank screen, fixation point or response
+ * window. arm() and disarm() do not allocate, so it is used with normal
+ * priority outside of real-time mode as well; expired() is delivered to
+ * the receiver's thread.
+ */
+class RealtimeDeadlineThread : public QThread
+{
+      Q_OBJECT
+
+   public:
+      explicit RealtimeDeadlineThread(int priority, int cpu, QObject* parent = nullptr);
+      virtual ~RealtimeDeadlineThread();
+
+      void arm(int id, int durationMs);
+      void disarm();
+      void shutdown();
+
+      bool waitUntilConfigured();
+      void getScheduling(RealtimeReport& report) const;
+
+   signals:
+      void expired(int id);
+
+   protected:
+      virtual void run();
+
+   private:
+      const int m_nRequestedPriority;
+      const int m_nRequestedCpu;
+
+      mutable QMutex m_mutex;
+      QWaitCondition m_condition;
+
+      QDeadlineTimer m_deadline;
+      int  m_nArmedId; // -1: not armed
+      bool m_bQuit;
+
+      // Result of the configuration in run()
+      bool m_bConfigured;
+      bool m_bFifoScheduling;
+      int  m_nCpu;
+      QStringList m_strlProblems;
+};
@@ -0,0 +1,97 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "RunningMoments.h"
+
+#include <cmath>
+
+
+/**
+ * @brief RunningMoments::RunningMoments
+ */
+RunningMoments::RunningMoments()
+   : m_i64Count(0LL)
+   , m_dMean(0.0)
+   , m_dM2(0.0)
+   , m_dM3(0.0)
+{
+}
+
+
+/**
+ * @brief RunningMoments::add
+ * @param x
+ */
+void RunningMoments::add(double x)
+{
+   RunningMoments single;
+   single.m_i64Count = 1LL;
+   single.m_dMean = x;
+
+   merge(single);
+}
+
+
+/**
+ * @brief RunningMoments::merge
+ * @param other
+ */
+void RunningMoments::merge(const RunningMoments& other)
+{
+   if (other.m_i64Count == 0LL) { return; }
+   if (m_i64Count == 0LL) { *this = other; return; }
+
+   const double na = static_cast<double>(m_i64Count);
+   const double nb = static_cast<double>(other.m_i64Count);
+   const double n = na + nb;
+   const double delta = other.m_dMean - m_dMean;
+
+   const double m3 = m_dM3 + other.m_dM3
+                   + delta * delta * delta * na * nb * (na - nb) / (n * n)
+                   + 3.0 * delta * (na * other.m_dM2 - nb * m_dM2) / n;
+   const double m2 = m_dM2 + other.m_dM2 + delta * delta * na * nb / n;
+
+   m_dMean += delta * nb / n;
+   m_dM2 = m2;
+   m_dM3 = m3;
+   m_i64Count += other.m_i64Count;
+}
+
+
+/**
+ * @brief RunningMoments::variance
+ * @return Sample variance
+ */
+double RunningMoments::variance() const
+{
+   return (m_i64Count > 1LL) ? m_dM2 / static_cast<double>(m_i64Count - 1LL) : 0.0;
+}
+
+
+/**
+ * @brief RunningMoments::standardDeviation
+ * @return
+ */
+double RunningMoments::standardDeviation() const
+{
+   return std::sqrt(variance());
+}
+
+
+/**
+ * @brief RunningMoments::skewness
+ * @return
+ */
+double RunningMoments::skewness() const
+{
+   if (m_i64Count < 3LL || !(m_dM2 > 0.0)) { return 0.0; }
+
+   const double n = static_cast<double>(m_i64Count);
+   return std::sqrt(n) * m_dM3 / std::pow(m_dM2, 1.5);
+}
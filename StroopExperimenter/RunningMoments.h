@@ -0,0 +1,36 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QtGlobal>
+
+
+/**
+ * @brief The RunningMoments struct
+ *
+ * Count, mean and central moments (M2, M3) that can be updated one sample
+ * at a time and merged pairwise (Chan et al. / Pebay update formulas).
+ */
+struct RunningMoments
+{
+   RunningMoments();
+
+   void add(double x);
+   void merge(const RunningMoments& other);
+
+   double variance() const;
+   double standardDeviation() const;
+   double skewness() const;
+
+   qint64 m_i64Count;
+   double m_dMean;
+   double m_dM2;
+   double m_dM3;
+};
@@ -0,0 +1,397 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StationController.h"
+#include "DataReaderWriter.h"
+#include "Experimenter.h"
+#include "StroopExperiment.h"
+#include "StroopExperimentDialog.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSettings>
+
+#include <iostream>
+
+
+/**
+ * @brief StationConfig::StationConfig
+ */
+StationConfig::StationConfig()
+   : m_nCpu(-1)
+{
+}
+
+
+/**
+ * @brief StationController::StationController
+ * @param parent
+ */
+StationController::StationController(QObject* parent)
+   : QObject(parent)
+   , m_nNumTrials(0)
+{
+}
+
+
+/**
+ * @brief StationController::load
+ * @param filePath Station file (INI), see the class description
+ * @param folderPath Folder of the participant files, empty: as given
+ * @param error Set if the file cannot be read or is not valid
+ * @return The stations are only replaced if the file is valid
+ */
+bool StationController::load(const QString& filePath, const QString& folderPath, QString* error)
+{
+   if (!QFileInfo::exists(filePath))
+   {
+      if (error) { *error = QString("%1 does not exist.").arg(filePath); }
+      return false;
+   }
+
+   QSettings settings(filePath, QSettings::IniFormat);
+   if (settings.status() != QSettings::NoError)
+   {
+      if (error) { *error = QString("%1 is not a valid INI file.").arg(filePath); }
+      return false;
+   }
+
+   const QStringList groups = settings.childGroups();
+   const QStringList names = settings.value("Stations/stations").toStringList();
+
+   if (names.isEmpty())
+   {
+      if (error) { *error = "No stations are listed in [Stations]."; }
+      return false;
+   }
+
+   QVector<StationConfig> configs;
+   QStringList files;
+   QStringList inputs;
+
+   for (const QString& stationName : names)
+   {
+      const QString name = stationName.trimmed();
+      if (!groups.contains(name))
+      {
+         if (error) { *error = QString("Station %1 is not defined.").arg(name); }
+         return false;
+      }
+
+      StationConfig config;
+      config.m_strName = name;
+
+      settings.beginGroup(name);
+
+      config.m_strScreen = settings.value("screen", QString::number(configs.count())).toString().trimmed();
+      config.m_strFile = settings.value("file", name + ".stroop").toString().trimmed();
+
+      const QStringList sources = settings.value("input").toStringList();
+      for (const QString& source : sources)
+      {
+         if (!source.trimmed().isEmpty()) { config.m_strlInput.append(source.trimmed()); }
+      }
+
+      bool okCpu = true;
+      config.m_nCpu = settings.value("cpu", -1).toInt(&okCpu);
+
+      settings.endGroup();
+
+      if (!okCpu)
+      {
+         if (error) { *error = QString("Station %1 has an invalid cpu.").arg(name); }
+         return false;
+      }
+
+      if (!folderPath.isEmpty())
+      {
+         config.m_strFile = folderPath + QDir::separator() + QFileInfo(config.m_strFile).fileName();
+      }
+
+      // Each participant file and keyboard belongs to one station
+      const QString file = QFileInfo(config.m_strFile).absoluteFilePath();
+      if (files.contains(file))
+      {
+         if (error) { *error = QString("Station %1 uses the file of another station.").arg(name); }
+         return false;
+      }
+      files.append(file);
+
+      for (const QString& source : config.m_strlInput)
+      {
+         if (inputs.contains(source))
+         {
+            if (error) { *error = QString("Station %1 uses the input %2 of another station.").arg(name, source); }
+            return false;
+         }
+         inputs.append(source);
+      }
+
+      configs.append(config);
+   }
+
+   // With several stations, Qt key events cannot tell the keyboards apart
+   if (configs.count() > 1)
+   {
+      for (const StationConfig& config : configs)
+      {
+         if (config.m_strlInput.isEmpty())
+         {
+            if (error) { *error = QString("Station %1 has no input; each station needs its own keyboard.").arg(config.m_strName); }
+            return false;
+         }
+      }
+   }
+
+   m_qvecConfigs = configs;
+   return true;
+}
+
+
+/**
+ * @brief StationController::getStations
+ * @return
+ */
+const QVector<StationConfig>& StationController::getStations() const
+{
+   return m_qvecConfigs;
+}
+
+
+/**
+ * @brief StationController::start
+ * @param settings Experiment configured by the command line; its protocol,
+ *        deadline mode, frame timing and calibration limits are used by
+ *        every station
+ * @param numTrials Trials per run without a protocol
+ * @param studyPlanPath Study plan (*.stplan), empty: none
+ * @param error Set if a station cannot be set up
+ * @return The dialogs are shown once all participant files are loaded
+ */
+bool StationController::start(const StroopExperiment& settings, int numTrials,
+                              const QString& studyPlanPath, QString* error)
+{
+   if (!m_qvecStations.isEmpty() || m_qvecConfigs.isEmpty()) { return false; }
+
+   // One GUI thread swaps all windows; with vsync each swap may wait for
+   // its own screen, so frames cannot be kept on more than one
+   if (settings.getFrameTiming() && m_qvecConfigs.count() > 1)
+   {
+      if (error) { *error = QString("Frame timing (-e) needs a single station, %1 are listed.")
+                            .arg(m_qvecConfigs.count()); }
+      return false;
+   }
+
+   m_nNumTrials = numTrials;
+
+   m_qvecStations.resize(m_qvecConfigs.count());
+   for (int i=0; i<m_qvecConfigs.count(); i++) { m_qvecStations[i].m_config = m_qvecConfigs.at(i); }
+
+   if (!assignScreens(error))
+   {
+      m_qvecStations.clear();
+      return false;
+   }
+
+   for (int i=0; i<m_qvecStations.count(); i++)
+   {
+      Station& station = m_qvecStations[i];
+      const StationConfig& config = station.m_config;
+
+      station.m_spDataRW = std::make_shared<DataReaderWriter>();
+      station.m_spExperimenter = std::make_shared<Experimenter>(station.m_spDataRW);
+      station.m_spExperiment = station.m_spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (!station.m_spExperiment)
+      {
+         if (error) { *error = QString("Station %1: the Stroop experiment is not available.").arg(config.m_strName); }
+         m_qvecStations.clear();
+         return false;
+      }
+
+      applySettings(settings, *station.m_spExperiment);
+
+      // Deadline timed on a thread of its own; what is not permitted is logged
+      station.m_spExperiment->setRealtimeMode(true, config.m_nCpu);
+
+      if (!config.m_strlInput.isEmpty()
+          && !station.m_spExperiment->setKernelInput(config.m_strlInput, true)
+          && m_qvecStations.count() > 1)
+      {
+         if (error) { *error = QString("Station %1: none of its inputs can be read.").arg(config.m_strName); }
+         m_qvecStations.clear();
+         return false;
+      }
+
+      station.m_spExperiment->setStation(QString("%1;screen=%2;input=%3")
+                                         .arg(config.m_strName, station.m_pScreen->name(),
+                                              config.m_strlInput.join(",")));
+
+      if (!studyPlanPath.isEmpty() && !station.m_spExperimenter->setStudyPlan(studyPlanPath))
+      {
+         if (error) { *error = QString("Invalid study plan: %1").arg(studyPlanPath); }
+         m_qvecStations.clear();
+         return false;
+      }
+
+      // Fonts, layout and quads at the size of the station's screen
+      station.m_spDialog = std::make_shared<StroopExperimentDialog>(station.m_spExperiment);
+      station.m_spDialog->setWindowTitle(config.m_strName);
+      station.m_spDialog->setScreen(station.m_pScreen);
+      station.m_spDialog->prepareStimuli(station.m_pScreen);
+
+      // The Experimenter saves the run on the thread pool when it stops
+      connect(station.m_spExperimenter.get(), &Experimenter::experimentLoaded,
+              this, [this, i]() { onStationLoaded(i); });
+      connect(station.m_spExperimenter.get(), &Experimenter::experimentSaved,
+              this, [this, i]() { onStationStopped(i); });
+
+      std::cout << "Station " << config.m_strName.toStdString()
+                << ": screen " << station.m_pScreen->name().toStdString()
+                << ", file " << config.m_strFile.toStdString()
+                << ", input " << (config.m_strlInput.isEmpty() ? std::string("Qt key events")
+                                                               : config.m_strlInput.join(",").toStdString())
+                << std::endl;
+   }
+
+   // New files are loaded right away, so all connections are made before
+   for (int i=0; i<m_qvecStations.count(); i++)
+   {
+      const Station& station = m_qvecStations.at(i);
+      if (!station.m_spExperimenter->loadExperiment(station.m_config.m_strFile))
+      {
+         if (error) { *error = QString("Station %1: %2 is not a *.stroop file.")
+                               .arg(station.m_config.m_strName, station.m_config.m_strFile); }
+         m_qvecStations.clear();
+         return false;
+      }
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief StationController::assignScreens
+ * @param error Set if a screen does not exist or is used twice
+ * @return
+ */
+bool StationController::assignScreens(QString* error)
+{
+   const QList<QScreen*> screens = QGuiApplication::screens();
+   QList<QScreen*> used;
+
+   for (Station& station : m_qvecStations)
+   {
+      const QString& screenStr = station.m_config.m_strScreen;
+
+      bool isIndex = false;
+      const int index = screenStr.toInt(&isIndex);
+
+      QScreen* screen = nullptr;
+      if (isIndex)
+      {
+         if (index >= 0 && index < screens.count()) { screen = screens.at(index); }
+      }
+      else
+      {
+         for (QScreen* candidate : screens)
+         {
+            if (candidate->name() == screenStr) { screen = candidate; break; }
+         }
+      }
+
+      if (!screen)
+      {
+         if (error) { *error = QString("Station %1: screen %2 does not exist (%3 screens).")
+                               .arg(station.m_config.m_strName, screenStr).arg(screens.count()); }
+         return false;
+      }
+      if (used.contains(screen))
+      {
+         if (error) { *error = QString("Station %1: screen %2 is used by another station.")
+                               .arg(station.m_config.m_strName, screen->name()); }
+         return false;
+      }
+
+      used.append(screen);
+      station.m_pScreen = screen;
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief StationController::applySettings
+ * @param settings Experiment configured by the command line
+ * @param experiment Experiment of a station
+ */
+void StationController::applySettings(const StroopExperiment& settings, StroopExperiment& experiment)
+{
+   if (settings.getProtocol().isLoaded()) { experiment.setProtocol(settings.getProtocol()); }
+
+   experiment.setTargetAccuracy(settings.getTargetAccuracy());
+   experiment.setAdaptiveDeadline(settings.getAdaptiveDeadline());
+   experiment.setFrameTiming(settings.getFrameTiming());
+   experiment.setCalibrationThresholds(settings.getCalibrationThresholds());
+
+   if (settings.getEvalCorrectTrialsOnly()) { experiment.activateEvalCorrectTrialsOnlyMode(); }
+}
+
+
+/**
+ * @brief StationController::onStationLoaded
+ * @param station Index of the station whose participant file is loaded
+ *
+ * All stations start together: the dialogs are shown once the last file
+ * is loaded, each run starts after the calibration on its screen.
+ */
+void StationController::onStationLoaded(int station)
+{
+   m_qvecStations[station].m_bLoaded = true;
+
+   for (const Station& other : m_qvecStations)
+   {
+      if (!other.m_bLoaded) { return; }
+   }
+
+   for (Station& other : m_qvecStations)
+   {
+      other.m_spExperimenter->setNumTrials(m_nNumTrials);
+
+      other.m_spDialog->setGeometry(other.m_pScreen->geometry());
+      other.m_spDialog->showFullScreen();
+   }
+}
+
+
+/**
+ * @brief StationController::onStationStopped
+ * @param station Index of the station whose run has stopped (and is saved)
+ */
+void StationController::onStationStopped(int station)
+{
+   Station& stopped = m_qvecStations[station];
+   if (stopped.m_bStopped) { return; }
+
+   stopped.m_bStopped = true;
+
+   std::cout << "Station " << stopped.m_config.m_strName.toStdString()
+             << ": run stopped, saved to " << stopped.m_config.m_strFile.toStdString() << std::endl;
+
+   for (const Station& other : m_qvecStations)
+   {
+      if (!other.m_bStopped) { return; }
+   }
+
+   emit allStopped();
+}
@@ -0,0 +1,108 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include <memory>
+
+// Forward declarations
+class DataReaderWriter;
+class Experimenter;
+class StroopExperiment;
+class StroopExperimentDialog;
+class QScreen;
+
+
+/**
+ * @brief The StationConfig struct
+ * One participant of a multi-station session, a section of the station file.
+ */
+struct StationConfig
+{
+   StationConfig();
+
+   QString     m_strName;
+   QString     m_strScreen;  // Index in QGuiApplication::screens() or screen name
+   QString     m_strFile;    // Participant file (*.stroop), in the -o folder if given
+   QStringList m_strlInput;  // evdev devices and/or a recording, see EvdevInputThread
+   int         m_nCpu;       // CPU of the deadline and input threads, -1: not pinned
+};
+
+
+/**
+ * @brief The StationController class
+ *
+ * Runs several participants in parallel on one multi-head workstation
+ * (-m). The station file (INI) lists the stations, e.g.
+ *
+ *   [Stations]
+ *   stations = links, rechts
+ *
+ *   [links]
+ *   screen = 0
+ *   file = P01.stroop
+ *   input = /dev/input/by-path/pci-0000:00:14.0-usb-0:1:1.0-event-kbd
+ *   cpu = 2
+ *
+ * Every station has its own data reader/writer, Experimenter (the run is
+ * saved to its file when it stops) and StroopExperiment with the settings
+ * of the command line, shown full screen on its screen. The response
+ * deadline is timed on a deadline thread per station and the color keys
+ * are read from the station's keyboards on an input thread per station,
+ * both with SCHED_FIFO priority on the station's cpu as far as permitted;
+ * the keyboards are grabbed, so no key reaches another station or the
+ * window system. The dialogs are widgets and therefore all painted by
+ * the GUI thread, so frame timing (-e) needs a single station. Model
+ * estimates and saving of a stopped run are done on the thread pool.
+ */
+class StationController : public QObject
+{
+      Q_OBJECT
+
+   public:
+      explicit StationController(QObject* parent = nullptr);
+
+      bool load(const QString& filePath, const QString& folderPath, QString* error = nullptr);
+      const QVector<StationConfig>& getStations() const;
+
+      bool start(const StroopExperiment& settings, int numTrials,
+                 const QString& studyPlanPath, QString* error = nullptr);
+
+   signals:
+      void allStopped();
+
+   private:
+      // Runtime objects of a station; the dialog is declared last, so it is
+      // destroyed before the experiment it shows
+      struct Station
+      {
+         StationConfig m_config;
+         QScreen* m_pScreen = nullptr;
+         std::shared_ptr<DataReaderWriter> m_spDataRW;
+         std::shared_ptr<Experimenter> m_spExperimenter;
+         std::shared_ptr<StroopExperiment> m_spExperiment;
+         std::shared_ptr<StroopExperimentDialog> m_spDialog;
+         bool m_bLoaded = false;
+         bool m_bStopped = false;
+      };
+
+      bool assignScreens(QString* error);
+      static void applySettings(const StroopExperiment& settings, StroopExperiment& experiment);
+
+      void onStationLoaded(int station);
+      void onStationStopped(int station);
+
+      QVector<StationConfig> m_qvecConfigs;
+      QVector<Station> m_qvecStations;
+      int m_nNumTrials;
+};
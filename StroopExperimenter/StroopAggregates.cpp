@@ -0,0 +1,504 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopAggregates.h"
+#include "StroopStatistics.h"
+
+#include <cmath>
+#include <algorithm>
+
+
+// Range of the RT sketch in milliseconds
+static constexpr double SketchMinRT = 50.0;
+static constexpr double SketchMaxRT = 10000.0;
+
+
+/**
+ * @brief RTSketch::RTSketch
+ */
+RTSketch::RTSketch()
+   : m_i64Total(0LL)
+   , m_qvecBins(NumBins, 0LL)
+{
+}
+
+
+/**
+ * @brief RTSketch::add
+ * @param rt Reaction time in milliseconds; values outside the range are clamped
+ */
+void RTSketch::add(double rt)
+{
+   const double pos = std::log(std::clamp(rt, SketchMinRT, SketchMaxRT) / SketchMinRT)
+                    / std::log(SketchMaxRT / SketchMinRT) * NumBins;
+   const int bin = std::clamp(static_cast<int>(pos), 0, NumBins - 1);
+
+   m_qvecBins[bin]++;
+   m_i64Total++;
+}
+
+
+/**
+ * @brief RTSketch::merge
+ * @param other
+ */
+void RTSketch::merge(const RTSketch& other)
+{
+   for (int i=0; i<NumBins; i++) { m_qvecBins[i] += other.m_qvecBins.at(i); }
+   m_i64Total += other.m_i64Total;
+}
+
+
+/**
+ * @brief RTSketch::quantile
+ * @param q In [0, 1]
+ * @return Approximate quantile in milliseconds (geometric interpolation within the bin)
+ */
+double RTSketch::quantile(double q) const
+{
+   if (m_i64Total == 0LL) { return 0.0; }
+
+   const double target = std::clamp(q, 0.0, 1.0) * static_cast<double>(m_i64Total);
+   const double binWidth = std::log(SketchMaxRT / SketchMinRT) / NumBins;
+
+   double cumulative = 0.0;
+   for (int i=0; i<NumBins; i++)
+   {
+      const double count = static_cast<double>(m_qvecBins.at(i));
+      if (count > 0.0 && cumulative + count >= target)
+      {
+         const double frac = (target - cumulative) / count;
+         return SketchMinRT * std::exp((i + frac) * binWidth);
+      }
+      cumulative += count;
+   }
+
+   return SketchMaxRT;
+}
+
+
+/**
+ * @brief RTSketch::toString
+ * @return Sparse list "bin:count,bin:count,..."
+ */
+QString RTSketch::toString() const
+{
+   QStringList entries;
+   for (int i=0; i<NumBins; i++)
+   {
+      if (m_qvecBins.at(i) > 0LL)
+      {
+         entries.append(QString("%1:%2").arg(i).arg(m_qvecBins.at(i)));
+      }
+   }
+
+   return entries.join(",");
+}
+
+
+/**
+ * @brief RTSketch::fromString
+ * @param str String as written by toString()
+ * @return
+ */
+RTSketch RTSketch::fromString(const QString& str)
+{
+   RTSketch sketch;
+
+   const QStringList entries = str.split(",", Qt::SkipEmptyParts);
+   for (const QString& entry : entries)
+   {
+      const QStringList binCount = entry.split(":");
+      if (binCount.count() != 2) { continue; }
+
+      const int bin = binCount.at(0).toInt();
+      if (bin < 0 || bin >= NumBins) { continue; }
+
+      const qint64 count = binCount.at(1).toLongLong();
+      sketch.m_qvecBins[bin] += count;
+      sketch.m_i64Total += count;
+   }
+
+   return sketch;
+}
+
+
+/**
+ * @brief StroopConditionAggregate::StroopConditionAggregate
+ */
+StroopConditionAggregate::StroopConditionAggregate()
+   : m_i64NumTrials(0LL)
+   , m_i64NumCorrect(0LL)
+{
+}
+
+
+/**
+ * @brief StroopConditionAggregate::merge
+ * @param other
+ */
+void StroopConditionAggregate::merge(const StroopConditionAggregate& other)
+{
+   m_i64NumTrials += other.m_i64NumTrials;
+   m_i64NumCorrect += other.m_i64NumCorrect;
+   m_moments.merge(other.m_moments);
+   m_sketch.merge(other.m_sketch);
+}
+
+
+/**
+ * @brief StroopConditionAggregate::toString
+ * @return "trials;correct;n;mean;M2;M3;sketch"
+ */
+QString StroopConditionAggregate::toString() const
+{
+   QStringList values;
+   values << QString::number(m_i64NumTrials)
+          << QString::number(m_i64NumCorrect)
+          << QString::number(m_moments.m_i64Count)
+          << QString::number(m_moments.m_dMean, 'g', 17)
+          << QString::number(m_moments.m_dM2, 'g', 17)
+          << QString::number(m_moments.m_dM3, 'g', 17)
+          << m_sketch.toString();
+
+   return values.join(";");
+}
+
+
+/**
+ * @brief StroopConditionAggregate::fromString
+ * @param str String as written by toString()
+ * @return
+ */
+StroopConditionAggregate StroopConditionAggregate::fromString(const QString& str)
+{
+   StroopConditionAggregate aggregate;
+
+   const QStringList values = str.split(";");
+   if (values.count() == 7)
+   {
+      aggregate.m_i64NumTrials       = values.at(0).toLongLong();
+      aggregate.m_i64NumCorrect      = values.at(1).toLongLong();
+      aggregate.m_moments.m_i64Count = values.at(2).toLongLong();
+      aggregate.m_moments.m_dMean    = values.at(3).toDouble();
+      aggregate.m_moments.m_dM2      = values.at(4).toDouble();
+      aggregate.m_moments.m_dM3      = values.at(5).toDouble();
+      aggregate.m_sketch             = RTSketch::fromString(values.at(6));
+   }
+
+   return aggregate;
+}
+
+
+/**
+ * @brief StroopSessionSummary::StroopSessionSummary
+ */
+StroopSessionSummary::StroopSessionSummary()
+   : m_bValid(false)
+   , m_nNumAnswered(0)
+   , m_nNumCorrect(0)
+   , m_nNumMisses(0)
+   , m_nNumStalled(0)
+   , m_dMeanRT(0.0)
+   , m_dStdDevRT(0.0)
+   , m_dMeanCorrectRT(0.0)
+{
+}
+
+
+/**
+ * @brief StroopSessionSummary::numWrong
+ * @return
+ */
+int StroopSessionSummary::numWrong() const
+{
+   return m_nNumAnswered - m_nNumCorrect;
+}
+
+
+/**
+ * @brief StroopSessionSummary::toString
+ * @return "answered;correct;misses;stalled;meanRT;sdRT;meanCorrectRT"
+ */
+QString StroopSessionSummary::toString() const
+{
+   QStringList values;
+   values << QString::number(m_nNumAnswered)
+          << QString::number(m_nNumCorrect)
+          << QString::number(m_nNumMisses)
+          << QString::number(m_nNumStalled)
+          << QString::number(m_dMeanRT, 'f', 3)
+          << QString::number(m_dStdDevRT, 'f', 3)
+          << QString::number(m_dMeanCorrectRT, 'f', 3);
+
+   return values.join(";");
+}
+
+
+/**
+ * @brief StroopSessionSummary::fromString
+ * @param str String as written by toString()
+ * @return Invalid summary if str is empty or malformed
+ */
+StroopSessionSummary StroopSessionSummary::fromString(const QString& str)
+{
+   StroopSessionSummary summary;
+
+   const QStringList values = str.split(";");
+   if (values.count() == 7)
+   {
+      summary.m_nNumAnswered   = values.at(0).toInt();
+      summary.m_nNumCorrect    = values.at(1).toInt();
+      summary.m_nNumMisses     = values.at(2).toInt();
+      summary.m_nNumStalled    = values.at(3).toInt();
+      summary.m_dMeanRT        = values.at(4).toDouble();
+      summary.m_dStdDevRT      = values.at(5).toDouble();
+      summary.m_dMeanCorrectRT = values.at(6).toDouble();
+      summary.m_bValid = true;
+   }
+
+   return summary;
+}
+
+
+/**
+ * @brief StroopSessionSummary::fromColumns
+ * @param session All trials of a run, for sessions stored without summary
+ * @param numMisses Trials without response, not part of session
+ * @return
+ */
+StroopSessionSummary StroopSessionSummary::fromColumns(const StroopSessionColumns& session,
+                                                       int numMisses)
+{
+   StroopSessionSummary summary;
+
+   RunningMoments all;
+   RunningMoments correct;
+
+   for (int i=0; i<session.count(); i++)
+   {
+      all.add(session.m_qvecRT.at(i));
+      if (session.m_qvecCorrect.at(i)) { correct.add(session.m_qvecRT.at(i)); }
+      if (session.m_qvecStalled.at(i)) { summary.m_nNumStalled++; }
+   }
+
+   summary.m_nNumAnswered   = session.count();
+   summary.m_nNumCorrect    = static_cast<int>(correct.m_i64Count);
+   summary.m_nNumMisses     = numMisses;
+   summary.m_dMeanRT        = all.m_dMean;
+   summary.m_dStdDevRT      = all.standardDeviation();
+   summary.m_dMeanCorrectRT = correct.m_dMean;
+   summary.m_bValid = true;
+
+   return summary;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::StroopParticipantAggregate
+ * @param evalCorrectTrialsOnly Only correct trials contribute to the RT moments
+ */
+StroopParticipantAggregate::StroopParticipantAggregate(bool evalCorrectTrialsOnly)
+   : m_bValid(true)
+   , m_bEvalCorrectTrialsOnly(evalCorrectTrialsOnly)
+   , m_nNumSessions(0)
+   , m_qvecConditions(NumStroopConditions)
+{
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::addSession
+ * @param session
+ */
+void StroopParticipantAggregate::addSession(const StroopSessionColumns& session)
+{
+   addTrials(session);
+   endSession();
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::addTrials
+ * @param trials Part of the current session, e.g. a chunk of a streamed run
+ */
+void StroopParticipantAggregate::addTrials(const StroopSessionColumns& trials)
+{
+   const int numTrials = trials.count();
+   for (int i=0; i<numTrials; i++)
+   {
+      const int cond = trials.m_qvecCondition.at(i);
+      if (cond < 0 || cond >= NumStroopConditions) { continue; }
+
+      StroopConditionAggregate& aggregate = m_qvecConditions[cond];
+      const bool correct = trials.m_qvecCorrect.at(i);
+
+      aggregate.m_i64NumTrials++;
+      if (correct) { aggregate.m_i64NumCorrect++; }
+
+      if ((!m_bEvalCorrectTrialsOnly || correct) && trials.m_qvecRT.at(i) > 0.0)
+      {
+         aggregate.m_moments.add(trials.m_qvecRT.at(i));
+         aggregate.m_sketch.add(trials.m_qvecRT.at(i));
+      }
+   }
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::endSession
+ * Counts the session whose trials were added with addTrials().
+ */
+void StroopParticipantAggregate::endSession()
+{
+   m_nNumSessions++;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::isValid
+ * @return False if no complete block was found in the store
+ */
+bool StroopParticipantAggregate::isValid() const
+{
+   return m_bValid;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::getNumSessions
+ * @return
+ */
+int StroopParticipantAggregate::getNumSessions() const
+{
+   return m_nNumSessions;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::getEvalCorrectTrialsOnly
+ * @return
+ */
+bool StroopParticipantAggregate::getEvalCorrectTrialsOnly() const
+{
+   return m_bEvalCorrectTrialsOnly;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::getCondition
+ * @param condition StroopTrialModes as int
+ * @return
+ */
+const StroopConditionAggregate& StroopParticipantAggregate::getCondition(int condition) const
+{
+   return m_qvecConditions.at(condition);
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::getTotal
+ * @return All conditions merged
+ */
+StroopConditionAggregate StroopParticipantAggregate::getTotal() const
+{
+   StroopConditionAggregate total;
+   for (const StroopConditionAggregate& aggregate : m_qvecConditions)
+   {
+      total.merge(aggregate);
+   }
+
+   return total;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::insertInto
+ * @param store
+ */
+void StroopParticipantAggregate::insertInto(QMap<QString, QVariant>& store) const
+{
+   store.insert("StroopAggregate/numSessions", m_nNumSessions);
+   store.insert("StroopAggregate/evalCorrectTrialsOnly", m_bEvalCorrectTrialsOnly ? 1 : 0);
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const QString condName = StroopTrial::modeToString(static_cast<StroopTrialModes>(cond));
+      store.insert("StroopAggregate/" + condName, m_qvecConditions.at(cond).toString());
+   }
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::fromStore
+ * @param store
+ * @return Aggregate marked invalid if the block is missing or incomplete
+ */
+StroopParticipantAggregate StroopParticipantAggregate::fromStore(const QMap<QString, QVariant>& store)
+{
+   StroopParticipantAggregate aggregate(store.value("StroopAggregate/evalCorrectTrialsOnly").toInt() != 0);
+   aggregate.m_nNumSessions = store.value("StroopAggregate/numSessions").toInt();
+   aggregate.m_bValid = store.contains("StroopAggregate/numSessions");
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const QString key = "StroopAggregate/"
+                        + StroopTrial::modeToString(static_cast<StroopTrialModes>(cond));
+
+      if (!store.contains(key)) { aggregate.m_bValid = false; continue; }
+
+      aggregate.m_qvecConditions[cond] = StroopConditionAggregate::fromString(store.value(key).toString());
+   }
+
+   return aggregate;
+}
+
+
+/**
+ * @brief StroopParticipantAggregate::toStringList
+ * @param german
+ * @return One line per condition plus a header line
+ */
+QStringList StroopParticipantAggregate::toStringList(bool german) const
+{
+   QStringList lines;
+
+   const StroopConditionAggregate total = getTotal();
+
+   if (german)
+   {
+      lines.append(QString("Sitzungen: %1 / Trials: %2 / Korrekt: %3")
+                      .arg(m_nNumSessions).arg(total.m_i64NumTrials).arg(total.m_i64NumCorrect));
+   }
+   else
+   {
+      lines.append(QString("Sessions: %1 / trials: %2 / correct: %3")
+                      .arg(m_nNumSessions).arg(total.m_i64NumTrials).arg(total.m_i64NumCorrect));
+   }
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const StroopConditionAggregate& aggregate = m_qvecConditions.at(cond);
+
+      const double accuracy = (aggregate.m_i64NumTrials > 0LL)
+            ? 100.0 * aggregate.m_i64NumCorrect / aggregate.m_i64NumTrials : 0.0;
+
+      lines.append(QString("%1: n=%2, %3% %4, %5 %6s, SD %7s, Median %8s")
+                      .arg(StroopTrial::modeToString(static_cast<StroopTrialModes>(cond)))
+                      .arg(aggregate.m_i64NumTrials)
+                      .arg(QString::number(accuracy, 'f', 1),
+                           german ? "korrekt" : "correct",
+                           german ? "Mittelwert" : "mean",
+                           QString::number(aggregate.m_moments.m_dMean/1000.0, 'f', 3),
+                           QString::number(aggregate.m_moments.standardDeviation()/1000.0, 'f', 3),
+                           QString::number(aggregate.m_sketch.quantile(0.5)/1000.0, 'f', 3)));
+   }
+
+   return lines;
+}
@@ -0,0 +1,128 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "RunningMoments.h"
+
+#include <QMap>
+#include <QVector>
+#include <QVariant>
+#include <QStringList>
+
+// Forward declarations
+struct StroopSessionColumns;
+
+
+/**
+ * @brief The RTSketch struct
+ *
+ * Histogram with logarithmically spaced bins between 50 ms and 10 s.
+ * Sketches of different sessions are merged by adding the bins, and
+ * quantiles are read with a relative error of about 4 %.
+ */
+struct RTSketch
+{
+   static constexpr int NumBins = 128;
+
+   RTSketch();
+
+   void add(double rt);
+   void merge(const RTSketch& other);
+   double quantile(double q) const;
+
+   QString toString() const;
+   static RTSketch fromString(const QString& str);
+
+   qint64 m_i64Total;
+   QVector<qint64> m_qvecBins;
+};
+
+
+/**
+ * @brief The StroopConditionAggregate struct
+ */
+struct StroopConditionAggregate
+{
+   StroopConditionAggregate();
+
+   void merge(const StroopConditionAggregate& other);
+
+   QString toString() const;
+   static StroopConditionAggregate fromString(const QString& str);
+
+   qint64         m_i64NumTrials;
+   qint64         m_i64NumCorrect;
+   RunningMoments m_moments;  // RTs used for evaluation (milliseconds)
+   RTSketch       m_sketch;
+};
+
+
+/**
+ * @brief The StroopSessionSummary struct
+ *
+ * Counts and RT moments of one run, stored as "StroopSession_N/summary" so
+ * session lists can be shown without decoding the trials.
+ */
+struct StroopSessionSummary
+{
+   StroopSessionSummary();
+
+   int numWrong() const;
+
+   QString toString() const;
+   static StroopSessionSummary fromString(const QString& str);
+   static StroopSessionSummary fromColumns(const StroopSessionColumns& session, int numMisses);
+
+   bool   m_bValid;
+   int    m_nNumAnswered;
+   int    m_nNumCorrect;
+   int    m_nNumMisses;
+   int    m_nNumStalled;
+   double m_dMeanRT;        // Milliseconds, all answered trials
+   double m_dStdDevRT;
+   double m_dMeanCorrectRT; // Milliseconds, correctly answered trials
+};
+
+
+/**
+ * @brief The StroopParticipantAggregate class
+ *
+ * Lifetime summary of all sessions of one participant file, stored in the
+ * group "StroopAggregate". Adding a session only touches that session's
+ * trials; a rebuild from all sessions is only necessary when the
+ * evaluation mode changes or the stored block is missing or outdated.
+ */
+class StroopParticipantAggregate
+{
+   public:
+      explicit StroopParticipantAggregate(bool evalCorrectTrialsOnly = false);
+
+      void addSession(const StroopSessionColumns& session);
+      void addTrials(const StroopSessionColumns& trials);
+      void endSession();
+
+      bool isValid() const;
+      int getNumSessions() const;
+      bool getEvalCorrectTrialsOnly() const;
+
+      const StroopConditionAggregate& getCondition(int condition) const;
+      StroopConditionAggregate getTotal() const;
+
+      void insertInto(QMap<QString, QVariant>& store) const;
+      static StroopParticipantAggregate fromStore(const QMap<QString, QVariant>& store);
+
+      QStringList toStringList(bool german = true) const;
+
+   private:
+      bool m_bValid;
+      bool m_bEvalCorrectTrialsOnly;
+      int m_nNumSessions;
+      QVector<StroopConditionAggregate> m_qvecConditions;
+};
@@ -9,12 +9,19 @@
  *****************************************************************************/
  
 #include "StroopExperiment.h"
-
-#include <random>
-#include <numeric>
-#include <QTimer>
+#include "StroopStatistics.h"
+#include "StroopReEvaluation.h"
+#include "TrialRandom.h"
+#include "TrialSequenceGenerator.h"
+#include "StudyPlan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <iostream>
 #include <QDateTime>
 #include <QObject>
+#include <QtConcurrent>
 
 
 /**
@@ -27,7 +34,21 @@ StroopTrial::StroopTrial()
    , m_nChosenColor(Qt::black)
    , m_i64DecisionTime(-1LL)
    , m_bCorrect(false)
+   , m_bMissed(false)
+   , m_nDeadline(0)
+   , m_nStall(0)
+   , m_nOnset(0)
+   , m_nAnticipations(0)
+   , m_nAutoRepeats(0)
+   , m_nNumPresses(0)
+   , m_nFixationFrames(0)
+   , m_nFixationFramesShown(0)
+   , m_nStimulusFrames(0)
+   , m_nStimulusFramesShown(0)
+   , m_nDroppedFrames(0)
 {
+   m_arrPressColors.fill(Qt::black);
+   m_arrPressTimes.fill(0);
 }
 
 
@@ -44,7 +65,21 @@ StroopTrial::StroopTrial(StroopTrialModes mode, const QString& text, Qt::GlobalC
    , m_nChosenColor(Qt::black)
    , m_i64DecisionTime(-1LL)
    , m_bCorrect(false)
+   , m_bMissed(false)
+   , m_nDeadline(0)
+   , m_nStall(0)
+   , m_nOnset(0)
+   , m_nAnticipations(0)
+   , m_nAutoRepeats(0)
+   , m_nNumPresses(0)
+   , m_nFixationFrames(0)
+   , m_nFixationFramesShown(0)
+   , m_nStimulusFrames(0)
+   , m_nStimulusFramesShown(0)
+   , m_nDroppedFrames(0)
 {
+   m_arrPressColors.fill(Qt::black);
+   m_arrPressTimes.fill(0);
 }
 
 
@@ -65,30 +100,7 @@ QStringList StroopTrial::toStringList(bool includeValidState, bool german) const
       if (includeValidState) { result.append(m_bValid ? "gültig" : "ungültig"); }
    }
 
-   switch(m_nMode)
-   {
-      case StroopTrialModes::ColoredQuads:
-      {
-         result.append("Quads");
-         break;
-      }
-      case StroopTrialModes::ColoredTextMatched:
-      {
-         result.append("TextMatch");
-         break;
-      }
-      case StroopTrialModes::ColorTextConflicted:
-      {
-         result.append("TextConflict");
-         break;
-      }
-      case StroopTrialModes::ColoredTextUnreferenced:
-      {
-         result.append("TextUnref");
-         break;
-      }
-      default: { break; }
-   }
+   result.append(modeToString(m_nMode));
 
    result.append(m_strText);
    result.append(Experiment::convertColorToString(m_nColor,german));
@@ -104,10 +116,88 @@ QStringList StroopTrial::toStringList(bool includeValidState, bool german) const
 //   }
    result.append(QString::number(m_i64DecisionTime/1000.0, 'f', 3));
 
+   // Event loop stall during the trial, 0 if none
+   result.append(QString::number(m_nStall));
+
+   result.append(QString::number(m_nAnticipations));
+   result.append(QString::number(m_nAutoRepeats));
+   result.append(pressesToString(german));
+
    return result;
 }
 
 
+/**
+ * @brief StroopTrial::logPress
+ * @param color
+ * @param sinceFixation Time of the press in ms after the fixation onset
+ *
+ * Does not allocate, so it can be called from the trial loop.
+ */
+void StroopTrial::logPress(Qt::GlobalColor color, qint64 sinceFixation)
+{
+   if (m_nNumPresses < MaxLoggedPresses)
+   {
+      m_arrPressColors[m_nNumPresses] = color;
+      m_arrPressTimes[m_nNumPresses] = static_cast<int>(sinceFixation);
+   }
+
+   m_nNumPresses++;
+}
+
+
+/**
+ * @brief StroopTrial::resetPresses
+ * A trial shown again after a pause starts with an empty log.
+ */
+void StroopTrial::resetPresses()
+{
+   m_nAnticipations = 0;
+   m_nAutoRepeats = 0;
+   m_nNumPresses = 0;
+}
+
+
+/**
+ * @brief StroopTrial::pressesToString
+ * @param german
+ * @return E.g. "red@-412;green@538": color and time relative to the
+ *         stimulus onset in ms, negative for anticipations; "+N" for
+ *         presses beyond MaxLoggedPresses
+ */
+QString StroopTrial::pressesToString(bool german) const
+{
+   QStringList presses;
+
+   const int numLogged = std::min(m_nNumPresses, MaxLoggedPresses);
+   for (int i=0; i<numLogged; i++)
+   {
+      presses.append(Experiment::convertColorToString(m_arrPressColors[i], german)
+                     + "@" + QString::number(m_arrPressTimes[i] - m_nOnset));
+   }
+
+   if (m_nNumPresses > numLogged) { presses.append("+" + QString::number(m_nNumPresses - numLogged)); }
+
+   return presses.join(";");
+}
+
+
+/**
+ * @brief StroopTrial::hasFrameErrors
+ * @return True if frames were dropped during the trial or the fixation
+ *         point (or the stimulus of a miss) was not shown for the intended
+ *         number of frames; always false without frame timing
+ */
+bool StroopTrial::hasFrameErrors() const
+{
+   if (m_nFixationFrames == 0) { return false; }
+
+   return m_nDroppedFrames > 0
+          || m_nFixationFramesShown != m_nFixationFrames
+          || (m_bMissed && m_nStimulusFramesShown != m_nStimulusFrames);
+}
+
+
 /**
  * @brief StroopTrial::toString
  * @param includeValidState
@@ -120,6 +210,95 @@ QString StroopTrial::toString(bool includeValidState, bool german) const
 }
 
 
+/**
+ * @brief StroopTrial::fromStringList
+ * @param values Fields of a stored trial as written by toStringList(false, ...)
+ * @return Valid trial; presses are restored relative to the onset (onset 0)
+ */
+StroopTrial StroopTrial::fromStringList(const QStringList& values)
+{
+   StroopTrial trial;
+   if (values.count() < 6) { return trial; }
+
+   trial.m_bValid = true;
+   trial.m_nMode = modeFromString(values.at(0));
+   trial.m_strText = values.at(1);
+   trial.m_nColor = Experiment::convertStringToColor(values.at(2));
+   trial.m_nChosenColor = Experiment::convertStringToColor(values.at(3));
+   trial.m_bCorrect = (values.at(4) == QString("1"));
+   trial.m_i64DecisionTime = qRound64(values.at(5).toDouble() * 1000.0);
+
+   // Sessions recorded before these fields existed keep the defaults
+   if (values.count() > 6) { trial.m_nStall = values.at(6).toInt(); }
+   if (values.count() > 7) { trial.m_nAnticipations = values.at(7).toInt(); }
+   if (values.count() > 8) { trial.m_nAutoRepeats = values.at(8).toInt(); }
+
+   if (values.count() > 9 && !values.at(9).isEmpty())
+   {
+      const QStringList presses = values.at(9).split(";");
+      for (const QString& press : presses)
+      {
+         if (press.startsWith("+"))
+         {
+            trial.m_nNumPresses += press.mid(1).toInt();
+            continue;
+         }
+
+         const int sep = press.lastIndexOf("@");
+         trial.logPress(Experiment::convertStringToColor(press.left(sep)), press.mid(sep + 1).toInt());
+      }
+   }
+
+   return trial;
+}
+
+
+/**
+ * @brief StroopTrial::modeToString
+ * @param mode
+ * @return Short name of the condition as used in the serialized results
+ */
+QString StroopTrial::modeToString(StroopTrialModes mode)
+{
+   switch(mode)
+   {
+      case StroopTrialModes::ColoredQuads:            { return "Quads";        }
+      case StroopTrialModes::ColoredTextMatched:      { return "TextMatch";    }
+      case StroopTrialModes::ColorTextConflicted:     { return "TextConflict"; }
+      case StroopTrialModes::ColoredTextUnreferenced: { return "TextUnref";    }
+      default: { break; }
+   }
+
+   return QString();
+}
+
+
+/**
+ * @brief StroopTrial::modeFromString
+ * @param modeStr Short name of the condition as written by modeToString()
+ * @return
+ */
+StroopTrialModes StroopTrial::modeFromString(const QString& modeStr)
+{
+        if (modeStr == "TextMatch")    { return StroopTrialModes::ColoredTextMatched;      }
+   else if (modeStr == "TextConflict") { return StroopTrialModes::ColorTextConflicted;     }
+   else if (modeStr == "TextUnref")    { return StroopTrialModes::ColoredTextUnreferenced; }
+   else  /*(modeStr == "Quads")*/      { return StroopTrialModes::ColoredQuads;            }
+}
+
+
+/**
+ * @brief StroopParadigm::stimulusToString
+ * @param trial
+ * @return Mode & Text & Color, e.g. for the misses of a run
+ */
+QString StroopParadigm::stimulusToString(const Trial& trial)
+{
+   return StroopTrial::modeToString(trial.m_nMode) + "&" + trial.m_strText
+          + "&" + Experiment::convertColorToString(trial.m_nColor, true);
+}
+
+
 /**
  * @brief StroopExperiment::StroopExperiment
  */
@@ -127,20 +306,43 @@ StroopExperiment::StroopExperiment(int globalIndex, int numTrials,
                                    std::weak_ptr<DataReaderWriter> wpDataRW,
                                    QObject* parent)
    : Experiment(globalIndex, numTrials, wpDataRW, parent)
-   , m_nProgress(0)
+   , m_nIndexBlockStart(0)
+   , m_engine(*this)
    , m_bIndexCreationMode(true)
     , m_bEvalCorrectTrialsOnly(false)
-    , m_skipped(false)
+    , m_bAdaptiveDeadline(false)
+    , m_bRealtimeMode(false)
+    , m_nRealtimeCpu(-1)
+    , m_nInterval(Interval::None)
+    , m_nIntervalId(0)
+    , m_nIntervalPosition(-1)
+    , m_i64StimulusOnset(0LL)
+    , m_bInputExclusive(false)
+    , m_i64KernelFixationOnset(0LL)
+    , m_i64KernelOnset(0LL)
+    , m_bFrameTiming(false)
+    , m_dRefreshInterval(1000.0 / 60.0)
+    , m_bFrameSynchronized(true)
+    , m_bStreaming(false)
+    , m_nNumFlushedTrials(0)
+    , m_nNumChunks(0)
+    , m_u64Seed(0ULL)
+    , m_bSeedPreset(false)
+    , m_nNumPlannedTrials(0)
+    , m_bPlannedEquallyDistributed(true)
+    , m_nNumPracticeTrials(0)
+    , m_bPracticeStored(false)
+    , m_bCompleting(false)
 {
-   createStroopTrials();
-
-   timer.setSingleShot(true);
-   timer.setInterval(2000);
+   m_qvecStroopTrials = createStroopTrials();
 
-   timer.start();
-   timer.stop();
+   connect(&m_completionWatcher, &QFutureWatcher< QMap<QString, QVariant> >::finished,
+           this, &StroopExperiment::onCompletionFinished);
 
-   connect(&timer, &QTimer::timeout, this, &StroopExperiment::storeTimeAndContinue);
+   // Blank, fixation point and response deadline are always timed on
+   // their own thread: arming it does not allocate, unlike starting a
+   // QTimer (see AllocationGuard); only the drawing is on the GUI thread
+   startDeadlineThread(0, -1);
 }
 
 
@@ -156,73 +358,252 @@ void StroopExperiment::start()
    }
    else if (!m_bStarted)
    {
+      // The last run is not stored completely yet, see onCompletionFinished()
+      if (m_bCompleting) { return; }
+
       m_bStarted = true;
       m_bStopped = false;
 
       // ...and initialize variables specific to each run.
-      m_nProgress = 0;
+      m_nIndexBlockStart = 0;
+      m_qvecStreamConditions.clear();
+      m_nNumFlushedTrials = 0;
+      m_nNumChunks = 0;
+
+      // One master seed per run, recorded with the results
+      if (!m_bSeedPreset) { m_u64Seed = TrialRandom::createMasterSeed(); }
+      m_bSeedPreset = false;
 
-      // Clear temporary result containers
-      m_qvecStroopTrialIndices.clear();
+      // Runs of a study plan need no generation at all
+      if (!m_qvecPlannedTrialIndices.isEmpty())
+      {
+         m_qvecStroopTrialIndices = m_qvecPlannedTrialIndices;
+         m_qvecConditionOrder = m_qvecPlannedConditionOrder;
+         m_nNumTrials = m_qvecStroopTrialIndices.count();
+         m_bStreaming = m_nNumTrials > StreamingThreshold;
 
-      if (m_bIndexCreationMode)
+         m_qvecPlannedTrialIndices.clear();
+         m_runProtocol = StroopProtocol::defaultProtocol(m_nNumTrials);
+      }
+      else if (m_protocol.isLoaded())
       {
-         createEquallyDistributedTrialIndices();
+         // The protocol sets blocks and trial counts, its sequence is compiled below
+         m_runProtocol = m_protocol;
+         m_nNumTrials = m_runProtocol.getNumTrials();
+         m_bStreaming = m_nNumTrials > StreamingThreshold;
+         m_qvecConditionOrder.clear();
+      }
+      else if (m_nNumTrials > StreamingThreshold)
+      {
+         // Long runs generate the conditions up front and their items block
+         // by block, see templateIndex()
+         m_bStreaming = true;
+         m_qvecStreamConditions = createStreamedConditions(m_u64Seed, m_nNumTrials,
+                                                           m_bIndexCreationMode);
+         m_qvecStroopTrialIndices.reserve(StreamBlockSize);
+         createTrialIndexBlock(m_u64Seed, 0, m_qvecStreamConditions, -1, m_qvecStroopTrialIndices);
+         m_qvecConditionOrder.clear();
+         m_runProtocol = StroopProtocol::defaultProtocol(m_nNumTrials);
       }
       else
       {
-         createFullyRandomTrialIndices();
+         m_bStreaming = false;
+         m_qvecStroopTrialIndices = createTrialIndices(m_u64Seed, m_nNumTrials, m_bIndexCreationMode);
+         m_qvecConditionOrder.clear();
+         m_runProtocol = StroopProtocol::defaultProtocol(m_nNumTrials);
       }
+      m_nNumPlannedTrials = m_nNumTrials;
+
+      // Timing of every trial (and the whole sequence of protocol runs) is
+      // compiled here, the engine only walks the timeline
+      QVector<StroopTimelineEvent> timeline;
+      m_runProtocol.compile(m_u64Seed, timeline,
+                            m_runProtocol.isLoaded() ? &m_qvecStroopTrialIndices : nullptr);
+
+      // Practice trials are stored apart, see storePracticeTrials(); streamed
+      // runs flush them like the others, see flushTrials()
+      m_nNumPracticeTrials = m_runProtocol.getNumPracticeTrials();
+      m_strlPracticeResults.clear();
+      m_bPracticeStored = (m_nNumPracticeTrials == 0);
+
+      // The trial slots are allocated here; nothing allocates from the
+      // display request of a stimulus to its response (see AllocationGuard).
+      // Between trials, streamed runs format and write their chunks and
+      // generate the next block of indices, which allocates. Trials are
+      // copied from the templates one trial ahead, so repeated items keep
+      // their own results. Streamed runs reuse a ring of slots.
+      m_engine.setFrameTiming(m_bFrameTiming, m_dRefreshInterval);
+      m_engine.setFlushInterval(m_bStreaming ? StreamChunkSize : 0);
+      m_engine.startRun(m_bStreaming ? StreamRingCapacity : m_nNumTrials, m_bStreaming, timeline);
+
+      if (m_bStreaming) { openChunkFile(); }
+
+      if (m_bRealtimeMode) { prepareRealtimeRun(); }
+
+      m_watchdog.resetStatistics();
+      m_watchdog.startWatching();
 
       m_strLastExpTimeStamp = QDateTime::currentDateTime().toString("yyyy.MM.dd-hh::mm::ss");
 
       emit started(m_nGlobalIndex);
    }
 
-   startNextTrial();
+   m_engine.resume();
 }
 
 
 /**
- * @brief StroopExperiment::startNewRun
- * A "new run" consists of displaying the fixation point for 1 second and
- * then showing one experiment screen.
+ * @brief StroopExperiment::presentBlank
+ * @param isBreak True for a break, false for the ISI
  */
-void StroopExperiment::startNextTrial()
+void StroopExperiment::presentBlank(bool isBreak)
 {
-   if (m_nProgress >= m_nNumTrials)
-   {
-      stop();
-      return; // Yes, break the cycle here.
-   }
+   emit requestBlankScreen(isBreak ? QStringLiteral("Pause") : QString());
+}
+
 
+/**
+ * @brief StroopExperiment::presentFixationPoint
+ */
+void StroopExperiment::presentFixationPoint()
+{
    emit requestFixationPoint();
-   QTimer::singleShot(1000, this, SLOT(issueDisplayRequest()));
 }
 
 
 /**
- * @brief StroopExperiment::issueDisplayRequest
+ * @brief StroopExperiment::presentStimulus
+ * @param trial Current trial
  */
-void StroopExperiment::issueDisplayRequest()
+void StroopExperiment::presentStimulus(const StroopTrial& trial)
 {
-   if (m_nProgress >= m_nNumTrials)
+   if (trial.m_nMode == StroopTrialModes::ColoredQuads)
    {
-      stop();
-      return;
+      emit requestColoredQuad(trial.m_nColor);
    }
+   else
+   {
+      emit requestColoredWriting(trial.m_strText, trial.m_nColor);
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::startBlankTimer
+ * @param durationMs ISI or break before the fixation point
+ */
+void StroopExperiment::startBlankTimer(int durationMs)
+{
+   armInterval(Interval::Blank, -1, durationMs);
+}
+
+
+/**
+ * @brief StroopExperiment::startFixationTimer
+ * @param durationMs Fixation point before the stimulus
+ */
+void StroopExperiment::startFixationTimer(int durationMs)
+{
+   armInterval(Interval::Fixation, -1, durationMs);
+}
+
+
+/**
+ * @brief StroopExperiment::stopTimers
+ */
+void StroopExperiment::stopTimers()
+{
+   if (m_nInterval == Interval::Blank || m_nInterval == Interval::Fixation) { disarmInterval(); }
+}
+
+
+/**
+ * @brief StroopExperiment::armInterval
+ * @param interval Passed to the engine when it expires, see onIntervalExpired()
+ * @param position Trial of a response deadline, else -1
+ * @param durationMs From now on
+ */
+void StroopExperiment::armInterval(Interval interval, int position, int durationMs)
+{
+   m_nInterval = interval;
+   m_nIntervalPosition = position;
+   ++m_nIntervalId;
+
+   m_upDeadlineThread->arm(m_nIntervalId, durationMs);
+}
+
+
+/**
+ * @brief StroopExperiment::disarmInterval
+ */
+void StroopExperiment::disarmInterval()
+{
+   m_nInterval = Interval::None;
+   m_upDeadlineThread->disarm();
+}
+
 
-   StroopTrial curTrial = m_qvecStroopTrials.at(m_qvecStroopTrialIndices.at(m_nProgress));
+/**
+ * @brief StroopExperiment::markFixationOnset
+ * Kernel-timed presses before this are dropped, see onKernelResponses().
+ */
+void StroopExperiment::markFixationOnset()
+{
+   if (m_upInputThread) { m_i64KernelFixationOnset = EvdevInputThread::monotonicNow(); }
+}
+
+
+/**
+ * @brief StroopExperiment::markStimulusOnset
+ * Response times and kernel-timed presses count from here.
+ * @return Stimulus onset in ms after the fixation onset
+ */
+int StroopExperiment::markStimulusOnset()
+{
+   m_i64StimulusOnset = m_watchdog.now();
 
-   if (curTrial.m_nMode == StroopTrialModes::ColoredQuads)
+   if (m_upInputThread)
    {
-      m_eltiSingleDecisionTime.start(); // also restarts
-      emit requestColoredQuad(curTrial.m_nColor);
+      m_i64KernelOnset = EvdevInputThread::monotonicNow();
+      return static_cast<int>((m_i64KernelOnset - m_i64KernelFixationOnset) / 1000000LL);
    }
-   else
+
+   return static_cast<int>(m_engine.sinceFixation());
+}
+
+
+/**
+ * @brief StroopExperiment::longestStall
+ * @return Longest event loop stall since the stimulus onset in ms
+ */
+int StroopExperiment::longestStall() const
+{
+   return m_watchdog.longestStall(m_i64StimulusOnset, m_watchdog.now());
+}
+
+
+/**
+ * @brief StroopExperiment::responseDeadline
+ * @param trial Current trial
+ * @param timelineDeadline Response window given by the timeline in ms
+ * @return Response window of the trial: fixed or by staircase
+ */
+int StroopExperiment::responseDeadline(const StroopTrial& trial, int timelineDeadline) const
+{
+   return m_bAdaptiveDeadline ? m_staircase.getDeadline(static_cast<int>(trial.m_nMode))
+                              : timelineDeadline;
+}
+
+
+/**
+ * @brief StroopExperiment::recordOutcome
+ * @param trial Current trial, answered or missed
+ */
+void StroopExperiment::recordOutcome(const StroopTrial& trial)
+{
+   if (m_bAdaptiveDeadline)
    {
-      m_eltiSingleDecisionTime.start(); // also restarts
-      emit requestColoredWriting(curTrial.m_strText, curTrial.m_nColor);
+      m_staircase.update(static_cast<int>(trial.m_nMode), StroopParadigm::isCorrect(trial));
    }
 }
 
@@ -233,6 +614,9 @@ void StroopExperiment::issueDisplayRequest()
 void StroopExperiment::pause()
 {
    m_bPaused = true;
+
+   // An unanswered trial is shown again on resume
+   m_engine.halt();
 }
 
 
@@ -241,6 +625,9 @@ void StroopExperiment::pause()
  */
 void StroopExperiment::togglePause()
 {
+   // Not yet started, e.g. while the refresh interval is measured
+   if (!m_bStarted) { return; }
+
    if(m_bPaused)
    {
       start();
@@ -263,141 +650,601 @@ void StroopExperiment::stop()
       m_bPaused  = false;
       m_bStopped = true;
 
+      m_engine.halt();
+
+      if (m_bRealtimeMode) { finishRealtimeRun(); }
+
+      const StroopEngine::RunStatistics& stats = m_engine.statistics();
+      if (m_bFrameTiming && stats.m_nNumFrameErrors > 0)
+      {
+         std::cout << "Frame timing: " << stats.m_nNumDroppedFrames << " dropped frames, "
+                   << stats.m_nNumFrameErrors << " trials flagged" << std::endl;
+      }
+
+      m_watchdog.stopWatching();
+
       checkIfAborted();
       evaluateTrials();
       serializeCurrentExperiment();
 
-      emit stopped(m_nGlobalIndex);
+      // Otherwise reported when the model estimates or chunks are stored
+      if (!m_bCompleting) { emit stopped(m_nGlobalIndex); }
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::onCompletionFinished
+ * Stores the model estimates or the chunks of the last run, which is then
+ * reported as stopped (and saved by the Experimenter).
+ */
+void StroopExperiment::onCompletionFinished()
+{
+   if (!m_bCompleting) { return; }
+
+   m_bCompleting = false;
+
+   // Keys of this session only: nothing stored yet is replaced
+   const QMap<QString, QVariant> results = m_completionWatcher.result();
+   QMap<QString, QVariant>::const_iterator it;
+   for (it = results.constBegin(); it != results.constEnd(); ++it)
+   {
+      m_mapSerializedResults.insert(it.key(), it.value());
+   }
+
+   emit stopped(m_nGlobalIndex);
+}
+
+
+/**
+ * @brief StroopExperiment::completeLastRun
+ * Waits for the estimates or chunks of the last run, e.g. before its
+ * results are exported.
+ */
+void StroopExperiment::completeLastRun()
+{
+   if (m_bCompleting)
+   {
+      m_completionWatcher.waitForFinished();
+      onCompletionFinished();
    }
 }
 
 
 /**
  * @brief StroopExperiment::storeTimeAndContinue
+ * Called after a response within the deadline.
  */
 void StroopExperiment::storeTimeAndContinue()
 {
-   if(m_skipped) {
-      // Save the time needed for the decision
-      m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_i64DecisionTime
-          = m_eltiSingleDecisionTime.elapsed();
+   if (m_engine.phase() != StroopEngine::Phase::Stimulus) { return; }
 
-      // Mark the current trial as valid
-      m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_bValid = true;
+   m_engine.respondAt(m_engine.sinceStimulus());
+}
 
-      // Finally, progress to the next trial
-      m_nProgress++;
 
-      if (m_bStarted && !m_bPaused)
-      {
-         startNextTrial();
-      }
+/**
+ * @brief StroopExperiment::onIntervalExpired
+ * @param id Interval that expired on the deadline thread
+ */
+void StroopExperiment::onIntervalExpired(int id)
+{
+   // Disarmed or armed again while the notification was queued
+   if (id != m_nIntervalId || m_nInterval == Interval::None) { return; }
+
+   const Interval interval = m_nInterval;
+   m_nInterval = Interval::None;
+
+   switch (interval)
+   {
+      case Interval::Blank:    m_engine.blankElapsed(); break;
+      case Interval::Fixation: m_engine.fixationElapsed(); break;
+      case Interval::Response: m_engine.deadlineExpired(m_nIntervalPosition); break;
+      default: break;
    }
 }
 
 
 /**
- * @brief StroopExperiment::checkIfAborted
+ * @brief StroopExperiment::onKernelResponses
+ * Takes the color keys read by the evdev thread. The phase of a press is
+ * decided by its kernel timestamp, so a press queued during the fixation
+ * point stays an anticipation. Presses before the fixation onset of the
+ * current trial are dropped.
  */
-void StroopExperiment::checkIfAborted()
+void StroopExperiment::onKernelResponses()
 {
-   const int maxIdx = m_nNumTrials - 1;
+   if (!m_upInputThread) { return; }
 
-   // "m_nProgress" is current idx, i.e. the index of the aborted trial.
-   // Thus, the trial at index "m_nProgress" and all following need to be deleted.
-   // Example: progress    5 -> [0,5] -> currentIndex 5
-   //          numTrials   8 -> [0,7] -> maxIndex     7
-   //  -> delete current invalid one and rest means delete trials at indices 5, 6 and 7.
+   AllocationGuard::Section section;
 
-   // All remaining trials, including the one that was active, are deleted.
-   if (m_nProgress < maxIdx)
+   KeyResponse response;
+   while (m_upInputThread->takeResponse(response))
    {
-      for(int i=m_nProgress; i<m_nNumTrials; i++)
+      const qint64 timestamp = response.m_i64Timestamp;
+
+      if (m_engine.phase() == StroopEngine::Phase::Idle
+          || timestamp < m_i64KernelFixationOnset) { continue; }
+
+      if (response.m_bAutoRepeat)
       {
-         m_qvecStroopTrialIndices.removeLast();
+         m_engine.autoRepeat();
+         continue;
       }
 
-      int numDefinedIndices = m_qvecStroopTrialIndices.count();
-      Q_ASSERT(m_nProgress == numDefinedIndices);
+      const bool inWindow = (m_engine.phase() == StroopEngine::Phase::Stimulus
+                             && timestamp >= m_i64KernelOnset);
 
-      m_nNumTrials = numDefinedIndices;
+      m_engine.handlePress(response.m_nColor, (timestamp - m_i64KernelFixationOnset) / 1000000LL,
+                           inWindow ? (timestamp - m_i64KernelOnset) / 1000000LL : -1LL);
    }
 }
 
 
 /**
- * @brief StroopExperiment::evaluateTrials
+ * @brief StroopExperiment::onFramePresented
+ * @param frame Refreshes since the refresh interval was measured
+ * @param droppedFrames Refreshes missed before this swap
+ *
+ * Frame timing, see FramePresenter and TrialEngine::framePresented().
  */
-void StroopExperiment::evaluateTrials()
+void StroopExperiment::onFramePresented(qint64 frame, int droppedFrames)
 {
-   /* Check for each trial if the participant has given the correct response */
-   int numCorrect = 0, numWrong = 0;
-   qint64 sumDT = 0LL;
-   int numDTs = 0;
+   m_engine.framePresented(frame, droppedFrames);
+}
 
-   std::vector<double> diffMean; // result vector
 
-   int numUsedTrials = 0;
-   for (int i=0; i<m_nNumTrials; i++)
-   {
-      StroopTrial& trial = m_qvecStroopTrials[m_qvecStroopTrialIndices.at(i)];
+/**
+ * @brief StroopExperiment::startDeadline
+ * @param position Position of the current trial
+ * @param deadlineMs Response window of the current trial
+ */
+void StroopExperiment::startDeadline(int position, int deadlineMs)
+{
+   armInterval(Interval::Response, position, deadlineMs);
+}
 
-      if (trial.m_bValid) { numUsedTrials++; }
-      else { continue; }
 
-      bool correct = ( trial.m_nColor == trial.m_nChosenColor );
-      if (correct) { numCorrect++; } else { numWrong++; }
+/**
+ * @brief StroopExperiment::stopDeadline
+ */
+void StroopExperiment::stopDeadline()
+{
+   if (m_nInterval == Interval::Response) { disarmInterval(); }
+}
 
-      trial.m_bCorrect = correct;
 
-      if (!m_bEvalCorrectTrialsOnly || correct)
-      {
-         sumDT += trial.m_i64DecisionTime;
-         numDTs++;
+/**
+ * @brief StroopExperiment::startDeadlineThread
+ * @param priority SCHED_FIFO priority, 0: normal scheduling
+ * @param cpu CPU to pin the thread to, -1: none
+ */
+void StroopExperiment::startDeadlineThread(int priority, int cpu)
+{
+   m_upDeadlineThread.reset();
+   m_upDeadlineThread = std::make_unique<RealtimeDeadlineThread>(priority, cpu);
 
-         // Save the individual minuends for later
-         diffMean.push_back(static_cast<double>(trial.m_i64DecisionTime));
-      }
-   }
+   connect(m_upDeadlineThread.get(), &RealtimeDeadlineThread::expired,
+           this, &StroopExperiment::onIntervalExpired, Qt::QueuedConnection);
 
-   Q_ASSERT((numCorrect+numWrong) == numUsedTrials);
+   m_upDeadlineThread->start();
+}
 
-   /** Compute mean and standard deviation of the decision time (DT) **/
 
-   /* Mean of decision times */
-   double meanDT = static_cast<double>(sumDT) / static_cast<double>(numDTs);
+/**
+ * @brief StroopExperiment::prepareRealtimeRun
+ * Locks the memory, prefaults the run buffers and records what the
+ * deadline thread was granted. Everything not granted is logged.
+ */
+void StroopExperiment::prepareRealtimeRun()
+{
+   m_realtimeReport = RealtimeReport();
+   m_realtimeReport.m_bMemoryLocked = RealtimeSupport::lockMemory(m_realtimeReport.m_strlProblems);
 
-   /* Standard deviation of decision times */
+   RealtimeSupport::prefault(m_engine.trials().constData(),
+                             m_engine.trials().count() * qint64(sizeof(StroopTrial)));
+   RealtimeSupport::prefault(m_qvecStroopTrialIndices.constData(),
+                             m_qvecStroopTrialIndices.count() * qint64(sizeof(int)));
+   RealtimeSupport::prefaultStack();
 
-   // Compute differences from the mean for each decision time
-   for (int i=0; i<numDTs; i++)
+   if (!m_upDeadlineThread->waitUntilConfigured())
    {
-      diffMean[i] = diffMean[i] - meanDT;
+      m_realtimeReport.m_strlProblems.append("Deadline thread did not start");
    }
+   m_upDeadlineThread->getScheduling(m_realtimeReport);
 
-   // Sum of squares of differences from mean using inner (dot) product.
-   // The differences from the mean are squared by using "diffMean" as argument for both vectors.
-   // Last argument is the value to initialize the sum.
-   double sqSum = std::inner_product(diffMean.begin(), diffMean.end(),
-                                     diffMean.begin(), 0.0);
-
-   // Finally, the standard deviation is computed as:
-   double stDevDT = std::sqrt(sqSum / static_cast<double>(numDTs));
+   if (m_upInputThread)
+   {
+      if (!m_upInputThread->waitUntilConfigured())
+      {
+         m_realtimeReport.m_strlProblems.append("Input thread did not start");
+      }
+      m_upInputThread->getScheduling(m_realtimeReport);
+   }
 
-   // Save whole assessment as a list of strings
-   m_strlLastStats.clear();
-   m_strlLastStats = statsToStringList(meanDT, numCorrect, numWrong, stDevDT);
+   const QStringList& problems = m_realtimeReport.m_strlProblems;
+   for (const QString& problem : problems)
+   {
+      std::cout << "Real-time mode: " << problem.toStdString() << std::endl;
+   }
 
-   emit statsComputed(numCorrect, numWrong, m_nNumTrials, meanDT, stDevDT);
+   // Counters at the start, see finishRealtimeRun()
+   RealtimeSupport::pageFaults(m_realtimeReport.m_i64MinorFaults, m_realtimeReport.m_i64MajorFaults);
 }
 
 
 /**
- * @brief StroopExperiment::assessmentToStringList
- * @param meanRT
- * @param numMatches
- * @param numWrong
- * @param stDevRT
+ * @brief StroopExperiment::finishRealtimeRun
+ */
+void StroopExperiment::finishRealtimeRun()
+{
+   qint64 minorFaults = 0LL;
+   qint64 majorFaults = 0LL;
+
+   if (RealtimeSupport::pageFaults(minorFaults, majorFaults))
+   {
+      m_realtimeReport.m_i64MinorFaults = minorFaults - m_realtimeReport.m_i64MinorFaults;
+      m_realtimeReport.m_i64MajorFaults = majorFaults - m_realtimeReport.m_i64MajorFaults;
+   }
+   else
+   {
+      m_realtimeReport.m_i64MinorFaults = -1LL;
+      m_realtimeReport.m_i64MajorFaults = -1LL;
+   }
+
+   if (m_realtimeReport.m_bMemoryLocked) { RealtimeSupport::unlockMemory(); }
+}
+
+
+/**
+ * @brief StroopExperiment::templateIndex
+ * @param position Position in the current run
+ * @return Index into m_qvecStroopTrials
+ *
+ * Streamed runs keep one block of indices and generate the next block
+ * when the run reaches it; the last trial of a block is passed on, so
+ * word and ink do not repeat at the border either.
+ */
+int StroopExperiment::templateIndex(int position)
+{
+   if (position - m_nIndexBlockStart >= m_qvecStroopTrialIndices.count())
+   {
+      const int block = position / StreamBlockSize;
+      const int previous = m_qvecStroopTrialIndices.isEmpty() ? -1 : m_qvecStroopTrialIndices.last();
+
+      createTrialIndexBlock(m_u64Seed, block, m_qvecStreamConditions, previous,
+                            m_qvecStroopTrialIndices);
+      m_nIndexBlockStart = block * StreamBlockSize;
+   }
+
+   return m_qvecStroopTrialIndices.at(position - m_nIndexBlockStart);
+}
+
+
+/**
+ * @brief StroopExperiment::trialTemplate
+ * @param position Position in the current run
+ * @return Template copied into the slot of the trial. QString members are
+ *         shared, so the copy does not allocate.
+ */
+const StroopTrial& StroopExperiment::trialTemplate(int position)
+{
+   return m_qvecStroopTrials.at(templateIndex(position));
+}
+
+
+/**
+ * @brief StroopExperiment::onTrialCompleted
+ * @param position Trial just completed, between trials
+ */
+void StroopExperiment::onTrialCompleted(int position)
+{
+   // The practice is stored when it is over
+   if (!m_bStreaming && position + 1 == m_nNumPracticeTrials) { storePracticeTrials(position + 1); }
+
+   // Receivers must not block (see StroopRTPlotWidget)
+   emit trialCompleted(position, m_engine.trial(position));
+}
+
+
+/**
+ * @brief StroopExperiment::flushTrials
+ * @param upToPosition Trials before this position are written
+ *
+ * Writes the trials since the last flush as chunk "chunk_K" (plus
+ * "misses_K" and "staircase_K") of the session that is being recorded,
+ * see writeChunk(). Practice trials are appended to "practice" instead.
+ */
+void StroopExperiment::flushTrials(int upToPosition)
+{
+   if (upToPosition <= m_nNumFlushedTrials) { return; }
+
+   const int sessionNumber = m_nDataSetCount + 1;
+   QMap<QString, QStringList> chunk;
+
+   const int practiceEnd = qMin(upToPosition, m_nNumPracticeTrials);
+   if (m_nNumFlushedTrials < practiceEnd)
+   {
+      QStringList practice;
+      QStringList misses;
+      m_engine.toStringLists(m_nNumFlushedTrials, practiceEnd, practice, misses, nullptr);
+
+      chunk.insert(sessionKey(sessionNumber, "practice"), practice);
+      m_nNumFlushedTrials = practiceEnd;
+   }
+
+   if (m_nNumFlushedTrials < upToPosition)
+   {
+      QStringList results;
+      QStringList misses;
+      QStringList trajectory;
+      trialsToStringLists(m_nNumFlushedTrials, upToPosition, results, misses, trajectory);
+
+      const QString suffix = QString("_%1").arg(m_nNumChunks);
+      chunk.insert(sessionKey(sessionNumber, "chunk" + suffix), results);
+      chunk.insert(sessionKey(sessionNumber, "misses" + suffix), misses);
+      if (m_bAdaptiveDeadline)
+      {
+         chunk.insert(sessionKey(sessionNumber, "staircase" + suffix), trajectory);
+      }
+      if (m_bFrameTiming)
+      {
+         QStringList frames;
+         framesToStringList(m_nNumFlushedTrials, upToPosition, frames);
+         chunk.insert(sessionKey(sessionNumber, "frames" + suffix), frames);
+      }
+
+      // Lifetime aggregate: merge the chunk, the session is counted on stop
+      m_aggregate.addTrials(StroopSessionColumns::fromSerialized(results));
+
+      m_nNumFlushedTrials = upToPosition;
+      m_nNumChunks++;
+   }
+
+   writeChunk(chunk);
+
+   emit trialsFlushed(m_nNumFlushedTrials);
+}
+
+
+/**
+ * @brief StroopExperiment::openChunkFile
+ * Opens the chunk file of the session that is about to be recorded, see
+ * chunkFilePath(). Without a participant's file the chunks are kept in
+ * the result map.
+ */
+void StroopExperiment::openChunkFile()
+{
+   if (m_chunkFile.isOpen()) { m_chunkFile.close(); }
+   if (m_strFilePath.isEmpty()) { return; }
+
+   m_chunkFile.setFileName(chunkFilePath(m_strFilePath, m_nDataSetCount + 1));
+   if (!m_chunkFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+   {
+      std::cout << "Cannot open " << m_chunkFile.fileName().toStdString() << ": "
+                << m_chunkFile.errorString().toStdString()
+                << ", the chunks are kept in memory" << std::endl;
+      return;
+   }
+
+   m_chunkStream.setDevice(&m_chunkFile);
+   m_chunkStream.setVersion(QDataStream::Qt_6_0);
+   m_chunkStream.resetStatus();
+}
+
+
+/**
+ * @brief StroopExperiment::writeChunk
+ * @param chunk Keys of the session and their values
+ *
+ * Appends the chunk to the chunk file, so its cost does not depend on the
+ * length of the run or the size of the participant's file. The chunk is
+ * kept in the result map if it cannot be written.
+ */
+void StroopExperiment::writeChunk(const QMap<QString, QStringList>& chunk)
+{
+   if (m_chunkFile.isOpen())
+   {
+      const qint64 chunkStart = m_chunkFile.pos();
+
+      QMap<QString, QStringList>::const_iterator it;
+      for (it = chunk.constBegin(); it != chunk.constEnd(); ++it)
+      {
+         m_chunkStream << it.key() << it.value();
+      }
+
+      if (m_chunkFile.flush() && m_chunkStream.status() == QDataStream::Ok) { return; }
+
+      // The complete chunks so far are merged, this one and the rest stay in memory
+      std::cout << "Cannot write " << m_chunkFile.fileName().toStdString() << ": "
+                << m_chunkFile.errorString().toStdString()
+                << ", the chunks are kept in memory" << std::endl;
+      m_chunkFile.resize(chunkStart);
+      mergeChunkFile();
+   }
+
+   QMap<QString, QStringList>::const_iterator it;
+   for (it = chunk.constBegin(); it != chunk.constEnd(); ++it)
+   {
+      appendToStore(it.key(), it.value());
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::mergeChunkFile
+ * Reads the chunk file back into the result map on the GUI thread, after
+ * a failed write. At the end of a run it is read on the thread pool, see
+ * serializeCurrentExperiment().
+ */
+void StroopExperiment::mergeChunkFile()
+{
+   if (!m_chunkFile.isOpen()) { return; }
+
+   m_chunkStream.setDevice(nullptr);
+   m_chunkFile.close();
+
+   const QMap<QString, QVariant> chunks = readChunkFile(m_chunkFile.fileName());
+   QMap<QString, QVariant>::const_iterator it;
+   for (it = chunks.constBegin(); it != chunks.constEnd(); ++it)
+   {
+      appendToStore(it.key(), it.value().toStringList());
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::readChunkFile
+ * @param fileName Closed chunk file, see chunkFilePath()
+ * @return Values of each key in the order of the chunks
+ *
+ * Removes the file once it is read; it is kept if it cannot be read
+ * completely. Does not touch the experiment, so it may run on the thread
+ * pool.
+ */
+QMap<QString, QVariant> StroopExperiment::readChunkFile(const QString& fileName)
+{
+   QMap<QString, QStringList> lists;
+
+   QFile file(fileName);
+   if (!file.open(QIODevice::ReadOnly))
+   {
+      std::cout << "Cannot read " << fileName.toStdString() << ": "
+                << file.errorString().toStdString() << std::endl;
+      return QMap<QString, QVariant>();
+   }
+
+   QDataStream in(&file);
+   in.setVersion(QDataStream::Qt_6_0);
+
+   QString key;
+   QStringList values;
+   while (!in.atEnd())
+   {
+      in >> key >> values;
+      if (in.status() != QDataStream::Ok) { break; }
+
+      lists[key].append(values);
+   }
+
+   file.close();
+
+   if (in.status() == QDataStream::Ok)
+   {
+      file.remove();
+   }
+   else
+   {
+      std::cout << "Cannot read " << fileName.toStdString()
+                << " completely, the file is kept" << std::endl;
+   }
+
+   QMap<QString, QVariant> chunks;
+   QMap<QString, QStringList>::const_iterator it;
+   for (it = lists.constBegin(); it != lists.constEnd(); ++it)
+   {
+      chunks.insert(it.key(), it.value());
+   }
+
+   return chunks;
+}
+
+
+/**
+ * @brief StroopExperiment::appendToStore
+ * @param key
+ * @param values Appended to the list stored under key, e.g. "practice"
+ */
+void StroopExperiment::appendToStore(const QString& key, const QStringList& values)
+{
+   QStringList stored = m_mapSerializedResults.value(key).toStringList();
+   stored.append(values);
+   m_mapSerializedResults.insert(key, stored);
+}
+
+
+/**
+ * @brief StroopExperiment::storePracticeTrials
+ * @param upToPosition End of the practice, or of an aborted run
+ *
+ * Practice trials are not evaluated; the answered ones are stored under
+ * "StroopSession_N/practice" instead of the results.
+ */
+void StroopExperiment::storePracticeTrials(int upToPosition)
+{
+   if (m_bPracticeStored) { return; }
+
+   QStringList misses;
+   m_engine.toStringLists(0, qMin(upToPosition, m_nNumPracticeTrials),
+                          m_strlPracticeResults, misses, nullptr);
+   m_bPracticeStored = true;
+}
+
+
+/**
+ * @brief StroopExperiment::checkIfAborted
+ */
+void StroopExperiment::checkIfAborted()
+{
+   // "progress" is current idx, i.e. the index of the aborted trial.
+   // Thus, the trial at index "progress" and all following need to be deleted.
+   // Example: progress    5 -> [0,5] -> currentIndex 5
+   //          numTrials   8 -> [0,7] -> maxIndex     7
+   //  -> delete current invalid one and rest means delete trials at indices 5, 6 and 7.
+
+   // All remaining trials, including the one that was active, are deleted.
+   if (m_engine.progress() < m_nNumTrials)
+   {
+      m_nNumTrials = m_engine.progress();
+
+      // Streamed runs only hold a block of indices and a ring of trials
+      if (!m_bStreaming)
+      {
+         m_qvecStroopTrialIndices.resize(m_nNumTrials);
+         m_engine.truncate(m_nNumTrials);
+      }
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::evaluateTrials
+ */
+void StroopExperiment::evaluateTrials()
+{
+   /* The counts and moments are updated trial by trial in TrialEngine::complete() */
+   const StroopEngine::RunStatistics& stats = m_engine.statistics();
+   const int numCorrect = stats.m_nNumCorrect;
+   const int numWrong = stats.m_nNumWrong;
+
+   const RunningMoments& moments = m_bEvalCorrectTrialsOnly ? stats.m_momentsCorrect
+                                                            : stats.m_momentsAll;
+
+   /** Mean and (population) standard deviation of the decision time (DT) **/
+   double meanDT  = std::numeric_limits<double>::quiet_NaN();
+   double stDevDT = std::numeric_limits<double>::quiet_NaN();
+
+   if (moments.m_i64Count > 0LL)
+   {
+      meanDT  = moments.m_dMean;
+      stDevDT = std::sqrt(moments.m_dM2 / static_cast<double>(moments.m_i64Count));
+   }
+
+   // Save whole assessment as a list of strings
+   m_strlLastStats.clear();
+   m_strlLastStats = statsToStringList(meanDT, numCorrect, numWrong, stDevDT);
+
+   emit statsComputed(numCorrect, numWrong, m_nNumTrials - qMin(m_nNumPracticeTrials, m_nNumTrials),
+                      meanDT, stDevDT);
+}
+
+
+/**
+ * @brief StroopExperiment::assessmentToStringList
+ * @param meanRT
+ * @param numMatches
+ * @param numWrong
+ * @param stDevRT
  */
 QStringList StroopExperiment::statsToStringList(double meanRT, int numMatches,
                                                 int numWrong, double stDevRT, bool german)
@@ -453,400 +1300,1316 @@ void StroopExperiment::setIndexCreationMode(bool blockOrderMode)
 
 
 /**
- * @brief StroopExperiment::activateEvalCorrectTrialsOnlyMode
+ * @brief StroopExperiment::activateEvalCorrectTrialsOnlyMode
+ */
+void StroopExperiment::activateEvalCorrectTrialsOnlyMode()
+{
+   if (m_bEvalCorrectTrialsOnly) { return; }
+
+   m_bEvalCorrectTrialsOnly = true;
+   rebuildAggregate();
+}
+
+
+/**
+ * @brief JpegPerceptionExperiment::activateEvalAllTrialsMode
+ */
+void StroopExperiment::activateEvalAllTrialsMode()
+{
+   if (!m_bEvalCorrectTrialsOnly) { return; }
+
+   m_bEvalCorrectTrialsOnly = false;
+   rebuildAggregate();
+}
+
+
+/**
+ * @brief StroopExperiment::getLastAssessmentStringList
+ * @return
+ */
+QStringList StroopExperiment::getLastStatsStringList() const
+{
+   return m_strlLastStats;
+}
+
+
+/**
+ * @brief StroopExperiment::getLifetimeStatsStringList
+ * @return Summary of all runs of the loaded participant
+ */
+QStringList StroopExperiment::getLifetimeStatsStringList() const
+{
+   return m_aggregate.toStringList();
+}
+
+
+/**
+ * @brief StroopExperiment::rebuildAggregate
+ *
+ * Recomputes the lifetime aggregate from all stored runs. Only needed if
+ * the evaluation mode changed or the stored aggregate is missing/outdated,
+ * new runs are added incrementally in serializeCurrentExperiment().
+ */
+void StroopExperiment::rebuildAggregate()
+{
+   m_aggregate = StroopParticipantAggregate(m_bEvalCorrectTrialsOnly);
+
+   for (int i=1; i<=m_nDataSetCount; i++)
+   {
+      const QStringList allExpData = sessionResults(m_mapSerializedResults, i);
+      m_aggregate.addSession(StroopSessionColumns::fromSerialized(allExpData));
+   }
+
+   m_aggregate.insertInto(m_mapSerializedResults);
+}
+
+
+/**
+ * @brief StroopExperiment::onRedChosen
+ */
+void StroopExperiment::onRedChosen()
+{
+   onColorKey(Qt::red, false);
+}
+
+
+/**
+ * @brief StroopExperiment::onGreenChosen
+ */
+void StroopExperiment::onGreenChosen()
+{
+   onColorKey(Qt::green, false);
+}
+
+
+/**
+ * @brief StroopExperiment::onBlueChosen
+ */
+void StroopExperiment::onBlueChosen()
+{
+   onColorKey(Qt::blue, false);
+}
+
+
+/**
+ * @brief StroopExperiment::onYellowChosen
+ */
+void StroopExperiment::onYellowChosen()
+{
+   onColorKey(Qt::yellow, false);
+}
+
+
+/**
+ * @brief StroopExperiment::onColorKey
+ * @param color Color of the pressed key
+ * @param autoRepeat True for presses generated by holding the key
+ *
+ * Input state machine: during the fixation point a press is an
+ * anticipation, during the stimulus the first press is the response.
+ * Every press is logged with the trial; auto repeats are only counted.
+ */
+void StroopExperiment::onColorKey(Qt::GlobalColor color, bool autoRepeat)
+{
+   if (m_engine.phase() == StroopEngine::Phase::Idle) { return; }
+
+   if (autoRepeat)
+   {
+      m_engine.autoRepeat();
+      return;
+   }
+
+   const bool inWindow = (m_engine.phase() == StroopEngine::Phase::Stimulus);
+
+   m_engine.handlePress(color, m_engine.sinceFixation(),
+                        inWindow ? m_engine.sinceStimulus() : -1LL);
+}
+
+
+/**
+ * @brief StroopExperiment::createStroopTrials
+ * @return The 40 trial templates, indexed by the trial indices
+ * @todo Check which order is intended / best
+ */
+QVector<StroopTrial> StroopExperiment::createStroopTrials()
+{
+   QVector<StroopTrial> trials;
+
+   // Quads [0-3]
+   trials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Rot",  Qt::red));
+   trials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Grün", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Blau", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Gelb", Qt::yellow));
+
+   // Text matches the color [4-7]
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Rot",  Qt::red));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Grün", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Blau", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Gelb", Qt::yellow));
+
+   // Text and color are conflicted [8-19]
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::red));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::red));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::red));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::yellow));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::yellow));
+   trials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::yellow));
+
+   /* Other words [20-39] */
+   // https://www.n-joy.de/leben/11-deutsche-Woerter-die-ihr-garantiert-nicht-kennt,witzigewoerter100.html
+   // "Durcheinander, Gerümpel, wertloses Zeug":
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::red));   // 20
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::yellow));
+
+   // https://www.n-joy.de/leben/11-deutsche-Woerter-die-ihr-garantiert-nicht-kennt,witzigewoerter100.html
+   // "...beschreibt laut Duden ein "dünnes, gehaltloses, fades Getränk"":
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::red));   // 24
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::yellow));
+
+   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
+   // "klarer Sternenhimmel":
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::red));   // 28
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::yellow));
+
+   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
+   // "wundersam, erstaunlich"
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::red));   // 32
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::yellow));
+
+   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
+   // "seliger als selig, überaus beglückt:"
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::red));   // 36
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::green));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::blue));
+   trials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::yellow));
+
+   return trials;
+}
+
+
+/**
+ * @brief StroopExperiment::createTrialIndices
+ * @param seed Master seed of the run
+ * @param numTrials
+ * @param equallyDistributed See m_bIndexCreationMode: equal condition counts
+ *        if true, counts proportional to the trial templates otherwise
+ * @param generator SequenceGenerator the session was recorded with
+ * @return Indices into createStroopTrials()
+ *
+ * Deterministic: the same arguments always give the same sequence, which
+ * allows runs to be regenerated offline from the stored seed.
+ */
+QVector<int> StroopExperiment::createTrialIndices(quint64 seed, int numTrials,
+                                                  bool equallyDistributed, int generator)
+{
+   const TrialRandom random(seed);
+
+   if (generator == StreamedSequenceGenerator)
+   {
+      return createStreamedTrialIndices(seed, numTrials, equallyDistributed);
+   }
+
+   if (generator == BlockwiseSequenceGenerator)
+   {
+      return createBlockwiseTrialIndices(seed, numTrials, equallyDistributed);
+   }
+
+   if (generator == LegacySequenceGenerator)
+   {
+      if (equallyDistributed)
+      {
+         return createEquallyDistributedTrialIndices(random, numTrials);
+      }
+      else
+      {
+         return createFullyRandomTrialIndices(random, numTrials);
+      }
+   }
+
+   const TrialSequenceGenerator sequenceGenerator(createStroopTrials());
+   const QVector<int> counts = equallyDistributed
+                               ? TrialSequenceGenerator::equalCounts(numTrials)
+                               : sequenceGenerator.proportionalCounts(numTrials);
+
+   QVector<int> indices;
+   QString error;
+   if (sequenceGenerator.generate(random, counts, indices, &error))
+   {
+      Q_ASSERT(sequenceGenerator.validate(indices, counts).isEmpty());
+      return indices;
+   }
+
+   // Only degenerate counts end up here: drop the run length limit
+   std::cout << "Trial sequence: " << error.toStdString()
+             << " Retrying without run length limit." << std::endl;
+
+   SequenceConstraints relaxed;
+   relaxed.m_nMaxRunLength = 0;
+
+   TrialSequenceGenerator(createStroopTrials(), relaxed).generate(random, counts, indices);
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::createStreamedConditions
+ * @param seed Master seed of the run
+ * @param numTrials
+ * @param equallyDistributed See createTrialIndices()
+ * @return Condition of every trial of a streamed run
+ *
+ * Run lengths and transitions are those of the whole run, the items are
+ * assigned block by block, see createTrialIndexBlock().
+ */
+QVector<qint8> StroopExperiment::createStreamedConditions(quint64 seed, int numTrials,
+                                                          bool equallyDistributed)
+{
+   const TrialSequenceGenerator sequenceGenerator(createStroopTrials());
+   const QVector<int> counts = equallyDistributed
+                               ? TrialSequenceGenerator::equalCounts(numTrials)
+                               : sequenceGenerator.proportionalCounts(numTrials);
+
+   QVector<qint8> conditions;
+   QString error;
+   if (sequenceGenerator.generateConditions(TrialRandom(seed), counts, conditions, &error))
+   {
+      Q_ASSERT(sequenceGenerator.validateConditions(conditions, counts).isEmpty());
+      return conditions;
+   }
+
+   // Only degenerate counts end up here: drop the run length limit
+   std::cout << "Trial sequence: " << error.toStdString()
+             << " Retrying without run length limit." << std::endl;
+
+   SequenceConstraints relaxed;
+   relaxed.m_nMaxRunLength = 0;
+
+   TrialSequenceGenerator(createStroopTrials(), relaxed).generateConditions(TrialRandom(seed), counts,
+                                                                            conditions);
+   return conditions;
+}
+
+
+/**
+ * @brief StroopExperiment::createTrialIndexBlock
+ * @param seed Master seed of the run
+ * @param block Block of StreamBlockSize trials, starts at 0
+ * @param conditions See createStreamedConditions()
+ * @param previousIndex Last index of the block before, -1: none
+ * @param indices Result: indices of the block, the last block may be
+ *        shorter; the buffer is reused
+ *
+ * The items of every block are drawn with its own sub-stream of the
+ * master seed.
+ */
+void StroopExperiment::createTrialIndexBlock(quint64 seed, int block, const QVector<qint8>& conditions,
+                                             int previousIndex, QVector<int>& indices)
+{
+   // Built once, the templates are the same for all runs
+   static const TrialSequenceGenerator sequenceGenerator(createStroopTrials());
+
+   const int from = block * StreamBlockSize;
+   const int to = qMin(from + StreamBlockSize, conditions.count());
+
+   const quint64 blockSeed = TrialRandom(seed).deriveSeed(TrialRandom::SequenceBlockStream
+                                                          + static_cast<quint64>(block));
+
+   sequenceGenerator.generateItems(TrialRandom(blockSeed), conditions, from, to, previousIndex, indices);
+   Q_ASSERT(sequenceGenerator.validateItems(conditions, from, indices, previousIndex).isEmpty());
+}
+
+
+/**
+ * @brief StroopExperiment::createStreamedTrialIndices
+ * @param seed Master seed of the run
+ * @param numTrials
+ * @param equallyDistributed See createTrialIndices()
+ * @return All blocks of a streamed run, used to regenerate it offline
+ */
+QVector<int> StroopExperiment::createStreamedTrialIndices(quint64 seed, int numTrials,
+                                                          bool equallyDistributed)
+{
+   const QVector<qint8> conditions = createStreamedConditions(seed, numTrials, equallyDistributed);
+
+   QVector<int> indices;
+   QVector<int> blockIndices;
+   indices.reserve(numTrials);
+   blockIndices.reserve(StreamBlockSize);
+
+   for (int block=0; block*StreamBlockSize < conditions.count(); block++)
+   {
+      createTrialIndexBlock(seed, block, conditions, indices.isEmpty() ? -1 : indices.last(),
+                            blockIndices);
+      indices.append(blockIndices);
+   }
+
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::createBlockwiseTrialIndices
+ * @param seed Master seed of the run
+ * @param numTrials
+ * @param equallyDistributed See createTrialIndices()
+ * @return Streamed runs recorded with BlockwiseSequenceGenerator: every
+ *         block of StreamBlockSize trials was generated on its own
+ */
+QVector<int> StroopExperiment::createBlockwiseTrialIndices(quint64 seed, int numTrials,
+                                                           bool equallyDistributed)
+{
+   QVector<int> indices;
+   indices.reserve(numTrials);
+
+   for (int block=0; block*StreamBlockSize < numTrials; block++)
+   {
+      const int numBlockTrials = qMin(StreamBlockSize, numTrials - block * StreamBlockSize);
+      const quint64 blockSeed = TrialRandom(seed).deriveSeed(TrialRandom::SequenceBlockStream
+                                                             + static_cast<quint64>(block));
+
+      indices.append(createTrialIndices(blockSeed, numBlockTrials, equallyDistributed,
+                                        ConstrainedSequenceGenerator));
+   }
+
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::createBlockedTrialIndices
+ * @param seed Master seed of the run
+ * @param numTrials
+ * @param equallyDistributed See createTrialIndices()
+ * @param blockOrder Order of the condition blocks
+ * @return Indices into createStroopTrials()
+ */
+QVector<int> StroopExperiment::createBlockedTrialIndices(quint64 seed, int numTrials,
+                                                         bool equallyDistributed,
+                                                         const QVector<int>& blockOrder)
+{
+   const TrialSequenceGenerator sequenceGenerator(createStroopTrials());
+   const QVector<int> counts = equallyDistributed
+                               ? TrialSequenceGenerator::equalCounts(numTrials)
+                               : sequenceGenerator.proportionalCounts(numTrials);
+
+   QVector<int> indices;
+   sequenceGenerator.generateBlocked(TrialRandom(seed), counts, blockOrder, indices);
+
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::setNextSeed
+ * @param seed Master seed to be used for the next run instead of a fresh one
+ */
+void StroopExperiment::setNextSeed(quint64 seed)
+{
+   m_u64Seed = seed;
+   m_bSeedPreset = true;
+}
+
+
+/**
+ * @brief StroopExperiment::getLastSeed
+ * @return Master seed of the current or last run
+ */
+quint64 StroopExperiment::getLastSeed() const
+{
+   return m_u64Seed;
+}
+
+
+/**
+ * @brief StroopExperiment::setPlannedSequence
+ * @param entry Study plan entry of the loaded participant; an invalid entry
+ *        drops a previously set plan
+ *
+ * The planned sequence replaces the generation of the next run.
+ */
+void StroopExperiment::setPlannedSequence(const StudyPlanEntry& entry)
+{
+   if (entry.isValid())
+   {
+      m_qvecPlannedTrialIndices = entry.m_qvecTrialIndices;
+      m_qvecPlannedConditionOrder = entry.m_qvecConditionOrder;
+      m_bPlannedEquallyDistributed = entry.m_bEquallyDistributed;
+
+      setNextSeed(entry.m_u64Seed);
+   }
+   else
+   {
+      // The seed belonged to the dropped plan
+      if (hasPlannedSequence()) { m_bSeedPreset = false; }
+
+      m_qvecPlannedTrialIndices.clear();
+      m_qvecPlannedConditionOrder.clear();
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::hasPlannedSequence
+ * @return True if the next run uses a sequence of the study plan
+ */
+bool StroopExperiment::hasPlannedSequence() const
+{
+   return !m_qvecPlannedTrialIndices.isEmpty();
+}
+
+
+/**
+ * @brief StroopExperiment::setProtocol
+ * @param protocol Used from the next run on instead of the number of
+ *        trials and the fixed timing
+ */
+void StroopExperiment::setProtocol(const StroopProtocol& protocol)
+{
+   m_protocol = protocol;
+}
+
+
+/**
+ * @brief StroopExperiment::getProtocol
+ * @return
+ */
+const StroopProtocol& StroopExperiment::getProtocol() const
+{
+   return m_protocol;
+}
+
+
+/**
+ * @brief StroopExperiment::createRandomStroopTrialIndices
+ * @param random Seed service of the run
+ * @param numTrials
+ * @return
+ * This method produces numTrials indices in the [0, numStroopTrials-1] range
+ * using an uniform integer distribution. Basically, it's like throwing a dice
+ * with numStroopTrials sides numTrials times.
+ */
+QVector<int> StroopExperiment::createFullyRandomTrialIndices(const TrialRandom& random,
+                                                             int numTrials)
+{
+   const int numStroopTrials = createStroopTrials().count();
+   const int highestIndex = numStroopTrials-1;
+
+   // Sub-stream of the run's master seed. SplitMix64 also provides the
+   // bounded integers, so the sequence does not depend on the
+   // implementation of std::uniform_int_distribution.
+   SplitMix64 genEngine = random.stream(TrialRandom::FullyRandomStream);
+
+   QVector<int> indices;
+   indices.reserve(numTrials);
+
+   int lastIndex = 0;
+   for (int i=0; i<numTrials; ++i)
+   {
+      // Draw an int in [0, numStroopTrials-1] and add it to the indices vector.
+      int index = genEngine.uniformInt(0, highestIndex);
+
+      if (index == lastIndex)
+      {
+         if (index < highestIndex)
+         {
+            index++;
+         }
+         else
+         {
+            index = 0;
+         }
+      }
+
+      indices.append(index);
+   }
+
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::createBlockedStroopTrialIndices
+ *
+ * Creates blocks of random indices for each type of trial.
+ * The three types of trials or conditions are:
+ * case 1: neutral stimulus: colored quad
+ * case 2: no conflict, e.g. "green" written in green
+ * case 3: conflict, e.g. "green" written in red
+ *
+ * Each block and the final shuffle use their own sub-stream of the run's
+ * master seed.
+ */
+QVector<int> StroopExperiment::createEquallyDistributedTrialIndices(const TrialRandom& random,
+                                                                    int numTrials)
+{
+   QVector<int> indices;
+   indices.reserve(numTrials);
+
+   /* Make four blocks for the three conditions (types of trials) */
+   const int numConditions = 4;
+   const int runsPerBlock = numTrials / numConditions;
+   const int newTotalNumTrials = runsPerBlock * numConditions;
+   const int diffNumTrials = numTrials - newTotalNumTrials;
+
+   // Increase number of "more fun" experiments if not an equal amount of all three
+   // can be instanced to achieve the desired total number of trials (experiment runs).
+   int numTrialsCondition1 = runsPerBlock;
+   int numTrialsCondition2 = runsPerBlock;
+   int numTrialsCondition3 = runsPerBlock;
+   int numTrialsCondition4 = runsPerBlock;
+
+   switch (diffNumTrials)
+   {
+      case 1: { numTrialsCondition4++; break; }
+      case 2: { numTrialsCondition4++; numTrialsCondition3++; break; }
+      case 3: { numTrialsCondition4++; numTrialsCondition3++; numTrialsCondition2++; break; }
+      default: break;
+   }
+
+   // Beware! Knowledge about m_qvecStroopTrials and how it set up in
+   // createStroopTrials() is used in the following.
+   // The blockwise generation is hard-coded using the following index ranges:
+   // [0-3]-> quads, [4-7]-> no conflicts, [8-19]-> conflicts, [20-39] other words
+   {
+      SplitMix64 genEngine = random.stream(TrialRandom::BlockStream + 0); // [0-3]-> quads
+
+      int lastIndex = 0;
+      for (int i=0; i<numTrialsCondition1; ++i)
+      {
+         int index = genEngine.uniformInt(0, 3);
+
+         // Avoid doubling of consecutive indices.
+         if (index == lastIndex)
+         {
+            if (index < 3) { index++; }
+            else { index = 0; }
+         }
+
+         indices.append(index);
+         lastIndex = index;
+      }
+   }
+   {
+      SplitMix64 genEngine = random.stream(TrialRandom::BlockStream + 1); // [4-7]-> no conflicts
+
+      int lastIndex = 4;
+      for (int i=0; i<numTrialsCondition2; ++i)
+      {
+         int index = genEngine.uniformInt(4, 7);
+
+         // Avoid doubling of consecutive indices.
+         if (index == lastIndex)
+         {
+            if (index < 7) { index++; }
+            else { index = 4; }
+         }
+
+         indices.append(index);
+         lastIndex = index;
+      }
+   }
+   {
+      SplitMix64 genEngine = random.stream(TrialRandom::BlockStream + 2); // [8-19]-> conflicts
+
+      int lastIndex = 8;
+      for (int i=0; i<numTrialsCondition3; ++i)
+      {
+         int index = genEngine.uniformInt(8, 19);
+
+         // Avoid doubling of consecutive indices.
+         if (index == lastIndex)
+         {
+            if (index < 19) { index++; }
+            else { index = 8; }
+         }
+
+         indices.append(index);
+         lastIndex = index;
+      }
+   }
+   {
+      SplitMix64 genEngine = random.stream(TrialRandom::BlockStream + 3); // [20-39]-> other words
+
+      int lastIndex = 20;
+      for (int i=0; i<numTrialsCondition4; ++i)
+      {
+         int index = genEngine.uniformInt(20, 39);
+
+         // Avoid doubling of consecutive indices.
+         if (index == lastIndex)
+         {
+            if (index < 39) { index++; }
+            else { index = 20; }
+         }
+
+         indices.append(index);
+         lastIndex = index;
+      }
+   }
+
+   // Shuffle the vector of integers randomly
+   SplitMix64 rng = random.stream(TrialRandom::ShuffleStream);
+   rng.shuffle(indices);
+
+   return indices;
+}
+
+
+/**
+ * @brief StroopExperiment::getDataToSave
+ * @return
+ * @todo Proper handling of required conditions using exeptions.
+ */
+QMap<QString, QVariant> StroopExperiment::getDataToSave()
+{
+   return m_mapSerializedResults;
+}
+
+
+/**
+ * @brief StroopExperiment::serializeCurrentExperiment
+ */
+void StroopExperiment::serializeCurrentExperiment()
+{
+   if (m_nNumTrials > 0)
+   {
+      // The result map will get one more entry:
+      // the list of serialized results of all experiment screens of the last run.
+      // Streamed runs store only the date here, the trials are in the chunks.
+      QStringList allExpData;
+      QStringList misses;
+      QStringList trajectory;
+
+      // Add experiment date
+      allExpData.append(m_strLastExpTimeStamp);
+
+      if (m_bStreaming)
+      {
+         // The last chunk; the chunk file is read below
+         flushTrials(m_nNumTrials);
+      }
+      else
+      {
+         // Aborted during the practice: the practice trials so far
+         storePracticeTrials(m_nNumTrials);
+         trialsToStringLists(m_nNumPracticeTrials, m_nNumTrials, allExpData, misses, trajectory);
+      }
+
+      // Store serialized results
+      m_nDataSetCount++;
+      QVariant allExpDataVar(allExpData);
+      m_mapSerializedResults.insert(resultsKey(m_nDataSetCount), allExpDataVar);
+
+      // Everything needed to regenerate the trial sequence
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "seed"),
+                                    TrialRandom::seedToString(m_u64Seed));
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "numTrials"), m_nNumPlannedTrials);
+      if (m_runProtocol.isLoaded())
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "sequenceGenerator"),
+                                       int(ProtocolSequenceGenerator));
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "protocol"),
+                                       m_runProtocol.toStringList());
+      }
+      else if (m_qvecConditionOrder.isEmpty())
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "indexCreationMode"),
+                                       m_bIndexCreationMode ? "equal" : "random");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "sequenceGenerator"),
+                                       int(m_bStreaming ? StreamedSequenceGenerator
+                                                        : ConstrainedSequenceGenerator));
+         if (m_bStreaming)
+         {
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "streamBlockSize"),
+                                          StreamBlockSize);
+         }
+      }
+      else
+      {
+         QStringList order;
+         for (int cond : m_qvecConditionOrder) { order.append(QString::number(cond)); }
+
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "indexCreationMode"),
+                                       m_bPlannedEquallyDistributed ? "equal" : "random");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "sequenceGenerator"),
+                                       int(BlockedSequenceGenerator));
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "conditionOrder"),
+                                       order.join(","));
+      }
+
+      // Response deadlines: misses and, in adaptive mode, the staircase trajectory.
+      // Streamed runs stored them with each chunk.
+      if (m_bStreaming)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "numChunks"), m_nNumChunks);
+      }
+      else
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "misses"), misses);
+      }
+
+      if (m_bAdaptiveDeadline)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "deadlineMode"), "adaptive");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "targetAccuracy"),
+                                       m_staircase.getTargetAccuracy());
+         if (!m_bStreaming)
+         {
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "staircase"), trajectory);
+         }
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "deadlines"),
+                                       m_staircase.deadlinesToStringList());
+      }
+      else
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "deadlineMode"), "fixed");
+      }
+
+      // Event loop stalls: trials are flagged in their "Stall(ms)" field
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "stallThreshold"),
+                                    m_watchdog.getStallThreshold());
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "eventLoopStalls"),
+                                    m_watchdog.getNumStalls());
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "maxEventLoopLatency"),
+                                    QString::number(m_watchdog.getMaxLatency(), 'f', 1));
+      const StroopEngine::RunStatistics& stats = m_engine.statistics();
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "stalledTrials"), stats.m_nNumStalled);
+
+      // Counts and RT moments for session lists, see StroopSessionHistoryModel
+      StroopSessionSummary summary;
+      summary.m_nNumAnswered   = stats.m_nNumCorrect + stats.m_nNumWrong;
+      summary.m_nNumCorrect    = stats.m_nNumCorrect;
+      summary.m_nNumMisses     = stats.m_nNumMisses;
+      summary.m_nNumStalled    = stats.m_nNumStalled;
+      summary.m_dMeanRT        = stats.m_momentsAll.m_dMean;
+      summary.m_dStdDevRT      = stats.m_momentsAll.standardDeviation();
+      summary.m_dMeanCorrectRT = stats.m_momentsCorrect.m_dMean;
+      summary.m_bValid = true;
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "summary"), summary.toString());
+
+      // Presses during the fixation point and auto repeats, see onColorKey()
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "anticipations"), stats.m_nNumAnticipations);
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "autoRepeats"), stats.m_nNumAutoRepeats);
+
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "responseInput"),
+                                    m_upInputThread ? "evdev" : "qt");
+
+      // Protocol ("default" for runs without one) and the practice trials
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "protocolName"), m_runProtocol.getName());
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "protocolVersion"), m_runProtocol.getVersion());
+      m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "protocolHash"), m_runProtocol.getHash());
+      if (m_nNumPracticeTrials > 0)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "numPracticeTrials"), m_nNumPracticeTrials);
+         if (!m_bStreaming)
+         {
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "practice"), m_strlPracticeResults);
+         }
+      }
+
+      // Frame timing: intended and shown frames per trial, stored with each
+      // chunk of streamed runs
+      if (m_bFrameTiming)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "frameTiming"), "on");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "refreshInterval"),
+                                       QString::number(m_dRefreshInterval, 'f', 3));
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "frameSync"),
+                                       m_bFrameSynchronized ? "vsync" : "nominal");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "droppedFrames"), stats.m_nNumDroppedFrames);
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "frameErrorTrials"), stats.m_nNumFrameErrors);
+         if (!m_bStreaming)
+         {
+            QStringList frames;
+            framesToStringList(m_nNumPracticeTrials, m_nNumTrials, frames);
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "frames"), frames);
+         }
+      }
+
+      // Timing calibration of the station before this run (one record per run)
+      if (m_calibration.m_bValid)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "calibration"), m_calibration.toString());
+         if (!m_strlCalibrationProblems.isEmpty())
+         {
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "calibrationProblems"),
+                                          m_strlCalibrationProblems);
+         }
+         m_calibration = TimingCalibrationRecord();
+      }
+
+      // Multi-station session: which screen and keyboard the run was on
+      if (!m_strStation.isEmpty())
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "station"), m_strStation);
+      }
+
+      // Real-time mode: what was granted and the page faults during the run
+      if (m_bRealtimeMode)
+      {
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "realtimeMode"), "on");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "memoryLocked"),
+                                       m_realtimeReport.m_bMemoryLocked);
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "scheduling"),
+                                       m_realtimeReport.m_bFifoScheduling ? "SCHED_FIFO" : "SCHED_OTHER");
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "priority"),
+                                       m_realtimeReport.m_nPriority);
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "cpu"), m_realtimeReport.m_nCpu);
+         if (m_upInputThread)
+         {
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "inputScheduling"),
+                                          m_realtimeReport.m_bInputFifoScheduling ? "SCHED_FIFO" : "SCHED_OTHER");
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "inputPriority"),
+                                          m_realtimeReport.m_nInputPriority);
+            m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "inputCpu"),
+                                          m_realtimeReport.m_nInputCpu);
+         }
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "minorPageFaults"),
+                                       m_realtimeReport.m_i64MinorFaults);
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "majorPageFaults"),
+                                       m_realtimeReport.m_i64MajorFaults);
+         m_mapSerializedResults.insert(sessionKey(m_nDataSetCount, "realtimeProblems"),
+                                       m_realtimeReport.m_strlProblems);
+      }
+
+      if (m_bStreaming)
+      {
+         // The chunks are already merged into the lifetime aggregate. Model
+         // estimates of streamed runs are left to the study analysis (-a).
+         m_aggregate.endSession();
+
+         // The chunk file is read into the result map on the thread pool,
+         // so stopping does not depend on the length of the run; see
+         // onCompletionFinished()
+         if (m_chunkFile.isOpen())
+         {
+            m_chunkStream.setDevice(nullptr);
+            m_chunkFile.close();
+
+            const QString chunkFileName = m_chunkFile.fileName();
+
+            m_bCompleting = true;
+            m_completionWatcher.setFuture(QtConcurrent::run([chunkFileName]()
+            {
+               return readChunkFile(chunkFileName);
+            }));
+         }
+      }
+      else
+      {
+         // Model estimates per condition of this run (ex-Gaussian and
+         // EZ-diffusion), fitted on the thread pool, so the GUI thread keeps
+         // serving the other stations; see onCompletionFinished()
+         StroopSessionColumns session = StroopSessionColumns::fromSerialized(allExpData);
+         const int sessionNumber = m_nDataSetCount;
+
+         m_bCompleting = true;
+         m_completionWatcher.setFuture(QtConcurrent::run([session, sessionNumber]()
+         {
+            QMap<QString, QVariant> estimates;
+            StroopStatistics::estimateSession(session).insertInto(estimates, sessionNumber);
+            return estimates;
+         }));
+
+         // Lifetime aggregate: merge this run only
+         m_aggregate.addSession(session);
+      }
+
+      m_aggregate.insertInto(m_mapSerializedResults);
+   }
+   else if (m_chunkFile.isOpen())
+   {
+      // Stopped before the first trial, nothing was written
+      m_chunkStream.setDevice(nullptr);
+      m_chunkFile.close();
+      m_chunkFile.remove();
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::trialsToStringLists
+ * @param from First position of the run
+ * @param to Position after the last one
+ * @param results Appended: serialized valid trials
+ * @param misses Appended: trials without response
+ * @param trajectory Appended in adaptive mode: deadline and outcome per trial
+ */
+void StroopExperiment::trialsToStringLists(int from, int to, QStringList& results,
+                                           QStringList& misses, QStringList& trajectory) const
+{
+   m_engine.toStringLists(from, to, results, misses, m_bAdaptiveDeadline ? &trajectory : nullptr);
+}
+
+
+/**
+ * @brief StroopExperiment::framesToStringList
+ * @param from First position of the run
+ * @param to Position after the last one
+ * @param frames Appended: frame counts of the answered and missed trials
+ */
+void StroopExperiment::framesToStringList(int from, int to, QStringList& frames) const
+{
+   for (int i=from; i<to; i++)
+   {
+      const StroopTrial& trial = m_engine.trial(i);
+      if (!trial.m_bValid && !trial.m_bMissed) { continue; }
+
+      // Position & Fixation(frames) & Shown & Stimulus(frames) & Shown & Dropped & Flag (1: timing error)
+      frames.append(QString::number(i+1)
+                    + "&" + QString::number(trial.m_nFixationFrames)
+                    + "&" + QString::number(trial.m_nFixationFramesShown)
+                    + "&" + QString::number(trial.m_nStimulusFrames)
+                    + "&" + QString::number(trial.m_nStimulusFramesShown)
+                    + "&" + QString::number(trial.m_nDroppedFrames)
+                    + "&" + (trial.hasFrameErrors() ? "1" : "0"));
+   }
+}
+
+
+/**
+ * @brief StroopExperiment::resultsKey
+ * @param sessionNumber Starts at 1
+ * @return Key of the serialized trials of the given run
+ */
+QString StroopExperiment::resultsKey(int sessionNumber)
+{
+   return QString("StroopResults_%1").arg(sessionNumber);
+}
+
+
+/**
+ * @brief StroopExperiment::sessionKey
+ * @param sessionNumber Starts at 1
+ * @param field
+ * @return Key of additional data belonging to the given run
+ *
+ * Anything derived from or recorded alongside a run is stored in the
+ * group "StroopSession_N", so "StroopResults_N" keeps its original format.
+ */
+QString StroopExperiment::sessionKey(int sessionNumber, const QString& field)
+{
+   return QString("StroopSession_%1/%2").arg(sessionNumber).arg(field);
+}
+
+
+/**
+ * @brief StroopExperiment::chunkFilePath
+ * @param filePath Participant's file
+ * @param sessionNumber Starts at 1
+ * @return File the chunks of a streamed run are appended to while it is
+ *         recorded; it is merged into the participant's file at the end
+ *         of the run and only left behind if the program crashed
+ */
+QString StroopExperiment::chunkFilePath(const QString& filePath, int sessionNumber)
+{
+   return filePath + QString(".session%1.chunks").arg(sessionNumber);
+}
+
+
+/**
+ * @brief StroopExperiment::countSessions
+ * @param data
+ * @return Number of "StroopResults_N" entries
+ */
+int StroopExperiment::countSessions(const QMap<QString, QVariant>& data)
+{
+   int numSessions = 0;
+
+   QMap<QString, QVariant>::const_iterator it;
+   for (it = data.constBegin(); it != data.constEnd(); ++it)
+   {
+      if (it.key().startsWith("StroopResults_")) { numSessions++; }
+   }
+
+   return numSessions;
+}
+
+
+/**
+ * @brief StroopExperiment::sessionResults
+ * @param data
+ * @param sessionNumber Starts at 1
+ * @return "StroopResults_N" followed by the trials of all chunks of a
+ *         streamed run, i.e. the format of a run that was not streamed
+ */
+QStringList StroopExperiment::sessionResults(const QMap<QString, QVariant>& data,
+                                             int sessionNumber)
+{
+   QStringList results = data.value(resultsKey(sessionNumber)).toStringList();
+
+   const int numChunks = data.value(sessionKey(sessionNumber, "numChunks"), 0).toInt();
+   for (int k=0; k<numChunks; k++)
+   {
+      results.append(data.value(sessionKey(sessionNumber, QString("chunk_%1").arg(k))).toStringList());
+   }
+
+   return results;
+}
+
+
+/**
+ * @brief StroopExperiment::getEvalCorrectTrialsOnly
+ * @return
  */
-void StroopExperiment::activateEvalCorrectTrialsOnlyMode()
+bool StroopExperiment::getEvalCorrectTrialsOnly() const
 {
-   m_bEvalCorrectTrialsOnly = true;
+   return m_bEvalCorrectTrialsOnly;
 }
 
 
 /**
- * @brief JpegPerceptionExperiment::activateEvalAllTrialsMode
+ * @brief StroopExperiment::setAdaptiveDeadline
+ * @param adaptive True: the deadline of each condition follows a weighted
+ *        up/down staircase, false: fixed deadline of 2 s
  */
-void StroopExperiment::activateEvalAllTrialsMode()
+void StroopExperiment::setAdaptiveDeadline(bool adaptive)
 {
-   m_bEvalCorrectTrialsOnly = false;
+   m_bAdaptiveDeadline = adaptive;
 }
 
 
 /**
- * @brief StroopExperiment::getLastAssessmentStringList
+ * @brief StroopExperiment::getAdaptiveDeadline
  * @return
  */
-QStringList StroopExperiment::getLastStatsStringList() const
+bool StroopExperiment::getAdaptiveDeadline() const
 {
-   return m_strlLastStats;
+   return m_bAdaptiveDeadline;
 }
 
 
 /**
- * @brief StroopExperiment::onRedChosen
+ * @brief StroopExperiment::setTargetAccuracy
+ * @param targetAccuracy Accuracy the adaptive deadlines converge to
  */
-void StroopExperiment::onRedChosen()
+void StroopExperiment::setTargetAccuracy(double targetAccuracy)
 {
-   m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_nChosenColor = Qt::red;
-
-   storeTimeAndContinue();
+   m_staircase.setTargetAccuracy(targetAccuracy);
 }
 
 
 /**
- * @brief StroopExperiment::onGreenChosen
+ * @brief StroopExperiment::getTargetAccuracy
+ * @return
  */
-void StroopExperiment::onGreenChosen()
+double StroopExperiment::getTargetAccuracy() const
 {
-   m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_nChosenColor = Qt::green;
-
-   storeTimeAndContinue();
+   return m_staircase.getTargetAccuracy();
 }
 
 
 /**
- * @brief StroopExperiment::onBlueChosen
+ * @brief StroopExperiment::setRealtimeMode
+ * @param enabled True: the response deadline is timed and the evdev keys
+ *        are read on SCHED_FIFO threads and the memory is locked during
+ *        runs, as far as permitted
+ * @param cpu CPU to pin both threads to, -1: no pinning
  */
-void StroopExperiment::onBlueChosen()
+void StroopExperiment::setRealtimeMode(bool enabled, int cpu)
 {
-   m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_nChosenColor = Qt::blue;
+   if (m_bStarted) { return; }
+
+   m_bRealtimeMode = enabled;
+   m_nRealtimeCpu = enabled ? cpu : -1;
+
+   // Without real-time mode the deadline thread runs with normal priority
+   startDeadlineThread(enabled ? RealtimePriority : 0, m_nRealtimeCpu);
 
-   storeTimeAndContinue();
+   // The input thread applies its scheduling when it starts
+   if (m_upInputThread)
+   {
+      const QStringList sources = m_strlInputSources;
+      setKernelInput(sources, m_bInputExclusive);
+   }
 }
 
 
 /**
- * @brief StroopExperiment::onYellowChosen
+ * @brief StroopExperiment::getRealtimeMode
+ * @return
  */
-void StroopExperiment::onYellowChosen()
+bool StroopExperiment::getRealtimeMode() const
 {
-   m_qvecStroopTrials[m_qvecStroopTrialIndices.at(m_nProgress)].m_nChosenColor = Qt::yellow;
-
-   storeTimeAndContinue();
+   return m_bRealtimeMode;
 }
 
 
 /**
- * @brief StroopExperiment::createStroopTrials
- * @todo Check which order is intended / best
+ * @brief StroopExperiment::setKernelInput
+ * @param sources evdev devices and/or a recording, see EvdevInputThread;
+ *        empty: color keys are taken from the Qt key events again
+ * @param exclusive True: the devices are grabbed, so only this experiment gets their keys
+ * @return False if none of the sources could be opened (Qt key events are used)
  */
-void StroopExperiment::createStroopTrials()
+bool StroopExperiment::setKernelInput(const QStringList& sources, bool exclusive)
 {
-   // Quads [0-3]
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Rot",  Qt::red));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Grün", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Blau", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredQuads, "Gelb", Qt::yellow));
+   if (m_bStarted) { return false; }
 
-   // Text matches the color [4-7]
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Rot",  Qt::red));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Grün", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Blau", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextMatched, "Gelb", Qt::yellow));
+   m_upInputThread.reset();
+   m_strlInputSources.clear();
+   if (sources.isEmpty()) { return true; }
 
-   // Text and color are conflicted [8-19]
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::red));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::red));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::red));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Gelb", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Rot",  Qt::yellow));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Grün", Qt::yellow));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColorTextConflicted, "Blau", Qt::yellow));
+   std::unique_ptr<EvdevInputThread> upInputThread = std::make_unique<EvdevInputThread>();
+   if (m_bRealtimeMode) { upInputThread->setRealtime(RealtimePriority, m_nRealtimeCpu); }
 
-   /* Other words [20-39] */
-   // https://www.n-joy.de/leben/11-deutsche-Woerter-die-ihr-garantiert-nicht-kennt,witzigewoerter100.html
-   // "Durcheinander, Gerümpel, wertloses Zeug":
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::red));   // 20
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Schurrmurr", Qt::yellow));
+   QStringList problems;
+   const bool opened = upInputThread->open(sources, problems, exclusive);
 
-   // https://www.n-joy.de/leben/11-deutsche-Woerter-die-ihr-garantiert-nicht-kennt,witzigewoerter100.html
-   // "...beschreibt laut Duden ein "dünnes, gehaltloses, fades Getränk"":
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::red));   // 24
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Plempe", Qt::yellow));
+   for (const QString& problem : problems)
+   {
+      std::cout << "evdev input: " << problem.toStdString() << std::endl;
+   }
 
-   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
-   // "klarer Sternenhimmel":
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::red));   // 28
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "Glanzgefunkel", Qt::yellow));
+   if (!opened) { return false; }
 
-   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
-   // "wundersam, erstaunlich"
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::red));   // 32
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "putzwunderlich", Qt::yellow));
+   m_upInputThread = std::move(upInputThread);
+   m_strlInputSources = sources;
+   m_bInputExclusive = exclusive;
 
-   // https://sternenvogelreisen.de/selten-schoene-woerter-der-deutschen-sprache/
-   // "seliger als selig, überaus beglückt:"
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::red));   // 36
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::green));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::blue));
-   m_qvecStroopTrials.append(StroopTrial(StroopTrialModes::ColoredTextUnreferenced, "überselig", Qt::yellow));
+   connect(m_upInputThread.get(), &EvdevInputThread::responsesAvailable,
+           this, &StroopExperiment::onKernelResponses, Qt::QueuedConnection);
+
+   m_upInputThread->start();
+   return true;
 }
 
 
 /**
- * @brief StroopExperiment::createRandomStroopTrialIndices
- * @see https://en.cppreference.com/w/cpp/numeric/random/uniform_int_distribution
- * This method produces m_nNumTrials indices in the [0, numStroopTrials-1] range
- * using an uniform integer distribution. Basically, it's like throwing a dice
- * with numStroopTrials sides m_nNumTrials times.
+ * @brief StroopExperiment::getKernelInput
+ * @return True if the color keys are read from evdev
  */
-void StroopExperiment::createFullyRandomTrialIndices()
+bool StroopExperiment::getKernelInput() const
 {
-   const int numStroopTrials = m_qvecStroopTrials.count();
-   const int highestIndex = numStroopTrials-1;
-
-   // Provides the seed for the pseudo random number generator (PRNG)
-   // (1) https://en.cppreference.com/w/cpp/numeric/random/random_device
-   std::random_device randDevice;
+   return static_cast<bool>(m_upInputThread);
+}
 
-   // "The performance of many implementations of random_device degrades sharply
-   // once the entropy pool is exhausted. For practical use random_device is
-   // generally only used to seed a PRNG such as mt19937." (1)
 
-   // Standard "Mersenne Twister" PRNG engine seeded by randDevice whose
-   // "operator() [...] advances the engine's state and returns the generated value". (1)
-   std::mt19937 genEngine(randDevice());
+/**
+ * @brief StroopExperiment::setFrameTiming
+ * @param enabled True: fixation point, ISI, breaks and stimuli last whole
+ *        frames and change on the swaps of the experiment dialog (see
+ *        FramePresenter), which measures the refresh interval when shown
+ */
+void StroopExperiment::setFrameTiming(bool enabled)
+{
+   if (m_bStarted) { return; }
 
-   // (2) https://de.wikipedia.org/wiki/Mersenne-Twister
-   // The Mersenne Twister PRNG features an extremely low correlation between
-   // successive series of values in the output sequence. (2)
-   // It is also very fast and often used in non-security related applications.
+   m_bFrameTiming = enabled;
+}
 
-   // "Produces random integer values i, uniformly distributed on the closed interval [a,b]..."
-   // https://en.cppreference.com/w/cpp/numeric/random/uniform_int_distribution
-   std::uniform_int_distribution<> dist(0, numStroopTrials-1);
 
-   // Delete old indices
-   m_qvecStroopTrialIndices.clear();
+/**
+ * @brief StroopExperiment::getFrameTiming
+ * @return
+ */
+bool StroopExperiment::getFrameTiming() const
+{
+   return m_bFrameTiming;
+}
 
-   int lastIndex = 0;
-   for (int i=0; i<m_nNumTrials; ++i)
-   {
-      // Use the distribution object "dist" to transform the random unsigned int
-      // generated by "genEngine" into an int in [0, numStroopTrials-1] and
-      // add it to the indices vector.
-      int index = dist(genEngine);
 
-      if (index == lastIndex)
-      {
-         if (index < highestIndex)
-         {
-            index++;
-         }
-         else
-         {
-            index = 0;
-         }
-      }
+/**
+ * @brief StroopExperiment::setRefreshInterval
+ * @param intervalMs Measured refresh interval of the display
+ * @param synchronized False if the swaps are not synchronized to the
+ *        display and intervalMs is its nominal refresh interval
+ */
+void StroopExperiment::setRefreshInterval(double intervalMs, bool synchronized)
+{
+   if (m_bStarted || intervalMs <= 0.0) { return; }
 
-      m_qvecStroopTrialIndices.append(index);
-   }
+   m_dRefreshInterval = intervalMs;
+   m_bFrameSynchronized = synchronized;
+}
 
-   // Shuffle the vector of integers randomly
-   //std::random_shuffle(m_qvecStroopTrialIndices.begin(), m_qvecStroopTrialIndices.end());
 
-   //qDebug() << __FUNCTION__ << m_qvecStroopTrialIndices;
+/**
+ * @brief StroopExperiment::getRefreshInterval
+ * @return ms
+ */
+double StroopExperiment::getRefreshInterval() const
+{
+   return m_dRefreshInterval;
 }
 
 
 /**
- * @brief StroopExperiment::createBlockedStroopTrialIndices
- *
- * Creates blocks of random indices for each type of trial.
- * The three types of trials or conditions are:
- * case 1: neutral stimulus: colored quad
- * case 2: no conflict, e.g. "green" written in green
- * case 3: conflict, e.g. "green" written in red
+ * @brief StroopExperiment::setCalibration
+ * @param record Timing calibration before the next run, stored with it
  *
- * @see https://en.cppreference.com/w/cpp/numeric/random
+ * Values beyond the thresholds are printed and reported by
+ * calibrationChecked(); the run is not prevented.
  */
-void StroopExperiment::createEquallyDistributedTrialIndices()
+void StroopExperiment::setCalibration(const TimingCalibrationRecord& record)
 {
-   // Delete old indices
-   m_qvecStroopTrialIndices.clear();
-
-   /* Make four blocks for the three conditions (types of trials) */
-   const int numConditions = 4;
-   const int runsPerBlock = m_nNumTrials / numConditions;
-   const int newTotalNumTrials = runsPerBlock * numConditions;
-   const int diffNumTrials = m_nNumTrials - newTotalNumTrials;
-
-   // Increase number of "more fun" experiments if not an equal amount of all three
-   // can be instanced to achieve the desired total number of trials (experiment runs).
-   int numTrialsCondition1 = runsPerBlock;
-   int numTrialsCondition2 = runsPerBlock;
-   int numTrialsCondition3 = runsPerBlock;
-   int numTrialsCondition4 = runsPerBlock;
-
-   switch (diffNumTrials)
-   {
-      case 1: { numTrialsCondition4++; break; }
-      case 2: { numTrialsCondition4++; numTrialsCondition3++; break; }
-      case 3: { numTrialsCondition4++; numTrialsCondition3++; numTrialsCondition2++; break; }
-      default: break;
-   }
-
-   // Beware! Knowledge about m_qvecStroopTrials and how it set up in
-   // createStroopTrials() is used in the following.
-   // The blockwise generation is hard-coded using the following index ranges:
-   // [0-3]-> quads, [4-7]-> no conflicts, [8-19]-> conflicts, [20-39] other words
-   {
-      // https://en.cppreference.com/w/cpp/numeric/random/uniform_int_distribution
-      std::random_device randDevice;
-      std::mt19937 genEngine(randDevice());
-      std::uniform_int_distribution<> dist(0, 3); // [0-3]-> quads
-
-      int lastIndex = 0;
-      for (int i=0; i<numTrialsCondition1; ++i)
-      {
-         int index = dist(genEngine);
-
-         // Avoid doubling of consecutive indices.
-         if (index == lastIndex)
-         {
-            if (index < 3) { index++; }
-            else { index = 0; }
-         }
+   if (m_bStarted) { return; }
 
-         m_qvecStroopTrialIndices.append(index);
-         lastIndex = index;
-      }
-   }
-   {
-      std::random_device randDevice;
-      std::mt19937 genEngine(randDevice());
-      std::uniform_int_distribution<> dist(4, 7); // [4-7]-> no conflicts
-
-      int lastIndex = 4;
-      for (int i=0; i<numTrialsCondition2; ++i)
-      {
-         int index = dist(genEngine);
+   m_calibration = record;
+   m_strlCalibrationProblems = record.m_bValid ? record.check(m_calibrationThresholds) : QStringList();
 
-         // Avoid doubling of consecutive indices.
-         if (index == lastIndex)
-         {
-            if (index < 7) { index++; }
-            else { index = 4; }
-         }
-
-         m_qvecStroopTrialIndices.append(index);
-         lastIndex = index;
-      }
-   }
+   const QStringList& problems = m_strlCalibrationProblems;
+   for (const QString& problem : problems)
    {
-      std::random_device randDevice;
-      std::mt19937 genEngine(randDevice());
-      std::uniform_int_distribution<> dist(8, 19); // [8-19]-> conflicts
-
-      int lastIndex = 8;
-      for (int i=0; i<numTrialsCondition3; ++i)
-      {
-         int index = dist(genEngine);
-
-         // Avoid doubling of consecutive indices.
-         if (index == lastIndex)
-         {
-            if (index < 19) { index++; }
-            else { index = 8; }
-         }
-
-         m_qvecStroopTrialIndices.append(index);
-         lastIndex = index;
-      }
+      std::cout << "Timing calibration: " << problem.toStdString() << std::endl;
    }
-   {
-      std::random_device randDevice;
-      std::mt19937 genEngine(randDevice());
-      std::uniform_int_distribution<> dist(20, 39); // [20-39]-> other words
-
-      int lastIndex = 20;
-      for (int i=0; i<numTrialsCondition4; ++i)
-      {
-         int index = dist(genEngine);
 
-         // Avoid doubling of consecutive indices.
-         if (index == lastIndex)
-         {
-            if (index < 39) { index++; }
-            else { index = 20; }
-         }
+   emit calibrationChecked(m_strlCalibrationProblems);
+}
 
-         m_qvecStroopTrialIndices.append(index);
-         lastIndex = index;
-      }
-   }
 
-   // Shuffle the vector of integers randomly
-   std::mt19937 rng(std::time(nullptr));
-   std::shuffle(m_qvecStroopTrialIndices.begin(), m_qvecStroopTrialIndices.end(), rng);
+/**
+ * @brief StroopExperiment::setCalibrationThresholds
+ * @param thresholds Limits of the calibration before each run
+ */
+void StroopExperiment::setCalibrationThresholds(const TimingThresholds& thresholds)
+{
+   m_calibrationThresholds = thresholds;
 }
 
 
 /**
- * @brief StroopExperiment::getDataToSave
+ * @brief StroopExperiment::getCalibrationThresholds
  * @return
- * @todo Proper handling of required conditions using exeptions.
  */
-QMap<QString, QVariant> StroopExperiment::getDataToSave()
+const TimingThresholds& StroopExperiment::getCalibrationThresholds() const
 {
-   return m_mapSerializedResults;
+   return m_calibrationThresholds;
 }
 
 
 /**
- * @brief StroopExperiment::serializeCurrentExperiment
+ * @brief StroopExperiment::setStation
+ * @param station Name, screen and input of the station the runs are shown
+ *        on, stored with each session; empty outside multi-station sessions
  */
-void StroopExperiment::serializeCurrentExperiment()
+void StroopExperiment::setStation(const QString& station)
 {
-   const bool german = true;
-   const int numUsedTrials  = m_qvecStroopTrialIndices.count();
-
-   if (numUsedTrials > 0)
-   {
-      Q_ASSERT(m_nNumTrials == numUsedTrials);
-
-      // The result map will get one more entry:
-      // the list of serialized results of all experiment screens of the last run.
-      QStringList allExpData;
-
-      // Add experiment date
-      allExpData.append(m_strLastExpTimeStamp);
-
-      for (int i=0; i<m_nNumTrials; i++)
-      {
-         const StroopTrial& trial = m_qvecStroopTrials.at(m_qvecStroopTrialIndices.at(i));
-
-         if (!trial.m_bValid) { continue; }
-
-         allExpData.append(trial.toString(false, german));
-      }
-
-      // Store serialized results
-      m_nDataSetCount++;
-      QVariant allExpDataVar(allExpData);
-      m_mapSerializedResults.insert(QString("StroopResults_%1").arg(m_nDataSetCount), allExpDataVar);
-   }
+   m_strStation = station;
 }
 
 
 /**
- * @brief StroopExperiment::getEvalCorrectTrialsOnly
+ * @brief StroopExperiment::getStation
  * @return
  */
-bool StroopExperiment::getEvalCorrectTrialsOnly() const
+const QString& StroopExperiment::getStation() const
 {
-   return m_bEvalCorrectTrialsOnly;
+   return m_strStation;
 }
 
 
@@ -854,12 +2617,14 @@ bool StroopExperiment::getEvalCorrectTrialsOnly() const
  * @brief StroopExperiment::exportLastRunToCSV
  */
 QVector<QStringList> StroopExperiment::exportLastRunToCSV(const QStringList& headers,
-                                                          bool includeStats=false) const
+                                                          bool includeStats=false)
 {
+   completeLastRun();
+
    const bool german = true;
    QVector<QStringList> dataToExport;
 
-   int numPlannedTrials = m_qvecStroopTrialIndices.count();
+   const int numPlannedTrials = m_nNumTrials;
 
    if (includeStats)
    {
@@ -879,17 +2644,23 @@ QVector<QStringList> StroopExperiment::exportLastRunToCSV(const QStringList& hea
 
 
    QVector<QStringList> allExpData;
-   int numUsedTrials = 0;
-   if (numPlannedTrials > 0)
+   if (m_bStreaming && m_nDataSetCount > 0)
    {
-      Q_ASSERT(m_nNumTrials == numPlannedTrials);
+      // Most trials of a streamed run are only in the chunks
+      const QStringList stored = sessionResults(m_mapSerializedResults, m_nDataSetCount);
 
-      for (int i=0; i<m_nNumTrials; i++)
+      for (int idx=1; idx<stored.count(); idx++)
+      {
+         allExpData.append(stored.at(idx).split("&"));
+      }
+   }
+   else if (numPlannedTrials > 0)
+   {
+      for (int i=m_nNumPracticeTrials; i<m_nNumTrials; i++)
       {
-         const StroopTrial& trial = m_qvecStroopTrials.at(m_qvecStroopTrialIndices.at(i));
+         const StroopTrial& trial = m_engine.trial(i);
 
-         if (trial.m_bValid) { numUsedTrials++; }
-         else { continue; }
+         if (!trial.m_bValid) { continue; }
 
          allExpData.append(trial.toStringList(false, german));
       }
@@ -911,6 +2682,8 @@ QVector<QStringList> StroopExperiment::exportLastRunToCSV(const QStringList& hea
 bool StroopExperiment::exportAllExperimentsToCSV(const QString& filename,
                                                  QStringList headers)
 {
+   completeLastRun();
+
    // Each QStringList is a row
    QVector<QStringList> dataToExport;
 
@@ -922,7 +2695,8 @@ bool StroopExperiment::exportAllExperimentsToCSV(const QString& filename,
    // Serialize all stored experiments including the current one
    for (int i=1; i<=m_nDataSetCount; i++)
    {
-      const QStringList& allExpData = m_mapSerializedResults.value(QString("StroopResults_%1").arg(i)).toStringList();
+      const QStringList allExpData = sessionResults(m_mapSerializedResults, i);
+      if (allExpData.isEmpty()) { continue; }
 
       QString dateTime;
       int nextIdx = 1;
@@ -962,30 +2736,72 @@ bool StroopExperiment::exportAllExperimentsToCSV(const QString& filename,
 
 
 /**
- * @brief StroopExperiment::currentExperimentSetToString
- * @param german
+ * @brief StroopExperiment::currentExperimentTrials
+ * @return The answered trials of the current/last run, for
+ *         StroopTrialTableModel
+ */
+QVector<StroopTrial> StroopExperiment::currentExperimentTrials() const
+{
+   // Streamed runs: only the trials still held in the ring
+   const int numShownTrials = qMin(m_engine.progress(), m_nNumTrials);
+   const int first = m_bStreaming ? qMax(0, numShownTrials - StreamRingCapacity) : 0;
+
+   QVector<StroopTrial> trials;
+   trials.reserve(qMax(0, numShownTrials - first));
+
+   for (int i=first; i<numShownTrials; i++)
+   {
+      const StroopTrial& trial = m_engine.trial(i);
+
+      if (trial.m_bValid) { trials.append(trial); }
+   }
+
+   return trials;
+}
+
+
+/**
+ * @brief StroopExperiment::exportReEvaluationToCSV
+ * @param filename
+ * @param policies Filters applied side by side to every stored run
  * @return
+ *
+ * Evaluates all runs of the loaded participant again, independent of the
+ * evaluation mode that was active when they were recorded.
  */
-QVector<QStringList> StroopExperiment::currentExperimentSetToString(bool german) const
+bool StroopExperiment::exportReEvaluationToCSV(const QString& filename,
+                                               const QVector<StroopFilterPolicy>& policies)
 {
-   int numUsedTrials  = m_qvecStroopTrialIndices.count();
+   completeLastRun();
 
-   QVector<QStringList> allExpData;
-   if (numUsedTrials > 0)
+   QVector<StroopSessionColumns> sessions;
+   for (int i=1; i<=m_nDataSetCount; i++)
    {
-      Q_ASSERT(m_nNumTrials == numUsedTrials);
+      const QStringList allExpData = sessionResults(m_mapSerializedResults, i);
+      sessions.append(StroopSessionColumns::fromSerialized(allExpData));
+   }
 
-      for (int i=0; i<m_nNumTrials; i++)
-      {
-         const StroopTrial& trial = m_qvecStroopTrials.at(m_qvecStroopTrialIndices.at(i));
+   const QVector<QVector<StroopFilteredSummary>> summaries =
+         StroopReEvaluation::evaluateSessions(sessions, policies);
 
-         if (!trial.m_bValid) { continue; }
+   QVector<QStringList> dataToExport;
+   dataToExport.append(StroopReEvaluation::csvHeaders(policies));
 
-         allExpData.append(trial.toStringList(false, german));
-      }
+   for (int i=0; i<sessions.count(); i++)
+   {
+      dataToExport.append(StroopReEvaluation::csvRows(m_strPersonID, QString::number(i+1),
+                                                      sessions.at(i).m_strTimeStamp,
+                                                      summaries.at(i)));
    }
 
-   return allExpData;
+   if (std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock())
+   {
+      return spDataRW->writeCSV(filename, dataToExport);
+   }
+   else
+   {
+      return false;
+   }
 }
 
 
@@ -995,8 +2811,28 @@ QVector<QStringList> StroopExperiment::currentExperimentSetToString(bool german)
  */
 void StroopExperiment::setLoadedData(const QMap<QString, QVariant>& data)
 {
+   // The last run is completed (and saved) with the data it belongs to
+   completeLastRun();
+
    m_mapSerializedResults = data;
-   m_nDataSetCount = data.count();
+   m_nDataSetCount = countSessions(data);
+
+   // Reuse the stored lifetime aggregate unless it does not match the runs
+   m_aggregate = StroopParticipantAggregate::fromStore(data);
+
+   if (!m_aggregate.isValid()
+       || m_aggregate.getNumSessions() != m_nDataSetCount
+       || m_aggregate.getEvalCorrectTrialsOnly() != m_bEvalCorrectTrialsOnly)
+   {
+      rebuildAggregate();
+   }
+
+   // Continue the deadline staircases of the participant's last adaptive run
+   const QStringList deadlines = data.value(sessionKey(m_nDataSetCount, "deadlines")).toStringList();
+   if (!m_staircase.deadlinesFromStringList(deadlines))
+   {
+      m_staircase.reset();
+   }
 
    // QStringList allExpData = data.value("StroopResults").toStringList();
    // QStringList newestExpData = data.last().toStringList();
@@ -11,10 +11,27 @@
 #pragma once
 
 #include "Experiment.h"
-#include <QTimer>
+#include "AllocationGuard.h"
+#include "StroopAggregates.h"
+#include "StroopStaircase.h"
+#include "RealtimeSupport.h"
+#include "EventLoopWatchdog.h"
+#include "EvdevInput.h"
+#include "TrialEngine.h"
+#include "StroopProtocol.h"
+#include "TimingCalibration.h"
 #include <QColor>
+#include <QDataStream>
+#include <QFile>
+#include <QFutureWatcher>
 #include <QVector>
-#include <QElapsedTimer>
+
+#include <array>
+
+// Forward declarations
+struct StroopFilterPolicy;
+struct StudyPlanEntry;
+class TrialRandom;
 
 
 // Scoped enumeration (hence the "struct" keyword) of default type int
@@ -22,14 +39,29 @@
 enum struct StroopTrialModes { ColoredQuads, ColoredTextMatched,
                                ColorTextConflicted, ColoredTextUnreferenced };
 
+// Number of conditions defined by StroopTrialModes
+constexpr int NumStroopConditions = 4;
+
 
 struct StroopTrial
 {
+   // Presses logged per trial; further presses are only counted
+   static constexpr int MaxLoggedPresses = 8;
+
    StroopTrial();
    StroopTrial(StroopTrialModes mode, const QString& text, Qt::GlobalColor color);
 
+   void logPress(Qt::GlobalColor color, qint64 sinceFixation);
+   void resetPresses();
+   QString pressesToString(bool german) const;
+   bool hasFrameErrors() const;
+
    QStringList toStringList(bool includeValidState, bool german) const;
    QString toString(bool includeValidState, bool german) const;
+   static StroopTrial fromStringList(const QStringList& values);
+
+   static QString modeToString(StroopTrialModes mode);
+   static StroopTrialModes modeFromString(const QString& modeStr);
 
    bool m_bValid;
 
@@ -40,9 +72,105 @@ struct StroopTrial
    Qt::GlobalColor m_nChosenColor;
    qint64          m_i64DecisionTime;
    bool            m_bCorrect;
+   bool            m_bMissed;   // No response within the deadline
+   int             m_nDeadline; // Response window in ms
+   int             m_nStall;    // Longest event loop stall from onset to response in ms
+
+   // All color presses from the fixation point to the response
+   int m_nOnset;          // Stimulus onset in ms after the fixation onset
+   int m_nAnticipations;  // Presses during the fixation point
+   int m_nAutoRepeats;    // Presses generated by holding a key, not logged
+   int m_nNumPresses;
+   std::array<Qt::GlobalColor, MaxLoggedPresses> m_arrPressColors;
+   std::array<int, MaxLoggedPresses>             m_arrPressTimes; // ms after the fixation onset
+
+   // Frame timing only: whole frames intended and shown, refreshes missed
+   int m_nFixationFrames;
+   int m_nFixationFramesShown;
+   int m_nStimulusFrames;      // Response window
+   int m_nStimulusFramesShown; // Until the response or the deadline
+   int m_nDroppedFrames;       // From the fixation onset to the end of the trial
 };
 
 
+/**
+ * @brief The StroopParadigm struct
+ * Policy of TrialEngine: the stimulus is a color (as quad or word), the
+ * response one of the four color keys, correct if it names the color.
+ */
+struct StroopParadigm
+{
+   using Trial     = StroopTrial;
+   using Response  = Qt::GlobalColor;
+   using Condition = StroopTrialModes;
+   using TimelineEvent = StroopTimelineEvent;
+
+   static constexpr int NumConditions = NumStroopConditions;
+   static constexpr std::array<Qt::GlobalColor, 4> Responses = { Qt::red, Qt::green,
+                                                                 Qt::blue, Qt::yellow };
+
+   static Condition condition(const Trial& trial) { return trial.m_nMode; }
+   static QString conditionToString(Condition condition) { return StroopTrial::modeToString(condition); }
+
+   static void setResponse(Trial& trial, Response response) { trial.m_nChosenColor = response; }
+
+   // Outcome: correct if the response names the color
+   static void setAnswered(Trial& trial, qint64 decisionTime, int stall)
+   {
+      trial.m_i64DecisionTime = decisionTime;
+      trial.m_nStall = stall;
+      trial.m_bValid = true;
+      trial.m_bCorrect = (trial.m_nColor == trial.m_nChosenColor);
+   }
+   static void setMissed(Trial& trial, int stall)
+   {
+      trial.m_bMissed = true;
+      trial.m_i64DecisionTime = trial.m_nDeadline;
+      trial.m_nStall = stall;
+   }
+   static bool isValid(const Trial& trial) { return trial.m_bValid; }
+   static bool isCorrect(const Trial& trial) { return trial.m_bCorrect; }
+   static bool isMissed(const Trial& trial) { return trial.m_bMissed; }
+   static qint64 decisionTime(const Trial& trial) { return trial.m_i64DecisionTime; }
+   static int stall(const Trial& trial) { return trial.m_nStall; }
+
+   static int deadline(const Trial& trial) { return trial.m_nDeadline; }
+   static void setDeadline(Trial& trial, int deadline) { trial.m_nDeadline = deadline; }
+   static void setOnset(Trial& trial, int onset) { trial.m_nOnset = onset; }
+
+   // Press log
+   static void logPress(Trial& trial, Response response, qint64 sinceFixation) { trial.logPress(response, sinceFixation); }
+   static void resetPresses(Trial& trial) { trial.resetPresses(); }
+   static void countAnticipation(Trial& trial) { trial.m_nAnticipations++; }
+   static void countAutoRepeat(Trial& trial) { trial.m_nAutoRepeats++; }
+   static int anticipations(const Trial& trial) { return trial.m_nAnticipations; }
+   static int autoRepeats(const Trial& trial) { return trial.m_nAutoRepeats; }
+
+   // Frame timing
+   static void setFixationFrames(Trial& trial, int frames) { trial.m_nFixationFrames = frames; }
+   static int fixationFrames(const Trial& trial) { return trial.m_nFixationFrames; }
+   static void setFixationFramesShown(Trial& trial, int frames) { trial.m_nFixationFramesShown = frames; }
+   static void setStimulusFrames(Trial& trial, int frames) { trial.m_nStimulusFrames = frames; }
+   static int stimulusFrames(const Trial& trial) { return trial.m_nStimulusFrames; }
+   static void setStimulusFramesShown(Trial& trial, int frames) { trial.m_nStimulusFramesShown = frames; }
+   static void addDroppedFrames(Trial& trial, int frames) { trial.m_nDroppedFrames += frames; }
+   static bool hasFrameErrors(const Trial& trial) { return trial.hasFrameErrors(); }
+
+   // Timeline of the run, see StroopProtocol::compile()
+   static int pause(const TimelineEvent& event) { return event.m_nPause; }
+   static int fixation(const TimelineEvent& event) { return event.m_nFixation; }
+   static int deadline(const TimelineEvent& event) { return event.m_nDeadline; }
+   static bool isBreak(const TimelineEvent& event) { return event.m_nFlags & StroopTimelineEvent::BreakBefore; }
+   static bool isPractice(const TimelineEvent& event) { return event.m_nFlags & StroopTimelineEvent::Practice; }
+
+   static QString resultToString(const Trial& trial) { return trial.toString(false, true); }
+   static QString stimulusToString(const Trial& trial);
+};
+
+class StroopExperiment;
+using StroopEngine = TrialEngine<StroopParadigm, StroopExperiment>;
+
+
 /**
  * @brief The StroopExperiment class
  */
@@ -51,6 +179,26 @@ class StroopExperiment : public Experiment
       Q_OBJECT
 
    public:
+      enum SequenceGenerator
+      {
+         LegacySequenceGenerator      = 1, // Dice/block generator, kept for old sessions
+         ConstrainedSequenceGenerator = 2, // TrialSequenceGenerator
+         BlockedSequenceGenerator     = 3, // Condition blocks in a planned order (StudyPlan)
+         BlockwiseSequenceGenerator   = 4, // Independent blocks of StreamBlockSize, kept for old sessions
+         ProtocolSequenceGenerator    = 5, // TrialSequenceGenerator per protocol block (StroopProtocol)
+         StreamedSequenceGenerator    = 6  // Conditions of the whole run, items per block of StreamBlockSize
+      };
+
+      // Runs longer than StreamingThreshold keep only a ring of trials in
+      // memory and append completed trials to a chunk file, see flushTrials().
+      static constexpr int StreamingThreshold = 1000;
+      static constexpr int StreamChunkSize    = 128;
+      static constexpr int StreamRingCapacity = 2 * StreamChunkSize;
+      static constexpr int StreamBlockSize    = 256;
+
+      // SCHED_FIFO priority of the deadline thread in real-time mode
+      static constexpr int RealtimePriority = 80;
+
       StroopExperiment(int globalIndex, int numTrials, std::weak_ptr<DataReaderWriter> wpDataRW, QObject* parent = nullptr);
 
       virtual void start();
@@ -62,13 +210,15 @@ class StroopExperiment : public Experiment
       void onGreenChosen();
       void onBlueChosen();
       void onYellowChosen();
+      void onColorKey(Qt::GlobalColor color, bool autoRepeat);
 
-      QVector<QStringList> currentExperimentSetToString(bool german=false) const;
+      QVector<StroopTrial> currentExperimentTrials() const;
 
       virtual QMap<QString, QVariant> getDataToSave();
       virtual void setLoadedData(const QMap<QString, QVariant>& data);
 
       QStringList getLastStatsStringList() const;
+      QStringList getLifetimeStatsStringList() const;
 
       bool getIndexCreationMode() const;
       void setIndexCreationMode(bool blockOrderMode);
@@ -78,48 +228,228 @@ class StroopExperiment : public Experiment
 
       bool getEvalCorrectTrialsOnly() const;
 
-      QVector<QStringList> exportLastRunToCSV(const QStringList& headers, bool includeStats) const;
+      void setAdaptiveDeadline(bool adaptive);
+      bool getAdaptiveDeadline() const;
+      void setTargetAccuracy(double targetAccuracy);
+      double getTargetAccuracy() const;
+
+      void setRealtimeMode(bool enabled, int cpu = -1);
+      bool getRealtimeMode() const;
+
+      bool setKernelInput(const QStringList& sources, bool exclusive = false);
+      bool getKernelInput() const;
+
+      void setFrameTiming(bool enabled);
+      bool getFrameTiming() const;
+      void setRefreshInterval(double intervalMs, bool synchronized);
+      double getRefreshInterval() const;
+
+      void setCalibration(const TimingCalibrationRecord& record);
+      void setCalibrationThresholds(const TimingThresholds& thresholds);
+      const TimingThresholds& getCalibrationThresholds() const;
+
+      void setStation(const QString& station);
+      const QString& getStation() const;
+
+      QVector<QStringList> exportLastRunToCSV(const QStringList& headers, bool includeStats);
       bool exportAllExperimentsToCSV(const QString& filename, QStringList headers);
+      bool exportReEvaluationToCSV(const QString& filename,
+                                   const QVector<StroopFilterPolicy>& policies);
+
+      void setNextSeed(quint64 seed);
+      quint64 getLastSeed() const;
+
+      void setPlannedSequence(const StudyPlanEntry& entry);
+      bool hasPlannedSequence() const;
+
+      void setProtocol(const StroopProtocol& protocol);
+      const StroopProtocol& getProtocol() const;
+
+      static QVector<StroopTrial> createStroopTrials();
+      static QVector<int> createTrialIndices(quint64 seed, int numTrials,
+                                             bool equallyDistributed,
+                                             int generator = ConstrainedSequenceGenerator);
+      static QVector<qint8> createStreamedConditions(quint64 seed, int numTrials,
+                                                     bool equallyDistributed);
+      static void createTrialIndexBlock(quint64 seed, int block, const QVector<qint8>& conditions,
+                                        int previousIndex, QVector<int>& indices);
+      static QVector<int> createStreamedTrialIndices(quint64 seed, int numTrials,
+                                                     bool equallyDistributed);
+      static QVector<int> createBlockwiseTrialIndices(quint64 seed, int numTrials,
+                                                      bool equallyDistributed);
+      static QVector<int> createBlockedTrialIndices(quint64 seed, int numTrials,
+                                                    bool equallyDistributed,
+                                                    const QVector<int>& blockOrder);
+
+      static QString resultsKey(int sessionNumber);
+      static QString sessionKey(int sessionNumber, const QString& field);
+      static QString chunkFilePath(const QString& filePath, int sessionNumber);
+      static QMap<QString, QVariant> readChunkFile(const QString& fileName);
+      static int countSessions(const QMap<QString, QVariant>& data);
+      static QStringList sessionResults(const QMap<QString, QVariant>& data, int sessionNumber);
 
    signals:
       void requestFixationPoint();
+      void requestBlankScreen(const QString& text); // ISI or break
       void requestColoredQuad(Qt::GlobalColor color);
       void requestColoredWriting(const QString& text, Qt::GlobalColor color);
       void statsComputed(int numMatches, int numWrong, int numTotal,
                          double mean, double stDev );
+      void trialsFlushed(int numFlushedTrials);
+      void trialCompleted(int position, const StroopTrial& trial); // Answered or missed
+      void calibrationChecked(const QStringList& problems); // Empty if within the thresholds
 
    private slots:
-      void startNextTrial();
-      void issueDisplayRequest();
+      void onIntervalExpired(int id);
+      void onKernelResponses();
+      void onCompletionFinished();
 
   public slots:
       void storeTimeAndContinue();
+      void onFramePresented(qint64 frame, int droppedFrames);
 
    private:
-      void createFullyRandomTrialIndices();
-      void createEquallyDistributedTrialIndices();
-      void createStroopTrials();
+      // The engine schedules the run and calls the hooks below
+      friend class TrialEngine<StroopParadigm, StroopExperiment>;
+
+      void presentBlank(bool isBreak);
+      void presentFixationPoint();
+      void presentStimulus(const StroopTrial& trial);
+      void startBlankTimer(int durationMs);
+      void startFixationTimer(int durationMs);
+      void stopTimers();
+      void startDeadline(int position, int deadlineMs);
+      void stopDeadline();
+      void markFixationOnset();
+      int markStimulusOnset();
+      int longestStall() const;
+      int responseDeadline(const StroopTrial& trial, int timelineDeadline) const;
+      void recordOutcome(const StroopTrial& trial);
+      const StroopTrial& trialTemplate(int position);
+      void onTrialCompleted(int position);
+
+      static QVector<int> createFullyRandomTrialIndices(const TrialRandom& random, int numTrials);
+      static QVector<int> createEquallyDistributedTrialIndices(const TrialRandom& random,
+                                                               int numTrials);
       QStringList statsToStringList(double meanRT, int numMatches,
                                     int numWrong, double stDevRT,
                                     bool german=true);
       void checkIfAborted();
       void evaluateTrials();
       void serializeCurrentExperiment();
+      void rebuildAggregate();
+      void completeLastRun();
+
+      int templateIndex(int position);
+
+      enum class Interval { None, Blank, Fixation, Response };
+
+      void armInterval(Interval interval, int position, int durationMs);
+      void disarmInterval();
+      void startDeadlineThread(int priority, int cpu);
+      void prepareRealtimeRun();
+      void finishRealtimeRun();
+      void flushTrials(int upToPosition);
+      void openChunkFile();
+      void writeChunk(const QMap<QString, QStringList>& chunk);
+      void mergeChunkFile();
+      void appendToStore(const QString& key, const QStringList& values);
+      void storePracticeTrials(int upToPosition);
+      void trialsToStringLists(int from, int to, QStringList& results,
+                               QStringList& misses, QStringList& trajectory) const;
+      void framesToStringList(int from, int to, QStringList& frames) const;
 
-      int m_nProgress; // It's the "m_nCurrentStroopTrialIndicesIndex" :)
       QVector<int> m_qvecStroopTrialIndices;
+      int m_nIndexBlockStart; // Position of m_qvecStroopTrialIndices.first()
+      QVector<qint8> m_qvecStreamConditions; // Streamed runs: condition of every trial
 
       QString     m_strLastExpTimeStamp;
       QStringList m_strlLastStats;
 
-      QElapsedTimer m_eltiSingleDecisionTime;
-      QVector<StroopTrial> m_qvecStroopTrials;
+      QVector<StroopTrial> m_qvecStroopTrials; // Templates
+
+      // Trials of the current/last run with their input phases and
+      // statistics; schedules the run
+      StroopEngine m_engine;
 
       QMap<QString, QVariant> m_mapSerializedResults;
+      StroopParticipantAggregate m_aggregate;
 
       bool m_bIndexCreationMode;
       bool m_bEvalCorrectTrialsOnly;
-      bool m_skipped;
 
-      QTimer timer;
+      // Response window: fixed or per condition by staircase
+      bool m_bAdaptiveDeadline;
+      StroopDeadlineStaircase m_staircase;
+
+      // Real-time mode: SCHED_FIFO for the deadline thread, memory locked during runs
+      bool m_bRealtimeMode;
+      int  m_nRealtimeCpu; // -1: not pinned
+      std::unique_ptr<RealtimeDeadlineThread> m_upDeadlineThread;
+      RealtimeReport m_realtimeReport;
+
+      // Blank, fixation or response interval armed on the deadline thread
+      Interval m_nInterval;
+      int m_nIntervalId;       // Changes with every interval, stale expirations are ignored
+      int m_nIntervalPosition; // Trial of a response deadline
+
+      // Event loop stalls between stimulus onset and response
+      EventLoopWatchdog m_watchdog;
+      qint64 m_i64StimulusOnset; // ns, see EventLoopWatchdog::now()
+
+      // Color keys read from evdev, timed by the kernel
+      std::unique_ptr<EvdevInputThread> m_upInputThread;
+      QStringList m_strlInputSources;
+      bool m_bInputExclusive;
+      qint64 m_i64KernelFixationOnset; // ns on CLOCK_MONOTONIC, see EvdevInputThread::monotonicNow()
+      qint64 m_i64KernelOnset;
+
+      // Frame timing: durations in whole refreshes, changed on the swaps
+      // reported by FramePresenter instead of by the timers (see TrialEngine)
+      bool   m_bFrameTiming;
+      double m_dRefreshInterval;   // ms, measured when the dialog is shown
+      bool   m_bFrameSynchronized; // False: frames counted in time, see FramePresenter
+
+      // Timing calibration of the station before the current run
+      TimingCalibrationRecord m_calibration;
+      TimingThresholds m_calibrationThresholds;
+      QStringList m_strlCalibrationProblems;
+
+      // Station of a multi-station session (see StationController), else empty
+      QString m_strStation;
+
+      // Streaming of long runs: chunks are appended to m_chunkFile during
+      // the run and merged into the result map when it is serialized
+      bool m_bStreaming;
+      int  m_nNumFlushedTrials;
+      int  m_nNumChunks;
+      QFile m_chunkFile;
+      QDataStream m_chunkStream;
+
+      // Master seed of the current/last run
+      quint64 m_u64Seed;
+      bool m_bSeedPreset;
+      int m_nNumPlannedTrials;
+
+      // Study plan: sequence of the next run...
+      QVector<int> m_qvecPlannedTrialIndices;
+      QVector<int> m_qvecPlannedConditionOrder;
+      bool m_bPlannedEquallyDistributed;
+
+      // ...and block order of the current/last run (empty if not planned)
+      QVector<int> m_qvecConditionOrder;
+
+      // Protocol of the next runs and the one of the current/last run,
+      // compiled into one timeline event per trial at its start (see TrialEngine)
+      StroopProtocol m_protocol;
+      StroopProtocol m_runProtocol;
+      int m_nNumPracticeTrials;
+      QStringList m_strlPracticeResults; // Not streamed runs only
+      bool m_bPracticeStored;
+
+      // Model estimates of the last run, fitted on the thread pool, or the
+      // chunks of a streamed one, read there; the run is reported as
+      // stopped when they are stored
+      QFutureWatcher< QMap<QString, QVariant> > m_completionWatcher;
+      bool m_bCompleting;
 };
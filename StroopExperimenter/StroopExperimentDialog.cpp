@@ -10,13 +10,14 @@
  
 #include "StroopExperimentDialog.h"
 #include "StroopExperiment.h"
+#include "FramePresenter.h"
 
-#include <QHBoxLayout>
-#include <QLabel>
 #include <QFont>
+#include <QFontMetrics>
 #include <QKeyEvent>
 #include <QColor>
 #include <QPainter>
+#include <QScreen>
 
 
 /**
@@ -27,17 +28,23 @@ StroopExperimentDialog::StroopExperimentDialog(
       std::weak_ptr<StroopExperiment> wpExperiment, QWidget* parent)
    : ExperimentDialog(parent)
    , m_wpExperiment(wpExperiment)
-   , m_pMainLabel(new QLabel)
+   , m_pPresenter(nullptr)
+   , m_dWritingRatio(0.0)
 {
    // Set up the dialog
    this->setStyleSheet("QDialog { background-color : white; }");
 
-   QHBoxLayout* layoutH = new QHBoxLayout; // Gets a parent later...
-   layoutH->addStretch(1);
-   layoutH->addWidget(m_pMainLabel);
-   layoutH->addStretch(1);
+   // Fonts of all stimuli
+   m_fontFixationPoint = this->font();
+   m_fontFixationPoint.setPointSize(128);
+   m_fontFixationPoint.setBold(true);
 
-   this->setLayout(layoutH); // Sets "this" as parent of the layout
+   m_fontWriting = this->font();
+   m_fontWriting.setPointSize(96);
+   m_fontWriting.setBold(true);
+
+   prepareWritings();
+   prepareQuads();
 
    // Draw initial state
    drawFixationPoint();
@@ -47,12 +54,27 @@ StroopExperimentDialog::StroopExperimentDialog(
    {
       connect(spExp.get(), &StroopExperiment::requestFixationPoint,
               this, &StroopExperimentDialog::drawFixationPoint);
+      connect(spExp.get(), &StroopExperiment::requestBlankScreen,
+              this, &StroopExperimentDialog::drawBlankScreen);
       connect(spExp.get(), &StroopExperiment::requestColoredWriting,
               this, &StroopExperimentDialog::drawColoredWriting);
       connect(spExp.get(), &StroopExperiment::requestColoredQuad,
               this, &StroopExperimentDialog::drawColoredQuad);
       connect(spExp.get(), &StroopExperiment::stopped,
               this, &StroopExperimentDialog::close);
+      connect(&m_calibration, &TimingCalibration::finished,
+              this, &StroopExperimentDialog::onCalibrated);
+
+      // Frame timing: the stimuli change on the swaps of this window
+      if (spExp->getFrameTiming())
+      {
+         m_pPresenter = new FramePresenter(this);
+
+         connect(m_pPresenter, &FramePresenter::refreshMeasured,
+                 this, &StroopExperimentDialog::onRefreshMeasured);
+         connect(m_pPresenter, &FramePresenter::framePresented,
+                 spExp.get(), &StroopExperiment::onFramePresented);
+      }
    }
 
 }
@@ -64,9 +86,27 @@ StroopExperimentDialog::StroopExperimentDialog(
  */
 void StroopExperimentDialog::showEvent(QShowEvent* evt)
 {
-   if (std::shared_ptr<StroopExperiment> spExp = m_wpExperiment.lock())
+   // The run starts after the timing calibration, see onCalibrated().
+   // Stimuli are updated into a pixmap and the fixation point is restored
+   // before the event loop runs again, so none of them is shown.
+   if (!m_calibration.isRunning())
    {
-      spExp->start();
+      prepareWritings(); // The screen may have another device pixel ratio
+      m_pixCalibration = QPixmap(size().expandedTo(QSize(1, 1)));
+
+      m_calibration.start(screen(), [this](int sample)
+      {
+         static constexpr std::array<Qt::GlobalColor, 4> colors = { Qt::red, Qt::green,
+                                                                    Qt::blue, Qt::yellow };
+         const Qt::GlobalColor color = colors[sample % colors.size()];
+
+         if (sample % 2 == 0) { drawColoredQuad(color); }
+         else                 { drawColoredWriting(StroopExperiment::convertColorToString(color, true), color); }
+
+         render(&m_pixCalibration);
+      });
+
+      drawFixationPoint();
    }
 
    ExperimentDialog::showEvent(evt);
@@ -84,10 +124,196 @@ void StroopExperimentDialog::closeEvent(QCloseEvent* evt)
       spExp->stop(); // Important if closed before the experiment has finished.
    }
 
+   if (m_pPresenter) { m_pPresenter->stop(); }
+
    ExperimentDialog::closeEvent(evt);
 }
 
 
+/**
+ * @brief StroopExperimentDialog::resizeEvent
+ * @param evt
+ */
+void StroopExperimentDialog::resizeEvent(QResizeEvent* evt)
+{
+   ExperimentDialog::resizeEvent(evt);
+
+   prepareQuads();
+}
+
+
+/**
+ * @brief StroopExperimentDialog::paintEvent
+ * @param evt
+ *
+ * The current stimulus is centered on the white background.
+ */
+void StroopExperimentDialog::paintEvent(QPaintEvent* evt)
+{
+   ExperimentDialog::paintEvent(evt);
+
+   if (m_pixStimulus.isNull()) { return; }
+
+   const QSizeF size = m_pixStimulus.deviceIndependentSize();
+
+   QPainter painter(this);
+   painter.drawPixmap(QPointF((width() - size.width()) / 2.0, (height() - size.height()) / 2.0),
+                      m_pixStimulus);
+}
+
+
+/**
+ * @brief StroopExperimentDialog::onCalibrated
+ * Frame timing: the refresh interval is measured from the swaps next.
+ */
+void StroopExperimentDialog::onCalibrated()
+{
+   if (!isVisible()) { return; } // Closed during the calibration
+
+   if (m_pPresenter) { m_pPresenter->measureRefreshInterval(); }
+   else              { startRun(); }
+}
+
+
+/**
+ * @brief StroopExperimentDialog::onRefreshMeasured
+ * @param intervalMs Refresh interval of the screen the dialog is shown on
+ */
+void StroopExperimentDialog::onRefreshMeasured(double intervalMs)
+{
+   m_calibration.addRefreshMeasurement(intervalMs, m_pPresenter->getRefreshDeviation());
+
+   if (std::shared_ptr<StroopExperiment> spExp = m_wpExperiment.lock())
+   {
+      spExp->setRefreshInterval(intervalMs, m_pPresenter->isSynchronized());
+   }
+
+   startRun();
+}
+
+
+/**
+ * @brief StroopExperimentDialog::startRun
+ */
+void StroopExperimentDialog::startRun()
+{
+   if (std::shared_ptr<StroopExperiment> spExp = m_wpExperiment.lock())
+   {
+      spExp->setCalibration(m_calibration.getRecord());
+      spExp->start();
+   }
+}
+
+
+/**
+ * @brief StroopExperimentDialog::prepareStimuli
+ * @param screen Screen the dialog will be shown on full screen
+ *
+ * Polishes the dialog and builds the quads at their full-screen size and
+ * the writings for the screen's pixel ratio while it is still hidden, so
+ * showing it for the first run does not.
+ */
+void StroopExperimentDialog::prepareStimuli(QScreen* screen)
+{
+   if (screen) { resize(screen->size()); }
+
+   ensurePolished();
+
+   prepareWritings();
+   prepareQuads();
+}
+
+
+/**
+ * @brief StroopExperimentDialog::prepareQuads
+ * The quads are a quarter of the dialog's height.
+ */
+void StroopExperimentDialog::prepareQuads()
+{
+   const int quadHeight = qMax(1, this->height() / 4);
+
+   // Already prepared for this size, e.g. by prepareStimuli()
+   if (!m_qhashQuads.isEmpty() && m_qhashQuads.constBegin()->height() == quadHeight) { return; }
+
+   for (Qt::GlobalColor color : { Qt::red, Qt::green, Qt::blue, Qt::yellow })
+   {
+      // Same color as the writings
+      QPixmap quad(quadHeight, quadHeight);
+      quad.fill(QColor(StroopExperiment::convertColorForStylesheet(color)));
+
+      m_qhashQuads.insert(color, quad);
+   }
+}
+
+
+/**
+ * @brief StroopExperimentDialog::prepareWritings
+ * Renders the fixation point and the word of every trial template in its
+ * color, at the device pixel ratio of the dialog.
+ */
+void StroopExperimentDialog::prepareWritings()
+{
+   // Already prepared for this ratio
+   if (qFuzzyCompare(m_dWritingRatio, devicePixelRatioF())) { return; }
+
+   m_dWritingRatio = devicePixelRatioF();
+   m_pixFixationPoint = renderText(QStringLiteral("+"), m_fontFixationPoint, Qt::black);
+
+   m_qhashWritings.clear();
+
+   const QVector<StroopTrial> templates = StroopExperiment::createStroopTrials();
+   for (const StroopTrial& trial : templates)
+   {
+      if (trial.m_nMode == StroopTrialModes::ColoredQuads) { continue; }
+
+      const QColor color(StroopExperiment::convertColorForStylesheet(trial.m_nColor));
+      m_qhashWritings.insert(qMakePair(trial.m_strText, static_cast<int>(trial.m_nColor)),
+                             renderText(trial.m_strText, m_fontWriting, color));
+   }
+}
+
+
+/**
+ * @brief StroopExperimentDialog::renderText
+ * @param text
+ * @param font
+ * @param color
+ * @return Text on white, as large as its bounding box
+ */
+QPixmap StroopExperimentDialog::renderText(const QString& text, const QFont& font,
+                                           const QColor& color) const
+{
+   const QSize size = QFontMetrics(font).size(Qt::TextSingleLine, text).expandedTo(QSize(1, 1));
+   const qreal ratio = devicePixelRatioF();
+
+   QPixmap pixmap(size * ratio);
+   pixmap.setDevicePixelRatio(ratio);
+   pixmap.fill(Qt::white);
+
+   QPainter painter(&pixmap);
+   painter.setFont(font);
+   painter.setPen(color);
+   painter.drawText(QRect(QPoint(0, 0), size), Qt::AlignCenter, text);
+
+   return pixmap;
+}
+
+
+/**
+ * @brief StroopExperimentDialog::showStimulus
+ * @param stimulus Shown with the next repaint, a null pixmap clears the screen
+ */
+void StroopExperimentDialog::showStimulus(const QPixmap& stimulus)
+{
+   m_pixStimulus = stimulus;
+
+   // Qt queues the repaint request, which allocates; the repaint itself is
+   // done by the event loop
+   AllocationGuard::Exemption exemption;
+   update();
+}
+
+
 /**
  * @brief StroopExperimentDialog::getGlobalExperimentIndex
  * @return
@@ -113,28 +339,31 @@ void StroopExperimentDialog::keyPressEvent(QKeyEvent* evt)
 {
    if (std::shared_ptr<StroopExperiment> spExp = m_wpExperiment.lock())
    {
+      // With evdev input the color keys are read by EvdevInputThread
+      const bool colorKeys = !spExp->getKernelInput();
+
       // Red
-      if(evt->key() == Qt::Key_R || evt->key() == Qt::Key_A || evt->key() == Qt::Key_7)
+      if(colorKeys && (evt->key() == Qt::Key_R || evt->key() == Qt::Key_A || evt->key() == Qt::Key_7))
       {
-         spExp->onRedChosen();
+         spExp->onColorKey(Qt::red, evt->isAutoRepeat());
          return;
       }
       // Green
-      if(evt->key() == Qt::Key_G || evt->key() == Qt::Key_S || evt->key() == Qt::Key_4)
+      if(colorKeys && (evt->key() == Qt::Key_G || evt->key() == Qt::Key_S || evt->key() == Qt::Key_4))
       {
-         spExp->onGreenChosen();
+         spExp->onColorKey(Qt::green, evt->isAutoRepeat());
          return;
       }
       // Blue
-      if(evt->key() == Qt::Key_B || evt->key() == Qt::Key_D || evt->key() == Qt::Key_1)
+      if(colorKeys && (evt->key() == Qt::Key_B || evt->key() == Qt::Key_D || evt->key() == Qt::Key_1))
       {
-         spExp->onBlueChosen();
+         spExp->onColorKey(Qt::blue, evt->isAutoRepeat());
          return;
       }
       // Yellow
-      if(evt->key() == Qt::Key_Y || evt->key() == Qt::Key_F || evt->key() == Qt::Key_0)
+      if(colorKeys && (evt->key() == Qt::Key_Y || evt->key() == Qt::Key_F || evt->key() == Qt::Key_0))
       {
-         spExp->onYellowChosen();
+         spExp->onColorKey(Qt::yellow, evt->isAutoRepeat());
          return;
       }
       // Pause and continue
@@ -160,12 +389,19 @@ void StroopExperimentDialog::keyPressEvent(QKeyEvent* evt)
  */
 void StroopExperimentDialog::drawFixationPoint()
 {
-   m_pMainLabel->setText("+");
-   QFont font = m_pMainLabel->font();
-   font.setPointSize(128);
-   font.setBold(true);
-   m_pMainLabel->setFont(font);
-   m_pMainLabel->setStyleSheet("QLabel { background-color : white; color : black; }");
+   showStimulus(m_pixFixationPoint);
+}
+
+
+/**
+ * @brief StroopExperimentDialog::drawBlankScreen
+ * @param text Shown in the style of the fixation point, e.g. during a break
+ */
+void StroopExperimentDialog::drawBlankScreen(const QString& text)
+{
+   // Between trials, so the text is rendered when needed
+   if (text.isEmpty()) { showStimulus(m_pixBlank); }
+   else                { showStimulus(renderText(text, m_fontFixationPoint, Qt::black)); }
 }
 
 
@@ -175,18 +411,18 @@ void StroopExperimentDialog::drawFixationPoint()
  */
 void StroopExperimentDialog::drawColoredWriting(const QString& text, Qt::GlobalColor color)
 {
-   QString colorStr = StroopExperiment::convertColorForStylesheet(color);
+   const QHash<QPair<QString, int>, QPixmap>::const_iterator it
+         = m_qhashWritings.constFind(qMakePair(text, static_cast<int>(color)));
 
-   QFont font = m_pMainLabel->font();
-   font.setPointSize(96);
-   font.setBold(true);
-   m_pMainLabel->setFont(font);
-
-   QString styleSheet =
-         QString("QLabel { background-color : white; color : %1; }").arg(colorStr);
-   m_pMainLabel->setStyleSheet(styleSheet);
+   if (it != m_qhashWritings.constEnd())
+   {
+      showStimulus(it.value());
+      return;
+   }
 
-   m_pMainLabel->setText(text);
+   // Not the word of a template
+   showStimulus(renderText(text, m_fontWriting,
+                           QColor(StroopExperiment::convertColorForStylesheet(color))));
 }
 
 
@@ -196,27 +432,7 @@ void StroopExperimentDialog::drawColoredWriting(const QString& text, Qt::GlobalC
  */
 void StroopExperimentDialog::drawColoredQuad(Qt::GlobalColor color)
 {
-   /* In order to have the same colors as for the text, the stylesheet of the label  */
-   /* that will contain the the pixmap of the quad is set first to retrieve the      */
-   /* color to draw the quad. The idea is to have QLabel to interpret the stylesheet */
-   /* and then get the color from the m_pMainLabel and use it to draw the QPixmap    */
-   /* which contains the quad.                                                       */
-
-   // Define the color of the QLabel "m_pMainLabel" using a stylesheet
-   QString colorStr = StroopExperiment::convertColorForStylesheet(color);
-   QString styleSheet =
-         QString("QLabel { background-color : white; color : %1; }").arg(colorStr);
-   m_pMainLabel->setStyleSheet(styleSheet);
-
-   // Get the color the label would use for the text
-   QColor labelTextColor = m_pMainLabel->palette().color(QPalette::Text);
-
-   // Create the quad to draw by defining a square QPixmap and set its color
-   // to the labelTextColor.
-   int quadHeight = this->height() / 4;
-   QPixmap quad(quadHeight,quadHeight);
-   quad.fill(labelTextColor);
-
-   // Finally draw the quad by setting the pixmap of the m_pMainLabel
-   m_pMainLabel->setPixmap(quad);
+   // The quads are prepared in the color the text would have, see prepareQuads()
+   const QHash<int, QPixmap>::const_iterator it = m_qhashQuads.constFind(color);
+   if (it != m_qhashQuads.constEnd()) { showStimulus(it.value()); }
 }
@@ -11,16 +11,27 @@
 #pragma once
 
 #include "ExperimentDialog.h"
+#include "TimingCalibration.h"
+
+#include <QFont>
+#include <QHash>
+#include <QPair>
+#include <QPixmap>
 
 
 // Forward declarations
+class FramePresenter;
 class StroopExperiment;
 class QKeyEvent;
-class QLabel;
+class QScreen;
 
 
 /**
  * @brief The StroopExperimentDialog class
+ *
+ * Shows the stimuli full screen. All of them are rendered into pixmaps
+ * beforehand and painted by paintEvent(), so a display request of the
+ * experiment only selects a pixmap (see AllocationGuard).
  */
 class StroopExperimentDialog : public ExperimentDialog
 {
@@ -32,17 +43,43 @@ class StroopExperimentDialog : public ExperimentDialog
 
       virtual int getGlobalExperimentIndex() const;
 
+      void prepareStimuli(QScreen* screen);
+
    protected:
       virtual void keyPressEvent(QKeyEvent* evt);
       virtual void showEvent(QShowEvent* evt);
       virtual void closeEvent(QCloseEvent* evt);
+      virtual void resizeEvent(QResizeEvent* evt);
+      virtual void paintEvent(QPaintEvent* evt);
 
    private slots:
       void drawFixationPoint();
+      void drawBlankScreen(const QString& text);
       void drawColoredWriting(const QString& text, Qt::GlobalColor color);
       void drawColoredQuad(Qt::GlobalColor color);
+      void onCalibrated();
+      void onRefreshMeasured(double intervalMs);
 
    private:
+      void prepareQuads();
+      void prepareWritings();
+      QPixmap renderText(const QString& text, const QFont& font, const QColor& color) const;
+      void showStimulus(const QPixmap& stimulus);
+      void startRun();
+
       std::weak_ptr<StroopExperiment> m_wpExperiment;
-      QLabel* m_pMainLabel;
+      FramePresenter* m_pPresenter; // Frame timing only, else nullptr
+      TimingCalibration m_calibration; // Before each run
+      QPixmap m_pixCalibration;        // Target of the stimulus updates of the calibration
+
+      // Prepared once, so drawing a stimulus needs no rendering
+      QFont m_fontFixationPoint;
+      QFont m_fontWriting;
+      qreal m_dWritingRatio; // Device pixel ratio the writings are rendered for
+      QPixmap m_pixFixationPoint;
+      QPixmap m_pixBlank;                                  // Null, nothing is painted
+      QHash<QPair<QString, int>, QPixmap> m_qhashWritings; // Word and Qt::GlobalColor of every template
+      QHash<int, QPixmap> m_qhashQuads;                    // Qt::GlobalColor -> quad of the current size
+
+      QPixmap m_pixStimulus; // Shown, shares the data of a prepared pixmap
 };
@@ -1,5 +1,5 @@
 # Common basic configurations
-QT += core gui widgets
+QT += core gui widgets concurrent openglwidgets
 
 TARGET = StroopExperimenter
 TEMPLATE = app
@@ -31,6 +31,28 @@ SOURCES +=  main.cpp \
             StroopExperiment.cpp \
             ExperimentDialog.cpp \
             StroopExperimentDialog.cpp \
+            AllocationGuard.cpp \
+            EvdevInput.cpp \
+            EventLoopWatchdog.cpp \
+            ExperimentRegistry.cpp \
+            FramePresenter.cpp \
+            RealtimeSupport.cpp \
+            RunningMoments.cpp \
+            StationController.cpp \
+            StroopAggregates.cpp \
+            StroopProtocol.cpp \
+            StroopReEvaluation.cpp \
+            StroopRTPlotWidget.cpp \
+            StroopSessionHistoryModel.cpp \
+            StroopStaircase.cpp \
+            StroopStatistics.cpp \
+            StroopTrialTableModel.cpp \
+            StudyAnalyzer.cpp \
+            StudyPlan.cpp \
+            TimingCalibration.cpp \
+            TrialRandom.cpp \
+            TrialSequenceGenerator.cpp \
+            TrialSequencePlanner.cpp \
             
 HEADERS +=  MainWindow.h \
             DataReaderWriter.h \
@@ -39,5 +61,28 @@ HEADERS +=  MainWindow.h \
             StroopExperiment.h \
             ExperimentDialog.h \
             StroopExperimentDialog.h \
+            AllocationGuard.h \
+            EvdevInput.h \
+            EventLoopWatchdog.h \
+            ExperimentRegistry.h \
+            FramePresenter.h \
+            RealtimeSupport.h \
+            RunningMoments.h \
+            StationController.h \
+            StroopAggregates.h \
+            StroopProtocol.h \
+            StroopReEvaluation.h \
+            StroopRTPlotWidget.h \
+            StroopSessionHistoryModel.h \
+            StroopStaircase.h \
+            StroopStatistics.h \
+            StroopTrialTableModel.h \
+            StudyAnalyzer.h \
+            StudyPlan.h \
+            TimingCalibration.h \
+            TrialEngine.h \
+            TrialRandom.h \
+            TrialSequenceGenerator.h \
+            TrialSequencePlanner.h \
             
 FORMS +=    MainWindow.ui
@@ -0,0 +1,604 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopProtocol.h"
+#include "StroopExperiment.h"
+#include "TrialSequenceGenerator.h"
+#include "TrialRandom.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QSettings>
+
+#include <algorithm>
+#include <cmath>
+
+
+/**
+ * @brief StroopProtocolBlock::StroopProtocolBlock
+ * Timing of a run without protocol.
+ */
+StroopProtocolBlock::StroopProtocolBlock()
+   : m_bPractice(false)
+   , m_nNumTrials(0)
+   , m_nFixationMin(StroopProtocol::DefaultFixation)
+   , m_nFixationMax(StroopProtocol::DefaultFixation)
+   , m_nISIMin(0)
+   , m_nISIMax(0)
+   , m_nDeadline(static_cast<int>(StroopDeadlineStaircase::FixedDeadline))
+   , m_nBreak(0)
+   , m_nMixMode(EqualMix)
+   , m_qvecMixWeights(NumStroopConditions, 0)
+{
+}
+
+
+/**
+ * @brief StroopProtocolBlock::toString
+ * @return Name;Practice;Trials;Fixation;ISI;Deadline;Mix;Break
+ */
+QString StroopProtocolBlock::toString() const
+{
+   QString mix = "equal";
+   if (m_nMixMode == ProportionalMix)
+   {
+      mix = "proportional";
+   }
+   else if (m_nMixMode == WeightedMix)
+   {
+      QStringList weights;
+      for (int weight : m_qvecMixWeights) { weights.append(QString::number(weight)); }
+      mix = weights.join(",");
+   }
+
+   QStringList fields;
+   fields << m_strName << (m_bPractice ? "1" : "0") << QString::number(m_nNumTrials)
+          << QString("%1-%2").arg(m_nFixationMin).arg(m_nFixationMax)
+          << QString("%1-%2").arg(m_nISIMin).arg(m_nISIMax)
+          << QString::number(m_nDeadline) << mix << QString::number(m_nBreak);
+
+   return fields.join(";");
+}
+
+
+/**
+ * @brief StroopProtocolBlock::fromString
+ * @param str As written by toString()
+ * @param block
+ * @return
+ */
+bool StroopProtocolBlock::fromString(const QString& str, StroopProtocolBlock& block)
+{
+   const QStringList fields = str.split(";");
+   if (fields.count() != 8) { return false; }
+
+   bool ok = true;
+   bool okNum = false;
+
+   block.m_strName = fields.at(0);
+   block.m_bPractice = (fields.at(1) == "1");
+   block.m_nNumTrials = fields.at(2).toInt(&okNum);             ok = ok && okNum;
+   ok = ok && StroopProtocol::parseRange(fields.at(3), block.m_nFixationMin, block.m_nFixationMax);
+   ok = ok && StroopProtocol::parseRange(fields.at(4), block.m_nISIMin, block.m_nISIMax);
+   block.m_nDeadline = fields.at(5).toInt(&okNum);              ok = ok && okNum;
+   block.m_nBreak = fields.at(7).toInt(&okNum);                 ok = ok && okNum;
+
+   const QStringList weights = fields.at(6).split(",");
+   if (weights.count() == NumStroopConditions)
+   {
+      block.m_nMixMode = WeightedMix;
+      for (int cond=0; cond<NumStroopConditions; cond++)
+      {
+         block.m_qvecMixWeights[cond] = weights.at(cond).toInt(&okNum); ok = ok && okNum;
+      }
+   }
+   else
+   {
+      ok = ok && StroopProtocol::parseMix(weights, block);
+   }
+
+   return ok;
+}
+
+
+/**
+ * @brief StroopProtocol::StroopProtocol
+ */
+StroopProtocol::StroopProtocol()
+   : m_strName("default")
+   , m_nVersion(0)
+   , m_bLoaded(false)
+{
+}
+
+
+/**
+ * @brief StroopProtocol::load
+ * @param filePath INI file
+ * @param error Set if the file cannot be read or is not valid
+ * @return The protocol is only replaced if the file is valid
+ */
+bool StroopProtocol::load(const QString& filePath, QString* error)
+{
+   if (!QFileInfo::exists(filePath))
+   {
+      if (error) { *error = QString("%1 does not exist.").arg(filePath); }
+      return false;
+   }
+
+   QSettings settings(filePath, QSettings::IniFormat);
+   if (settings.status() != QSettings::NoError)
+   {
+      if (error) { *error = QString("%1 is not a valid INI file.").arg(filePath); }
+      return false;
+   }
+
+   StroopProtocol protocol;
+   protocol.m_strFilePath = filePath;
+   protocol.m_strName = settings.value("Protocol/name", QFileInfo(filePath).completeBaseName()).toString();
+   protocol.m_nVersion = settings.value("Protocol/version", 1).toInt();
+   protocol.m_bLoaded = true;
+
+   const QStringList groups = settings.childGroups();
+   const QStringList blockNames = settings.value("Protocol/blocks").toStringList();
+
+   for (const QString& blockName : blockNames)
+   {
+      const QString name = blockName.trimmed();
+      if (!groups.contains(name))
+      {
+         if (error) { *error = QString("Block %1 is not defined.").arg(name); }
+         return false;
+      }
+
+      StroopProtocolBlock block;
+      block.m_strName = name;
+
+      settings.beginGroup(name);
+
+      block.m_bPractice = settings.value("practice", false).toBool();
+      block.m_nNumTrials = settings.value("trials", 0).toInt();
+      block.m_nDeadline = settings.value("deadline", block.m_nDeadline).toInt();
+
+      bool ok = parseRange(settings.value("fixation", QString::number(block.m_nFixationMin)).toString(),
+                           block.m_nFixationMin, block.m_nFixationMax)
+                && parseRange(settings.value("isi", "0").toString(), block.m_nISIMin, block.m_nISIMax)
+                && parseMix(settings.value("mix", "equal").toStringList(), block);
+
+      bool okBreak = true;
+      const QString breakStr = settings.value("break", "0").toString().trimmed();
+      if (breakStr.compare("key", Qt::CaseInsensitive) == 0) { block.m_nBreak = -1; }
+      else                                                   { block.m_nBreak = breakStr.toInt(&okBreak); }
+      ok = ok && okBreak;
+
+      settings.endGroup();
+
+      if (!ok)
+      {
+         if (error) { *error = QString("Block %1 has an invalid fixation, isi, mix or break.").arg(name); }
+         return false;
+      }
+
+      protocol.m_qvecBlocks.append(block);
+   }
+
+   if (!protocol.validate(error)) { return false; }
+
+   *this = protocol;
+   return true;
+}
+
+
+/**
+ * @brief StroopProtocol::validate
+ * @param error
+ * @return
+ */
+bool StroopProtocol::validate(QString* error) const
+{
+   QString problem;
+
+   bool mainBlockSeen = false;
+   for (const StroopProtocolBlock& block : m_qvecBlocks)
+   {
+      const QString& name = block.m_strName;
+
+      int weightSum = 0;
+      bool negativeWeight = false;
+      for (int weight : block.m_qvecMixWeights) { weightSum += weight; negativeWeight = negativeWeight || weight < 0; }
+
+      if (block.m_nNumTrials <= 0)
+      {
+         problem = QString("Block %1 has no trials.").arg(name);
+      }
+      else if (block.m_nFixationMin < 0 || block.m_nFixationMin > block.m_nFixationMax
+               || block.m_nISIMin < 0 || block.m_nISIMin > block.m_nISIMax)
+      {
+         problem = QString("Block %1 has an invalid fixation or isi range.").arg(name);
+      }
+      else if (block.m_nDeadline <= 0 || block.m_nBreak < -1)
+      {
+         problem = QString("Block %1 has an invalid deadline or break.").arg(name);
+      }
+      else if (block.m_nMixMode == StroopProtocolBlock::WeightedMix && (weightSum <= 0 || negativeWeight))
+      {
+         problem = QString("Block %1 has invalid mix weights.").arg(name);
+      }
+      else if (block.m_bPractice && mainBlockSeen)
+      {
+         problem = QString("Practice block %1 follows a main block.").arg(name);
+      }
+
+      if (!problem.isEmpty()) { break; }
+
+      mainBlockSeen = mainBlockSeen || !block.m_bPractice;
+   }
+
+   if (problem.isEmpty() && !mainBlockSeen)
+   {
+      problem = "The protocol has no main block.";
+   }
+
+   if (error && !problem.isEmpty()) { *error = problem; }
+
+   return problem.isEmpty();
+}
+
+
+/**
+ * @brief StroopProtocol::isLoaded
+ * @return True if read from a file, false for the protocol of runs without one
+ */
+bool StroopProtocol::isLoaded() const
+{
+   return m_bLoaded;
+}
+
+
+/**
+ * @brief StroopProtocol::getFilePath
+ * @return
+ */
+QString StroopProtocol::getFilePath() const
+{
+   return m_strFilePath;
+}
+
+
+/**
+ * @brief StroopProtocol::getName
+ * @return
+ */
+QString StroopProtocol::getName() const
+{
+   return m_strName;
+}
+
+
+/**
+ * @brief StroopProtocol::getVersion
+ * @return Version given in the file
+ */
+int StroopProtocol::getVersion() const
+{
+   return m_nVersion;
+}
+
+
+/**
+ * @brief StroopProtocol::getHash
+ * @return Hex SHA-256 of the canonical definition
+ */
+QString StroopProtocol::getHash() const
+{
+   return QString::fromLatin1(QCryptographicHash::hash(toStringList().join("\n").toUtf8(),
+                                                       QCryptographicHash::Sha256).toHex());
+}
+
+
+/**
+ * @brief StroopProtocol::getBlocks
+ * @return
+ */
+const QVector<StroopProtocolBlock>& StroopProtocol::getBlocks() const
+{
+   return m_qvecBlocks;
+}
+
+
+/**
+ * @brief StroopProtocol::getNumTrials
+ * @return Trials of all blocks, including practice
+ */
+int StroopProtocol::getNumTrials() const
+{
+   int numTrials = 0;
+   for (const StroopProtocolBlock& block : m_qvecBlocks) { numTrials += block.m_nNumTrials; }
+
+   return numTrials;
+}
+
+
+/**
+ * @brief StroopProtocol::getNumPracticeTrials
+ * @return Trials of the practice blocks at the start of the run
+ */
+int StroopProtocol::getNumPracticeTrials() const
+{
+   int numTrials = 0;
+   for (const StroopProtocolBlock& block : m_qvecBlocks)
+   {
+      if (block.m_bPractice) { numTrials += block.m_nNumTrials; }
+   }
+
+   return numTrials;
+}
+
+
+/**
+ * @brief StroopProtocol::compile
+ * @param seed Master seed of the run
+ * @param timeline Set to one event per trial
+ * @param indices If not null, set to the trial indices of the run
+ *        (indices into StroopExperiment::createStroopTrials())
+ * @param error
+ * @return
+ *
+ * Block b generates its sequence with stream ProtocolStream + 2b and draws
+ * its durations from stream ProtocolStream + 2b + 1.
+ */
+bool StroopProtocol::compile(quint64 seed, QVector<StroopTimelineEvent>& timeline,
+                             QVector<int>* indices, QString* error) const
+{
+   const int numTrials = getNumTrials();
+
+   timeline.clear();
+   timeline.reserve(numTrials);
+
+   const TrialRandom random(seed);
+   const QVector<StroopTrial> templates = StroopExperiment::createStroopTrials();
+   const TrialSequenceGenerator generator(templates);
+
+   if (indices)
+   {
+      indices->clear();
+      indices->reserve(numTrials);
+   }
+
+   for (int b=0; b<m_qvecBlocks.count(); b++)
+   {
+      const StroopProtocolBlock& block = m_qvecBlocks.at(b);
+      const quint64 blockStream = TrialRandom::ProtocolStream + 2ULL * static_cast<quint64>(b);
+
+      if (indices)
+      {
+         const QVector<int> counts = conditionCounts(block, generator);
+         const TrialRandom blockRandom(random.deriveSeed(blockStream));
+
+         QVector<int> blockIndices;
+         if (!generator.generate(blockRandom, counts, blockIndices))
+         {
+            // Only degenerate mixes end up here: drop the run length limit
+            SequenceConstraints relaxed;
+            relaxed.m_nMaxRunLength = 0;
+
+            if (!TrialSequenceGenerator(templates, relaxed).generate(blockRandom, counts,
+                                                                     blockIndices, error))
+            {
+               return false;
+            }
+         }
+
+         indices->append(blockIndices);
+      }
+
+      SplitMix64 durations = random.stream(blockStream + 1ULL);
+
+      for (int i=0; i<block.m_nNumTrials; i++)
+      {
+         StroopTimelineEvent event;
+         event.m_nPause = durations.uniformInt(block.m_nISIMin, block.m_nISIMax);
+         event.m_nFixation = durations.uniformInt(block.m_nFixationMin, block.m_nFixationMax);
+         event.m_nDeadline = block.m_nDeadline;
+         event.m_nFlags = block.m_bPractice ? StroopTimelineEvent::Practice : 0;
+
+         // The first trial of the run starts right away, the first of a
+         // block after the break of the block before
+         if (i == 0 && b == 0)
+         {
+            event.m_nPause = 0;
+         }
+         else if (i == 0 && m_qvecBlocks.at(b-1).m_nBreak != 0)
+         {
+            event.m_nPause = m_qvecBlocks.at(b-1).m_nBreak;
+            event.m_nFlags |= StroopTimelineEvent::BreakBefore;
+         }
+
+         timeline.append(event);
+      }
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief StroopProtocol::conditionCounts
+ * @param block
+ * @param generator
+ * @return Trials per condition of the block
+ */
+QVector<int> StroopProtocol::conditionCounts(const StroopProtocolBlock& block,
+                                             const TrialSequenceGenerator& generator)
+{
+   if (block.m_nMixMode == StroopProtocolBlock::EqualMix)
+   {
+      return TrialSequenceGenerator::equalCounts(block.m_nNumTrials);
+   }
+
+   if (block.m_nMixMode == StroopProtocolBlock::ProportionalMix)
+   {
+      return generator.proportionalCounts(block.m_nNumTrials);
+   }
+
+   // Weights: largest remainder method, ties go to the first condition
+   int weightSum = 0;
+   for (int weight : block.m_qvecMixWeights) { weightSum += weight; }
+
+   QVector<int> counts(NumStroopConditions, 0);
+   QVector<double> remainders(NumStroopConditions, 0.0);
+
+   int assigned = 0;
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const double exact = static_cast<double>(block.m_nNumTrials) * block.m_qvecMixWeights.at(cond) / weightSum;
+      counts[cond] = static_cast<int>(std::floor(exact));
+      remainders[cond] = exact - counts.at(cond);
+      assigned += counts.at(cond);
+   }
+
+   for (; assigned<block.m_nNumTrials; assigned++)
+   {
+      const int cond = static_cast<int>(std::max_element(remainders.begin(), remainders.end())
+                                        - remainders.begin());
+      counts[cond]++;
+      remainders[cond] = -1.0;
+   }
+
+   return counts;
+}
+
+
+/**
+ * @brief StroopProtocol::toStringList
+ * @return Name;Version followed by one line per block (StroopProtocolBlock::toString())
+ */
+QStringList StroopProtocol::toStringList() const
+{
+   QStringList definition;
+   definition.append(m_strName + ";" + QString::number(m_nVersion));
+
+   for (const StroopProtocolBlock& block : m_qvecBlocks) { definition.append(block.toString()); }
+
+   return definition;
+}
+
+
+/**
+ * @brief StroopProtocol::fromStringList
+ * @param definition As stored with a session, see toStringList()
+ * @param protocol
+ * @return
+ */
+bool StroopProtocol::fromStringList(const QStringList& definition, StroopProtocol& protocol)
+{
+   if (definition.isEmpty()) { return false; }
+
+   const QStringList header = definition.first().split(";");
+   if (header.count() != 2) { return false; }
+
+   StroopProtocol result;
+   result.m_strName = header.at(0);
+   result.m_nVersion = header.at(1).toInt();
+   result.m_bLoaded = true;
+
+   for (int i=1; i<definition.count(); i++)
+   {
+      StroopProtocolBlock block;
+      if (!StroopProtocolBlock::fromString(definition.at(i), block)) { return false; }
+
+      result.m_qvecBlocks.append(block);
+   }
+
+   if (!result.validate(nullptr)) { return false; }
+
+   protocol = result;
+   return true;
+}
+
+
+/**
+ * @brief StroopProtocol::defaultProtocol
+ * @param numTrials
+ * @return One block with the timing of a run without protocol
+ */
+StroopProtocol StroopProtocol::defaultProtocol(int numTrials)
+{
+   StroopProtocolBlock block;
+   block.m_strName = "default";
+   block.m_nNumTrials = numTrials;
+
+   StroopProtocol protocol;
+   protocol.m_qvecBlocks.append(block);
+
+   return protocol;
+}
+
+
+/**
+ * @brief StroopProtocol::parseRange
+ * @param str "value" or "min-max"
+ * @param min
+ * @param max
+ * @return
+ */
+bool StroopProtocol::parseRange(const QString& str, int& min, int& max)
+{
+   const QStringList parts = str.split("-");
+   if (parts.count() < 1 || parts.count() > 2) { return false; }
+
+   bool okMin = false;
+   bool okMax = false;
+   min = parts.first().trimmed().toInt(&okMin);
+   max = parts.last().trimmed().toInt(&okMax);
+
+   return okMin && okMax;
+}
+
+
+/**
+ * @brief StroopProtocol::parseMix
+ * @param mix "equal", "proportional" or weights like "Quads:1", "TextConflict:2"
+ * @param block
+ * @return
+ */
+bool StroopProtocol::parseMix(const QStringList& mix, StroopProtocolBlock& block)
+{
+   if (mix.count() == 1 && mix.first().trimmed().compare("equal", Qt::CaseInsensitive) == 0)
+   {
+      block.m_nMixMode = StroopProtocolBlock::EqualMix;
+      return true;
+   }
+
+   if (mix.count() == 1 && mix.first().trimmed().compare("proportional", Qt::CaseInsensitive) == 0)
+   {
+      block.m_nMixMode = StroopProtocolBlock::ProportionalMix;
+      return true;
+   }
+
+   block.m_nMixMode = StroopProtocolBlock::WeightedMix;
+   block.m_qvecMixWeights.fill(0);
+
+   for (const QString& entry : mix)
+   {
+      const QStringList parts = entry.trimmed().split(":");
+      if (parts.count() != 2) { return false; }
+
+      // modeFromString() falls back to Quads, so check the name
+      const QString name = parts.at(0).trimmed();
+      const StroopTrialModes mode = StroopTrial::modeFromString(name);
+      if (StroopTrial::modeToString(mode) != name) { return false; }
+
+      bool ok = false;
+      block.m_qvecMixWeights[static_cast<int>(mode)] = parts.at(1).trimmed().toInt(&ok);
+      if (!ok) { return false; }
+   }
+
+   return true;
+}
@@ -0,0 +1,139 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QStringList>
+
+// Forward declarations
+class TrialSequenceGenerator;
+
+
+/**
+ * @brief The StroopProtocolBlock struct
+ */
+struct StroopProtocolBlock
+{
+   enum MixMode { EqualMix, ProportionalMix, WeightedMix };
+
+   StroopProtocolBlock();
+
+   QString toString() const;
+   static bool fromString(const QString& str, StroopProtocolBlock& block);
+
+   QString m_strName;
+   bool m_bPractice;   // Not evaluated, stored apart from the results
+   int  m_nNumTrials;
+   int  m_nFixationMin; // ms, drawn per trial
+   int  m_nFixationMax;
+   int  m_nISIMin;      // ms blank screen between response and fixation point
+   int  m_nISIMax;
+   int  m_nDeadline;    // ms response window
+   int  m_nBreak;       // ms after the block, 0: none, -1: until the pause key
+   MixMode m_nMixMode;
+   QVector<int> m_qvecMixWeights; // Per condition, WeightedMix only
+};
+
+
+/**
+ * @brief The StroopTimelineEvent struct
+ *
+ * One trial of a compiled protocol. All times are relative to the event
+ * before, so the scheduler only reads them.
+ */
+struct StroopTimelineEvent
+{
+   enum Flags { Practice = 1, BreakBefore = 2 };
+
+   qint32 m_nPause;    // ms blank before the fixation point (ISI or break), -1: until the pause key
+   qint32 m_nFixation; // ms from the fixation onset to the stimulus onset
+   qint32 m_nDeadline; // ms from the stimulus onset
+   qint32 m_nFlags;
+};
+
+
+/**
+ * @brief The StroopProtocol class
+ *
+ * Structure of a run, read from an INI file:
+ *
+ *   [Protocol]
+ *   name=Standard
+ *   version=2
+ *   blocks=practice, main, main
+ *
+ *   [practice]
+ *   practice=true
+ *   trials=12
+ *   fixation=800-1200
+ *   isi=300-700
+ *   deadline=2000
+ *   mix=equal
+ *   break=key
+ *
+ * "blocks" lists sections in run order (they may repeat), practice blocks
+ * only at the start. Times are in ms, as a value or a range. "mix" is
+ * equal, proportional (to the templates) or weights such as
+ * "Quads:1, TextConflict:2". "break" after a block is in ms or "key" (until
+ * the pause key). Apart from "trials", missing keys take the values of a
+ * run without protocol.
+ *
+ * Before a run it is compiled once into a flat timeline of one event per
+ * trial and the trial indices of the whole run. Durations drawn from ranges
+ * and the sequence of every block use their own streams of the master seed,
+ * so a run can be compiled again from the seed and the protocol.
+ *
+ * The canonical definition (toStringList()) is stored with each session;
+ * the protocol hash is the SHA-256 of it, so comments and formatting of the
+ * file do not change the hash.
+ */
+class StroopProtocol
+{
+   public:
+      static constexpr int DefaultFixation = 1000; // ms
+
+      StroopProtocol();
+
+      bool load(const QString& filePath, QString* error = nullptr);
+      bool isLoaded() const;
+
+      QString getFilePath() const;
+      QString getName() const;
+      int getVersion() const;
+      QString getHash() const;
+      const QVector<StroopProtocolBlock>& getBlocks() const;
+
+      int getNumTrials() const;
+      int getNumPracticeTrials() const;
+
+      bool compile(quint64 seed, QVector<StroopTimelineEvent>& timeline,
+                   QVector<int>* indices, QString* error = nullptr) const;
+
+      QStringList toStringList() const;
+      static bool fromStringList(const QStringList& definition, StroopProtocol& protocol);
+
+      static StroopProtocol defaultProtocol(int numTrials);
+
+   private:
+      friend struct StroopProtocolBlock; // Parses the stored definition
+
+      bool validate(QString* error) const;
+      static QVector<int> conditionCounts(const StroopProtocolBlock& block,
+                                          const TrialSequenceGenerator& generator);
+
+      static bool parseRange(const QString& str, int& min, int& max);
+      static bool parseMix(const QStringList& mix, StroopProtocolBlock& block);
+
+      QString m_strFilePath;
+      QString m_strName;
+      int     m_nVersion;
+      bool    m_bLoaded;
+      QVector<StroopProtocolBlock> m_qvecBlocks;
+};
@@ -0,0 +1,452 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopRTPlotWidget.h"
+
+#include <QPainter>
+
+#include <algorithm>
+
+
+// Axis range before the first trial (ms), e.g. the fixed deadline
+static constexpr double InitialRTRange = 2000.0;
+
+// Margins around the scatter plot in pixels
+static constexpr int MarginLeft   = 48;
+static constexpr int MarginTop    = 22;
+static constexpr int MarginBottom = 20;
+static constexpr int MarginRight  = 8;
+
+
+/**
+ * @brief StroopRTPlotWidget::StroopRTPlotWidget
+ * @param parent
+ */
+StroopRTPlotWidget::StroopRTPlotWidget(QWidget* parent)
+   : QWidget(parent)
+   , m_nNumRendered(0)
+   , m_nXRange(1)
+   , m_dYRange(InitialRTRange)
+   , m_bLayerValid(false)
+   , m_bPathsValid(false)
+   , m_bLiveRendering(true)
+{
+   setAttribute(Qt::WA_OpaquePaintEvent);
+   clear();
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::startRun
+ * @param numPlannedTrials
+ *
+ * Allocates the points of the whole run, so addTrial() does not allocate.
+ */
+void StroopRTPlotWidget::startRun(int numPlannedTrials)
+{
+   clear();
+
+   m_nXRange = std::max(numPlannedTrials, 1);
+   m_qvecPoints.reserve(m_nXRange);
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::clear
+ */
+void StroopRTPlotWidget::clear()
+{
+   m_qvecPoints.clear();
+   m_nNumRendered = 0;
+   m_nXRange = 1;
+   m_dYRange = InitialRTRange;
+
+   for (std::array<int, NumBins>& bins : m_arrBins) { bins.fill(0); }
+   m_arrMaxBin.fill(0);
+
+   m_bLayerValid = false;
+   m_bPathsValid = false;
+   update();
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::setLiveRendering
+ * @param live False while painting could delay the experiment, e.g. when
+ *        the experiment dialog is full screen
+ */
+void StroopRTPlotWidget::setLiveRendering(bool live)
+{
+   m_bLiveRendering = live;
+
+   if (live) { update(); }
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::getLiveRendering
+ * @return
+ */
+bool StroopRTPlotWidget::getLiveRendering() const
+{
+   return m_bLiveRendering;
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::sizeHint
+ * @return
+ */
+QSize StroopRTPlotWidget::sizeHint() const
+{
+   return QSize(640, 260);
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::minimumSizeHint
+ * @return
+ */
+QSize StroopRTPlotWidget::minimumSizeHint() const
+{
+   return QSize(320, 160);
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::addTrial
+ * @param position Position in the run, starting at 0
+ * @param trial Answered or missed trial
+ *
+ * Called between trials: only stores the point and, with live rendering,
+ * requests a repaint of its surroundings and of the distributions.
+ */
+void StroopRTPlotWidget::addTrial(int position, const StroopTrial& trial)
+{
+   if (!trial.m_bValid && !trial.m_bMissed) { return; }
+
+   PlotPoint point;
+   point.m_nPosition  = position;
+   point.m_fRT        = static_cast<float>(trial.m_i64DecisionTime);
+   point.m_nCondition = static_cast<qint8>(trial.m_nMode);
+   point.m_bCorrect   = trial.m_bCorrect;
+   point.m_bMissed    = trial.m_bMissed;
+
+   // Axes double when exceeded, so complete redraws stay rare
+   while (point.m_nPosition >= m_nXRange) { m_nXRange *= 2; m_bLayerValid = false; }
+   while (point.m_fRT > m_dYRange)        { m_dYRange *= 2.0; m_bLayerValid = false; m_bPathsValid = false; }
+
+   m_qvecPoints.append(point);
+
+   if (!point.m_bMissed)
+   {
+      const int bin = std::min(static_cast<int>(point.m_fRT / BinWidth), NumBins - 1);
+      const int count = ++m_arrBins[point.m_nCondition][bin];
+      m_arrMaxBin[point.m_nCondition] = std::max(m_arrMaxBin[point.m_nCondition], count);
+      m_bPathsValid = false;
+   }
+
+   if (!m_bLiveRendering || !isVisible()) { return; }
+
+   if (m_bLayerValid)
+   {
+      const QPoint center = mapPoint(scatterRect(), point.m_nPosition, point.m_fRT).toPoint();
+      update(QRect(center - QPoint(5, 5), QSize(11, 11)));
+      update(distributionRect());
+   }
+   else
+   {
+      update();
+   }
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::paintEvent
+ * @param event
+ */
+void StroopRTPlotWidget::paintEvent(QPaintEvent* event)
+{
+   Q_UNUSED(event);
+
+   // Without live rendering the last layer is shown as it is
+   if (m_bLiveRendering)
+   {
+      if (!m_bLayerValid) { renderLayer(); }
+      else if (m_nNumRendered < m_qvecPoints.count()) { renderNewPoints(); }
+
+      if (!m_bPathsValid) { rebuildDistributionPaths(); }
+   }
+
+   QPainter painter(this);
+
+   if (m_pixLayer.isNull()) { painter.fillRect(rect(), Qt::white); }
+   else                     { painter.drawPixmap(0, 0, m_pixLayer); }
+
+   const QRect distRect = distributionRect();
+   painter.fillRect(distRect, Qt::white);
+   painter.setPen(Qt::lightGray);
+   painter.drawLine(distRect.topLeft(), distRect.bottomLeft());
+
+   painter.setRenderHint(QPainter::Antialiasing);
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      painter.setPen(QPen(conditionColor(cond), 1.5));
+      painter.drawPath(m_arrPaths[cond]);
+   }
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::resizeEvent
+ * @param event
+ */
+void StroopRTPlotWidget::resizeEvent(QResizeEvent* event)
+{
+   QWidget::resizeEvent(event);
+
+   m_bLayerValid = false;
+   m_bPathsValid = false;
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::scatterRect
+ * @return Area of the RT per trial, left three quarters of the widget
+ */
+QRect StroopRTPlotWidget::scatterRect() const
+{
+   const int scatterWidth = width() * 3 / 4;
+   return QRect(MarginLeft, MarginTop,
+                std::max(scatterWidth - MarginLeft - MarginRight, 1),
+                std::max(height() - MarginTop - MarginBottom, 1));
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::distributionRect
+ * @return Area of the distributions, same RT axis as scatterRect()
+ */
+QRect StroopRTPlotWidget::distributionRect() const
+{
+   const QRect scatter = scatterRect();
+   const int left = scatter.right() + MarginRight;
+
+   return QRect(left, scatter.top(), std::max(width() - left - MarginRight, 1), scatter.height());
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::mapPoint
+ * @param rect
+ * @param position
+ * @param rt ms
+ * @return
+ */
+QPointF StroopRTPlotWidget::mapPoint(const QRect& rect, int position, double rt) const
+{
+   const double x = rect.left() + (position + 0.5) * rect.width() / m_nXRange;
+   return QPointF(x, mapRT(rect, rt));
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::mapRT
+ * @param rect
+ * @param rt ms
+ * @return Vertical pixel position of rt
+ */
+double StroopRTPlotWidget::mapRT(const QRect& rect, double rt) const
+{
+   return rect.bottom() - rt * rect.height() / m_dYRange;
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::renderLayer
+ * Draws axes, legend and all points.
+ */
+void StroopRTPlotWidget::renderLayer()
+{
+   const qreal dpr = devicePixelRatioF();
+   m_pixLayer = QPixmap(size() * dpr);
+   m_pixLayer.setDevicePixelRatio(dpr);
+   m_pixLayer.fill(Qt::white);
+
+   QPainter painter(&m_pixLayer);
+   const QRect rect = scatterRect();
+
+   // RT axis: 4 to 8 ticks
+   double step = 250.0;
+   while (m_dYRange / step > 8.0) { step *= 2.0; }
+
+   painter.setPen(QColor(230, 230, 230));
+   for (double rt=step; rt<=m_dYRange; rt+=step)
+   {
+      const int y = static_cast<int>(mapRT(rect, rt));
+      painter.drawLine(rect.left(), y, rect.right(), y);
+   }
+
+   painter.setPen(Qt::darkGray);
+   painter.drawLine(rect.bottomLeft(), rect.bottomRight());
+   painter.drawLine(rect.bottomLeft(), rect.topLeft());
+
+   for (double rt=0.0; rt<=m_dYRange; rt+=step)
+   {
+      const int y = static_cast<int>(mapRT(rect, rt));
+      painter.drawText(QRect(0, y - 8, MarginLeft - 4, 16), Qt::AlignRight | Qt::AlignVCenter,
+                       QString::number(rt/1000.0, 'f', 2) + " s");
+   }
+
+   // Trial axis: first and last position
+   painter.drawText(QRect(rect.left(), rect.bottom() + 2, 60, MarginBottom - 2),
+                    Qt::AlignLeft | Qt::AlignTop, "1");
+   painter.drawText(QRect(rect.right() - 120, rect.bottom() + 2, 120, MarginBottom - 2),
+                    Qt::AlignRight | Qt::AlignTop, QString("Trial %1").arg(m_nXRange));
+
+   // Legend
+   int x = rect.left();
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      painter.setPen(Qt::NoPen);
+      painter.setBrush(conditionColor(cond));
+      painter.drawEllipse(QPointF(x + 4, MarginTop / 2), 3.5, 3.5);
+
+      const QString name = conditionName(cond);
+      painter.setPen(Qt::black);
+      painter.drawText(QPoint(x + 12, MarginTop / 2 + 4), name);
+      x += 24 + painter.fontMetrics().horizontalAdvance(name);
+   }
+   painter.drawText(QPoint(x + 12, MarginTop / 2 + 4), "(hohl: falsch, x: verpasst)");
+
+   painter.end();
+
+   m_nNumRendered = 0;
+   m_bLayerValid = true;
+   renderNewPoints();
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::renderNewPoints
+ * Draws the points added since the last call into the layer.
+ */
+void StroopRTPlotWidget::renderNewPoints()
+{
+   QPainter painter(&m_pixLayer);
+   painter.setRenderHint(QPainter::Antialiasing);
+
+   const QRect rect = scatterRect();
+   for (int i=m_nNumRendered; i<m_qvecPoints.count(); i++)
+   {
+      drawPoint(painter, rect, m_qvecPoints.at(i));
+   }
+
+   m_nNumRendered = m_qvecPoints.count();
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::drawPoint
+ * @param painter
+ * @param rect
+ * @param point Filled: correct, hollow: wrong, cross: missed (at the deadline)
+ */
+void StroopRTPlotWidget::drawPoint(QPainter& painter, const QRect& rect, const PlotPoint& point) const
+{
+   const QPointF center = mapPoint(rect, point.m_nPosition, point.m_fRT);
+   const QColor color = conditionColor(point.m_nCondition);
+
+   if (point.m_bMissed)
+   {
+      painter.setPen(QPen(color, 1.5));
+      painter.drawLine(center + QPointF(-3, -3), center + QPointF(3, 3));
+      painter.drawLine(center + QPointF(-3, 3), center + QPointF(3, -3));
+   }
+   else
+   {
+      painter.setPen(QPen(color, 1.2));
+      painter.setBrush(point.m_bCorrect ? QBrush(color) : QBrush(Qt::NoBrush));
+      painter.drawEllipse(center, 2.5, 2.5);
+   }
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::rebuildDistributionPaths
+ *
+ * One outline per condition, scaled to its own largest bin. The cost only
+ * depends on the number of bins, not on the number of trials.
+ */
+void StroopRTPlotWidget::rebuildDistributionPaths()
+{
+   const QRect rect = distributionRect();
+   const int numBins = std::min(static_cast<int>(m_dYRange / BinWidth), NumBins);
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      QPainterPath path;
+
+      if (m_arrMaxBin[cond] > 0)
+      {
+         const double scale = rect.width() / static_cast<double>(m_arrMaxBin[cond]);
+
+         path.moveTo(rect.left(), mapRT(rect, 0.0));
+         for (int bin=0; bin<numBins; bin++)
+         {
+            const double x = rect.left() + m_arrBins[cond][bin] * scale;
+            path.lineTo(x, mapRT(rect, bin * BinWidth));
+            path.lineTo(x, mapRT(rect, (bin + 1) * BinWidth));
+         }
+         path.lineTo(rect.left(), mapRT(rect, numBins * BinWidth));
+      }
+
+      m_arrPaths[cond] = path;
+   }
+
+   m_bPathsValid = true;
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::conditionColor
+ * @param condition StroopTrialModes
+ * @return
+ */
+QColor StroopRTPlotWidget::conditionColor(int condition)
+{
+   switch (static_cast<StroopTrialModes>(condition))
+   {
+      case StroopTrialModes::ColoredQuads:            { return QColor(110, 110, 110); }
+      case StroopTrialModes::ColoredTextMatched:      { return QColor( 44, 160,  44); }
+      case StroopTrialModes::ColorTextConflicted:     { return QColor(214,  39,  40); }
+      case StroopTrialModes::ColoredTextUnreferenced: { return QColor( 31, 119, 180); }
+   }
+
+   return Qt::black;
+}
+
+
+/**
+ * @brief StroopRTPlotWidget::conditionName
+ * @param condition StroopTrialModes
+ * @return German legend entry
+ */
+QString StroopRTPlotWidget::conditionName(int condition)
+{
+   switch (static_cast<StroopTrialModes>(condition))
+   {
+      case StroopTrialModes::ColoredQuads:            { return "Farbfelder";  }
+      case StroopTrialModes::ColoredTextMatched:      { return "Kongruent";   }
+      case StroopTrialModes::ColorTextConflicted:     { return "Inkongruent"; }
+      case StroopTrialModes::ColoredTextUnreferenced: { return "Neutral";     }
+   }
+
+   return QString();
+}
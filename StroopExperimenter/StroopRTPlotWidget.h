@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopExperiment.h"
+
+#include <QWidget>
+#include <QPixmap>
+#include <QPainterPath>
+
+#include <array>
+
+
+/**
+ * @brief The StroopRTPlotWidget class
+ *
+ * RT per trial colored by condition, with the RT distribution of each
+ * condition beside it on the same axis. Axes and points are kept in a
+ * pixmap layer: a new trial only draws its own point into the layer, the
+ * distributions are cached paths over fixed 50 ms bins. The layer is only
+ * redrawn completely when the widget is resized or a trial falls outside
+ * the axes, which then double.
+ *
+ * Without live rendering trials are only collected (no painting, no
+ * allocation beyond startRun()); they are drawn once it is enabled again.
+ */
+class StroopRTPlotWidget : public QWidget
+{
+      Q_OBJECT
+
+   public:
+      explicit StroopRTPlotWidget(QWidget* parent = nullptr);
+
+      void startRun(int numPlannedTrials);
+      void clear();
+
+      void setLiveRendering(bool live);
+      bool getLiveRendering() const;
+
+      virtual QSize sizeHint() const;
+      virtual QSize minimumSizeHint() const;
+
+   public slots:
+      void addTrial(int position, const StroopTrial& trial);
+
+   protected:
+      virtual void paintEvent(QPaintEvent* event);
+      virtual void resizeEvent(QResizeEvent* event);
+
+   private:
+      struct PlotPoint
+      {
+         int   m_nPosition;
+         float m_fRT;        // Milliseconds
+         qint8 m_nCondition; // StroopTrialModes
+         bool  m_bCorrect;
+         bool  m_bMissed;
+      };
+
+      static constexpr int    NumBins  = 200;
+      static constexpr double BinWidth = 50.0; // ms
+
+      QRect scatterRect() const;
+      QRect distributionRect() const;
+      QPointF mapPoint(const QRect& rect, int position, double rt) const;
+      double mapRT(const QRect& rect, double rt) const;
+
+      void renderLayer();
+      void renderNewPoints();
+      void drawPoint(QPainter& painter, const QRect& rect, const PlotPoint& point) const;
+      void rebuildDistributionPaths();
+
+      static QColor conditionColor(int condition);
+      static QString conditionName(int condition);
+
+      QVector<PlotPoint> m_qvecPoints;
+      int    m_nNumRendered; // Points already drawn into m_pixLayer
+      int    m_nXRange;      // Trials
+      double m_dYRange;      // ms
+      bool   m_bLayerValid;
+      bool   m_bPathsValid;
+      bool   m_bLiveRendering;
+      QPixmap m_pixLayer;    // Axes, legend and points
+
+      std::array<std::array<int, NumBins>, NumStroopConditions> m_arrBins;
+      std::array<int, NumStroopConditions>                      m_arrMaxBin;
+      std::array<QPainterPath, NumStroopConditions>             m_arrPaths;
+};
@@ -0,0 +1,319 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopReEvaluation.h"
+
+#include <QtConcurrent>
+
+
+/**
+ * @brief StroopFilterPolicy::StroopFilterPolicy
+ * @param type
+ * @param correctOnly Only used by the RT window and the outlier rule
+ * @param minRT Milliseconds
+ * @param maxRT Milliseconds
+ * @param numStDevs
+ * @param excludeStalls
+ */
+StroopFilterPolicy::StroopFilterPolicy(StroopFilterPolicyType type, bool correctOnly,
+                                       double minRT, double maxRT, double numStDevs,
+                                       bool excludeStalls)
+   : m_nType(type)
+   , m_bCorrectOnly(correctOnly)
+   , m_dMinRT(minRT)
+   , m_dMaxRT(maxRT)
+   , m_dNumStDevs(numStDevs)
+   , m_bExcludeStalls(excludeStalls)
+{
+}
+
+
+/**
+ * @brief StroopFilterPolicy::name
+ * @return German label used in CSV headers
+ */
+QString StroopFilterPolicy::name() const
+{
+   const QString suffix = m_bCorrectOnly ? QString(" (korrekt)") : QString();
+   const QString stalls = m_bExcludeStalls ? QString(" ohne Störungen") : QString();
+
+   switch (m_nType)
+   {
+      case StroopFilterPolicyType::AllTrials:   return QString("alle") + stalls;
+      case StroopFilterPolicyType::CorrectOnly: return QString("korrekt") + stalls;
+      case StroopFilterPolicyType::RTWindow:
+         return QString("RT %1-%2ms%3").arg(m_dMinRT).arg(m_dMaxRT).arg(suffix) + stalls;
+      case StroopFilterPolicyType::Outlier:
+         return QString("MW+-%1SD%2").arg(m_dNumStDevs).arg(suffix) + stalls;
+   }
+
+   return QString();
+}
+
+
+/**
+ * @brief StroopFilterPolicy::fromString
+ * @param str "all", "correct", "window:<min>:<max>" or "outlier:<k>";
+ *        window and outlier rule accept the prefix "correct-", all
+ *        policies the prefix "nostall-" (before "correct-")
+ * @param policy Target, only changed on success
+ * @return
+ */
+bool StroopFilterPolicy::fromString(const QString& str, StroopFilterPolicy& policy)
+{
+   QString spec = str.trimmed().toLower();
+
+   bool excludeStalls = false;
+   if (spec.startsWith("nostall-"))
+   {
+      excludeStalls = true;
+      spec.remove(0, 8);
+   }
+
+   if (spec == "all")
+   {
+      policy = StroopFilterPolicy(StroopFilterPolicyType::AllTrials);
+      policy.m_bExcludeStalls = excludeStalls;
+      return true;
+   }
+   if (spec == "correct")
+   {
+      policy = StroopFilterPolicy(StroopFilterPolicyType::CorrectOnly);
+      policy.m_bExcludeStalls = excludeStalls;
+      return true;
+   }
+
+   bool correctOnly = false;
+   if (spec.startsWith("correct-"))
+   {
+      correctOnly = true;
+      spec.remove(0, 8);
+   }
+
+   const QStringList parts = spec.split(":");
+   bool ok1 = false;
+   bool ok2 = false;
+
+   if (parts.count() == 3 && parts.at(0) == "window")
+   {
+      const double minRT = parts.at(1).toDouble(&ok1);
+      const double maxRT = parts.at(2).toDouble(&ok2);
+      if (!ok1 || !ok2 || minRT >= maxRT) { return false; }
+
+      policy = StroopFilterPolicy(StroopFilterPolicyType::RTWindow, correctOnly, minRT, maxRT,
+                                  0.0, excludeStalls);
+      return true;
+   }
+
+   if (parts.count() == 2 && parts.at(0) == "outlier")
+   {
+      const double numStDevs = parts.at(1).toDouble(&ok1);
+      if (!ok1 || numStDevs <= 0.0) { return false; }
+
+      policy = StroopFilterPolicy(StroopFilterPolicyType::Outlier, correctOnly, 0.0, 0.0, numStDevs,
+                                  excludeStalls);
+      return true;
+   }
+
+   return false;
+}
+
+
+/**
+ * @brief StroopFilteredSummary::StroopFilteredSummary
+ */
+StroopFilteredSummary::StroopFilteredSummary()
+{
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      m_nNumTrials[cond] = 0;
+      m_nNumCorrect[cond] = 0;
+      m_nNumAccepted[cond] = 0;
+      m_dMeanRT[cond] = 0.0;
+      m_dStDevRT[cond] = 0.0;
+   }
+}
+
+
+/**
+ * @brief StroopFilteredSummary::interference
+ * @return Mean RT of incongruent minus congruent trials (milliseconds)
+ */
+double StroopFilteredSummary::interference() const
+{
+   const int incongruent = static_cast<int>(StroopTrialModes::ColorTextConflicted);
+   const int congruent = static_cast<int>(StroopTrialModes::ColoredTextMatched);
+
+   if (m_nNumAccepted[incongruent] == 0 || m_nNumAccepted[congruent] == 0) { return 0.0; }
+
+   return m_dMeanRT[incongruent] - m_dMeanRT[congruent];
+}
+
+
+/**
+ * @brief StroopReEvaluation::defaultPolicies
+ * @return All trials, correct trials, correct trials within 200-2000 ms and
+ *         correct trials within 2.5 SD of the condition mean
+ */
+QVector<StroopFilterPolicy> StroopReEvaluation::defaultPolicies()
+{
+   QVector<StroopFilterPolicy> policies;
+   policies.append(StroopFilterPolicy(StroopFilterPolicyType::AllTrials));
+   policies.append(StroopFilterPolicy(StroopFilterPolicyType::CorrectOnly));
+   policies.append(StroopFilterPolicy(StroopFilterPolicyType::RTWindow, true, 200.0, 2000.0));
+   policies.append(StroopFilterPolicy(StroopFilterPolicyType::Outlier, true, 0.0, 0.0, 2.5));
+
+   return policies;
+}
+
+
+/**
+ * @brief StroopReEvaluation::evaluate
+ * @param session
+ * @param policy
+ * @return
+ *
+ * Selects the specialized scan once per session. Trials that overlapped an
+ * event loop stall are removed before the scan if the policy says so.
+ */
+StroopFilteredSummary StroopReEvaluation::evaluate(const StroopSessionColumns& session,
+                                                   const StroopFilterPolicy& policy)
+{
+   if (policy.m_bExcludeStalls)
+   {
+      StroopFilterPolicy withStalls = policy;
+      withStalls.m_bExcludeStalls = false;
+
+      return evaluate(session.withoutStalls(), withStalls);
+   }
+
+   switch (policy.m_nType)
+   {
+      case StroopFilterPolicyType::AllTrials:
+         return scan(session, AllTrialsFilter());
+
+      case StroopFilterPolicyType::CorrectOnly:
+         return scan(session, CorrectOnlyFilter());
+
+      case StroopFilterPolicyType::RTWindow:
+         if (policy.m_bCorrectOnly)
+         {
+            return scan(session, RTWindowFilter<true>{policy.m_dMinRT, policy.m_dMaxRT});
+         }
+         return scan(session, RTWindowFilter<false>{policy.m_dMinRT, policy.m_dMaxRT});
+
+      case StroopFilterPolicyType::Outlier:
+         if (policy.m_bCorrectOnly)
+         {
+            return scan(session, OutlierFilter<true>{policy.m_dNumStDevs, {}, {}});
+         }
+         return scan(session, OutlierFilter<false>{policy.m_dNumStDevs, {}, {}});
+   }
+
+   return StroopFilteredSummary();
+}
+
+
+/**
+ * @brief StroopReEvaluation::evaluateSessions
+ * @param sessions
+ * @param policies
+ * @return Indexed by [session][policy]
+ *
+ * Sessions are evaluated in parallel on the global QThreadPool.
+ */
+QVector<QVector<StroopFilteredSummary>> StroopReEvaluation::evaluateSessions(
+      const QVector<StroopSessionColumns>& sessions,
+      const QVector<StroopFilterPolicy>& policies)
+{
+   std::function<QVector<StroopFilteredSummary>(const StroopSessionColumns&)> evaluateAll =
+         [&policies](const StroopSessionColumns& session)
+   {
+      QVector<StroopFilteredSummary> summaries;
+      summaries.reserve(policies.count());
+
+      for (const StroopFilterPolicy& policy : policies)
+      {
+         summaries.append(evaluate(session, policy));
+      }
+
+      return summaries;
+   };
+
+   return QtConcurrent::blockingMapped< QVector<QVector<StroopFilteredSummary>> >(sessions, evaluateAll);
+}
+
+
+/**
+ * @brief StroopReEvaluation::csvHeaders
+ * @param policies
+ * @return Person, session and condition columns followed by one group of
+ *         columns per policy
+ */
+QStringList StroopReEvaluation::csvHeaders(const QVector<StroopFilterPolicy>& policies)
+{
+   QStringList headers;
+   headers << "Versuchsperson" << "Sitzung" << "Zeitstempel" << "Modus"
+           << "Trials" << "Korrekt";
+
+   for (const StroopFilterPolicy& policy : policies)
+   {
+      const QString name = policy.name();
+      headers << QString("%1 n").arg(name)
+              << QString("%1 MW(ms)").arg(name)
+              << QString("%1 SD(ms)").arg(name);
+   }
+
+   return headers;
+}
+
+
+/**
+ * @brief StroopReEvaluation::csvRows
+ * @param personID
+ * @param session
+ * @param timeStamp
+ * @param summaries One entry per policy, in the order of csvHeaders()
+ * @return One row per condition plus one row with the interference effect
+ */
+QVector<QStringList> StroopReEvaluation::csvRows(const QString& personID, const QString& session,
+                                                 const QString& timeStamp,
+                                                 const QVector<StroopFilteredSummary>& summaries)
+{
+   QVector<QStringList> rows;
+   if (summaries.isEmpty()) { return rows; }
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      QStringList row;
+      row << personID << session << timeStamp
+          << StroopTrial::modeToString(static_cast<StroopTrialModes>(cond))
+          << QString::number(summaries.first().m_nNumTrials[cond])
+          << QString::number(summaries.first().m_nNumCorrect[cond]);
+
+      for (const StroopFilteredSummary& summary : summaries)
+      {
+         row << QString::number(summary.m_nNumAccepted[cond])
+             << QString::number(summary.m_dMeanRT[cond], 'f', 1)
+             << QString::number(summary.m_dStDevRT[cond], 'f', 1);
+      }
+
+      rows.append(row);
+   }
+
+   QStringList row;
+   row << personID << session << timeStamp << "Interferenz" << "" << "";
+   for (const StroopFilteredSummary& summary : summaries)
+   {
+      row << "" << QString::number(summary.interference(), 'f', 1) << "";
+   }
+   rows.append(row);
+
+   return rows;
+}
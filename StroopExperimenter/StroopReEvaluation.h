@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopStatistics.h"
+#include <QVector>
+#include <QStringList>
+
+#include <cmath>
+#include <algorithm>
+
+
+enum struct StroopFilterPolicyType { AllTrials, CorrectOnly, RTWindow, Outlier };
+
+
+/**
+ * @brief The StroopFilterPolicy struct
+ *
+ * Runtime description of a trial filter. The filter itself is chosen once
+ * per session in StroopReEvaluation::evaluate(); the scan over the trials
+ * is instantiated for each filter type and contains no checks of these
+ * fields.
+ */
+struct StroopFilterPolicy
+{
+   StroopFilterPolicy(StroopFilterPolicyType type = StroopFilterPolicyType::AllTrials,
+                      bool correctOnly = false, double minRT = 0.0, double maxRT = 0.0,
+                      double numStDevs = 0.0, bool excludeStalls = false);
+
+   QString name() const;
+   static bool fromString(const QString& str, StroopFilterPolicy& policy);
+
+   StroopFilterPolicyType m_nType;
+   bool   m_bCorrectOnly; // RT window and outlier rule: start from the correct trials
+   double m_dMinRT;       // RT window (milliseconds)
+   double m_dMaxRT;
+   double m_dNumStDevs;   // Outlier rule: limit in standard deviations of the condition
+   bool   m_bExcludeStalls; // Drop trials that overlapped an event loop stall first
+};
+
+
+/**
+ * @brief The StroopFilteredSummary struct
+ *
+ * Result of one policy applied to one session, indexed by StroopTrialModes.
+ */
+struct StroopFilteredSummary
+{
+   StroopFilteredSummary();
+
+   double interference() const;
+
+   int    m_nNumTrials[NumStroopConditions];
+   int    m_nNumCorrect[NumStroopConditions];
+   int    m_nNumAccepted[NumStroopConditions];
+   double m_dMeanRT[NumStroopConditions];   // Milliseconds, accepted trials
+   double m_dStDevRT[NumStroopConditions];
+};
+
+
+// Trial filters. accept() returns 0 or 1 and is evaluated for every trial
+// without branches, the result is used as a weight in the scan.
+
+struct AllTrialsFilter
+{
+   void prepare(const StroopSessionColumns&) {}
+   inline double accept(quint8, double, int) const { return 1.0; }
+};
+
+struct CorrectOnlyFilter
+{
+   void prepare(const StroopSessionColumns&) {}
+   inline double accept(quint8 correct, double, int) const { return correct; }
+};
+
+template<bool CorrectOnly>
+struct RTWindowFilter
+{
+   void prepare(const StroopSessionColumns&) {}
+
+   inline double accept(quint8 correct, double rt, int) const
+   {
+      return (CorrectOnly ? correct : 1) & (rt >= m_dMinRT) & (rt <= m_dMaxRT);
+   }
+
+   double m_dMinRT;
+   double m_dMaxRT;
+};
+
+template<bool CorrectOnly>
+struct OutlierFilter
+{
+   // Limits are mean +/- k standard deviations of the (correct) trials of
+   // the same condition within the session.
+   void prepare(const StroopSessionColumns& session)
+   {
+      double n[NumStroopConditions] = {};
+      double sum[NumStroopConditions] = {};
+      double sumSq[NumStroopConditions] = {};
+
+      const int numTrials = session.count();
+      for (int i=0; i<numTrials; i++)
+      {
+         const int cond = session.m_qvecCondition.at(i);
+         const double w = CorrectOnly ? session.m_qvecCorrect.at(i) : 1.0;
+         const double rt = session.m_qvecRT.at(i);
+         n[cond] += w;
+         sum[cond] += w * rt;
+         sumSq[cond] += w * rt * rt;
+      }
+
+      for (int cond=0; cond<NumStroopConditions; cond++)
+      {
+         const double mean = (n[cond] > 0.0) ? sum[cond] / n[cond] : 0.0;
+         const double var = (n[cond] > 1.0)
+               ? std::max(0.0, (sumSq[cond] - n[cond] * mean * mean) / (n[cond] - 1.0)) : 0.0;
+         m_dLow[cond]  = mean - m_dNumStDevs * std::sqrt(var);
+         m_dHigh[cond] = mean + m_dNumStDevs * std::sqrt(var);
+      }
+   }
+
+   inline double accept(quint8 correct, double rt, int cond) const
+   {
+      return (CorrectOnly ? correct : 1) & (rt >= m_dLow[cond]) & (rt <= m_dHigh[cond]);
+   }
+
+   double m_dNumStDevs;
+   double m_dLow[NumStroopConditions];
+   double m_dHigh[NumStroopConditions];
+};
+
+
+/**
+ * @brief The StroopReEvaluation class
+ *
+ * Applies filter policies to stored sessions after the fact, independent of
+ * the evaluation mode that was active when the sessions were recorded.
+ */
+class StroopReEvaluation
+{
+   public:
+      static QVector<StroopFilterPolicy> defaultPolicies();
+
+      template<typename Filter>
+      static StroopFilteredSummary scan(const StroopSessionColumns& session, Filter filter);
+
+      static StroopFilteredSummary evaluate(const StroopSessionColumns& session,
+                                            const StroopFilterPolicy& policy);
+
+      static QVector<QVector<StroopFilteredSummary>> evaluateSessions(
+            const QVector<StroopSessionColumns>& sessions,
+            const QVector<StroopFilterPolicy>& policies);
+
+      static QStringList csvHeaders(const QVector<StroopFilterPolicy>& policies);
+      static QVector<QStringList> csvRows(const QString& personID, const QString& session,
+                                          const QString& timeStamp,
+                                          const QVector<StroopFilteredSummary>& summaries);
+};
+
+
+/**
+ * @brief StroopReEvaluation::scan
+ * @param session
+ * @param filter
+ * @return
+ *
+ * Single pass over the columns; the filter is inlined and its result is
+ * used as a weight, so the loop body is the same for every trial.
+ */
+template<typename Filter>
+StroopFilteredSummary StroopReEvaluation::scan(const StroopSessionColumns& session, Filter filter)
+{
+   filter.prepare(session);
+
+   double n[NumStroopConditions] = {};
+   double sum[NumStroopConditions] = {};
+   double sumSq[NumStroopConditions] = {};
+
+   StroopFilteredSummary summary;
+
+   const qint8*  conditions = session.m_qvecCondition.constData();
+   const quint8* correct    = session.m_qvecCorrect.constData();
+   const double* rts        = session.m_qvecRT.constData();
+
+   const int numTrials = session.count();
+   for (int i=0; i<numTrials; i++)
+   {
+      const int cond = conditions[i];
+      const double rt = rts[i];
+      const double w = filter.accept(correct[i], rt, cond);
+
+      summary.m_nNumTrials[cond]++;
+      summary.m_nNumCorrect[cond] += correct[i];
+      n[cond] += w;
+      sum[cond] += w * rt;
+      sumSq[cond] += w * rt * rt;
+   }
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      summary.m_nNumAccepted[cond] = static_cast<int>(n[cond]);
+
+      if (n[cond] > 0.0)
+      {
+         const double mean = sum[cond] / n[cond];
+         summary.m_dMeanRT[cond] = mean;
+         summary.m_dStDevRT[cond] = (n[cond] > 1.0)
+               ? std::sqrt(std::max(0.0, (sumSq[cond] - n[cond] * mean * mean) / (n[cond] - 1.0)))
+               : 0.0;
+      }
+   }
+
+   return summary;
+}
@@ -0,0 +1,392 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopSessionHistoryModel.h"
+#include "StroopStatistics.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+
+/**
+ * @brief StroopSessionHistoryModel::StroopSessionHistoryModel
+ * @param parent
+ */
+StroopSessionHistoryModel::StroopSessionHistoryModel(QObject* parent)
+   : QAbstractTableModel(parent)
+   , m_nSortColumn(SessionColumn)
+   , m_nSortOrder(Qt::AscendingOrder)
+   , m_u64Generation(0ULL)
+   , m_u64SessionGeneration(0ULL)
+{
+   connect(&m_arrangementWatcher, &QFutureWatcher<Arrangement>::finished,
+           this, &StroopSessionHistoryModel::onArrangementFinished);
+   connect(&m_sessionWatcher, &QFutureWatcher<LoadedSession>::finished,
+           this, &StroopSessionHistoryModel::onSessionFinished);
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::setStore
+ * @param store Result map of the participant, see StroopExperiment::getDataToSave()
+ *
+ * Reads the date and stored summary of each run only.
+ */
+void StroopSessionHistoryModel::setStore(const QMap<QString, QVariant>& store)
+{
+   const int numSessions = StroopExperiment::countSessions(store);
+
+   beginResetModel();
+
+   m_qmapStore = store;
+
+   m_strlTimeStamps.clear();
+   m_qvecSummaries.clear();
+   m_qvecRows.clear();
+
+   for (int n=1; n<=numSessions; n++)
+   {
+      // Element 0 of "StroopResults_N" is the date, the list is not copied
+      const QStringList results = store.value(StroopExperiment::resultsKey(n)).toStringList();
+      m_strlTimeStamps.append((!results.isEmpty() && results.first().contains(":"))
+                              ? results.first() : QString());
+
+      m_qvecSummaries.append(StroopSessionSummary::fromString(
+                                store.value(StroopExperiment::sessionKey(n, "summary")).toString()));
+      m_qvecRows.append(n - 1);
+   }
+
+   endResetModel();
+
+   // Rows are shown in session order until the first arrangement is done
+   arrange();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::setFilterText
+ * @param text Shows only runs whose number or date contains text
+ */
+void StroopSessionHistoryModel::setFilterText(const QString& text)
+{
+   if (text == m_strFilterText) { return; }
+
+   m_strFilterText = text;
+   arrange();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::sessionNumber
+ * @param row
+ * @return Session number starting at 1, 0 for an invalid row
+ */
+int StroopSessionHistoryModel::sessionNumber(int row) const
+{
+   if (row < 0 || row >= m_qvecRows.count()) { return 0; }
+
+   return m_qvecRows.at(row) + 1;
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::rowOfSession
+ * @param sessionNumber
+ * @return -1 if the session is filtered out
+ */
+int StroopSessionHistoryModel::rowOfSession(int sessionNumber) const
+{
+   return m_qvecRows.indexOf(sessionNumber - 1);
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::loadSession
+ * @param row
+ *
+ * Decodes the trials of the run in the background and emits
+ * sessionLoaded(). A later call supersedes a pending one.
+ */
+void StroopSessionHistoryModel::loadSession(int row)
+{
+   const int n = sessionNumber(row);
+   if (n == 0) { return; }
+
+   m_u64SessionGeneration++;
+   m_sessionWatcher.setFuture(QtConcurrent::run(&StroopSessionHistoryModel::decodeSession,
+                                                m_u64SessionGeneration, m_qmapStore, n));
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::sort
+ * @param column
+ * @param order
+ */
+void StroopSessionHistoryModel::sort(int column, Qt::SortOrder order)
+{
+   if (column < 0 || column >= NumColumns) { return; }
+
+   m_nSortColumn = column;
+   m_nSortOrder = order;
+   arrange();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::arrange
+ * Starts a background job for the current store, sorting and filter.
+ */
+void StroopSessionHistoryModel::arrange()
+{
+   m_u64Generation++;
+   m_arrangementWatcher.setFuture(QtConcurrent::run(&StroopSessionHistoryModel::arrangeSessions,
+                                                    m_u64Generation, m_qmapStore,
+                                                    m_strlTimeStamps, m_qvecSummaries,
+                                                    m_nSortColumn, m_nSortOrder,
+                                                    m_strFilterText));
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::arrangeSessions
+ * @param generation
+ * @param store
+ * @param timeStamps
+ * @param summaries Stored summaries; invalid ones are computed from the trials
+ * @param sortColumn
+ * @param sortOrder
+ * @param filterText
+ * @return
+ *
+ * Runs on the thread pool, works on copies only.
+ */
+StroopSessionHistoryModel::Arrangement StroopSessionHistoryModel::arrangeSessions(
+      quint64 generation, const QMap<QString, QVariant>& store,
+      const QStringList& timeStamps, QVector<StroopSessionSummary> summaries,
+      int sortColumn, Qt::SortOrder sortOrder, const QString& filterText)
+{
+   Arrangement arrangement;
+   arrangement.m_u64Generation = generation;
+
+   // Runs recorded before summaries were stored
+   for (int i=0; i<summaries.count(); i++)
+   {
+      if (summaries.at(i).m_bValid) { continue; }
+
+      const int n = i + 1;
+      int numMisses = store.value(StroopExperiment::sessionKey(n, "misses")).toStringList().count();
+
+      const int numChunks = store.value(StroopExperiment::sessionKey(n, "numChunks"), 0).toInt();
+      for (int k=0; k<numChunks; k++)
+      {
+         numMisses += store.value(StroopExperiment::sessionKey(n, QString("misses_%1").arg(k)))
+                      .toStringList().count();
+      }
+
+      summaries[i] = StroopSessionSummary::fromColumns(
+                        StroopSessionColumns::fromSerialized(StroopExperiment::sessionResults(store, n)),
+                        numMisses);
+   }
+
+   QVector<int> rows;
+   rows.reserve(summaries.count());
+   for (int i=0; i<summaries.count(); i++)
+   {
+      if (filterText.isEmpty()
+          || QString::number(i + 1).contains(filterText)
+          || timeStamps.at(i).contains(filterText, Qt::CaseInsensitive))
+      {
+         rows.append(i);
+      }
+   }
+
+   auto sortKey = [&summaries, sortColumn](int i) -> double
+   {
+      const StroopSessionSummary& summary = summaries.at(i);
+
+      switch (sortColumn)
+      {
+         case TrialsColumn:        return summary.m_nNumAnswered;
+         case CorrectColumn:       return summary.m_nNumCorrect;
+         case WrongColumn:         return summary.numWrong();
+         case MissesColumn:        return summary.m_nNumMisses;
+         case MeanRTColumn:        return summary.m_dMeanRT;
+         case StdDevRTColumn:      return summary.m_dStdDevRT;
+         case MeanCorrectRTColumn: return summary.m_dMeanCorrectRT;
+         default: { break; }
+      }
+
+      return i; // Session and date: runs are stored in chronological order
+   };
+
+   std::stable_sort(rows.begin(), rows.end(), [&sortKey, sortOrder](int a, int b)
+   {
+      return (sortOrder == Qt::AscendingOrder) ? sortKey(a) < sortKey(b)
+                                               : sortKey(b) < sortKey(a);
+   });
+
+   arrangement.m_qvecSummaries = summaries;
+   arrangement.m_qvecRows = rows;
+
+   return arrangement;
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::decodeSession
+ * @param generation
+ * @param store
+ * @param sessionNumber
+ * @return
+ *
+ * Runs on the thread pool.
+ */
+StroopSessionHistoryModel::LoadedSession StroopSessionHistoryModel::decodeSession(
+      quint64 generation, const QMap<QString, QVariant>& store, int sessionNumber)
+{
+   LoadedSession session;
+   session.m_u64Generation = generation;
+   session.m_nSessionNumber = sessionNumber;
+
+   const QStringList results = StroopExperiment::sessionResults(store, sessionNumber);
+
+   const int first = (!results.isEmpty() && results.first().contains(":")) ? 1 : 0;
+
+   session.m_qvecTrials.reserve(results.count() - first);
+   for (int idx=first; idx<results.count(); idx++)
+   {
+      const QStringList values = results.at(idx).split("&");
+      if (values.count() < 6) { continue; }
+
+      session.m_qvecTrials.append(StroopTrial::fromStringList(values));
+   }
+
+   return session;
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::onArrangementFinished
+ */
+void StroopSessionHistoryModel::onArrangementFinished()
+{
+   const Arrangement arrangement = m_arrangementWatcher.result();
+   if (arrangement.m_u64Generation != m_u64Generation) { return; }
+
+   beginResetModel();
+   m_qvecSummaries = arrangement.m_qvecSummaries;
+   m_qvecRows = arrangement.m_qvecRows;
+   endResetModel();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::onSessionFinished
+ */
+void StroopSessionHistoryModel::onSessionFinished()
+{
+   const LoadedSession session = m_sessionWatcher.result();
+   if (session.m_u64Generation != m_u64SessionGeneration) { return; }
+
+   emit sessionLoaded(session.m_nSessionNumber, session.m_qvecTrials);
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::rowCount
+ * @param parent
+ * @return
+ */
+int StroopSessionHistoryModel::rowCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : m_qvecRows.count();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::columnCount
+ * @param parent
+ * @return
+ */
+int StroopSessionHistoryModel::columnCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : NumColumns;
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::data
+ * @param index
+ * @param role
+ * @return Empty summary cells until a missing summary is computed
+ */
+QVariant StroopSessionHistoryModel::data(const QModelIndex& index, int role) const
+{
+   if (!index.isValid() || index.row() >= m_qvecRows.count()) { return QVariant(); }
+
+   if (role == Qt::TextAlignmentRole)
+   {
+      const bool numeric = index.column() != DateColumn;
+      return int(numeric ? (Qt::AlignRight | Qt::AlignVCenter) : (Qt::AlignLeft | Qt::AlignVCenter));
+   }
+
+   if (role != Qt::DisplayRole) { return QVariant(); }
+
+   const int i = m_qvecRows.at(index.row());
+   const StroopSessionSummary& summary = m_qvecSummaries.at(i);
+
+   if (index.column() == SessionColumn) { return i + 1; }
+   if (index.column() == DateColumn)    { return m_strlTimeStamps.at(i); }
+   if (!summary.m_bValid)               { return QVariant(); }
+
+   switch (index.column())
+   {
+      case TrialsColumn:        return summary.m_nNumAnswered;
+      case CorrectColumn:       return summary.m_nNumCorrect;
+      case WrongColumn:         return summary.numWrong();
+      case MissesColumn:        return summary.m_nNumMisses;
+      case MeanRTColumn:        return QString::number(summary.m_dMeanRT/1000.0, 'f', 3);
+      case StdDevRTColumn:      return QString::number(summary.m_dStdDevRT/1000.0, 'f', 3);
+      case MeanCorrectRTColumn: return QString::number(summary.m_dMeanCorrectRT/1000.0, 'f', 3);
+      default: { break; }
+   }
+
+   return QVariant();
+}
+
+
+/**
+ * @brief StroopSessionHistoryModel::headerData
+ * @param section
+ * @param orientation
+ * @param role
+ * @return
+ */
+QVariant StroopSessionHistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+   if (role != Qt::DisplayRole || orientation != Qt::Horizontal) { return QVariant(); }
+
+   switch (section)
+   {
+      case SessionColumn:       return QStringLiteral("Sitzung");
+      case DateColumn:          return QStringLiteral("Datum");
+      case TrialsColumn:        return QStringLiteral("Beantwortet");
+      case CorrectColumn:       return QStringLiteral("Korrekt");
+      case WrongColumn:         return QStringLiteral("Falsch");
+      case MissesColumn:        return QStringLiteral("Verpasst");
+      case MeanRTColumn:        return QStringLiteral("Mittelwert RT (s)");
+      case StdDevRTColumn:      return QStringLiteral("STD RT (s)");
+      case MeanCorrectRTColumn: return QStringLiteral("Mittelwert RT korrekt (s)");
+      default: { break; }
+   }
+
+   return QVariant();
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopExperiment.h"
+#include "StroopAggregates.h"
+
+#include <QAbstractTableModel>
+#include <QFutureWatcher>
+
+
+/**
+ * @brief The StroopSessionHistoryModel class
+ *
+ * One row per run of the loaded participant. Only the date and the stored
+ * summary ("StroopSession_N/summary") of each run are read when the store
+ * is set; the trials are decoded on request by loadSession(). Sorting,
+ * filtering and the summaries of runs stored without one are computed on
+ * the thread pool, the model is reset with the result.
+ */
+class StroopSessionHistoryModel : public QAbstractTableModel
+{
+      Q_OBJECT
+
+   public:
+      enum Column
+      {
+         SessionColumn, DateColumn, TrialsColumn, CorrectColumn, WrongColumn,
+         MissesColumn, MeanRTColumn, StdDevRTColumn, MeanCorrectRTColumn,
+         NumColumns
+      };
+
+      explicit StroopSessionHistoryModel(QObject* parent = nullptr);
+
+      void setStore(const QMap<QString, QVariant>& store);
+      void setFilterText(const QString& text);
+
+      int sessionNumber(int row) const;
+      int rowOfSession(int sessionNumber) const;
+      void loadSession(int row);
+
+      virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+      virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+      virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+      virtual QVariant headerData(int section, Qt::Orientation orientation,
+                                  int role = Qt::DisplayRole) const;
+      virtual void sort(int column, Qt::SortOrder order = Qt::AscendingOrder);
+
+   signals:
+      void sessionLoaded(int sessionNumber, const QVector<StroopTrial>& trials);
+
+   private slots:
+      void onArrangementFinished();
+      void onSessionFinished();
+
+   private:
+      // Result of a background job, applied if no newer job was started
+      struct Arrangement
+      {
+         quint64 m_u64Generation;
+         QVector<StroopSessionSummary> m_qvecSummaries;
+         QVector<int> m_qvecRows;
+      };
+
+      struct LoadedSession
+      {
+         quint64 m_u64Generation;
+         int m_nSessionNumber;
+         QVector<StroopTrial> m_qvecTrials;
+      };
+
+      void arrange();
+
+      static Arrangement arrangeSessions(quint64 generation,
+                                         const QMap<QString, QVariant>& store,
+                                         const QStringList& timeStamps,
+                                         QVector<StroopSessionSummary> summaries,
+                                         int sortColumn, Qt::SortOrder sortOrder,
+                                         const QString& filterText);
+      static LoadedSession decodeSession(quint64 generation,
+                                         const QMap<QString, QVariant>& store,
+                                         int sessionNumber);
+
+      QMap<QString, QVariant> m_qmapStore; // Implicitly shared with the experiment
+
+      QStringList m_strlTimeStamps;                  // Indexed by session number - 1...
+      QVector<StroopSessionSummary> m_qvecSummaries; // ...as well
+      QVector<int> m_qvecRows;                       // Session number - 1 of each row
+
+      int m_nSortColumn;
+      Qt::SortOrder m_nSortOrder;
+      QString m_strFilterText;
+
+      quint64 m_u64Generation;        // Store, sorting or filter changed
+      quint64 m_u64SessionGeneration; // Latest loadSession()
+      QFutureWatcher<Arrangement>   m_arrangementWatcher;
+      QFutureWatcher<LoadedSession> m_sessionWatcher;
+};
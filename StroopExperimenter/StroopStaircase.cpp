@@ -0,0 +1,177 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopStaircase.h"
+#include "StroopExperiment.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+/**
+ * @brief WeightedStaircase::WeightedStaircase
+ * @param startMs Initial deadline
+ * @param stepDownMs Step after a correct response
+ * @param targetAccuracy Proportion correct to converge to, in (0, 1)
+ */
+WeightedStaircase::WeightedStaircase(double startMs, double stepDownMs, double targetAccuracy)
+   : m_dDeadline(startMs)
+   , m_dStepDown(stepDownMs)
+   , m_dStepUp(stepDownMs * targetAccuracy / (1.0 - targetAccuracy))
+   , m_nNumReversals(0)
+   , m_nLastDirection(0)
+{
+}
+
+
+/**
+ * @brief WeightedStaircase::update
+ * @param correct False for errors and misses
+ */
+void WeightedStaircase::update(bool correct)
+{
+   const int direction = correct ? -1 : 1;
+
+   if (m_nLastDirection != 0 && direction != m_nLastDirection) { m_nNumReversals++; }
+   m_nLastDirection = direction;
+
+   const double factor = (m_nNumReversals == 0) ? 2.0 : 1.0;
+   const double step = correct ? -m_dStepDown : m_dStepUp;
+
+   m_dDeadline = std::clamp(m_dDeadline + factor * step,
+                            StroopDeadlineStaircase::MinDeadline,
+                            StroopDeadlineStaircase::MaxDeadline);
+}
+
+
+/**
+ * @brief WeightedStaircase::getDeadline
+ * @return Deadline in milliseconds
+ */
+int WeightedStaircase::getDeadline() const
+{
+   return static_cast<int>(std::lround(m_dDeadline));
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::StroopDeadlineStaircase
+ * @param targetAccuracy
+ */
+StroopDeadlineStaircase::StroopDeadlineStaircase(double targetAccuracy)
+   : m_dTargetAccuracy(targetAccuracy)
+{
+   reset();
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::reset
+ * Starts all conditions at the fixed deadline again.
+ */
+void StroopDeadlineStaircase::reset()
+{
+   m_qvecStaircases = QVector<WeightedStaircase>(NumStroopConditions,
+                                                 WeightedStaircase(FixedDeadline, 40.0,
+                                                                   m_dTargetAccuracy));
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::setTargetAccuracy
+ * @param targetAccuracy Clamped to [0.5, 0.95]; resets the staircases
+ */
+void StroopDeadlineStaircase::setTargetAccuracy(double targetAccuracy)
+{
+   m_dTargetAccuracy = std::clamp(targetAccuracy, 0.5, 0.95);
+   reset();
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::getTargetAccuracy
+ * @return
+ */
+double StroopDeadlineStaircase::getTargetAccuracy() const
+{
+   return m_dTargetAccuracy;
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::getDeadline
+ * @param condition See StroopTrialModes
+ * @return Current deadline of the condition in milliseconds
+ */
+int StroopDeadlineStaircase::getDeadline(int condition) const
+{
+   return m_qvecStaircases.at(condition).getDeadline();
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::update
+ * @param condition See StroopTrialModes
+ * @param correct False for errors and misses
+ */
+void StroopDeadlineStaircase::update(int condition, bool correct)
+{
+   m_qvecStaircases[condition].update(correct);
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::deadlinesToStringList
+ * @return "Mode&deadline(ms)&reversals" per condition
+ */
+QStringList StroopDeadlineStaircase::deadlinesToStringList() const
+{
+   QStringList result;
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const WeightedStaircase& staircase = m_qvecStaircases.at(cond);
+
+      result.append(StroopTrial::modeToString(static_cast<StroopTrialModes>(cond))
+                    + "&" + QString::number(staircase.getDeadline())
+                    + "&" + QString::number(staircase.m_nNumReversals));
+   }
+
+   return result;
+}
+
+
+/**
+ * @brief StroopDeadlineStaircase::deadlinesFromStringList
+ * @param deadlines As written by deadlinesToStringList()
+ * @return
+ *
+ * Continues the staircases of a stored session. The doubled initial
+ * steps are skipped for conditions that already had reversals.
+ */
+bool StroopDeadlineStaircase::deadlinesFromStringList(const QStringList& deadlines)
+{
+   if (deadlines.count() != NumStroopConditions) { return false; }
+
+   reset();
+
+   for (const QString& entry : deadlines)
+   {
+      const QStringList values = entry.split("&");
+      if (values.count() < 3) { return false; }
+
+      const int cond = static_cast<int>(StroopTrial::modeFromString(values.at(0)));
+
+      WeightedStaircase& staircase = m_qvecStaircases[cond];
+      staircase.m_dDeadline = std::clamp(values.at(1).toDouble(), MinDeadline, MaxDeadline);
+      staircase.m_nNumReversals = values.at(2).toInt();
+   }
+
+   return true;
+}
@@ -0,0 +1,69 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QStringList>
+
+
+/**
+ * @brief The WeightedStaircase struct
+ *
+ * Weighted up/down staircase (Kaernbach 1991) on a response deadline: a
+ * correct response shortens the deadline by one step, an error or a miss
+ * lengthens it by step * p / (1 - p). The deadline settles where the
+ * accuracy equals the target accuracy p. Steps are doubled until the first
+ * reversal to approach the threshold quickly.
+ */
+struct WeightedStaircase
+{
+   WeightedStaircase(double startMs = 2000.0, double stepDownMs = 40.0,
+                     double targetAccuracy = 0.8);
+
+   void update(bool correct);
+   int getDeadline() const;
+
+   double m_dDeadline;     // Milliseconds
+   double m_dStepDown;
+   double m_dStepUp;
+   int    m_nNumReversals;
+   int    m_nLastDirection; // -1: shortened, +1: lengthened, 0: no update yet
+};
+
+
+/**
+ * @brief The StroopDeadlineStaircase class
+ *
+ * One weighted staircase per condition.
+ */
+class StroopDeadlineStaircase
+{
+   public:
+      static constexpr double MinDeadline = 250.0;  // ms
+      static constexpr double MaxDeadline = 3000.0; // ms
+      static constexpr double FixedDeadline = 2000.0; // ms, non-adaptive mode
+
+      explicit StroopDeadlineStaircase(double targetAccuracy = 0.8);
+
+      void reset();
+
+      void setTargetAccuracy(double targetAccuracy);
+      double getTargetAccuracy() const;
+
+      int getDeadline(int condition) const;
+      void update(int condition, bool correct);
+
+      QStringList deadlinesToStringList() const;
+      bool deadlinesFromStringList(const QStringList& deadlines);
+
+   private:
+      double m_dTargetAccuracy;
+      QVector<WeightedStaircase> m_qvecStaircases;
+};
@@ -0,0 +1,1286 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopStatistics.h"
+
+#include <QtConcurrent>
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+
+// Constants of the standard normal distribution
+static constexpr double InvSqrt2   = 0.70710678118654752440;
+static constexpr double InvSqrt2Pi = 0.39894228040143267794;
+static constexpr double LogSqrt2Pi = 0.91893853320467274178;
+static constexpr double Pi         = 3.14159265358979323846;
+
+// Scaling parameter of the diffusion process (conventional value)
+static constexpr double DiffusionScaling = 0.1;
+
+// Lower bound of a single trial's log-likelihood, e.g. for RTs below Ter
+static constexpr double WienerLogDensityFloor = -23.0;
+
+
+/**
+ * @brief logNormalCdfAndMillsRatio
+ * @param z
+ * @param logCdf Receives log(Phi(z))
+ * @param millsRatio Receives phi(z) / Phi(z)
+ *
+ * Far in the left tail Phi(z) underflows, so an asymptotic expansion is used there.
+ */
+static inline void logNormalCdfAndMillsRatio(double z, double& logCdf, double& millsRatio)
+{
+   if (z > -30.0)
+   {
+      const double cdf = 0.5 * std::erfc(-z * InvSqrt2);
+      const double pdf = std::exp(-0.5 * z * z) * InvSqrt2Pi;
+
+      logCdf = std::log(cdf);
+      millsRatio = pdf / cdf;
+   }
+   else
+   {
+      const double z2 = z * z;
+      const double series = 1.0 - 1.0 / z2 + 3.0 / (z2 * z2);
+
+      logCdf = -0.5 * z2 - std::log(-z) - LogSqrt2Pi + std::log(series);
+      millsRatio = -z / series;
+   }
+}
+
+
+/**
+ * @brief standardWienerDensity
+ * @param u Normalized decision time t/a^2
+ * @return First-passage-time density of a Wiener process without drift,
+ *         boundaries 0 and 1 and starting point 0.5 (Navarro & Fuss, 2009)
+ *
+ * The small-time series converges fast for u < 1, the large-time series
+ * for u >= 1. Only used to fill the lookup table.
+ */
+static double standardWienerDensity(double u)
+{
+   const double w = 0.5;
+
+   if (u < 1.0)
+   {
+      double sum = 0.0;
+      for (int k=-10; k<=10; k++)
+      {
+         const double wk = w + 2.0 * k;
+         sum += wk * std::exp(-wk * wk / (2.0 * u));
+      }
+      return sum / std::sqrt(2.0 * Pi * u * u * u);
+   }
+
+   double sum = 0.0;
+   for (int k=1; k<=40; k++)
+   {
+      sum += k * std::exp(-k * k * Pi * Pi * u / 2.0) * std::sin(k * Pi * w);
+   }
+   return Pi * sum;
+}
+
+
+/**
+ * @brief StroopSessionColumns::fromSerialized
+ * @param serialized List as stored under "StroopResults_N"
+ * @return
+ */
+StroopSessionColumns StroopSessionColumns::fromSerialized(const QStringList& serialized)
+{
+   StroopSessionColumns session;
+
+   int nextIdx = 0;
+   if (!serialized.isEmpty() && serialized.at(0).contains(":")) // identify date-time string
+   {
+      session.m_strTimeStamp = serialized.at(0);
+      nextIdx = 1;
+   }
+
+   const int numTrials = serialized.count() - nextIdx;
+   session.m_qvecCondition.reserve(numTrials);
+   session.m_qvecColor.reserve(numTrials);
+   session.m_qvecChosenColor.reserve(numTrials);
+   session.m_qvecCorrect.reserve(numTrials);
+   session.m_qvecRT.reserve(numTrials);
+   session.m_qvecStalled.reserve(numTrials);
+
+   for (int idx=nextIdx; idx<serialized.count(); idx++)
+   {
+      // Mode & Text & Color & Chosen color & Correct & RT(s) [& Stall(ms) & Anticipations
+      // & Auto repeats & Presses]
+      const QStringList values = serialized.at(idx).split("&");
+      if (values.count() < 6) { continue; }
+
+      session.m_qvecCondition.append(static_cast<qint8>(StroopTrial::modeFromString(values.at(0))));
+      session.m_qvecColor.append(static_cast<qint8>(Experiment::convertStringToColor(values.at(2))));
+      session.m_qvecChosenColor.append(static_cast<qint8>(Experiment::convertStringToColor(values.at(3))));
+      session.m_qvecCorrect.append(values.at(4) == QString("1") ? 1 : 0);
+      session.m_qvecRT.append(values.at(5).toDouble() * 1000.0);
+      session.m_qvecStalled.append((values.count() > 6 && values.at(6).toInt() > 0) ? 1 : 0);
+   }
+
+   return session;
+}
+
+
+/**
+ * @brief StroopSessionColumns::count
+ * @return
+ */
+int StroopSessionColumns::count() const
+{
+   return m_qvecRT.count();
+}
+
+
+/**
+ * @brief StroopSessionColumns::append
+ * @param other Trials to add at the end, e.g. of a later session
+ */
+void StroopSessionColumns::append(const StroopSessionColumns& other)
+{
+   m_qvecCondition.append(other.m_qvecCondition);
+   m_qvecColor.append(other.m_qvecColor);
+   m_qvecChosenColor.append(other.m_qvecChosenColor);
+   m_qvecCorrect.append(other.m_qvecCorrect);
+   m_qvecRT.append(other.m_qvecRT);
+   m_qvecStalled.append(other.m_qvecStalled);
+}
+
+
+/**
+ * @brief StroopSessionColumns::withoutStalls
+ * @return Copy without the trials that overlapped an event loop stall
+ */
+StroopSessionColumns StroopSessionColumns::withoutStalls() const
+{
+   StroopSessionColumns session;
+   session.m_strTimeStamp = m_strTimeStamp;
+
+   const int numTrials = count();
+   for (int i=0; i<numTrials; i++)
+   {
+      if (m_qvecStalled.at(i)) { continue; }
+
+      session.m_qvecCondition.append(m_qvecCondition.at(i));
+      session.m_qvecColor.append(m_qvecColor.at(i));
+      session.m_qvecChosenColor.append(m_qvecChosenColor.at(i));
+      session.m_qvecCorrect.append(m_qvecCorrect.at(i));
+      session.m_qvecRT.append(m_qvecRT.at(i));
+      session.m_qvecStalled.append(0);
+   }
+
+   return session;
+}
+
+
+/**
+ * @brief ExGaussianFit::ExGaussianFit
+ */
+ExGaussianFit::ExGaussianFit()
+   : m_nNumSamples(0)
+   , m_dMu(0.0)
+   , m_dSigma(0.0)
+   , m_dTau(0.0)
+   , m_dLogLikelihood(0.0)
+   , m_dGradientNorm(0.0)
+   , m_nIterations(0)
+   , m_bConverged(false)
+{
+}
+
+
+/**
+ * @brief ExGaussianFit::toString
+ * @return "n;mu;sigma;tau;logLikelihood;gradientNorm;iterations;converged"
+ */
+QString ExGaussianFit::toString() const
+{
+   QStringList values;
+   values << QString::number(m_nNumSamples)
+          << QString::number(m_dMu, 'f', 3)
+          << QString::number(m_dSigma, 'f', 3)
+          << QString::number(m_dTau, 'f', 3)
+          << QString::number(m_dLogLikelihood, 'f', 4)
+          << QString::number(m_dGradientNorm, 'g', 3)
+          << QString::number(m_nIterations)
+          << (m_bConverged ? "1" : "0");
+
+   return values.join(";");
+}
+
+
+/**
+ * @brief ExGaussianFit::fromString
+ * @param str String as written by toString()
+ * @return
+ */
+ExGaussianFit ExGaussianFit::fromString(const QString& str)
+{
+   ExGaussianFit fit;
+
+   const QStringList values = str.split(";");
+   if (values.count() == 8)
+   {
+      fit.m_nNumSamples    = values.at(0).toInt();
+      fit.m_dMu            = values.at(1).toDouble();
+      fit.m_dSigma         = values.at(2).toDouble();
+      fit.m_dTau           = values.at(3).toDouble();
+      fit.m_dLogLikelihood = values.at(4).toDouble();
+      fit.m_dGradientNorm  = values.at(5).toDouble();
+      fit.m_nIterations    = values.at(6).toInt();
+      fit.m_bConverged     = (values.at(7) == QString("1"));
+   }
+
+   return fit;
+}
+
+
+/**
+ * @brief DiffusionEstimate::DiffusionEstimate
+ */
+DiffusionEstimate::DiffusionEstimate()
+   : m_nNumSamples(0)
+   , m_dAccuracy(0.0)
+   , m_dDriftRate(0.0)
+   , m_dBoundarySeparation(0.0)
+   , m_dNonDecisionTime(0.0)
+   , m_dLogLikelihood(0.0)
+   , m_nIterations(0)
+   , m_bValid(false)
+{
+}
+
+
+/**
+ * @brief DiffusionEstimate::toString
+ * @return "n;accuracy;v;a;Ter;logLikelihood;iterations;valid"
+ */
+QString DiffusionEstimate::toString() const
+{
+   QStringList values;
+   values << QString::number(m_nNumSamples)
+          << QString::number(m_dAccuracy, 'f', 4)
+          << QString::number(m_dDriftRate, 'f', 5)
+          << QString::number(m_dBoundarySeparation, 'f', 5)
+          << QString::number(m_dNonDecisionTime, 'f', 3)
+          << QString::number(m_dLogLikelihood, 'f', 4)
+          << QString::number(m_nIterations)
+          << (m_bValid ? "1" : "0");
+
+   return values.join(";");
+}
+
+
+/**
+ * @brief DiffusionEstimate::fromString
+ * @param str String as written by toString()
+ * @return
+ */
+DiffusionEstimate DiffusionEstimate::fromString(const QString& str)
+{
+   DiffusionEstimate estimate;
+
+   const QStringList values = str.split(";");
+   if (values.count() == 8)
+   {
+      estimate.m_nNumSamples         = values.at(0).toInt();
+      estimate.m_dAccuracy           = values.at(1).toDouble();
+      estimate.m_dDriftRate          = values.at(2).toDouble();
+      estimate.m_dBoundarySeparation = values.at(3).toDouble();
+      estimate.m_dNonDecisionTime    = values.at(4).toDouble();
+      estimate.m_dLogLikelihood      = values.at(5).toDouble();
+      estimate.m_nIterations         = values.at(6).toInt();
+      estimate.m_bValid              = (values.at(7) == QString("1"));
+   }
+
+   return estimate;
+}
+
+
+/**
+ * @brief SequentialEffects::SequentialEffects
+ */
+SequentialEffects::SequentialEffects()
+   : m_nNumTrials(0)
+   , m_nNumErrors(0)
+   , m_dPostErrorSlowing(0.0)
+   , m_nNumPostErrorPairs(0)
+   , m_dPostErrorSlowingTraditional(0.0)
+   , m_dMeanRT{ {0.0, 0.0}, {0.0, 0.0} }
+   , m_nNumPairs{ {0, 0}, {0, 0} }
+   , m_dCongruencySequenceEffect(0.0)
+   , m_dTimeOnTaskSlope(0.0)
+   , m_dMinWindowSlope(0.0)
+   , m_dMaxWindowSlope(0.0)
+   , m_nWindowSize(0)
+{
+}
+
+
+/**
+ * @brief SequentialEffects::toString
+ * @return "trials;errors;PES;PES pairs;PES traditional;cC;cI;iC;iI;
+ *          n cC;n cI;n iC;n iI;CSE;slope;min window slope;max window slope;window"
+ */
+QString SequentialEffects::toString() const
+{
+   QStringList values;
+   values << QString::number(m_nNumTrials)
+          << QString::number(m_nNumErrors)
+          << QString::number(m_dPostErrorSlowing, 'f', 3)
+          << QString::number(m_nNumPostErrorPairs)
+          << QString::number(m_dPostErrorSlowingTraditional, 'f', 3);
+
+   for (int prev=0; prev<2; prev++)
+   {
+      for (int cur=0; cur<2; cur++) { values << QString::number(m_dMeanRT[prev][cur], 'f', 3); }
+   }
+   for (int prev=0; prev<2; prev++)
+   {
+      for (int cur=0; cur<2; cur++) { values << QString::number(m_nNumPairs[prev][cur]); }
+   }
+
+   values << QString::number(m_dCongruencySequenceEffect, 'f', 3)
+          << QString::number(m_dTimeOnTaskSlope, 'f', 4)
+          << QString::number(m_dMinWindowSlope, 'f', 4)
+          << QString::number(m_dMaxWindowSlope, 'f', 4)
+          << QString::number(m_nWindowSize);
+
+   return values.join(";");
+}
+
+
+/**
+ * @brief SequentialEffects::fromString
+ * @param str String as written by toString()
+ * @return
+ */
+SequentialEffects SequentialEffects::fromString(const QString& str)
+{
+   SequentialEffects effects;
+
+   const QStringList values = str.split(";");
+   if (values.count() == 18)
+   {
+      effects.m_nNumTrials                   = values.at(0).toInt();
+      effects.m_nNumErrors                   = values.at(1).toInt();
+      effects.m_dPostErrorSlowing            = values.at(2).toDouble();
+      effects.m_nNumPostErrorPairs           = values.at(3).toInt();
+      effects.m_dPostErrorSlowingTraditional = values.at(4).toDouble();
+
+      for (int i=0; i<4; i++)
+      {
+         effects.m_dMeanRT[i/2][i%2]   = values.at(5+i).toDouble();
+         effects.m_nNumPairs[i/2][i%2] = values.at(9+i).toInt();
+      }
+
+      effects.m_dCongruencySequenceEffect = values.at(13).toDouble();
+      effects.m_dTimeOnTaskSlope          = values.at(14).toDouble();
+      effects.m_dMinWindowSlope           = values.at(15).toDouble();
+      effects.m_dMaxWindowSlope           = values.at(16).toDouble();
+      effects.m_nWindowSize               = values.at(17).toInt();
+   }
+
+   return effects;
+}
+
+
+/**
+ * @brief StroopSessionEstimates::insertInto
+ * @param store Session store, e.g. StroopExperiment's serialized results
+ * @param sessionNumber Number N of the corresponding "StroopResults_N"
+ */
+void StroopSessionEstimates::insertInto(QMap<QString, QVariant>& store, int sessionNumber) const
+{
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const QString condName = StroopTrial::modeToString(static_cast<StroopTrialModes>(cond));
+
+      if (cond < m_qvecExGaussian.count())
+      {
+         store.insert(StroopExperiment::sessionKey(sessionNumber, "exGaussian/" + condName),
+                      m_qvecExGaussian.at(cond).toString());
+      }
+      if (cond < m_qvecEZDiffusion.count())
+      {
+         store.insert(StroopExperiment::sessionKey(sessionNumber, "ezDiffusion/" + condName),
+                      m_qvecEZDiffusion.at(cond).toString());
+      }
+      if (cond < m_qvecWienerDiffusion.count())
+      {
+         store.insert(StroopExperiment::sessionKey(sessionNumber, "wienerDiffusion/" + condName),
+                      m_qvecWienerDiffusion.at(cond).toString());
+      }
+   }
+
+   store.insert(StroopExperiment::sessionKey(sessionNumber, "sequential"),
+                m_sequentialEffects.toString());
+
+   if (!m_qvecWindowSlopes.isEmpty())
+   {
+      QStringList slopes;
+      slopes.reserve(m_qvecWindowSlopes.count());
+      for (double slope : m_qvecWindowSlopes) { slopes.append(QString::number(slope, 'f', 4)); }
+
+      store.insert(StroopExperiment::sessionKey(sessionNumber, "timeOnTaskSlopes"), slopes);
+   }
+}
+
+
+/**
+ * @brief StroopStatistics::exGaussianLogLikelihood
+ * @param x Samples
+ * @param n Number of samples
+ * @param gradient Optional array of three receiving d/dmu, d/dsigma and d/dtau
+ * @return Log-likelihood of the samples
+ *
+ * log f(x) = -log(tau) + (mu-x)/tau + sigma^2/(2 tau^2) + log(Phi(z)),
+ * with z = (x-mu)/sigma - sigma/tau.
+ * Everything except the normal CDF term reduces to sums over the samples,
+ * so the loop only accumulates four sums and the closed-form gradient is
+ * assembled from them afterwards.
+ */
+double StroopStatistics::exGaussianLogLikelihood(const double* x, int n,
+                                                 double mu, double sigma, double tau,
+                                                 double* gradient)
+{
+   const double invSigma = 1.0 / sigma;
+   const double invTau = 1.0 / tau;
+   const double sigmaOverTau = sigma * invTau;
+
+   double sumDiff = 0.0;       // sum(x - mu)
+   double sumLogCdf = 0.0;     // sum(log(Phi(z)))
+   double sumMills = 0.0;      // sum(phi(z)/Phi(z))
+   double sumMillsDiff = 0.0;  // sum(phi(z)/Phi(z) * (x - mu))
+
+   for (int i=0; i<n; i++)
+   {
+      const double diff = x[i] - mu;
+      const double z = diff * invSigma - sigmaOverTau;
+
+      double logCdf, millsRatio;
+      logNormalCdfAndMillsRatio(z, logCdf, millsRatio);
+
+      sumDiff += diff;
+      sumLogCdf += logCdf;
+      sumMills += millsRatio;
+      sumMillsDiff += millsRatio * diff;
+   }
+
+   const double dn = static_cast<double>(n);
+
+   if (gradient)
+   {
+      gradient[0] = dn * invTau - sumMills * invSigma;
+      gradient[1] = dn * sigma * invTau * invTau
+                  - sumMillsDiff * invSigma * invSigma - sumMills * invTau;
+      gradient[2] = -dn * invTau + sumDiff * invTau * invTau
+                  - dn * sigma * sigma * invTau * invTau * invTau
+                  + sumMills * sigma * invTau * invTau;
+   }
+
+   return dn * (-std::log(tau) + 0.5 * sigmaOverTau * sigmaOverTau)
+          - sumDiff * invTau + sumLogCdf;
+}
+
+
+/**
+ * @brief StroopStatistics::fitExGaussian
+ * @param rts Reaction times in milliseconds
+ * @param maxIterations
+ * @param tolerance Convergence threshold for the gradient (standardized units)
+ * @return
+ *
+ * The samples are standardized first and the optimization runs in
+ * (mu, log sigma, log tau), which keeps sigma and tau positive and all three
+ * parameters on a comparable scale. A BFGS quasi-Newton method with
+ * backtracking line search is started from the method-of-moments estimates.
+ */
+ExGaussianFit StroopStatistics::fitExGaussian(const QVector<double>& rts,
+                                              int maxIterations, double tolerance)
+{
+   ExGaussianFit fit;
+
+   const int n = rts.count();
+   fit.m_nNumSamples = n;
+   if (n < 3) { return fit; }
+
+   /* Moments */
+   const double dn = static_cast<double>(n);
+   double mean = 0.0;
+   for (double rt : rts) { mean += rt; }
+   mean /= dn;
+
+   double m2 = 0.0, m3 = 0.0;
+   for (double rt : rts)
+   {
+      const double d = rt - mean;
+      m2 += d * d;
+      m3 += d * d * d;
+   }
+   m2 /= dn;
+   m3 /= dn;
+
+   const double sd = std::sqrt(m2);
+   if (!(sd > 0.0)) { return fit; }
+
+   QVector<double> x(n);
+   const double invSd = 1.0 / sd;
+   for (int i=0; i<n; i++) { x[i] = (rts.at(i) - mean) * invSd; }
+
+   /* Method-of-moments start values in standardized units */
+   const double skew = m3 / (m2 * sd);
+   const double tau0 = std::clamp(std::cbrt(std::max(skew, 0.0) / 2.0), 0.1, 0.9);
+
+   double theta[3] = { -tau0, 0.5 * std::log(1.0 - tau0 * tau0), std::log(tau0) };
+
+   // Objective: mean negative log-likelihood and its gradient in theta space
+   auto objective = [&x, n, dn](const double* t, double* g) -> double
+   {
+      const double sigma = std::exp(t[1]);
+      const double tau = std::exp(t[2]);
+
+      double grad[3];
+      const double ll = exGaussianLogLikelihood(x.constData(), n, t[0], sigma, tau, grad);
+
+      g[0] = -grad[0] / dn;
+      g[1] = -grad[1] * sigma / dn;
+      g[2] = -grad[2] * tau / dn;
+
+      return -ll / dn;
+   };
+
+   auto norm = [](const double* v) -> double
+   {
+      return std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+   };
+
+   // Inverse Hessian approximation
+   double H[3][3] = { {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0}, {0.0, 0.0, 1.0} };
+
+   double g[3];
+   double f = objective(theta, g);
+
+   int iter = 0;
+   for (; iter<maxIterations; iter++)
+   {
+      if (norm(g) < tolerance) { fit.m_bConverged = true; break; }
+
+      // Search direction p = -H g
+      double p[3];
+      for (int r=0; r<3; r++)
+      {
+         p[r] = -(H[r][0]*g[0] + H[r][1]*g[1] + H[r][2]*g[2]);
+      }
+
+      double slope = p[0]*g[0] + p[1]*g[1] + p[2]*g[2];
+      if (slope >= 0.0) // Not a descent direction: restart with steepest descent
+      {
+         for (int r=0; r<3; r++)
+         {
+            for (int c=0; c<3; c++) { H[r][c] = (r == c) ? 1.0 : 0.0; }
+            p[r] = -g[r];
+         }
+         slope = -(g[0]*g[0] + g[1]*g[1] + g[2]*g[2]);
+      }
+
+      // Backtracking line search (Armijo condition)
+      double step = 1.0;
+      double thetaNew[3], gNew[3], fNew = f;
+      bool accepted = false;
+      for (int k=0; k<40; k++)
+      {
+         for (int r=0; r<3; r++) { thetaNew[r] = theta[r] + step * p[r]; }
+
+         fNew = objective(thetaNew, gNew);
+         if (std::isfinite(fNew) && fNew <= f + 1e-4 * step * slope)
+         {
+            accepted = true;
+            break;
+         }
+         step *= 0.5;
+      }
+
+      if (!accepted) { break; }
+
+      // BFGS update of the inverse Hessian
+      double s[3], y[3];
+      for (int r=0; r<3; r++)
+      {
+         s[r] = thetaNew[r] - theta[r];
+         y[r] = gNew[r] - g[r];
+      }
+
+      const double sy = s[0]*y[0] + s[1]*y[1] + s[2]*y[2];
+      if (sy > 1e-12)
+      {
+         const double rho = 1.0 / sy;
+
+         double Hy[3];
+         for (int r=0; r<3; r++) { Hy[r] = H[r][0]*y[0] + H[r][1]*y[1] + H[r][2]*y[2]; }
+         const double yHy = y[0]*Hy[0] + y[1]*Hy[1] + y[2]*Hy[2];
+
+         for (int r=0; r<3; r++)
+         {
+            for (int c=0; c<3; c++)
+            {
+               H[r][c] += (1.0 + rho * yHy) * rho * s[r] * s[c]
+                        - rho * (Hy[r] * s[c] + s[r] * Hy[c]);
+            }
+         }
+      }
+
+      const double fOld = f;
+      for (int r=0; r<3; r++)
+      {
+         theta[r] = thetaNew[r];
+         g[r] = gNew[r];
+      }
+      f = fNew;
+
+      if (std::abs(fOld - f) < tolerance * tolerance * (1.0 + std::abs(f)))
+      {
+         fit.m_bConverged = (norm(g) < std::sqrt(tolerance));
+         iter++;
+         break;
+      }
+   }
+
+   // Transform back to milliseconds
+   fit.m_dMu = mean + sd * theta[0];
+   fit.m_dSigma = sd * std::exp(theta[1]);
+   fit.m_dTau = sd * std::exp(theta[2]);
+   fit.m_dLogLikelihood = -f * dn - dn * std::log(sd);
+   fit.m_dGradientNorm = norm(g);
+   fit.m_nIterations = iter;
+
+   return fit;
+}
+
+
+/**
+ * @brief StroopStatistics::conditionRTs
+ * @param session
+ * @param condition StroopTrialModes as int
+ * @param correctTrialsOnly
+ * @return Reaction times in milliseconds of all matching trials
+ */
+QVector<double> StroopStatistics::conditionRTs(const StroopSessionColumns& session,
+                                               int condition, bool correctTrialsOnly)
+{
+   QVector<double> rts;
+
+   const int numTrials = session.count();
+   rts.reserve(numTrials);
+
+   for (int i=0; i<numTrials; i++)
+   {
+      if (session.m_qvecCondition.at(i) != condition) { continue; }
+      if (correctTrialsOnly && !session.m_qvecCorrect.at(i)) { continue; }
+      if (session.m_qvecRT.at(i) <= 0.0) { continue; }
+
+      rts.append(session.m_qvecRT.at(i));
+   }
+
+   return rts;
+}
+
+
+/**
+ * @brief StroopStatistics::fitExGaussianPerCondition
+ * @param session
+ * @param correctTrialsOnly
+ * @return One fit per condition, indexed by StroopTrialModes
+ */
+QVector<ExGaussianFit> StroopStatistics::fitExGaussianPerCondition(
+                                             const StroopSessionColumns& session,
+                                             bool correctTrialsOnly)
+{
+   QVector<ExGaussianFit> fits(NumStroopConditions);
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      fits[cond] = fitExGaussian(conditionRTs(session, cond, correctTrialsOnly));
+   }
+
+   return fits;
+}
+
+
+/**
+ * @brief StroopStatistics::ezDiffusion
+ * @param numTrials Number of trials including errors
+ * @param numCorrect
+ * @param meanCorrectRT Mean RT of the correct trials in milliseconds
+ * @param varCorrectRT Variance of the correct RTs in milliseconds^2
+ * @return
+ *
+ * Closed-form EZ-diffusion estimates (Wagenmakers, van der Maas & Grasman, 2007).
+ * An accuracy of exactly 1 or 0.5 is corrected by half a trial, since the
+ * equations are undefined there.
+ */
+DiffusionEstimate StroopStatistics::ezDiffusion(int numTrials, int numCorrect,
+                                                double meanCorrectRT, double varCorrectRT)
+{
+   DiffusionEstimate estimate;
+   estimate.m_nNumSamples = numTrials;
+
+   if (numTrials < 2 || numCorrect < 2 || !(varCorrectRT > 0.0)) { return estimate; }
+
+   const double dn = static_cast<double>(numTrials);
+   double pc = static_cast<double>(numCorrect) / dn;
+   estimate.m_dAccuracy = pc;
+
+   if (pc >= 1.0)      { pc = 1.0 - 1.0 / (2.0 * dn); }
+   else if (pc == 0.5) { pc = 0.5 + 1.0 / (2.0 * dn); }
+   else if (pc <= 0.0) { pc = 1.0 / (2.0 * dn); }
+
+   const double mrt = meanCorrectRT / 1000.0;  // seconds
+   const double vrt = varCorrectRT / 1.0e6;    // seconds^2
+   const double s2 = DiffusionScaling * DiffusionScaling;
+
+   const double L = std::log(pc / (1.0 - pc));
+   const double x = L * (L * pc * pc - L * pc + pc - 0.5) / vrt;
+   const double v = ((pc > 0.5) ? 1.0 : -1.0) * DiffusionScaling * std::pow(x, 0.25);
+   const double a = s2 * L / v;
+   const double y = -v * a / s2;
+   const double mdt = (a / (2.0 * v)) * (1.0 - std::exp(y)) / (1.0 + std::exp(y));
+
+   estimate.m_dDriftRate = v;
+   estimate.m_dBoundarySeparation = a;
+   estimate.m_dNonDecisionTime = (mrt - mdt) * 1000.0;
+   estimate.m_bValid = std::isfinite(v) && std::isfinite(a) && std::isfinite(mdt);
+
+   return estimate;
+}
+
+
+/**
+ * @brief StroopStatistics::ezDiffusionPerCondition
+ * @param session
+ * @return One estimate per condition, indexed by StroopTrialModes
+ */
+QVector<DiffusionEstimate> StroopStatistics::ezDiffusionPerCondition(
+                                                const StroopSessionColumns& session)
+{
+   QVector<DiffusionEstimate> estimates(NumStroopConditions);
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      int numTrials = 0;
+      for (int i=0; i<session.count(); i++)
+      {
+         if (session.m_qvecCondition.at(i) == cond) { numTrials++; }
+      }
+
+      const QVector<double> rts = conditionRTs(session, cond, true);
+      const int numCorrect = rts.count();
+
+      double mean = 0.0, var = 0.0;
+      if (numCorrect > 1)
+      {
+         for (double rt : rts) { mean += rt; }
+         mean /= numCorrect;
+
+         for (double rt : rts) { var += (rt - mean) * (rt - mean); }
+         var /= (numCorrect - 1);
+      }
+
+      estimates[cond] = ezDiffusion(numTrials, numCorrect, mean, var);
+   }
+
+   return estimates;
+}
+
+
+/**
+ * @brief StroopStatistics::standardWienerLogDensity
+ * @param u Normalized decision time t/a^2
+ * @return log of the standardized first-passage-time density
+ *
+ * The infinite series are evaluated once into a table over log(u) and
+ * interpolated afterwards, so a likelihood evaluation costs one lookup per
+ * trial. Beyond the table the first term of the large-time series is exact
+ * to double precision.
+ */
+double StroopStatistics::standardWienerLogDensity(double u)
+{
+   static constexpr int    TableSize = 4096;
+   static constexpr double LogUMin = -9.2103403719761836;  // log(1e-4)
+   static constexpr double LogUMax =  2.7725887222397811;  // log(16)
+
+   struct Table
+   {
+      Table() : m_vecLogDensity(TableSize)
+      {
+         m_dStep = (LogUMax - LogUMin) / (TableSize - 1);
+         for (int i=0; i<TableSize; i++)
+         {
+            const double density = standardWienerDensity(std::exp(LogUMin + i * m_dStep));
+            m_vecLogDensity[i] = std::log(std::max(density, 1e-300));
+         }
+      }
+
+      std::vector<double> m_vecLogDensity;
+      double m_dStep;
+   };
+
+   // Initialization of function-local statics is thread-safe.
+   static const Table table;
+
+   if (!(u > 0.0)) { return WienerLogDensityFloor; }
+
+   const double logU = std::log(u);
+   if (logU <= LogUMin) { return table.m_vecLogDensity.front(); }
+   if (logU >= LogUMax) { return std::log(Pi) - Pi * Pi * u / 2.0; }
+
+   const double pos = (logU - LogUMin) / table.m_dStep;
+   const int idx = std::min(static_cast<int>(pos), TableSize - 2);
+   const double frac = pos - idx;
+
+   return (1.0 - frac) * table.m_vecLogDensity[idx] + frac * table.m_vecLogDensity[idx + 1];
+}
+
+
+/**
+ * @brief StroopStatistics::wienerLogLikelihood
+ * @param rts Reaction times in milliseconds
+ * @param correct Correct responses hit the upper boundary, errors the lower one
+ * @param driftRate
+ * @param boundarySeparation
+ * @param nonDecisionTime In milliseconds
+ * @return
+ */
+double StroopStatistics::wienerLogLikelihood(const QVector<double>& rts,
+                                             const QVector<quint8>& correct,
+                                             double driftRate, double boundarySeparation,
+                                             double nonDecisionTime)
+{
+   // Rescale to s = 1
+   const double v = driftRate / DiffusionScaling;
+   const double a = boundarySeparation / DiffusionScaling;
+   const double invA2 = 1.0 / (a * a);
+   const double logInvA2 = std::log(invA2);
+   const double driftTerm = 0.5 * v * a;
+
+   double logLikelihood = 0.0;
+
+   const int n = rts.count();
+   for (int i=0; i<n; i++)
+   {
+      const double t = (rts.at(i) - nonDecisionTime) / 1000.0;
+
+      double logDensity = WienerLogDensityFloor;
+      if (t > 0.0)
+      {
+         logDensity = logInvA2 + (correct.at(i) ? driftTerm : -driftTerm)
+                    - 0.5 * v * v * t + standardWienerLogDensity(t * invA2);
+      }
+
+      logLikelihood += std::max(logDensity, WienerLogDensityFloor);
+   }
+
+   return logLikelihood;
+}
+
+
+/**
+ * @brief StroopStatistics::fitWienerDiffusion
+ * @param rts Reaction times in milliseconds
+ * @param correct
+ * @param start Start values, usually the EZ-diffusion estimates
+ * @param maxIterations
+ * @return
+ *
+ * Nelder-Mead simplex search over (v, log a, Ter).
+ */
+DiffusionEstimate StroopStatistics::fitWienerDiffusion(const QVector<double>& rts,
+                                                       const QVector<quint8>& correct,
+                                                       const DiffusionEstimate& start,
+                                                       int maxIterations)
+{
+   DiffusionEstimate estimate;
+
+   const int n = rts.count();
+   estimate.m_nNumSamples = n;
+   if (n < 3) { return estimate; }
+
+   int numCorrect = 0;
+   for (quint8 c : correct) { numCorrect += c; }
+   estimate.m_dAccuracy = static_cast<double>(numCorrect) / n;
+
+   const double minRT = *std::min_element(rts.constBegin(), rts.constEnd());
+
+   double v0 = 0.2, a0 = 0.12, ter0 = 0.5 * minRT;
+   if (start.m_bValid)
+   {
+      v0 = start.m_dDriftRate;
+      a0 = start.m_dBoundarySeparation;
+      ter0 = std::clamp(start.m_dNonDecisionTime, 0.0, 0.9 * minRT);
+   }
+
+   auto objective = [&rts, &correct](const double* t) -> double
+   {
+      return -wienerLogLikelihood(rts, correct, t[0], std::exp(t[1]), t[2]);
+   };
+
+   // Initial simplex
+   double simplex[4][3] = { { v0, std::log(a0), ter0 },
+                            { v0 + 0.05, std::log(a0), ter0 },
+                            { v0, std::log(a0) + 0.2, ter0 },
+                            { v0, std::log(a0), ter0 + 20.0 } };
+   double f[4];
+   for (int i=0; i<4; i++) { f[i] = objective(simplex[i]); }
+
+   int iter = 0;
+   bool converged = false;
+   for (; iter<maxIterations; iter++)
+   {
+      // Order vertices by objective value
+      int order[4] = {0, 1, 2, 3};
+      std::sort(order, order+4, [&f](int l, int r) { return f[l] < f[r]; });
+      const int best = order[0], secondWorst = order[2], worst = order[3];
+
+      if (std::abs(f[worst] - f[best]) < 1e-8 * (1.0 + std::abs(f[best])))
+      {
+         converged = true;
+         break;
+      }
+
+      double centroid[3] = {0.0, 0.0, 0.0};
+      for (int k=0; k<3; k++)
+      {
+         for (int c=0; c<3; c++) { centroid[c] += simplex[order[k]][c] / 3.0; }
+      }
+
+      auto pointAt = [&](double coeff, double* p)
+      {
+         for (int c=0; c<3; c++) { p[c] = centroid[c] + coeff * (simplex[worst][c] - centroid[c]); }
+         return objective(p);
+      };
+
+      double reflected[3];
+      const double fr = pointAt(-1.0, reflected);
+
+      if (fr < f[best])
+      {
+         double expanded[3];
+         const double fe = pointAt(-2.0, expanded);
+         const bool useExpanded = (fe < fr);
+         std::copy(useExpanded ? expanded : reflected, (useExpanded ? expanded : reflected) + 3, simplex[worst]);
+         f[worst] = useExpanded ? fe : fr;
+      }
+      else if (fr < f[secondWorst])
+      {
+         std::copy(reflected, reflected + 3, simplex[worst]);
+         f[worst] = fr;
+      }
+      else
+      {
+         double contracted[3];
+         const double fc = pointAt(0.5, contracted);
+         if (fc < f[worst])
+         {
+            std::copy(contracted, contracted + 3, simplex[worst]);
+            f[worst] = fc;
+         }
+         else // Shrink towards the best vertex
+         {
+            for (int k=1; k<4; k++)
+            {
+               const int idx = order[k];
+               for (int c=0; c<3; c++)
+               {
+                  simplex[idx][c] = simplex[best][c] + 0.5 * (simplex[idx][c] - simplex[best][c]);
+               }
+               f[idx] = objective(simplex[idx]);
+            }
+         }
+      }
+   }
+
+   const int best = static_cast<int>(std::min_element(f, f+4) - f);
+
+   estimate.m_dDriftRate = simplex[best][0];
+   estimate.m_dBoundarySeparation = std::exp(simplex[best][1]);
+   estimate.m_dNonDecisionTime = simplex[best][2];
+   estimate.m_dLogLikelihood = -f[best];
+   estimate.m_nIterations = iter;
+   estimate.m_bValid = converged;
+
+   return estimate;
+}
+
+
+/**
+ * @brief StroopStatistics::fitWienerDiffusionPerCondition
+ * @param session
+ * @param ezStart EZ-diffusion estimates used as start values
+ * @return One estimate per condition, indexed by StroopTrialModes
+ *
+ * The four conditions are fitted concurrently on the global thread pool.
+ */
+QVector<DiffusionEstimate> StroopStatistics::fitWienerDiffusionPerCondition(
+                                                const StroopSessionColumns& session,
+                                                const QVector<DiffusionEstimate>& ezStart)
+{
+   QVector<int> conditions(NumStroopConditions);
+   std::iota(conditions.begin(), conditions.end(), 0);
+
+   std::function<DiffusionEstimate(int)> fitCondition = [&session, &ezStart](int cond)
+   {
+      QVector<double> rts;
+      QVector<quint8> correct;
+      for (int i=0; i<session.count(); i++)
+      {
+         if (session.m_qvecCondition.at(i) != cond || session.m_qvecRT.at(i) <= 0.0) { continue; }
+
+         rts.append(session.m_qvecRT.at(i));
+         correct.append(session.m_qvecCorrect.at(i));
+      }
+
+      const DiffusionEstimate start = (cond < ezStart.count()) ? ezStart.at(cond) : DiffusionEstimate();
+      return fitWienerDiffusion(rts, correct, start);
+   };
+
+   return QtConcurrent::blockingMapped< QVector<DiffusionEstimate> >(conditions, fitCondition);
+}
+
+
+/**
+ * @brief StroopStatistics::congruencyClass
+ * @param condition StroopTrialModes as int
+ * @return 0 for congruent, 1 for incongruent and -1 for neutral conditions
+ */
+int StroopStatistics::congruencyClass(int condition)
+{
+   switch (static_cast<StroopTrialModes>(condition))
+   {
+      case StroopTrialModes::ColoredTextMatched:  { return 0; }
+      case StroopTrialModes::ColorTextConflicted: { return 1; }
+      default: { break; }
+   }
+
+   return -1;
+}
+
+
+/**
+ * @brief StroopStatistics::slidingWindowSlopes
+ * @param session
+ * @param windowSize Number of consecutive trials per window
+ * @return Regression slope of RT (ms) on trial index for each window,
+ *         i.e. one value per trial from index windowSize-1 on
+ *
+ * The sums of the normal equations are updated when a trial enters and
+ * leaves the window, so the whole series costs O(n). Errors are skipped
+ * but keep their position on the index axis.
+ */
+QVector<double> StroopStatistics::slidingWindowSlopes(const StroopSessionColumns& session,
+                                                      int windowSize)
+{
+   QVector<double> slopes;
+
+   const int n = session.count();
+   if (windowSize < 3 || n < windowSize) { return slopes; }
+
+   slopes.reserve(n - windowSize + 1);
+
+   double sumX = 0.0, sumY = 0.0, sumXY = 0.0, sumXX = 0.0;
+   int count = 0;
+
+   auto used = [&session](int i)
+   {
+      return session.m_qvecCorrect.at(i) && session.m_qvecRT.at(i) > 0.0;
+   };
+
+   for (int i=0; i<n; i++)
+   {
+      if (used(i))
+      {
+         const double x = i, y = session.m_qvecRT.at(i);
+         sumX += x; sumY += y; sumXY += x * y; sumXX += x * x;
+         count++;
+      }
+
+      const int leaving = i - windowSize;
+      if (leaving >= 0 && used(leaving))
+      {
+         const double x = leaving, y = session.m_qvecRT.at(leaving);
+         sumX -= x; sumY -= y; sumXY -= x * y; sumXX -= x * x;
+         count--;
+      }
+
+      if (i < windowSize - 1) { continue; }
+
+      const double denominator = count * sumXX - sumX * sumX;
+      slopes.append((count >= 3 && denominator > 0.0)
+                    ? (count * sumXY - sumX * sumY) / denominator : 0.0);
+   }
+
+   return slopes;
+}
+
+
+/**
+ * @brief StroopStatistics::sequentialEffects
+ * @param sessions One or more sessions, each in presentation order
+ * @param windowSize Window of the time-on-task regression
+ * @return
+ */
+SequentialEffects StroopStatistics::sequentialEffects(const QVector<StroopSessionColumns>& sessions,
+                                                      int windowSize)
+{
+   SequentialEffects effects;
+   effects.m_nWindowSize = windowSize;
+
+   double sumPES = 0.0;
+   double sumAfterError = 0.0, sumAfterCorrect = 0.0;
+   int numAfterError = 0, numAfterCorrect = 0;
+   double sumPairs[2][2] = { {0.0, 0.0}, {0.0, 0.0} };
+   double sxx = 0.0, sxy = 0.0;
+   bool haveWindowSlope = false;
+
+   for (const StroopSessionColumns& session : sessions)
+   {
+      const int n = session.count();
+      const quint8* correct = session.m_qvecCorrect.constData();
+      const double* rt = session.m_qvecRT.constData();
+      const qint8* condition = session.m_qvecCondition.constData();
+
+      effects.m_nNumTrials += n;
+
+      double sumX = 0.0, sumY = 0.0;
+      int numUsed = 0;
+
+      for (int i=0; i<n; i++)
+      {
+         if (!correct[i]) { effects.m_nNumErrors++; }
+
+         const bool usable = correct[i] && rt[i] > 0.0;
+         if (usable)
+         {
+            sumX += i;
+            sumY += rt[i];
+            numUsed++;
+         }
+
+         if (i == 0 || !usable) { continue; }
+
+         if (correct[i-1]) { sumAfterCorrect += rt[i]; numAfterCorrect++; }
+         else              { sumAfterError += rt[i];   numAfterError++;   }
+
+         // Robust post-error slowing: correct - error - correct
+         if (i >= 2 && !correct[i-1] && correct[i-2] && rt[i-2] > 0.0)
+         {
+            sumPES += rt[i] - rt[i-2];
+            effects.m_nNumPostErrorPairs++;
+         }
+
+         const int prevClass = congruencyClass(condition[i-1]);
+         const int curClass = congruencyClass(condition[i]);
+         if (prevClass >= 0 && curClass >= 0 && correct[i-1])
+         {
+            sumPairs[prevClass][curClass] += rt[i];
+            effects.m_nNumPairs[prevClass][curClass]++;
+         }
+      }
+
+      // Within-session centered sums, so sessions with different mean RT
+      // do not introduce a spurious slope when pooled.
+      if (numUsed > 1)
+      {
+         const double meanX = sumX / numUsed, meanY = sumY / numUsed;
+         for (int i=0; i<n; i++)
+         {
+            if (!correct[i] || rt[i] <= 0.0) { continue; }
+
+            sxx += (i - meanX) * (i - meanX);
+            sxy += (i - meanX) * (rt[i] - meanY);
+         }
+      }
+
+      const QVector<double> slopes = slidingWindowSlopes(session, windowSize);
+      for (double slope : slopes)
+      {
+         if (!haveWindowSlope)
+         {
+            effects.m_dMinWindowSlope = effects.m_dMaxWindowSlope = slope;
+            haveWindowSlope = true;
+         }
+         effects.m_dMinWindowSlope = std::min(effects.m_dMinWindowSlope, slope);
+         effects.m_dMaxWindowSlope = std::max(effects.m_dMaxWindowSlope, slope);
+      }
+   }
+
+   if (effects.m_nNumPostErrorPairs > 0)
+   {
+      effects.m_dPostErrorSlowing = sumPES / effects.m_nNumPostErrorPairs;
+   }
+   if (numAfterError > 0 && numAfterCorrect > 0)
+   {
+      effects.m_dPostErrorSlowingTraditional = sumAfterError / numAfterError
+                                             - sumAfterCorrect / numAfterCorrect;
+   }
+
+   bool allPairs = true;
+   for (int prev=0; prev<2; prev++)
+   {
+      for (int cur=0; cur<2; cur++)
+      {
+         const int num = effects.m_nNumPairs[prev][cur];
+         if (num > 0) { effects.m_dMeanRT[prev][cur] = sumPairs[prev][cur] / num; }
+         else         { allPairs = false; }
+      }
+   }
+   if (allPairs)
+   {
+      effects.m_dCongruencySequenceEffect =
+            (effects.m_dMeanRT[0][1] - effects.m_dMeanRT[0][0])
+          - (effects.m_dMeanRT[1][1] - effects.m_dMeanRT[1][0]);
+   }
+
+   if (sxx > 0.0) { effects.m_dTimeOnTaskSlope = sxy / sxx; }
+
+   return effects;
+}
+
+
+/**
+ * @brief StroopStatistics::estimateSession
+ * @param session
+ * @param fullDiffusionFit Additionally fit the diffusion model by maximum likelihood
+ * @return
+ */
+StroopSessionEstimates StroopStatistics::estimateSession(const StroopSessionColumns& session,
+                                                         bool fullDiffusionFit)
+{
+   StroopSessionEstimates estimates;
+
+   estimates.m_qvecExGaussian = fitExGaussianPerCondition(session);
+   estimates.m_qvecEZDiffusion = ezDiffusionPerCondition(session);
+   estimates.m_sequentialEffects = sequentialEffects(QVector<StroopSessionColumns>{session});
+   estimates.m_qvecWindowSlopes = slidingWindowSlopes(session, estimates.m_sequentialEffects.m_nWindowSize);
+
+   if (fullDiffusionFit)
+   {
+      estimates.m_qvecWienerDiffusion =
+            fitWienerDiffusionPerCondition(session, estimates.m_qvecEZDiffusion);
+   }
+
+   return estimates;
+}
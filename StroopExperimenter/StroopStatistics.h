@@ -0,0 +1,208 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopExperiment.h"
+#include <QVector>
+#include <QStringList>
+
+
+/**
+ * @brief The StroopSessionColumns struct
+ *
+ * Column-wise representation of one serialized run ("StroopResults_N").
+ * Each vector holds one entry per valid trial in presentation order, so the
+ * statistics can scan contiguous arrays instead of re-splitting strings.
+ */
+struct StroopSessionColumns
+{
+   static StroopSessionColumns fromSerialized(const QStringList& serialized);
+
+   int count() const;
+   void append(const StroopSessionColumns& other);
+   StroopSessionColumns withoutStalls() const;
+
+   QString m_strTimeStamp;
+
+   QVector<qint8>  m_qvecCondition; // StroopTrialModes
+   QVector<qint8>  m_qvecColor;     // Qt::GlobalColor
+   QVector<qint8>  m_qvecChosenColor;
+   QVector<quint8> m_qvecCorrect;
+   QVector<double> m_qvecRT;        // Milliseconds
+   QVector<quint8> m_qvecStalled;   // 1: overlapped an event loop stall
+};
+
+
+/**
+ * @brief The ExGaussianFit struct
+ *
+ * Maximum-likelihood estimate of an ex-Gaussian distribution (convolution of
+ * a normal with mean mu and standard deviation sigma and an exponential with
+ * mean tau) together with the diagnostics of the optimizer.
+ */
+struct ExGaussianFit
+{
+   ExGaussianFit();
+
+   QString toString() const;
+   static ExGaussianFit fromString(const QString& str);
+
+   int    m_nNumSamples;
+   double m_dMu;             // Milliseconds
+   double m_dSigma;          // Milliseconds
+   double m_dTau;            // Milliseconds
+   double m_dLogLikelihood;
+   double m_dGradientNorm;
+   int    m_nIterations;
+   bool   m_bConverged;
+};
+
+
+/**
+ * @brief The DiffusionEstimate struct
+ *
+ * Drift rate, boundary separation and non-decision time of a Wiener
+ * diffusion model with unbiased starting point. Drift rate and boundary
+ * separation use the conventional scaling s = 0.1.
+ */
+struct DiffusionEstimate
+{
+   DiffusionEstimate();
+
+   QString toString() const;
+   static DiffusionEstimate fromString(const QString& str);
+
+   int    m_nNumSamples;
+   double m_dAccuracy;
+   double m_dDriftRate;
+   double m_dBoundarySeparation;
+   double m_dNonDecisionTime;    // Milliseconds
+   double m_dLogLikelihood;      // Full-likelihood fits only
+   int    m_nIterations;         // Full-likelihood fits only
+   bool   m_bValid;
+};
+
+
+/**
+ * @brief The SequentialEffects struct
+ *
+ * Effects of the preceding trial on the current one, computed from
+ * consecutive trials in presentation order. Pairs never cross a session
+ * boundary when several sessions are combined.
+ */
+struct SequentialEffects
+{
+   SequentialEffects();
+
+   QString toString() const;
+   static SequentialEffects fromString(const QString& str);
+
+   int    m_nNumTrials;
+   int    m_nNumErrors;
+
+   // Post-error slowing in milliseconds: robust variant (RT after minus RT
+   // before an error, both correct) and traditional variant (mean RT after
+   // errors minus mean RT after correct responses).
+   double m_dPostErrorSlowing;
+   int    m_nNumPostErrorPairs;
+   double m_dPostErrorSlowingTraditional;
+
+   // Mean RTs of correct trials after a correct trial, indexed by
+   // [previous][current] congruency (0: congruent, 1: incongruent), and the
+   // congruency sequence (Gratton) effect (cI - cC) - (iI - iC).
+   double m_dMeanRT[2][2];
+   int    m_nNumPairs[2][2];
+   double m_dCongruencySequenceEffect;
+
+   // Time-on-task drift in milliseconds per trial: pooled within-session
+   // regression slope and range of the sliding-window slopes
+   double m_dTimeOnTaskSlope;
+   double m_dMinWindowSlope;
+   double m_dMaxWindowSlope;
+   int    m_nWindowSize;
+};
+
+
+/**
+ * @brief The StroopSessionEstimates struct
+ *
+ * All model estimates of one session (or of several pooled sessions),
+ * each vector indexed by StroopTrialModes.
+ */
+struct StroopSessionEstimates
+{
+   void insertInto(QMap<QString, QVariant>& store, int sessionNumber) const;
+
+   QVector<ExGaussianFit>     m_qvecExGaussian;
+   QVector<DiffusionEstimate> m_qvecEZDiffusion;
+   QVector<DiffusionEstimate> m_qvecWienerDiffusion; // Empty if not requested
+   SequentialEffects          m_sequentialEffects;
+   QVector<double>            m_qvecWindowSlopes;    // Single sessions only
+};
+
+
+/**
+ * @brief The StroopStatistics class
+ *
+ * Collection of stateless estimators working on StroopSessionColumns.
+ * All methods are reentrant and may be called from worker threads.
+ */
+class StroopStatistics
+{
+   public:
+      static double exGaussianLogLikelihood(const double* x, int n,
+                                            double mu, double sigma, double tau,
+                                            double* gradient = nullptr);
+
+      static ExGaussianFit fitExGaussian(const QVector<double>& rts,
+                                         int maxIterations = 200,
+                                         double tolerance = 1e-6);
+
+      static QVector<ExGaussianFit> fitExGaussianPerCondition(
+                                         const StroopSessionColumns& session,
+                                         bool correctTrialsOnly = true);
+
+      static QVector<double> conditionRTs(const StroopSessionColumns& session,
+                                          int condition, bool correctTrialsOnly);
+
+      static DiffusionEstimate ezDiffusion(int numTrials, int numCorrect,
+                                           double meanCorrectRT, double varCorrectRT);
+
+      static QVector<DiffusionEstimate> ezDiffusionPerCondition(
+                                           const StroopSessionColumns& session);
+
+      static double wienerLogLikelihood(const QVector<double>& rts,
+                                        const QVector<quint8>& correct,
+                                        double driftRate, double boundarySeparation,
+                                        double nonDecisionTime);
+
+      static DiffusionEstimate fitWienerDiffusion(const QVector<double>& rts,
+                                                  const QVector<quint8>& correct,
+                                                  const DiffusionEstimate& start,
+                                                  int maxIterations = 400);
+
+      static QVector<DiffusionEstimate> fitWienerDiffusionPerCondition(
+                                           const StroopSessionColumns& session,
+                                           const QVector<DiffusionEstimate>& ezStart);
+
+      static int congruencyClass(int condition);
+
+      static QVector<double> slidingWindowSlopes(const StroopSessionColumns& session,
+                                                 int windowSize);
+
+      static SequentialEffects sequentialEffects(const QVector<StroopSessionColumns>& sessions,
+                                                 int windowSize = 20);
+
+      static StroopSessionEstimates estimateSession(const StroopSessionColumns& session,
+                                                    bool fullDiffusionFit = false);
+
+   private:
+      static double standardWienerLogDensity(double u);
+};
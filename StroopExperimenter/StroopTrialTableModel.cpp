@@ -0,0 +1,220 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StroopTrialTableModel.h"
+
+
+/**
+ * @brief StroopTrialTableModel::StroopTrialTableModel
+ * @param parent
+ */
+StroopTrialTableModel::StroopTrialTableModel(QObject* parent)
+   : QAbstractTableModel(parent)
+{
+}
+
+
+/**
+ * @brief StroopTrialTableModel::setTrials
+ * @param trials Shared with the caller, not copied
+ */
+void StroopTrialTableModel::setTrials(const QVector<StroopTrial>& trials)
+{
+   beginResetModel();
+   m_qvecTrials = trials;
+   endResetModel();
+}
+
+
+/**
+ * @brief StroopTrialTableModel::clear
+ */
+void StroopTrialTableModel::clear()
+{
+   setTrials(QVector<StroopTrial>());
+}
+
+
+/**
+ * @brief StroopTrialTableModel::trial
+ * @param row
+ * @return
+ */
+const StroopTrial& StroopTrialTableModel::trial(int row) const
+{
+   return m_qvecTrials.at(row);
+}
+
+
+/**
+ * @brief StroopTrialTableModel::headers
+ * @return German column titles, also used for the CSV export
+ */
+QStringList StroopTrialTableModel::headers() const
+{
+   QStringList titles;
+   for (int col=0; col<NumColumns; col++)
+   {
+      titles.append(headerData(col, Qt::Horizontal).toString());
+   }
+
+   return titles;
+}
+
+
+/**
+ * @brief StroopTrialTableModel::rowCount
+ * @param parent
+ * @return
+ */
+int StroopTrialTableModel::rowCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : m_qvecTrials.count();
+}
+
+
+/**
+ * @brief StroopTrialTableModel::columnCount
+ * @param parent
+ * @return
+ */
+int StroopTrialTableModel::columnCount(const QModelIndex& parent) const
+{
+   return parent.isValid() ? 0 : NumColumns;
+}
+
+
+/**
+ * @brief StroopTrialTableModel::data
+ * @param index
+ * @param role
+ * @return Cells formatted like StroopTrial::toStringList(false, true)
+ */
+QVariant StroopTrialTableModel::data(const QModelIndex& index, int role) const
+{
+   if (!index.isValid() || index.row() >= m_qvecTrials.count()) { return QVariant(); }
+
+   const StroopTrial& trial = m_qvecTrials.at(index.row());
+
+   if (role == Qt::TextAlignmentRole)
+   {
+      const bool numeric = index.column() >= CorrectColumn && index.column() != PressesColumn;
+      return int(numeric ? (Qt::AlignRight | Qt::AlignVCenter) : (Qt::AlignLeft | Qt::AlignVCenter));
+   }
+
+   if (role != Qt::DisplayRole) { return QVariant(); }
+
+   switch (index.column())
+   {
+      case ModeColumn:          return StroopTrial::modeToString(trial.m_nMode);
+      case TextColumn:          return trial.m_strText;
+      case ColorColumn:         return Experiment::convertColorToString(trial.m_nColor, true);
+      case ChosenColorColumn:   return Experiment::convertColorToString(trial.m_nChosenColor, true);
+      case CorrectColumn:       return trial.m_bCorrect ? QStringLiteral("1") : QStringLiteral("0");
+      case RTColumn:            return QString::number(trial.m_i64DecisionTime/1000.0, 'f', 3);
+      case StallColumn:         return trial.m_nStall;
+      case AnticipationsColumn: return trial.m_nAnticipations;
+      case AutoRepeatsColumn:   return trial.m_nAutoRepeats;
+      case PressesColumn:       return trial.pressesToString(true);
+      default: { break; }
+   }
+
+   return QVariant();
+}
+
+
+/**
+ * @brief StroopTrialTableModel::headerData
+ * @param section
+ * @param orientation
+ * @param role
+ * @return
+ */
+QVariant StroopTrialTableModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+   if (role != Qt::DisplayRole) { return QVariant(); }
+
+   if (orientation == Qt::Vertical) { return section + 1; }
+
+   switch (section)
+   {
+      case ModeColumn:          return QStringLiteral("Modus");
+      case TextColumn:          return QStringLiteral("Text");
+      case ColorColumn:         return QStringLiteral("Angezeigte Farbe");
+      case ChosenColorColumn:   return QStringLiteral("Gewählte Farbe");
+      case CorrectColumn:       return QStringLiteral("Übereinstimmung");
+      case RTColumn:            return QStringLiteral("Reaktionszeit");
+      case StallColumn:         return QStringLiteral("Störung (ms)");
+      case AnticipationsColumn: return QStringLiteral("Antizipationen");
+      case AutoRepeatsColumn:   return QStringLiteral("Wiederholungen");
+      case PressesColumn:       return QStringLiteral("Tastendrücke (ms)");
+      default: { break; }
+   }
+
+   return QVariant();
+}
+
+
+/**
+ * @brief StroopTrialFilterModel::StroopTrialFilterModel
+ * @param parent
+ */
+StroopTrialFilterModel::StroopTrialFilterModel(QObject* parent)
+   : QSortFilterProxyModel(parent)
+   , m_filters(NoFilter)
+{
+}
+
+
+/**
+ * @brief StroopTrialFilterModel::setFilters
+ * @param filters
+ */
+void StroopTrialFilterModel::setFilters(Filters filters)
+{
+   if (filters == m_filters) { return; }
+
+   m_filters = filters;
+   invalidateFilter();
+}
+
+
+/**
+ * @brief StroopTrialFilterModel::getFilters
+ * @return
+ */
+StroopTrialFilterModel::Filters StroopTrialFilterModel::getFilters() const
+{
+   return m_filters;
+}
+
+
+/**
+ * @brief StroopTrialFilterModel::filterAcceptsRow
+ * @param sourceRow
+ * @param sourceParent
+ * @return
+ */
+bool StroopTrialFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+   Q_UNUSED(sourceParent);
+
+   if (!m_filters) { return true; }
+
+   const StroopTrialTableModel* trials = qobject_cast<const StroopTrialTableModel*>(sourceModel());
+   if (!trials) { return true; }
+
+   const StroopTrial& trial = trials->trial(sourceRow);
+
+   if ((m_filters & CorrectOnly) && !trial.m_bCorrect)                    { return false; }
+   if ((m_filters & WithoutStalls) && trial.m_nStall > 0)                 { return false; }
+   if ((m_filters & WithoutAnticipations) && trial.m_nAnticipations > 0) { return false; }
+
+   return true;
+}
@@ -0,0 +1,88 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopExperiment.h"
+
+#include <QAbstractTableModel>
+#include <QSortFilterProxyModel>
+
+
+/**
+ * @brief The StroopTrialTableModel class
+ *
+ * Read-only table over the trials of a run. The trials are kept as they
+ * are; cells are only formatted when the view asks for them, so a model
+ * with many rows costs no more than the trials themselves.
+ */
+class StroopTrialTableModel : public QAbstractTableModel
+{
+      Q_OBJECT
+
+   public:
+      enum Column
+      {
+         ModeColumn, TextColumn, ColorColumn, ChosenColorColumn, CorrectColumn,
+         RTColumn, StallColumn, AnticipationsColumn, AutoRepeatsColumn, PressesColumn,
+         NumColumns
+      };
+
+      explicit StroopTrialTableModel(QObject* parent = nullptr);
+
+      void setTrials(const QVector<StroopTrial>& trials);
+      void clear();
+      const StroopTrial& trial(int row) const;
+
+      QStringList headers() const;
+
+      virtual int rowCount(const QModelIndex& parent = QModelIndex()) const;
+      virtual int columnCount(const QModelIndex& parent = QModelIndex()) const;
+      virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const;
+      virtual QVariant headerData(int section, Qt::Orientation orientation,
+                                  int role = Qt::DisplayRole) const;
+
+   private:
+      QVector<StroopTrial> m_qvecTrials;
+};
+
+
+/**
+ * @brief The StroopTrialFilterModel class
+ *
+ * Hides trials of a StroopTrialTableModel by their typed flags instead of
+ * comparing the formatted cells.
+ */
+class StroopTrialFilterModel : public QSortFilterProxyModel
+{
+      Q_OBJECT
+
+   public:
+      enum Filter
+      {
+         NoFilter             = 0x0,
+         CorrectOnly          = 0x1,
+         WithoutStalls        = 0x2,
+         WithoutAnticipations = 0x4
+      };
+      Q_DECLARE_FLAGS(Filters, Filter)
+
+      explicit StroopTrialFilterModel(QObject* parent = nullptr);
+
+      void setFilters(Filters filters);
+      Filters getFilters() const;
+
+   protected:
+      virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const;
+
+   private:
+      Filters m_filters;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(StroopTrialFilterModel::Filters)
@@ -0,0 +1,454 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StudyAnalyzer.h"
+#include "DataReaderWriter.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
+#include <iostream>
+
+
+/**
+ * @brief StudyAnalyzer::StudyAnalyzer
+ * @param wpDataRW
+ * @param parent
+ */
+StudyAnalyzer::StudyAnalyzer(std::weak_ptr<DataReaderWriter> wpDataRW, QObject* parent)
+   : QObject(parent)
+   , m_wpDataRW(wpDataRW)
+   , m_bFullDiffusionFit(false)
+{
+}
+
+
+/**
+ * @brief StudyAnalyzer::run
+ * @param dirPath Directory containing the *.stroop files of a study
+ * @return
+ *
+ * Complete batch pass: load, estimate, store and export
+ * "study_exgaussian.csv", "study_diffusion.csv" and "study_sequential.csv".
+ * If filter policies are set, "study_reevaluation.csv" is written as well.
+ */
+bool StudyAnalyzer::run(const QString& dirPath)
+{
+   QElapsedTimer elapsed;
+   elapsed.start();
+
+   int numParticipants = loadDirectory(dirPath);
+   if (numParticipants <= 0)
+   {
+      std::cout << "No participant files found in " << dirPath.toStdString() << std::endl;
+      return false;
+   }
+
+   analyze();
+
+   bool success = storeResults();
+   success &= exportExGaussianCSV(QDir(dirPath).absoluteFilePath("study_exgaussian.csv"));
+   success &= exportDiffusionCSV(QDir(dirPath).absoluteFilePath("study_diffusion.csv"));
+   success &= exportSequentialCSV(QDir(dirPath).absoluteFilePath("study_sequential.csv"));
+
+   if (!m_qvecFilterPolicies.isEmpty())
+   {
+      success &= exportReEvaluationCSV(QDir(dirPath).absoluteFilePath("study_reevaluation.csv"));
+   }
+
+   std::cout << "Analyzed " << numParticipants << " participants in "
+             << elapsed.elapsed() << " ms." << std::endl;
+
+   return success;
+}
+
+
+/**
+ * @brief StudyAnalyzer::setFullDiffusionFit
+ * @param fullDiffusionFit Fit the diffusion model by maximum likelihood in
+ *        addition to the closed-form EZ estimates
+ */
+void StudyAnalyzer::setFullDiffusionFit(bool fullDiffusionFit)
+{
+   m_bFullDiffusionFit = fullDiffusionFit;
+}
+
+
+/**
+ * @brief StudyAnalyzer::setFilterPolicies
+ * @param policies Filters for the re-evaluation export, empty to skip it
+ */
+void StudyAnalyzer::setFilterPolicies(const QVector<StroopFilterPolicy>& policies)
+{
+   m_qvecFilterPolicies = policies;
+}
+
+
+/**
+ * @brief StudyAnalyzer::loadDirectory
+ * @param dirPath
+ * @return Number of loaded participant files
+ */
+int StudyAnalyzer::loadDirectory(const QString& dirPath)
+{
+   m_qvecParticipants.clear();
+
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return 0; }
+
+   QDir dir(dirPath);
+   const QFileInfoList files = dir.entryInfoList(QStringList("*.stroop"),
+                                                 QDir::Files, QDir::Name);
+
+   for (const QFileInfo& fileInfo : files)
+   {
+      Participant participant;
+      participant.m_strPersonID = fileInfo.completeBaseName();
+      participant.m_strFilePath = fileInfo.absoluteFilePath();
+      m_qvecParticipants.append(participant);
+   }
+
+   // Parsing the files and splitting the trial strings dominates, so it runs in parallel.
+   DataReaderWriter* pDataRW = spDataRW.get();
+   QtConcurrent::blockingMap(m_qvecParticipants, [pDataRW](Participant& participant)
+   {
+      QMap<QString, QVariant> data;
+      pDataRW->loadData(participant.m_strFilePath, data);
+
+      const int numSessions = StroopExperiment::countSessions(data);
+      for (int n=1; n<=numSessions; n++)
+      {
+         const QString key = StroopExperiment::resultsKey(n);
+         if (!data.contains(key)) { continue; }
+
+         participant.m_qvecSessionNumbers.append(n);
+         participant.m_qvecSessions.append(
+                  StroopSessionColumns::fromSerialized(StroopExperiment::sessionResults(data, n)));
+      }
+   });
+
+   return m_qvecParticipants.count();
+}
+
+
+/**
+ * @brief StudyAnalyzer::analyze
+ *
+ * One job per session plus one pooled job per participant. The jobs are
+ * flattened so the thread pool is kept busy even if the number of sessions
+ * differs a lot between participants.
+ */
+void StudyAnalyzer::analyze()
+{
+   struct Job
+   {
+      int m_nParticipant;
+      int m_nSession; // -1: pooled over all sessions
+      StroopSessionEstimates m_estimates;
+   };
+
+   QVector<Job> jobs;
+   for (int p=0; p<m_qvecParticipants.count(); p++)
+   {
+      const int numSessions = m_qvecParticipants.at(p).m_qvecSessions.count();
+      for (int s=-1; s<numSessions; s++)
+      {
+         jobs.append(Job{p, s, StroopSessionEstimates()});
+      }
+   }
+
+   const QVector<Participant>& participants = m_qvecParticipants;
+   const bool fullDiffusionFit = m_bFullDiffusionFit;
+   QtConcurrent::blockingMap(jobs, [&participants, fullDiffusionFit](Job& job)
+   {
+      const Participant& participant = participants.at(job.m_nParticipant);
+
+      if (job.m_nSession >= 0)
+      {
+         job.m_estimates = StroopStatistics::estimateSession(
+                  participant.m_qvecSessions.at(job.m_nSession), fullDiffusionFit);
+      }
+      else
+      {
+         StroopSessionColumns pooled;
+         for (const StroopSessionColumns& session : participant.m_qvecSessions)
+         {
+            pooled.append(session);
+         }
+         job.m_estimates = StroopStatistics::estimateSession(pooled, fullDiffusionFit);
+
+         // Sequential effects must not pair the last trial of one session
+         // with the first trial of the next one.
+         job.m_estimates.m_sequentialEffects =
+               StroopStatistics::sequentialEffects(participant.m_qvecSessions);
+         job.m_estimates.m_qvecWindowSlopes.clear();
+      }
+   });
+
+   // Collect results and prepare the entries for the session store
+   for (Participant& participant : m_qvecParticipants)
+   {
+      participant.m_qvecEstimates.fill(StroopSessionEstimates(),
+                                       participant.m_qvecSessions.count() + 1);
+   }
+
+   for (const Job& job : jobs)
+   {
+      Participant& participant = m_qvecParticipants[job.m_nParticipant];
+      const int numSessions = participant.m_qvecSessions.count();
+
+      if (job.m_nSession < 0)
+      {
+         participant.m_qvecEstimates[numSessions] = job.m_estimates;
+         continue;
+      }
+
+      participant.m_qvecEstimates[job.m_nSession] = job.m_estimates;
+
+      const int sessionNumber = participant.m_qvecSessionNumbers.at(job.m_nSession);
+      job.m_estimates.insertInto(participant.m_mapNewData, sessionNumber);
+   }
+}
+
+
+/**
+ * @brief StudyAnalyzer::sessionLabel
+ * @param participant
+ * @param idx Index into m_qvecEstimates
+ * @return Session number or "alle" for the pooled estimates
+ */
+QString StudyAnalyzer::sessionLabel(const Participant& participant, int idx) const
+{
+   if (idx >= participant.m_qvecSessionNumbers.count())
+   {
+      return QString("alle");
+   }
+
+   return QString::number(participant.m_qvecSessionNumbers.at(idx));
+}
+
+
+/**
+ * @brief StudyAnalyzer::storeResults
+ * @return
+ *
+ * Merges the new entries into each participant's file. Existing keys that
+ * are not touched by the analysis stay as they are.
+ */
+bool StudyAnalyzer::storeResults()
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   DataReaderWriter* pDataRW = spDataRW.get();
+   QtConcurrent::blockingMap(m_qvecParticipants, [pDataRW](Participant& participant)
+   {
+      if (!participant.m_mapNewData.isEmpty())
+      {
+         pDataRW->saveData(participant.m_strFilePath, participant.m_mapNewData);
+      }
+   });
+
+   return true;
+}
+
+
+/**
+ * @brief StudyAnalyzer::exportExGaussianCSV
+ * @param filePath
+ * @return
+ */
+bool StudyAnalyzer::exportExGaussianCSV(const QString& filePath) const
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   QVector<QStringList> dataToExport;
+
+   QStringList headers;
+   headers << "Versuchsperson" << "Sitzung" << "Modus" << "n"
+           << "mu(ms)" << "sigma(ms)" << "tau(ms)" << "LogLikelihood"
+           << "Iterationen" << "Gradientennorm" << "Konvergiert";
+   dataToExport.append(headers);
+
+   for (const Participant& participant : m_qvecParticipants)
+   {
+      for (int s=0; s<participant.m_qvecEstimates.count(); s++)
+      {
+         const QString session = sessionLabel(participant, s);
+
+         const QVector<ExGaussianFit>& fits = participant.m_qvecEstimates.at(s).m_qvecExGaussian;
+         for (int cond=0; cond<fits.count(); cond++)
+         {
+            const ExGaussianFit& fit = fits.at(cond);
+
+            QStringList row;
+            row << participant.m_strPersonID << session
+                << StroopTrial::modeToString(static_cast<StroopTrialModes>(cond))
+                << QString::number(fit.m_nNumSamples)
+                << QString::number(fit.m_dMu, 'f', 3)
+                << QString::number(fit.m_dSigma, 'f', 3)
+                << QString::number(fit.m_dTau, 'f', 3)
+                << QString::number(fit.m_dLogLikelihood, 'f', 4)
+                << QString::number(fit.m_nIterations)
+                << QString::number(fit.m_dGradientNorm, 'g', 3)
+                << (fit.m_bConverged ? "1" : "0");
+
+            dataToExport.append(row);
+         }
+      }
+   }
+
+   return spDataRW->writeCSV(filePath, dataToExport);
+}
+
+
+/**
+ * @brief StudyAnalyzer::exportDiffusionCSV
+ * @param filePath
+ * @return
+ *
+ * One row per participant, session and condition with the EZ estimates and,
+ * if requested, the maximum-likelihood estimates side by side.
+ */
+bool StudyAnalyzer::exportDiffusionCSV(const QString& filePath) const
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   QVector<QStringList> dataToExport;
+
+   QStringList headers;
+   headers << "Versuchsperson" << "Sitzung" << "Modus" << "n" << "Anteil korrekt"
+           << "EZ v" << "EZ a" << "EZ Ter(ms)" << "EZ gueltig";
+   if (m_bFullDiffusionFit)
+   {
+      headers << "ML v" << "ML a" << "ML Ter(ms)" << "ML LogLikelihood"
+              << "ML Iterationen" << "ML Konvergiert";
+   }
+   dataToExport.append(headers);
+
+   for (const Participant& participant : m_qvecParticipants)
+   {
+      for (int s=0; s<participant.m_qvecEstimates.count(); s++)
+      {
+         const StroopSessionEstimates& estimates = participant.m_qvecEstimates.at(s);
+
+         for (int cond=0; cond<estimates.m_qvecEZDiffusion.count(); cond++)
+         {
+            const DiffusionEstimate& ez = estimates.m_qvecEZDiffusion.at(cond);
+
+            QStringList row;
+            row << participant.m_strPersonID << sessionLabel(participant, s)
+                << StroopTrial::modeToString(static_cast<StroopTrialModes>(cond))
+                << QString::number(ez.m_nNumSamples)
+                << QString::number(ez.m_dAccuracy, 'f', 4)
+                << QString::number(ez.m_dDriftRate, 'f', 5)
+                << QString::number(ez.m_dBoundarySeparation, 'f', 5)
+                << QString::number(ez.m_dNonDecisionTime, 'f', 3)
+                << (ez.m_bValid ? "1" : "0");
+
+            if (m_bFullDiffusionFit && cond < estimates.m_qvecWienerDiffusion.count())
+            {
+               const DiffusionEstimate& ml = estimates.m_qvecWienerDiffusion.at(cond);
+               row << QString::number(ml.m_dDriftRate, 'f', 5)
+                   << QString::number(ml.m_dBoundarySeparation, 'f', 5)
+                   << QString::number(ml.m_dNonDecisionTime, 'f', 3)
+                   << QString::number(ml.m_dLogLikelihood, 'f', 4)
+                   << QString::number(ml.m_nIterations)
+                   << (ml.m_bValid ? "1" : "0");
+            }
+
+            dataToExport.append(row);
+         }
+      }
+   }
+
+   return spDataRW->writeCSV(filePath, dataToExport);
+}
+
+
+/**
+ * @brief StudyAnalyzer::exportSequentialCSV
+ * @param filePath
+ * @return
+ */
+bool StudyAnalyzer::exportSequentialCSV(const QString& filePath) const
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   QVector<QStringList> dataToExport;
+
+   QStringList headers;
+   headers << "Versuchsperson" << "Sitzung" << "Trials" << "Fehler"
+           << "PES(ms)" << "PES Paare" << "PES traditionell(ms)"
+           << "cC(ms)" << "cI(ms)" << "iC(ms)" << "iI(ms)"
+           << "n cC" << "n cI" << "n iC" << "n iI" << "Gratton-Effekt(ms)"
+           << "Steigung(ms/Trial)" << "min. Fenstersteigung" << "max. Fenstersteigung"
+           << "Fenstergroesse";
+   dataToExport.append(headers);
+
+   for (const Participant& participant : m_qvecParticipants)
+   {
+      for (int s=0; s<participant.m_qvecEstimates.count(); s++)
+      {
+         QStringList row;
+         row << participant.m_strPersonID << sessionLabel(participant, s);
+         row.append(participant.m_qvecEstimates.at(s).m_sequentialEffects.toString().split(";"));
+
+         dataToExport.append(row);
+      }
+   }
+
+   return spDataRW->writeCSV(filePath, dataToExport);
+}
+
+
+/**
+ * @brief StudyAnalyzer::exportReEvaluationCSV
+ * @param filePath
+ * @return
+ *
+ * All sessions of all participants are scanned in one parallel pass, one
+ * group of columns per filter policy.
+ */
+bool StudyAnalyzer::exportReEvaluationCSV(const QString& filePath) const
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   QVector<StroopSessionColumns> sessions;
+   for (const Participant& participant : m_qvecParticipants)
+   {
+      sessions.append(participant.m_qvecSessions);
+   }
+
+   const QVector<QVector<StroopFilteredSummary>> summaries =
+         StroopReEvaluation::evaluateSessions(sessions, m_qvecFilterPolicies);
+
+   QVector<QStringList> dataToExport;
+   dataToExport.append(StroopReEvaluation::csvHeaders(m_qvecFilterPolicies));
+
+   int idx = 0;
+   for (const Participant& participant : m_qvecParticipants)
+   {
+      for (int s=0; s<participant.m_qvecSessions.count(); s++, idx++)
+      {
+         dataToExport.append(StroopReEvaluation::csvRows(participant.m_strPersonID,
+                                                         sessionLabel(participant, s),
+                                                         participant.m_qvecSessions.at(s).m_strTimeStamp,
+                                                         summaries.at(idx)));
+      }
+   }
+
+   return spDataRW->writeCSV(filePath, dataToExport);
+}
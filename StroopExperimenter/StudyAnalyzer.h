@@ -0,0 +1,72 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopStatistics.h"
+#include "StroopReEvaluation.h"
+#include <QObject>
+#include <QMap>
+#include <QVector>
+
+// Forward declarations
+class DataReaderWriter;
+
+
+/**
+ * @brief The StudyAnalyzer class
+ *
+ * Batch analysis of all participant files (*.stroop) of a study directory.
+ * Files are loaded and decoded once, the estimators run on the global
+ * QThreadPool and the results are written back into the session store of
+ * each participant as well as into a study-wide CSV file.
+ */
+class StudyAnalyzer : public QObject
+{
+      Q_OBJECT
+
+   public:
+      explicit StudyAnalyzer(std::weak_ptr<DataReaderWriter> wpDataRW,
+                             QObject* parent = nullptr);
+
+      bool run(const QString& dirPath);
+
+      void setFullDiffusionFit(bool fullDiffusionFit);
+      void setFilterPolicies(const QVector<StroopFilterPolicy>& policies);
+
+      int loadDirectory(const QString& dirPath);
+      void analyze();
+      bool storeResults();
+      bool exportExGaussianCSV(const QString& filePath) const;
+      bool exportDiffusionCSV(const QString& filePath) const;
+      bool exportSequentialCSV(const QString& filePath) const;
+      bool exportReEvaluationCSV(const QString& filePath) const;
+
+   private:
+      struct Participant
+      {
+         QString m_strPersonID;
+         QString m_strFilePath;
+         QVector<int> m_qvecSessionNumbers;
+         QVector<StroopSessionColumns> m_qvecSessions;
+
+         // Results to be merged into the participant's file
+         QMap<QString, QVariant> m_mapNewData;
+
+         // Estimates per session, the last entry pools all sessions
+         QVector<StroopSessionEstimates> m_qvecEstimates;
+      };
+
+      QString sessionLabel(const Participant& participant, int idx) const;
+
+      QVector<Participant> m_qvecParticipants;
+      std::weak_ptr<DataReaderWriter> m_wpDataRW;
+      bool m_bFullDiffusionFit;
+      QVector<StroopFilterPolicy> m_qvecFilterPolicies;
+};
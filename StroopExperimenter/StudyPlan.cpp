@@ -0,0 +1,396 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "StudyPlan.h"
+
+#include <QFile>
+#include <QDataStream>
+#include <QDir>
+#include <QSaveFile>
+#include <QSet>
+
+#include <algorithm>
+#include <iostream>
+
+
+static constexpr quint32 PlanMagic   = 0x5354504C; // "STPL"
+static constexpr quint16 PlanVersion = 1;
+
+// magic, version, flags, study seed, #entries, table size
+static constexpr qint64 HeaderSize = 4 + 2 + 1 + 8 + 4 + 4;
+
+// hash, record offset
+static constexpr qint64 SlotSize = 8 + 4;
+
+
+/**
+ * @brief writeRecord
+ * @param stream
+ * @param entry Indices must fit into one byte each
+ */
+static void writeRecord(QDataStream& stream, const StudyPlanEntry& entry)
+{
+   stream << entry.m_strParticipantID << entry.m_u64Seed;
+
+   stream << static_cast<quint8>(entry.m_qvecConditionOrder.count());
+   for (int cond : entry.m_qvecConditionOrder) { stream << static_cast<quint8>(cond); }
+
+   stream << static_cast<quint32>(entry.m_qvecTrialIndices.count());
+   for (int idx : entry.m_qvecTrialIndices) { stream << static_cast<quint8>(idx); }
+}
+
+
+/**
+ * @brief readRecord
+ * @param stream Positioned at the start of a record
+ * @param entry
+ * @return
+ */
+static bool readRecord(QDataStream& stream, StudyPlanEntry& entry)
+{
+   quint8 numConditions = 0;
+   quint32 numTrials = 0;
+
+   stream >> entry.m_strParticipantID >> entry.m_u64Seed >> numConditions;
+
+   entry.m_qvecConditionOrder.resize(numConditions);
+   for (int i=0; i<numConditions; i++)
+   {
+      quint8 cond = 0;
+      stream >> cond;
+      entry.m_qvecConditionOrder[i] = cond;
+   }
+
+   stream >> numTrials;
+   if (stream.status() != QDataStream::Ok) { return false; }
+
+   entry.m_qvecTrialIndices.resize(static_cast<int>(numTrials));
+   for (quint32 i=0; i<numTrials; i++)
+   {
+      quint8 idx = 0;
+      stream >> idx;
+      entry.m_qvecTrialIndices[static_cast<int>(i)] = idx;
+   }
+
+   return stream.status() == QDataStream::Ok;
+}
+
+
+/**
+ * @brief StudyPlanEntry::StudyPlanEntry
+ */
+StudyPlanEntry::StudyPlanEntry()
+   : m_u64Seed(0ULL)
+   , m_bEquallyDistributed(true)
+{
+}
+
+
+/**
+ * @brief StudyPlanEntry::isValid
+ * @return
+ */
+bool StudyPlanEntry::isValid() const
+{
+   return !m_strParticipantID.isEmpty() && !m_qvecTrialIndices.isEmpty();
+}
+
+
+/**
+ * @brief StudyPlan::StudyPlan
+ */
+StudyPlan::StudyPlan()
+   : m_u64StudySeed(0ULL)
+   , m_bEquallyDistributed(true)
+   , m_u32NumEntries(0)
+   , m_u32TableSize(0)
+{
+}
+
+
+/**
+ * @brief StudyPlan::open
+ * @param filePath
+ * @return
+ *
+ * Only reads the header; records are read on lookup.
+ */
+bool StudyPlan::open(const QString& filePath)
+{
+   m_strFilePath.clear();
+
+   QFile file(filePath);
+   if (!file.open(QIODevice::ReadOnly)) { return false; }
+
+   QDataStream stream(&file);
+   stream.setVersion(QDataStream::Qt_6_0);
+
+   quint32 magic = 0;
+   quint16 version = 0;
+   quint8 flags = 0;
+
+   stream >> magic >> version >> flags >> m_u64StudySeed >> m_u32NumEntries >> m_u32TableSize;
+
+   const bool tableSizeValid = m_u32TableSize > 0 && (m_u32TableSize & (m_u32TableSize - 1)) == 0;
+
+   if (stream.status() != QDataStream::Ok || magic != PlanMagic
+       || version != PlanVersion || !tableSizeValid)
+   {
+      return false;
+   }
+
+   m_bEquallyDistributed = (flags & 0x01) != 0;
+   m_strFilePath = filePath;
+
+   return true;
+}
+
+
+/**
+ * @brief StudyPlan::isOpen
+ * @return
+ */
+bool StudyPlan::isOpen() const
+{
+   return !m_strFilePath.isEmpty();
+}
+
+
+/**
+ * @brief StudyPlan::getFilePath
+ * @return
+ */
+QString StudyPlan::getFilePath() const
+{
+   return m_strFilePath;
+}
+
+
+/**
+ * @brief StudyPlan::getStudySeed
+ * @return
+ */
+quint64 StudyPlan::getStudySeed() const
+{
+   return m_u64StudySeed;
+}
+
+
+/**
+ * @brief StudyPlan::getNumEntries
+ * @return
+ */
+int StudyPlan::getNumEntries() const
+{
+   return static_cast<int>(m_u32NumEntries);
+}
+
+
+/**
+ * @brief StudyPlan::lookup
+ * @param participantID
+ * @param entry Only changed if the participant is part of the plan
+ * @return
+ */
+bool StudyPlan::lookup(const QString& participantID, StudyPlanEntry& entry) const
+{
+   if (!isOpen()) { return false; }
+
+   QFile file(m_strFilePath);
+   if (!file.open(QIODevice::ReadOnly)) { return false; }
+
+   QDataStream stream(&file);
+   stream.setVersion(QDataStream::Qt_6_0);
+
+   const quint64 hash = hashID(participantID);
+   const quint32 mask = m_u32TableSize - 1;
+
+   for (quint32 probe=0; probe<m_u32TableSize; probe++)
+   {
+      const quint32 slot = (static_cast<quint32>(hash) + probe) & mask;
+
+      quint64 slotHash = 0ULL;
+      quint32 offset = 0;
+
+      file.seek(HeaderSize + slot * SlotSize);
+      stream >> slotHash >> offset;
+
+      if (stream.status() != QDataStream::Ok || offset == 0) { return false; }
+      if (slotHash != hash) { continue; }
+
+      StudyPlanEntry candidate;
+      file.seek(offset);
+      if (!readRecord(stream, candidate)) { return false; }
+
+      // Different IDs may share a hash
+      if (candidate.m_strParticipantID == participantID)
+      {
+         candidate.m_bEquallyDistributed = m_bEquallyDistributed;
+         entry = candidate;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+
+/**
+ * @brief StudyPlan::write
+ * @param filePath
+ * @param studySeed
+ * @param equallyDistributed Condition counts of the plan
+ * @param entries Unique participant IDs
+ * @return
+ */
+bool StudyPlan::write(const QString& filePath, quint64 studySeed, bool equallyDistributed,
+                      const QVector<StudyPlanEntry>& entries)
+{
+   QSet<QString> ids;
+   for (const StudyPlanEntry& entry : entries)
+   {
+      if (ids.contains(entry.m_strParticipantID)) { return false; }
+      ids.insert(entry.m_strParticipantID);
+
+      for (int idx : entry.m_qvecTrialIndices)
+      {
+         if (idx < 0 || idx > 255) { return false; }
+      }
+   }
+
+   // At most half of the slots are used
+   quint32 tableSize = 1;
+   while (tableSize < 2U * static_cast<quint32>(entries.count())) { tableSize <<= 1; }
+
+   const qint64 recordsStart = HeaderSize + tableSize * SlotSize;
+
+   QVector<quint64> slotHashes(static_cast<int>(tableSize), 0ULL);
+   QVector<quint32> slotOffsets(static_cast<int>(tableSize), 0);
+
+   QByteArray records;
+   {
+      QDataStream recordStream(&records, QIODevice::WriteOnly);
+      recordStream.setVersion(QDataStream::Qt_6_0);
+
+      for (const StudyPlanEntry& entry : entries)
+      {
+         const quint64 hash = hashID(entry.m_strParticipantID);
+
+         quint32 slot = static_cast<quint32>(hash) & (tableSize - 1);
+         while (slotOffsets.at(static_cast<int>(slot)) != 0)
+         {
+            slot = (slot + 1) & (tableSize - 1);
+         }
+
+         slotHashes[static_cast<int>(slot)] = hash;
+         slotOffsets[static_cast<int>(slot)] =
+               static_cast<quint32>(recordsStart + recordStream.device()->pos());
+
+         writeRecord(recordStream, entry);
+      }
+   }
+
+   // Written to a temporary file first, a failed write keeps the old plan
+   QSaveFile file(filePath);
+   if (!file.open(QIODevice::WriteOnly)) { return false; }
+
+   QDataStream stream(&file);
+   stream.setVersion(QDataStream::Qt_6_0);
+
+   stream << PlanMagic << PlanVersion << static_cast<quint8>(equallyDistributed ? 0x01 : 0x00)
+          << studySeed << static_cast<quint32>(entries.count()) << tableSize;
+
+   for (int slot=0; slot<static_cast<int>(tableSize); slot++)
+   {
+      stream << slotHashes.at(slot) << slotOffsets.at(slot);
+   }
+
+   stream.writeRawData(records.constData(), records.size());
+
+   if (stream.status() != QDataStream::Ok)
+   {
+      file.cancelWriting();
+      return false;
+   }
+
+   if (!file.commit())
+   {
+      QString errorMessage = QString("Cannot write file %1:\n%2.")
+                     .arg(QDir::toNativeSeparators(filePath), file.errorString());
+
+      std::cout << errorMessage.toStdString() << std::endl;
+      return false;
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief StudyPlan::williamsSquare
+ * @param numConditions
+ * @return Rows of a Williams design: every condition appears once at every
+ *         position and directly follows every other condition equally often.
+ *         Odd numbers of conditions need the mirrored rows, too (2n rows).
+ */
+QVector<QVector<int>> StudyPlan::williamsSquare(int numConditions)
+{
+   QVector<QVector<int>> rows;
+   if (numConditions <= 0) { return rows; }
+
+   // First row: 0, 1, n-1, 2, n-2, ...
+   QVector<int> first;
+   int low = 1;
+   int high = numConditions - 1;
+
+   first.append(0);
+   for (int k=1; k<numConditions; k++)
+   {
+      first.append((k % 2 == 1) ? low++ : high--);
+   }
+
+   for (int r=0; r<numConditions; r++)
+   {
+      QVector<int> row;
+      for (int cond : first) { row.append((cond + r) % numConditions); }
+      rows.append(row);
+   }
+
+   if (numConditions % 2 == 1)
+   {
+      for (int r=0; r<numConditions; r++)
+      {
+         QVector<int> row = rows.at(r);
+         std::reverse(row.begin(), row.end());
+         rows.append(row);
+      }
+   }
+
+   return rows;
+}
+
+
+/**
+ * @brief StudyPlan::hashID
+ * @param participantID
+ * @return 64 bit FNV-1a hash of the UTF-8 encoded ID
+ */
+quint64 StudyPlan::hashID(const QString& participantID)
+{
+   quint64 hash = 14695981039346656037ULL;
+
+   const QByteArray bytes = participantID.toUtf8();
+   for (char byte : bytes)
+   {
+      hash ^= static_cast<quint8>(byte);
+      hash *= 1099511628211ULL;
+   }
+
+   return hash;
+}
@@ -0,0 +1,74 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QString>
+
+
+/**
+ * @brief The StudyPlanEntry struct
+ *
+ * Precomputed run of one participant.
+ */
+struct StudyPlanEntry
+{
+   StudyPlanEntry();
+
+   bool isValid() const;
+
+   QString m_strParticipantID;
+   quint64 m_u64Seed;
+   bool m_bEquallyDistributed;
+   QVector<int> m_qvecConditionOrder; // Row of the Williams square: block order
+   QVector<int> m_qvecTrialIndices;   // Indices into StroopExperiment::createStroopTrials()
+};
+
+
+/**
+ * @brief The StudyPlan class
+ *
+ * Binary plan file of a study (*.stplan). Layout (QDataStream, big endian):
+ *
+ *   header  magic, version, flags, study seed, #entries, table size
+ *   table   table size slots of (FNV-1a hash of the ID, record offset),
+ *           open addressing with linear probing, offset 0: empty slot
+ *   records participant ID, seed, condition order, trial indices (1 byte each)
+ *
+ * Slots have a fixed size, so a lookup seeks to the slot of the ID's hash
+ * and reads a single record without loading the rest of the file.
+ */
+class StudyPlan
+{
+   public:
+      StudyPlan();
+
+      bool open(const QString& filePath);
+      bool isOpen() const;
+
+      QString getFilePath() const;
+      quint64 getStudySeed() const;
+      int getNumEntries() const;
+
+      bool lookup(const QString& participantID, StudyPlanEntry& entry) const;
+
+      static bool write(const QString& filePath, quint64 studySeed, bool equallyDistributed,
+                        const QVector<StudyPlanEntry>& entries);
+
+      static QVector<QVector<int>> williamsSquare(int numConditions);
+      static quint64 hashID(const QString& participantID);
+
+   private:
+      QString m_strFilePath;
+      quint64 m_u64StudySeed;
+      bool    m_bEquallyDistributed;
+      quint32 m_u32NumEntries;
+      quint32 m_u32TableSize;
+};
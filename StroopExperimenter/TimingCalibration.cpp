@@ -0,0 +1,340 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "TimingCalibration.h"
+
+#include <QGuiApplication>
+#include <QScreen>
+#include <QSysInfo>
+
+#include <cmath>
+#include <limits>
+
+
+/**
+ * @brief TimingThresholds::TimingThresholds
+ * Defaults: 1 µs clock steps, timers at most 2 ms late with 1 ms jitter,
+ * refresh intervals within 0.5 ms, stimulus updates within a quarter of
+ * a 60 Hz frame.
+ */
+TimingThresholds::TimingThresholds()
+   : m_i64MaxClockResolution(1000LL)
+   , m_dMaxTimerLateness(2.0)
+   , m_dMaxTimerJitter(1.0)
+   , m_dMaxFrameDeviation(0.5)
+   , m_dMaxStimulusUpdate(4.0)
+{
+}
+
+
+/**
+ * @brief TimingThresholds::fromString
+ * @param spec Comma-separated limits, e.g. "resolution:1000,timer:2,jitter:1,frame:0.5,update:4"
+ *        (resolution in ns, the others in ms); limits not given keep their default
+ * @param thresholds
+ * @return False if the spec could not be parsed
+ */
+bool TimingThresholds::fromString(const QString& spec, TimingThresholds& thresholds)
+{
+   TimingThresholds result;
+
+   const QStringList limits = spec.split(",", Qt::SkipEmptyParts);
+   for (const QString& limit : limits)
+   {
+      const QStringList parts = limit.trimmed().toLower().split(":");
+      if (parts.count() != 2) { return false; }
+
+      bool ok = false;
+      const double value = parts.at(1).toDouble(&ok);
+      if (!ok || value <= 0.0) { return false; }
+
+      if      (parts.at(0) == "resolution") { result.m_i64MaxClockResolution = qRound64(value); }
+      else if (parts.at(0) == "timer")      { result.m_dMaxTimerLateness = value; }
+      else if (parts.at(0) == "jitter")     { result.m_dMaxTimerJitter = value; }
+      else if (parts.at(0) == "frame")      { result.m_dMaxFrameDeviation = value; }
+      else if (parts.at(0) == "update")     { result.m_dMaxStimulusUpdate = value; }
+      else                                  { return false; }
+   }
+
+   thresholds = result;
+   return true;
+}
+
+
+/**
+ * @brief TimingCalibrationRecord::TimingCalibrationRecord
+ */
+TimingCalibrationRecord::TimingCalibrationRecord()
+   : m_bValid(false)
+   , m_bMonotonic(false)
+   , m_i64ClockResolution(-1LL)
+   , m_dTimerLatenessMean(0.0)
+   , m_dTimerLatenessMax(0.0)
+   , m_dTimerJitter(0.0)
+   , m_dNominalRefreshRate(0.0)
+   , m_dRefreshInterval(0.0)
+   , m_dRefreshDeviation(0.0)
+   , m_dStimulusUpdateMean(0.0)
+   , m_dStimulusUpdateMax(0.0)
+{
+}
+
+
+/**
+ * @brief TimingCalibrationRecord::toString
+ * @return Compact record, see the class description
+ */
+QString TimingCalibrationRecord::toString() const
+{
+   QStringList fields;
+
+   fields.append("station=" + m_strStation);
+   fields.append("platform=" + m_strPlatform);
+   fields.append("clock=" + m_strClockType);
+   fields.append(QString("monotonic=%1").arg(m_bMonotonic ? 1 : 0));
+   fields.append(QString("resolutionNs=%1").arg(m_i64ClockResolution));
+   fields.append("timerMs=" + QString::number(m_dTimerLatenessMean, 'f', 3)
+                 + "/" + QString::number(m_dTimerLatenessMax, 'f', 3)
+                 + "/" + QString::number(m_dTimerJitter, 'f', 3));
+   fields.append("refreshHz=" + QString::number(m_dNominalRefreshRate, 'f', 2));
+   fields.append("frameMs=" + (m_dRefreshInterval > 0.0
+                               ? QString::number(m_dRefreshInterval, 'f', 3)
+                                 + "/" + QString::number(m_dRefreshDeviation, 'f', 3)
+                               : QString("-")));
+   fields.append("updateMs=" + QString::number(m_dStimulusUpdateMean, 'f', 3)
+                 + "/" + QString::number(m_dStimulusUpdateMax, 'f', 3));
+
+   return fields.join(";");
+}
+
+
+/**
+ * @brief TimingCalibrationRecord::check
+ * @param thresholds
+ * @return Values beyond the thresholds, empty if the station is fine
+ */
+QStringList TimingCalibrationRecord::check(const TimingThresholds& thresholds) const
+{
+   QStringList problems;
+
+   if (!m_bMonotonic)
+   {
+      problems.append(QString("clock %1 is not monotonic").arg(m_strClockType));
+   }
+   if (m_i64ClockResolution < 0LL || m_i64ClockResolution > thresholds.m_i64MaxClockResolution)
+   {
+      problems.append(QString("clock resolution %1 ns > %2 ns")
+                      .arg(m_i64ClockResolution).arg(thresholds.m_i64MaxClockResolution));
+   }
+   if (m_dTimerLatenessMax > thresholds.m_dMaxTimerLateness)
+   {
+      problems.append(QString("timer late by %1 ms > %2 ms")
+                      .arg(m_dTimerLatenessMax, 0, 'f', 2).arg(thresholds.m_dMaxTimerLateness));
+   }
+   if (m_dTimerJitter > thresholds.m_dMaxTimerJitter)
+   {
+      problems.append(QString("timer jitter %1 ms > %2 ms")
+                      .arg(m_dTimerJitter, 0, 'f', 2).arg(thresholds.m_dMaxTimerJitter));
+   }
+   if (m_dRefreshInterval > 0.0 && m_dRefreshDeviation > thresholds.m_dMaxFrameDeviation)
+   {
+      problems.append(QString("refresh interval SD %1 ms > %2 ms")
+                      .arg(m_dRefreshDeviation, 0, 'f', 2).arg(thresholds.m_dMaxFrameDeviation));
+   }
+   if (m_dStimulusUpdateMax > thresholds.m_dMaxStimulusUpdate)
+   {
+      problems.append(QString("stimulus update %1 ms > %2 ms")
+                      .arg(m_dStimulusUpdateMax, 0, 'f', 2).arg(thresholds.m_dMaxStimulusUpdate));
+   }
+
+   return problems;
+}
+
+
+/**
+ * @brief TimingCalibration::TimingCalibration
+ * @param parent
+ */
+TimingCalibration::TimingCalibration(QObject* parent)
+   : QObject(parent)
+   , m_bRunning(false)
+{
+   m_timer.setSingleShot(true);
+   m_timer.setTimerType(Qt::PreciseTimer);
+   m_timer.setInterval(TimerInterval);
+
+   m_qvecLateness.reserve(TimerSamples);
+
+   connect(&m_timer, &QTimer::timeout, this, &TimingCalibration::onTimeout);
+}
+
+
+/**
+ * @brief TimingCalibration::start
+ * @param screen Screen the stimuli are shown on
+ * @param stimulusUpdate Applies and paints stimulus number i (0...UpdateSamples-1);
+ *        only called from within start(), so the caller can restore its
+ *        screen before anything is shown
+ *
+ * Clock and stimulus updates are measured right away, the timer over the
+ * next TimerSamples * TimerInterval ms; finished() is emitted then.
+ */
+void TimingCalibration::start(QScreen* screen, const std::function<void(int)>& stimulusUpdate)
+{
+   if (m_bRunning) { return; }
+
+   m_record = TimingCalibrationRecord();
+   m_record.m_strStation = QSysInfo::machineHostName();
+   m_record.m_strPlatform = QGuiApplication::platformName();
+   m_record.m_dNominalRefreshRate = screen ? screen->refreshRate() : 0.0;
+
+   measureClock();
+   measureStimulusUpdate(stimulusUpdate);
+
+   m_bRunning = true;
+   m_qvecLateness.clear();
+
+   m_eltiTimer.start();
+   m_timer.start();
+}
+
+
+/**
+ * @brief TimingCalibration::isRunning
+ * @return
+ */
+bool TimingCalibration::isRunning() const
+{
+   return m_bRunning;
+}
+
+
+/**
+ * @brief TimingCalibration::addRefreshMeasurement
+ * @param intervalMs Measured refresh interval, see FramePresenter
+ * @param deviationMs Standard deviation of the swap intervals
+ */
+void TimingCalibration::addRefreshMeasurement(double intervalMs, double deviationMs)
+{
+   m_record.m_dRefreshInterval = intervalMs;
+   m_record.m_dRefreshDeviation = deviationMs;
+}
+
+
+/**
+ * @brief TimingCalibration::getRecord
+ * @return Result of the last pass
+ */
+const TimingCalibrationRecord& TimingCalibration::getRecord() const
+{
+   return m_record;
+}
+
+
+/**
+ * @brief TimingCalibration::measureClock
+ * Reads the clock in a tight loop; the smallest step seen is its resolution.
+ */
+void TimingCalibration::measureClock()
+{
+   QElapsedTimer clock;
+   clock.start();
+
+   switch (QElapsedTimer::clockType())
+   {
+      case QElapsedTimer::SystemTime:         m_record.m_strClockType = "SystemTime";         break;
+      case QElapsedTimer::MonotonicClock:     m_record.m_strClockType = "MonotonicClock";     break;
+      case QElapsedTimer::MachAbsoluteTime:   m_record.m_strClockType = "MachAbsoluteTime";   break;
+      case QElapsedTimer::PerformanceCounter: m_record.m_strClockType = "PerformanceCounter"; break;
+      default:                                m_record.m_strClockType = "Other";              break;
+   }
+   m_record.m_bMonotonic = QElapsedTimer::isMonotonic();
+
+   qint64 resolution = std::numeric_limits<qint64>::max();
+   qint64 last = clock.nsecsElapsed();
+
+   for (int i=0; i<ClockSamples; i++)
+   {
+      const qint64 now = clock.nsecsElapsed();
+      if (now != last)
+      {
+         resolution = qMin(resolution, now - last);
+         last = now;
+      }
+   }
+
+   m_record.m_i64ClockResolution = (resolution == std::numeric_limits<qint64>::max()) ? -1LL : resolution;
+}
+
+
+/**
+ * @brief TimingCalibration::measureStimulusUpdate
+ * @param stimulusUpdate See start()
+ */
+void TimingCalibration::measureStimulusUpdate(const std::function<void(int)>& stimulusUpdate)
+{
+   if (!stimulusUpdate) { return; }
+
+   QElapsedTimer clock;
+   double sum = 0.0;
+   double max = 0.0;
+
+   for (int i=0; i<UpdateSamples; i++)
+   {
+      clock.start();
+      stimulusUpdate(i);
+      const double duration = clock.nsecsElapsed() / 1000000.0;
+
+      sum += duration;
+      max = qMax(max, duration);
+   }
+
+   m_record.m_dStimulusUpdateMean = sum / UpdateSamples;
+   m_record.m_dStimulusUpdateMax = max;
+}
+
+
+/**
+ * @brief TimingCalibration::onTimeout
+ * Lateness of the precise single shot timer, restarted after each timeout.
+ */
+void TimingCalibration::onTimeout()
+{
+   if (!m_bRunning) { return; }
+
+   m_qvecLateness.append(m_eltiTimer.nsecsElapsed() / 1000000.0 - TimerInterval);
+
+   if (m_qvecLateness.count() < TimerSamples)
+   {
+      m_eltiTimer.start();
+      m_timer.start();
+      return;
+   }
+
+   double sum = 0.0;
+   double max = 0.0;
+   for (double lateness : m_qvecLateness)
+   {
+      sum += lateness;
+      max = qMax(max, lateness);
+   }
+   const double mean = sum / m_qvecLateness.count();
+
+   double sumSq = 0.0;
+   for (double lateness : m_qvecLateness) { sumSq += (lateness - mean) * (lateness - mean); }
+
+   m_record.m_dTimerLatenessMean = mean;
+   m_record.m_dTimerLatenessMax = max;
+   m_record.m_dTimerJitter = std::sqrt(sumSq / (m_qvecLateness.count() - 1));
+   m_record.m_bValid = true;
+
+   m_bRunning = false;
+
+   emit finished();
+}
@@ -0,0 +1,126 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+#include <functional>
+
+// Forward declarations
+class QScreen;
+
+
+/**
+ * @brief The TimingThresholds struct
+ * Limits a station has to meet, e.g. "timer:2,update:4" (-k).
+ */
+struct TimingThresholds
+{
+   TimingThresholds();
+
+   static bool fromString(const QString& spec, TimingThresholds& thresholds);
+
+   qint64 m_i64MaxClockResolution; // ns
+   double m_dMaxTimerLateness;     // ms, latest timer of the pass
+   double m_dMaxTimerJitter;       // ms, standard deviation of the lateness
+   double m_dMaxFrameDeviation;    // ms, standard deviation of the refresh interval
+   double m_dMaxStimulusUpdate;    // ms, slowest stimulus update
+};
+
+
+/**
+ * @brief The TimingCalibrationRecord struct
+ *
+ * Stored with each session as "StroopSession_N/calibration", e.g.
+ *
+ *   station=lab-2;platform=xcb;clock=MonotonicClock;monotonic=1;
+ *   resolutionNs=20;timerMs=0.084/0.412/0.061;refreshHz=60.00;
+ *   frameMs=16.668/0.012;updateMs=0.274/0.518
+ *
+ * (one line; timerMs: mean/max/SD of the lateness, frameMs: measured
+ * interval/SD, "-" without frame timing, updateMs: mean/max).
+ */
+struct TimingCalibrationRecord
+{
+   TimingCalibrationRecord();
+
+   QString toString() const;
+   QStringList check(const TimingThresholds& thresholds) const;
+
+   bool m_bValid;
+
+   QString m_strStation;   // Host name
+   QString m_strPlatform;  // Qt platform plugin, e.g. xcb, wayland, windows
+
+   QString m_strClockType; // QElapsedTimer::clockType()
+   bool    m_bMonotonic;
+   qint64  m_i64ClockResolution; // ns, smallest step seen, -1: none
+
+   double m_dTimerLatenessMean;  // ms after the intended time
+   double m_dTimerLatenessMax;
+   double m_dTimerJitter;        // ms, standard deviation
+
+   double m_dNominalRefreshRate; // Hz, as reported by the screen
+   double m_dRefreshInterval;    // ms, measured from swaps (frame timing), 0: not measured
+   double m_dRefreshDeviation;   // ms, standard deviation of the swap intervals
+
+   double m_dStimulusUpdateMean; // ms to apply and paint a stimulus
+   double m_dStimulusUpdateMax;
+};
+
+
+/**
+ * @brief The TimingCalibration class
+ *
+ * Short pass before a run (about 300 ms): resolution and type of the
+ * clock, lateness of a precise timer on the event loop, nominal refresh
+ * rate and the cost of a stimulus update. The refresh interval itself is
+ * measured from swaps, which only the frame timing mode has (see
+ * FramePresenter); it is added by addRefreshMeasurement().
+ */
+class TimingCalibration : public QObject
+{
+      Q_OBJECT
+
+   public:
+      static constexpr int ClockSamples  = 20000;
+      static constexpr int UpdateSamples = 16;
+      static constexpr int TimerSamples  = 50;
+      static constexpr int TimerInterval = 5; // ms
+
+      explicit TimingCalibration(QObject* parent = nullptr);
+
+      void start(QScreen* screen, const std::function<void(int)>& stimulusUpdate);
+      bool isRunning() const;
+
+      void addRefreshMeasurement(double intervalMs, double deviationMs);
+      const TimingCalibrationRecord& getRecord() const;
+
+   signals:
+      void finished();
+
+   private slots:
+      void onTimeout();
+
+   private:
+      void measureClock();
+      void measureStimulusUpdate(const std::function<void(int)>& stimulusUpdate);
+
+      QTimer m_timer;
+      QElapsedTimer m_eltiTimer;
+      QVector<double> m_qvecLateness; // ms
+      bool m_bRunning;
+
+      TimingCalibrationRecord m_record;
+};
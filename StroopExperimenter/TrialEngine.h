@@ -0,0 +1,858 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "AllocationGuard.h"
+#include "RunningMoments.h"
+
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+
+
+/**
+ * @brief The TrialEngine class
+ *
+ * Trial loop shared by the paradigms: slots of the run (all trials, or a
+ * ring for streamed runs), progress, input phases, press log, response and
+ * miss handling, statistics of the run and serialization of its trials.
+ * It also schedules the run: the timeline is walked (ISI or break, fixation
+ * point, stimulus and its response window), durations are kept in whole
+ * refreshes with frame timing, and completed trials are handed on in
+ * chunks between trials.
+ *
+ * Everything specific to a paradigm comes from the policy at compile time,
+ * so there is no virtual call per trial. The policy provides
+ *
+ *   Trial            Stimulus and result of one trial, copied from a template
+ *   Response         Element of the response set, e.g. the color of a key
+ *   Condition        Enumeration of the conditions
+ *   Responses        std::array of all valid responses
+ *   TimelineEvent    Timing of one trial of the run, compiled before it starts
+ *   condition(trial), conditionToString(condition)
+ *   setResponse(trial, response)
+ *   setAnswered(trial, decisionTime, stall), setMissed(trial, stall)
+ *   isValid(trial), isCorrect(trial), isMissed(trial)
+ *   decisionTime(trial), stall(trial), deadline(trial), setDeadline(trial, ms)
+ *   setOnset(trial, ms), logPress(trial, response, sinceFixation), resetPresses(trial)
+ *   countAnticipation(trial), countAutoRepeat(trial), anticipations(trial), autoRepeats(trial)
+ *   resultToString(trial), stimulusToString(trial)
+ *   setFixationFrames(trial, n), fixationFrames(trial), setFixationFramesShown(trial, n)
+ *   setStimulusFrames(trial, n), stimulusFrames(trial), setStimulusFramesShown(trial, n)
+ *   addDroppedFrames(trial, n), hasFrameErrors(trial)
+ *   pause(event) (ms blank before the fixation point, -1: until resumed),
+ *   fixation(event), deadline(event), isBreak(event), isPractice(event)
+ *
+ * The host shows the screens, runs the timers and measures the onsets; it
+ * is called directly, so it is a template parameter as well:
+ *
+ *   presentBlank(isBreak), presentFixationPoint(), presentStimulus(trial)
+ *   startBlankTimer(ms), startFixationTimer(ms), stopTimers()
+ *   startDeadline(position, ms), stopDeadline()
+ *   markFixationOnset(), markStimulusOnset() (returns ms after the fixation onset)
+ *   longestStall(), responseDeadline(trial, ms), recordOutcome(trial)
+ *   trialTemplate(position), onTrialCompleted(position), flushTrials(upToPosition)
+ *   pause(), stop()
+ *
+ * and calls back blankElapsed(), fixationElapsed(), framePresented(),
+ * handlePress(), respondAt(), timeout() and deadlineExpired().
+ *
+ * Only startRun() and truncate() allocate. Nothing the engine does from the
+ * display request of a stimulus to its response allocates either; this is
+ * checked by the AllocationGuard in debug builds.
+ */
+template <class Paradigm, class Host>
+class TrialEngine
+{
+   public:
+      using Trial     = typename Paradigm::Trial;
+      using Response  = typename Paradigm::Response;
+      using Condition = typename Paradigm::Condition;
+      using TimelineEvent = typename Paradigm::TimelineEvent;
+
+      // Presses are anticipations during the fixation point, the first
+      // press during the stimulus is the response
+      enum struct Phase { Idle, Fixation, Stimulus };
+
+      // Frame timing: what the next swap completes (a change requested
+      // before it is on screen with it) or counts down
+      enum struct FrameWait { None, BlankOnset, Blank, FixationOnset, Fixation,
+                              StimulusOnset, Stimulus };
+
+      struct RunStatistics
+      {
+         int m_nNumCorrect       = 0;
+         int m_nNumWrong         = 0;
+         int m_nNumMisses        = 0;
+         int m_nNumStalled       = 0;
+         int m_nNumAnticipations = 0;
+         int m_nNumAutoRepeats   = 0;
+         int m_nNumDroppedFrames = 0;
+         int m_nNumFrameErrors   = 0; // Trials with Paradigm::hasFrameErrors()
+         RunningMoments m_momentsAll;     // RTs of all answered trials
+         RunningMoments m_momentsCorrect; // RTs of correctly answered trials
+      };
+
+      explicit TrialEngine(Host& host)
+         : m_host(host)
+         , m_nProgress(0)
+         , m_bRing(false)
+         , m_nPhase(Phase::Idle)
+         , m_nNumTrials(0)
+         , m_bScheduling(false)
+         , m_nBreakTaken(-1)
+         , m_nFlushInterval(0)
+         , m_nFlushedUpTo(0)
+         , m_bFrameTiming(false)
+         , m_dRefreshInterval(1000.0 / 60.0)
+         , m_nFrameWait(FrameWait::None)
+         , m_i64Frame(0LL)
+         , m_i64FrameTarget(0LL)
+         , m_i64FixationFrame(0LL)
+         , m_i64StimulusFrame(0LL)
+         , m_nBlankFrames(0)
+      {
+      }
+
+      /**
+       * @brief TrialEngine::setFrameTiming
+       * @param enabled True if durations are counted in the swaps passed to
+       *        framePresented() instead of by the host's timers
+       * @param refreshIntervalMs Refresh interval of the display
+       *
+       * Used from the next startRun().
+       */
+      void setFrameTiming(bool enabled, double refreshIntervalMs)
+      {
+         m_bFrameTiming = enabled;
+         m_dRefreshInterval = refreshIntervalMs;
+      }
+
+      /**
+       * @brief TrialEngine::setFlushInterval
+       * @param numTrials Completed trials per Host::flushTrials(), 0: none
+       */
+      void setFlushInterval(int numTrials)
+      {
+         m_nFlushInterval = numTrials;
+      }
+
+      /**
+       * @brief TrialEngine::startRun
+       * @param numSlots Trials held during the run
+       * @param ring True if positions beyond numSlots reuse the slots
+       * @param timeline One event per trial of the run
+       *
+       * Prepares the first trial; the run is scheduled by resume().
+       */
+      void startRun(int numSlots, bool ring, const QVector<TimelineEvent>& timeline)
+      {
+         m_qvecTrials = QVector<Trial>(numSlots);
+         m_bRing = ring;
+         m_nProgress = 0;
+         m_nPhase = Phase::Idle;
+         m_stats = RunStatistics();
+
+         m_qvecTimeline = timeline;
+         m_nNumTrials = timeline.count();
+         m_bScheduling = false;
+         m_nBreakTaken = -1;
+         m_nFlushedUpTo = 0;
+         m_nFrameWait = FrameWait::None;
+
+         prepareTrial(0);
+      }
+
+      /**
+       * @brief TrialEngine::resume
+       * Continues the run with the current trial: an unanswered trial is
+       * shown again, a break that was shown is not.
+       */
+      void resume()
+      {
+         m_bScheduling = true;
+         nextTrial();
+      }
+
+      /**
+       * @brief TrialEngine::halt
+       * Stops the timers and ignores all input and swaps until resume(),
+       * e.g. on pause or stop.
+       */
+      void halt()
+      {
+         m_bScheduling = false;
+         m_nFrameWait = FrameWait::None;
+
+         m_host.stopTimers();
+         m_host.stopDeadline();
+         endTrial();
+
+         m_allocationGuard.disarm();
+      }
+
+      /**
+       * @brief TrialEngine::blankElapsed
+       * The ISI or break before the current trial is over.
+       */
+      void blankElapsed()
+      {
+         if (m_bScheduling) { showFixationPoint(); }
+      }
+
+      /**
+       * @brief TrialEngine::fixationElapsed
+       * The fixation point of the current trial is over.
+       */
+      void fixationElapsed()
+      {
+         if (m_bScheduling) { showStimulus(); }
+      }
+
+      /**
+       * @brief TrialEngine::framePresented
+       * @param frame Refreshes since the refresh interval was measured
+       * @param droppedFrames Refreshes missed before this swap
+       *
+       * Frame timing: a change requested here is on screen with the next
+       * swap, so a screen shown for N frames is replaced in the call N-1
+       * swaps after its onset. Misses are decided with the last frame of
+       * the stimulus.
+       */
+      void framePresented(qint64 frame, int droppedFrames)
+      {
+         m_i64Frame = frame;
+
+         if (!m_bFrameTiming || !m_bScheduling) { return; }
+
+         AllocationGuard::Section section;
+
+         if (droppedFrames > 0)
+         {
+            m_stats.m_nNumDroppedFrames += droppedFrames;
+
+            if (m_nPhase != Phase::Idle) { Paradigm::addDroppedFrames(current(), droppedFrames); }
+         }
+
+         // Onset of the change requested before this swap
+         if (m_nFrameWait == FrameWait::BlankOnset)
+         {
+            m_i64FrameTarget = frame + m_nBlankFrames - 1;
+            m_nFrameWait = FrameWait::Blank;
+         }
+         else if (m_nFrameWait == FrameWait::FixationOnset)
+         {
+            startFixation();
+
+            m_i64FixationFrame = frame;
+            m_i64FrameTarget = frame + Paradigm::fixationFrames(current()) - 1;
+            m_nFrameWait = FrameWait::Fixation;
+         }
+         else if (m_nFrameWait == FrameWait::StimulusOnset)
+         {
+            startStimulus();
+
+            Trial& cur = current();
+            Paradigm::setFixationFramesShown(cur, static_cast<int>(frame - m_i64FixationFrame));
+
+            m_i64StimulusFrame = frame;
+            m_i64FrameTarget = frame + Paradigm::stimulusFrames(cur) - 1;
+            m_nFrameWait = FrameWait::Stimulus;
+         }
+
+         // Last frame of the current screen: the next one is requested now
+         if (frame < m_i64FrameTarget) { return; }
+
+         if (m_nFrameWait == FrameWait::Blank)
+         {
+            showFixationPoint();
+         }
+         else if (m_nFrameWait == FrameWait::Fixation)
+         {
+            showStimulus();
+         }
+         else if (m_nFrameWait == FrameWait::Stimulus)
+         {
+            timeout();
+         }
+      }
+
+      /**
+       * @brief TrialEngine::handlePress
+       * @param response
+       * @param sinceFixation ms after the fixation onset of the current trial
+       * @param decisionTime ms after the stimulus onset, -1 for an anticipation
+       */
+      void handlePress(Response response, qint64 sinceFixation, qint64 decisionTime)
+      {
+         AllocationGuard::Section section;
+
+         // Anticipations are only logged
+         if (!press(response, sinceFixation, decisionTime)) { return; }
+
+         respondAt(decisionTime);
+      }
+
+      /**
+       * @brief TrialEngine::respondAt
+       * @param decisionTime Time from the stimulus onset to the response in ms
+       *
+       * Records the response of the current trial and continues the run.
+       */
+      void respondAt(qint64 decisionTime)
+      {
+         if (m_nPhase != Phase::Stimulus) { return; }
+
+         AllocationGuard::Section section;
+
+         // The deadline may have expired while its notification is still queued
+         if (decisionTime >= Paradigm::deadline(current()))
+         {
+            timeout();
+            return;
+         }
+
+         m_host.stopDeadline();
+
+         respond(decisionTime, m_host.longestStall());
+         m_host.recordOutcome(current());
+
+         completeTrial();
+      }
+
+      /**
+       * @brief TrialEngine::timeout
+       * No response within the deadline: the trial is recorded as a miss and
+       * does not enter the evaluation.
+       */
+      void timeout()
+      {
+         if (m_nPhase != Phase::Stimulus) { return; }
+
+         AllocationGuard::Section section;
+         m_host.stopDeadline();
+
+         miss(m_host.longestStall());
+         m_host.recordOutcome(current());
+
+         completeTrial();
+      }
+
+      /**
+       * @brief TrialEngine::deadlineExpired
+       * @param position Trial whose deadline expired, e.g. on a deadline thread
+       */
+      void deadlineExpired(int position)
+      {
+         if (position == m_nProgress) { timeout(); }
+      }
+
+      /**
+       * @brief TrialEngine::truncate
+       * @param numTrials Trials kept of an aborted run (rings are kept as they are)
+       */
+      void truncate(int numTrials)
+      {
+         if (!m_bRing) { m_qvecTrials.resize(numTrials); }
+      }
+
+      /**
+       * @brief TrialEngine::trial
+       * @param position Position in the current run
+       * @return Trial of the run; rings only hold the last numSlots trials
+       */
+      Trial& trial(int position)
+      {
+         return m_qvecTrials[m_bRing ? position % m_qvecTrials.count() : position];
+      }
+
+      /**
+       * @brief TrialEngine::trial
+       * @param position Position in the current run
+       * @return
+       */
+      const Trial& trial(int position) const
+      {
+         return m_qvecTrials.at(m_bRing ? position % m_qvecTrials.count() : position);
+      }
+
+      /**
+       * @brief TrialEngine::trials
+       * @return Slots of the run, e.g. to prefault them
+       */
+      const QVector<Trial>& trials() const
+      {
+         return m_qvecTrials;
+      }
+
+      /**
+       * @brief TrialEngine::current
+       * @return Trial at the current position
+       */
+      Trial& current()
+      {
+         return trial(m_nProgress);
+      }
+
+      /**
+       * @brief TrialEngine::prepare
+       * @param position Position in the current run
+       * @param templ Stimulus of the trial
+       */
+      void prepare(int position, const Trial& templ)
+      {
+         trial(position) = templ;
+      }
+
+      /**
+       * @brief TrialEngine::progress
+       * @return Position of the current trial, i.e. number of completed trials
+       */
+      int progress() const
+      {
+         return m_nProgress;
+      }
+
+      /**
+       * @brief TrialEngine::phase
+       * @return
+       */
+      Phase phase() const
+      {
+         return m_nPhase;
+      }
+
+      /**
+       * @brief TrialEngine::beginFixation
+       * Presses from now on belong to the current trial.
+       */
+      void beginFixation()
+      {
+         Paradigm::resetPresses(current());
+         m_eltiFixation.start();
+         m_nPhase = Phase::Fixation;
+      }
+
+      /**
+       * @brief TrialEngine::beginStimulus
+       * @param onset Stimulus onset in ms after the fixation onset
+       */
+      void beginStimulus(int onset)
+      {
+         Paradigm::setOnset(current(), onset);
+         m_eltiStimulus.start();
+         m_nPhase = Phase::Stimulus;
+      }
+
+      /**
+       * @brief TrialEngine::endTrial
+       * Ignores all input until the next fixation point, e.g. on pause.
+       */
+      void endTrial()
+      {
+         m_nPhase = Phase::Idle;
+      }
+
+      /**
+       * @brief TrialEngine::sinceFixation
+       * @return ms since the fixation onset of the current trial
+       */
+      qint64 sinceFixation() const
+      {
+         return m_eltiFixation.elapsed();
+      }
+
+      /**
+       * @brief TrialEngine::sinceStimulus
+       * @return ms since the stimulus onset of the current trial
+       */
+      qint64 sinceStimulus() const
+      {
+         return m_eltiStimulus.elapsed();
+      }
+
+      /**
+       * @brief TrialEngine::autoRepeat
+       * Presses generated by holding a key are only counted.
+       */
+      void autoRepeat()
+      {
+         if (m_nPhase != Phase::Idle) { Paradigm::countAutoRepeat(current()); }
+      }
+
+      /**
+       * @brief TrialEngine::press
+       * @param response
+       * @param sinceFixation ms after the fixation onset of the current trial
+       * @param decisionTime ms after the stimulus onset, -1 for an anticipation
+       * @return True if the press is the response of the current trial
+       */
+      bool press(Response response, qint64 sinceFixation, qint64 decisionTime)
+      {
+         if (m_nPhase == Phase::Idle || !isResponse(response)) { return false; }
+
+         Trial& cur = current();
+         Paradigm::logPress(cur, response, sinceFixation);
+
+         if (decisionTime < 0LL)
+         {
+            Paradigm::countAnticipation(cur);
+            return false;
+         }
+
+         Paradigm::setResponse(cur, response);
+
+         return true;
+      }
+
+      /**
+       * @brief TrialEngine::respond
+       * @param decisionTime Time from stimulus onset to the response in ms,
+       *        within the deadline
+       * @param stall Longest event loop stall since the stimulus onset in ms
+       */
+      void respond(qint64 decisionTime, int stall)
+      {
+         m_nPhase = Phase::Idle;
+
+         Paradigm::setAnswered(current(), decisionTime, stall);
+      }
+
+      /**
+       * @brief TrialEngine::miss
+       * @param stall Longest event loop stall since the stimulus onset in ms
+       *
+       * No response within the deadline: the trial does not enter the evaluation.
+       */
+      void miss(int stall)
+      {
+         m_nPhase = Phase::Idle;
+
+         Paradigm::setMissed(current(), stall);
+      }
+
+      /**
+       * @brief TrialEngine::complete
+       * @param evaluated False for e.g. practice trials, which are not
+       *        part of the statistics of the run
+       * Adds the current trial to the statistics of the run and moves on.
+       */
+      void complete(bool evaluated = true)
+      {
+         if (!evaluated)
+         {
+            m_nProgress++;
+            return;
+         }
+
+         const Trial& cur = current();
+
+         if (Paradigm::isValid(cur))
+         {
+            const double rt = static_cast<double>(Paradigm::decisionTime(cur));
+
+            if (Paradigm::isCorrect(cur)) { m_stats.m_nNumCorrect++; m_stats.m_momentsCorrect.add(rt); }
+            else                          { m_stats.m_nNumWrong++; }
+
+            m_stats.m_momentsAll.add(rt);
+         }
+         else if (Paradigm::isMissed(cur))
+         {
+            m_stats.m_nNumMisses++;
+         }
+
+         if (Paradigm::stall(cur) > 0) { m_stats.m_nNumStalled++; }
+
+         m_stats.m_nNumAnticipations += Paradigm::anticipations(cur);
+         m_stats.m_nNumAutoRepeats += Paradigm::autoRepeats(cur);
+
+         m_nProgress++;
+      }
+
+      /**
+       * @brief TrialEngine::statistics
+       * @return Statistics of the completed trials of the run
+       */
+      const RunStatistics& statistics() const
+      {
+         return m_stats;
+      }
+
+      /**
+       * @brief TrialEngine::toStringLists
+       * @param from First position of the run
+       * @param to Position after the last one
+       * @param results Appended: serialized valid trials
+       * @param misses Appended: trials without response
+       * @param trajectory If not null, appended: deadline and outcome per trial
+       */
+      void toStringLists(int from, int to, QStringList& results, QStringList& misses,
+                         QStringList* trajectory) const
+      {
+         for (int i=from; i<to; i++)
+         {
+            const Trial& cur = trial(i);
+
+            if (Paradigm::isValid(cur)) { results.append(Paradigm::resultToString(cur)); }
+
+            // Position & Stimulus & Deadline(s) & Stall(ms)
+            if (Paradigm::isMissed(cur))
+            {
+               misses.append(QString::number(i+1) + "&" + Paradigm::stimulusToString(cur)
+                             + "&" + QString::number(Paradigm::deadline(cur)/1000.0, 'f', 3)
+                             + "&" + QString::number(Paradigm::stall(cur)));
+            }
+
+            // Position & Condition & Deadline(ms) & Outcome (1: correct, 0: wrong, -1: missed)
+            if (trajectory && (Paradigm::isValid(cur) || Paradigm::isMissed(cur)))
+            {
+               const QString outcome = Paradigm::isMissed(cur) ? "-1" : (Paradigm::isCorrect(cur) ? "1" : "0");
+
+               trajectory->append(QString::number(i+1) + "&"
+                                  + Paradigm::conditionToString(Paradigm::condition(cur))
+                                  + "&" + QString::number(Paradigm::deadline(cur)) + "&" + outcome);
+            }
+         }
+      }
+
+   private:
+      static bool isResponse(Response response)
+      {
+         for (const Response& valid : Paradigm::Responses)
+         {
+            if (valid == response) { return true; }
+         }
+
+         return false;
+      }
+
+      /**
+       * @brief TrialEngine::nextTrial
+       * A trial consists of the blank screen of the ISI or a break (if any),
+       * the fixation point and the stimulus, timed as given by the timeline.
+       */
+      void nextTrial()
+      {
+         if (m_nProgress >= m_nNumTrials)
+         {
+            m_host.stop();
+            return;
+         }
+
+         const TimelineEvent& event = m_qvecTimeline.at(m_nProgress);
+         const int pauseMs = Paradigm::pause(event);
+
+         // A break is shown once, also if the run is paused during it
+         if (Paradigm::isBreak(event) && m_nBreakTaken != m_nProgress)
+         {
+            m_nBreakTaken = m_nProgress;
+            m_host.presentBlank(true);
+
+            if (pauseMs < 0) { m_host.pause(); } // Continued by the pause key
+            else             { startBlank(pauseMs); }
+            return;
+         }
+
+         if (!Paradigm::isBreak(event) && pauseMs > 0)
+         {
+            m_host.presentBlank(false);
+            startBlank(pauseMs);
+            return;
+         }
+
+         showFixationPoint();
+      }
+
+      /**
+       * @brief TrialEngine::startBlank
+       * @param durationMs ISI or break before the fixation point
+       */
+      void startBlank(int durationMs)
+      {
+         if (m_bFrameTiming)
+         {
+            m_nBlankFrames = framesFor(durationMs);
+            m_nFrameWait = FrameWait::BlankOnset;
+         }
+         else
+         {
+            m_host.startBlankTimer(durationMs);
+         }
+      }
+
+      /**
+       * @brief TrialEngine::showFixationPoint
+       */
+      void showFixationPoint()
+      {
+         const int fixationMs = Paradigm::fixation(m_qvecTimeline.at(m_nProgress));
+
+         if (m_bFrameTiming)
+         {
+            // On screen with the next swap, see framePresented()
+            Paradigm::setFixationFrames(current(), framesFor(fixationMs));
+            m_nFrameWait = FrameWait::FixationOnset;
+
+            m_host.presentFixationPoint();
+            return;
+         }
+
+         startFixation();
+
+         m_host.presentFixationPoint();
+         m_host.startFixationTimer(fixationMs);
+      }
+
+      /**
+       * @brief TrialEngine::showStimulus
+       * Sets the response window of the current trial and shows its stimulus.
+       */
+      void showStimulus()
+      {
+         if (m_nProgress >= m_nNumTrials)
+         {
+            m_host.stop();
+            return;
+         }
+
+         // Nothing allocates from here to the recorded response, see completeTrial()
+         AllocationGuard::Section section;
+         m_allocationGuard.arm();
+
+         Trial& cur = current();
+         Paradigm::setDeadline(cur, m_host.responseDeadline(cur, Paradigm::deadline(m_qvecTimeline.at(m_nProgress))));
+
+         // In whole frames: the response window is the time the stimulus is shown
+         if (m_bFrameTiming)
+         {
+            const int frames = framesFor(Paradigm::deadline(cur));
+            Paradigm::setStimulusFrames(cur, frames);
+            Paradigm::setDeadline(cur, qRound(frames * m_dRefreshInterval));
+         }
+         else
+         {
+            startStimulus();
+         }
+
+         m_host.presentStimulus(cur);
+
+         // With frame timing, onset and deadline follow the swaps, see framePresented()
+         if (m_bFrameTiming) { m_nFrameWait = FrameWait::StimulusOnset; }
+         else                { m_host.startDeadline(m_nProgress, Paradigm::deadline(cur)); }
+      }
+
+      /**
+       * @brief TrialEngine::startFixation
+       * Presses from now on belong to the current trial.
+       */
+      void startFixation()
+      {
+         beginFixation();
+         m_host.markFixationOnset();
+      }
+
+      /**
+       * @brief TrialEngine::startStimulus
+       * Response times count from here.
+       */
+      void startStimulus()
+      {
+         beginStimulus(m_host.markStimulusOnset());
+      }
+
+      /**
+       * @brief TrialEngine::completeTrial
+       * Updates the statistics of the run with the current trial, hands on a
+       * chunk if due, prepares the next trial and continues with it.
+       */
+      void completeTrial()
+      {
+         // The stimulus is replaced with the next swap
+         if (m_bFrameTiming)
+         {
+            Trial& cur = current();
+            Paradigm::setStimulusFramesShown(cur, static_cast<int>(m_i64Frame + 1 - m_i64StimulusFrame));
+            if (Paradigm::hasFrameErrors(cur)) { m_stats.m_nNumFrameErrors++; }
+         }
+
+         const bool practice = Paradigm::isPractice(m_qvecTimeline.at(m_nProgress));
+         complete(!practice);
+
+         // End of the span armed in showStimulus()
+         m_allocationGuard.check("TrialEngine::completeTrial");
+
+         m_host.onTrialCompleted(m_nProgress - 1);
+
+         // Disk writes of streamed runs are due between trials, i.e. while
+         // the fixation point is shown
+         if (m_nFlushInterval > 0 && m_nProgress - m_nFlushedUpTo >= m_nFlushInterval)
+         {
+            m_host.flushTrials(m_nProgress);
+            m_nFlushedUpTo = m_nProgress;
+         }
+
+         prepareTrial(m_nProgress);
+
+         if (m_bScheduling) { nextTrial(); }
+      }
+
+      /**
+       * @brief TrialEngine::prepareTrial
+       * @param position Position in the current run
+       */
+      void prepareTrial(int position)
+      {
+         if (position >= m_nNumTrials) { return; }
+
+         prepare(position, m_host.trialTemplate(position));
+      }
+
+      /**
+       * @brief TrialEngine::framesFor
+       * @param durationMs
+       * @return Nearest whole number of refreshes, at least one
+       */
+      int framesFor(int durationMs) const
+      {
+         return qMax(1, qRound(durationMs / m_dRefreshInterval));
+      }
+
+      Host& m_host;
+
+      QVector<Trial> m_qvecTrials;
+      int  m_nProgress;
+      bool m_bRing;
+      Phase m_nPhase;
+
+      QElapsedTimer m_eltiFixation; // Since the fixation onset of the current trial
+      QElapsedTimer m_eltiStimulus; // Since the stimulus onset of the current trial
+
+      RunStatistics m_stats;
+
+      // Scheduling of the run
+      QVector<TimelineEvent> m_qvecTimeline;
+      int  m_nNumTrials;
+      bool m_bScheduling;    // False before resume() and after halt()
+      int  m_nBreakTaken;    // Position of the last break shown
+      int  m_nFlushInterval;
+      int  m_nFlushedUpTo;
+
+      // Frame timing: durations in whole refreshes, changed on the swaps
+      bool      m_bFrameTiming;
+      double    m_dRefreshInterval; // ms
+      FrameWait m_nFrameWait;
+      qint64    m_i64Frame;          // Last swap
+      qint64    m_i64FrameTarget;    // Swap that ends the blank/fixation/stimulus
+      qint64    m_i64FixationFrame;  // Swap of the fixation onset
+      qint64    m_i64StimulusFrame;  // Swap of the stimulus onset
+      int       m_nBlankFrames;
+
+      AllocationGuard m_allocationGuard; // Display request to recorded response
+};
@@ -0,0 +1,176 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "TrialRandom.h"
+
+#include <random>
+#include <utility>
+
+
+/**
+ * @brief SplitMix64::SplitMix64
+ * @param seed
+ */
+SplitMix64::SplitMix64(quint64 seed)
+   : m_u64State(seed)
+{
+}
+
+
+/**
+ * @brief SplitMix64::operator ()
+ * @return Next 64-bit value
+ */
+quint64 SplitMix64::operator()()
+{
+   m_u64State += 0x9E3779B97F4A7C15ULL;
+   return mix(m_u64State);
+}
+
+
+/**
+ * @brief SplitMix64::mix
+ * @param z
+ * @return Finalizer of SplitMix64 (bijective 64-bit hash)
+ */
+quint64 SplitMix64::mix(quint64 z)
+{
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return z ^ (z >> 31);
+}
+
+
+/**
+ * @brief SplitMix64::bounded
+ * @param bound > 0
+ * @return Unbiased integer in [0, bound-1] (rejection sampling)
+ */
+int SplitMix64::bounded(int bound)
+{
+   const quint64 range = static_cast<quint64>(bound);
+   const quint64 threshold = (0ULL - range) % range;
+
+   quint64 r = (*this)();
+   while (r < threshold) { r = (*this)(); }
+
+   return static_cast<int>(r % range);
+}
+
+
+/**
+ * @brief SplitMix64::uniformInt
+ * @param lo
+ * @param hi
+ * @return Integer in the closed interval [lo, hi]
+ */
+int SplitMix64::uniformInt(int lo, int hi)
+{
+   return lo + bounded(hi - lo + 1);
+}
+
+
+/**
+ * @brief SplitMix64::shuffle
+ * @param values
+ *
+ * Fisher-Yates shuffle.
+ */
+void SplitMix64::shuffle(QVector<int>& values)
+{
+   for (int i=values.count()-1; i>0; i--)
+   {
+      std::swap(values[i], values[bounded(i+1)]);
+   }
+}
+
+
+/**
+ * @brief TrialRandom::TrialRandom
+ * @param masterSeed
+ */
+TrialRandom::TrialRandom(quint64 masterSeed)
+   : m_u64MasterSeed(masterSeed)
+{
+}
+
+
+/**
+ * @brief TrialRandom::getMasterSeed
+ * @return
+ */
+quint64 TrialRandom::getMasterSeed() const
+{
+   return m_u64MasterSeed;
+}
+
+
+/**
+ * @brief TrialRandom::deriveSeed
+ * @param streamID
+ * @return Seed of the given sub-stream
+ */
+quint64 TrialRandom::deriveSeed(quint64 streamID) const
+{
+   return SplitMix64::mix(m_u64MasterSeed ^ SplitMix64::mix(streamID + 0x9E3779B97F4A7C15ULL));
+}
+
+
+/**
+ * @brief TrialRandom::stream
+ * @param streamID
+ * @return Independent generator for the given sub-stream
+ */
+SplitMix64 TrialRandom::stream(quint64 streamID) const
+{
+   return SplitMix64(deriveSeed(streamID));
+}
+
+
+/**
+ * @brief TrialRandom::createMasterSeed
+ * @return Fresh seed from std::random_device
+ *
+ * The only place where non-reproducible entropy enters.
+ */
+quint64 TrialRandom::createMasterSeed()
+{
+   std::random_device randDevice;
+   return (static_cast<quint64>(randDevice()) << 32) ^ static_cast<quint64>(randDevice());
+}
+
+
+/**
+ * @brief TrialRandom::seedToString
+ * @param seed
+ * @return 16 hex digits
+ */
+QString TrialRandom::seedToString(quint64 seed)
+{
+   return QString("%1").arg(seed, 16, 16, QChar('0'));
+}
+
+
+/**
+ * @brief TrialRandom::seedFromString
+ * @param str Hex digits as written by seedToString(), optionally with "0x"
+ * @param seed Target, only changed on success
+ * @return
+ */
+bool TrialRandom::seedFromString(const QString& str, quint64& seed)
+{
+   QString hex = str.trimmed();
+   if (hex.startsWith("0x", Qt::CaseInsensitive)) { hex.remove(0, 2); }
+
+   bool ok = false;
+   const quint64 value = hex.toULongLong(&ok, 16);
+   if (ok) { seed = value; }
+
+   return ok;
+}
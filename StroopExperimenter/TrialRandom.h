@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QVector>
+#include <QString>
+
+
+/**
+ * @brief The SplitMix64 class
+ *
+ * Small 64-bit generator (Steele, Lea & Flood 2014) that satisfies the
+ * UniformRandomBitGenerator requirements. Bounded integers and shuffling
+ * are implemented here as well, because the std distributions are allowed
+ * to differ between standard libraries and a sequence must be
+ * reproducible on every platform.
+ */
+class SplitMix64
+{
+   public:
+      using result_type = quint64;
+
+      explicit SplitMix64(quint64 seed = 0ULL);
+
+      quint64 operator()();
+
+      static constexpr quint64 min() { return 0ULL; }
+      static constexpr quint64 max() { return ~0ULL; }
+
+      int bounded(int bound);
+      int uniformInt(int lo, int hi);
+      void shuffle(QVector<int>& values);
+
+      static quint64 mix(quint64 z);
+
+   private:
+      quint64 m_u64State;
+};
+
+
+/**
+ * @brief The TrialRandom class
+ *
+ * One master seed per run. Every consumer (a block, the final shuffle, ...)
+ * gets its own sub-stream derived from the master seed and a fixed stream
+ * id, so adding or reordering consumers does not change the others.
+ */
+class TrialRandom
+{
+   public:
+      enum Stream : quint64
+      {
+         FullyRandomStream   = 1,
+         BlockStream         = 16, // + condition
+         ShuffleStream       = 32,
+         ConditionStream     = 33,
+         ItemStream          = 34,
+         ParticipantStream   = 64, // + participant index (bulk planning)
+         SequenceBlockStream = 1ULL << 32, // + block index (streamed runs)
+         ProtocolStream      = 1ULL << 33  // + 2 * protocol block (+1: its durations)
+      };
+
+      explicit TrialRandom(quint64 masterSeed);
+
+      quint64 getMasterSeed() const;
+      SplitMix64 stream(quint64 streamID) const;
+      quint64 deriveSeed(quint64 streamID) const;
+
+      static quint64 createMasterSeed();
+
+      static QString seedToString(quint64 seed);
+      static bool seedFromString(const QString& str, quint64& seed);
+
+   private:
+      quint64 m_u64MasterSeed;
+};
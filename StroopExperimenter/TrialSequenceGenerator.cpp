@@ -0,0 +1,926 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "TrialSequenceGenerator.h"
+#include "TrialRandom.h"
+
+#include <QHash>
+#include <QElapsedTimer>
+
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <iostream>
+
+
+// Retries if a rounded transition matrix happens to be disconnected
+static constexpr int MaxAttempts = 16;
+
+
+/**
+ * @brief SequenceConstraints::SequenceConstraints
+ */
+SequenceConstraints::SequenceConstraints()
+   : m_nMaxRunLength(3)
+   , m_bNoWordRepeats(true)
+   , m_bNoInkRepeats(true)
+   , m_bBalancedTransitions(true)
+{
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::TrialSequenceGenerator
+ * @param templates See StroopExperiment::createStroopTrials()
+ * @param constraints
+ */
+TrialSequenceGenerator::TrialSequenceGenerator(const QVector<StroopTrial>& templates,
+                                               const SequenceConstraints& constraints)
+   : m_qvecConditionItems(NumStroopConditions)
+   , m_constraints(constraints)
+{
+   QHash<QString, int> wordIDs;
+
+   for (int i=0; i<templates.count(); i++)
+   {
+      const StroopTrial& trial = templates.at(i);
+      const int cond = static_cast<int>(trial.m_nMode);
+
+      // Colored quads do not show their text
+      int word = -1;
+      if (trial.m_nMode != StroopTrialModes::ColoredQuads)
+      {
+         word = wordIDs.value(trial.m_strText, wordIDs.count());
+         wordIDs.insert(trial.m_strText, word);
+      }
+
+      m_qvecConditionItems[cond].append(i);
+      m_qvecCondition.append(cond);
+      m_qvecWord.append(word);
+      m_qvecInk.append(static_cast<int>(trial.m_nColor));
+   }
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::equalCounts
+ * @param numTrials
+ * @return Trials per condition; the remainder goes to the conditions with
+ *         the most items first (unreferenced words, then conflicts, ...)
+ */
+QVector<int> TrialSequenceGenerator::equalCounts(int numTrials)
+{
+   QVector<int> counts(NumStroopConditions, numTrials / NumStroopConditions);
+
+   const int remainder = numTrials - (numTrials / NumStroopConditions) * NumStroopConditions;
+   for (int i=0; i<remainder; i++)
+   {
+      counts[NumStroopConditions - 1 - i]++;
+   }
+
+   return counts;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::proportionalCounts
+ * @param numTrials
+ * @return Trials per condition in proportion to the number of items of each
+ *         condition (largest remainder method)
+ */
+QVector<int> TrialSequenceGenerator::proportionalCounts(int numTrials) const
+{
+   const int numItems = m_qvecCondition.count();
+
+   QVector<int> counts(NumStroopConditions, 0);
+   QVector<double> remainders(NumStroopConditions, 0.0);
+
+   int assigned = 0;
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      const double exact = static_cast<double>(numTrials) * m_qvecConditionItems.at(cond).count() / numItems;
+      counts[cond] = static_cast<int>(std::floor(exact));
+      remainders[cond] = exact - counts.at(cond);
+      assigned += counts.at(cond);
+   }
+
+   for (; assigned<numTrials; assigned++)
+   {
+      const int cond = static_cast<int>(std::max_element(remainders.begin(), remainders.end())
+                                        - remainders.begin());
+      counts[cond]++;
+      remainders[cond] = -1.0;
+   }
+
+   return counts;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::generate
+ * @param random Seed service of the run
+ * @param conditionCounts Exact number of trials per condition
+ * @param indices Result: indices into the templates
+ * @param error Reason if the constraints cannot be met
+ * @return
+ */
+bool TrialSequenceGenerator::generate(const TrialRandom& random, const QVector<int>& conditionCounts,
+                                      QVector<int>& indices, QString* error) const
+{
+   indices.clear();
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      if (conditionCounts.value(cond) > 0 && m_qvecConditionItems.at(cond).isEmpty())
+      {
+         if (error) { *error = QString("No items for condition %1.").arg(cond); }
+         return false;
+      }
+   }
+
+   SplitMix64 conditionRng = random.stream(TrialRandom::ConditionStream);
+   SplitMix64 itemRng = random.stream(TrialRandom::ItemStream);
+
+   QVector<int> conditions;
+   if (!createConditionSequence(conditionCounts, conditionRng, conditions, error))
+   {
+      return false;
+   }
+
+   assignItems(conditions.constData(), conditions.count(), -1, itemRng, indices);
+
+   return true;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::generateConditions
+ * @param random Seed service of the run
+ * @param conditionCounts Exact number of trials per condition
+ * @param conditions Result: condition of every trial
+ * @param error Reason if the constraints cannot be met
+ * @return
+ *
+ * Step 1 of generate() only, one byte per trial, for streamed runs.
+ */
+bool TrialSequenceGenerator::generateConditions(const TrialRandom& random,
+                                                const QVector<int>& conditionCounts,
+                                                QVector<qint8>& conditions, QString* error) const
+{
+   conditions.clear();
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      if (conditionCounts.value(cond) > 0 && m_qvecConditionItems.at(cond).isEmpty())
+      {
+         if (error) { *error = QString("No items for condition %1.").arg(cond); }
+         return false;
+      }
+   }
+
+   SplitMix64 conditionRng = random.stream(TrialRandom::ConditionStream);
+
+   QVector<int> sequence;
+   if (!createConditionSequence(conditionCounts, conditionRng, sequence, error))
+   {
+      return false;
+   }
+
+   conditions.reserve(sequence.count());
+   for (int cond : sequence) { conditions.append(static_cast<qint8>(cond)); }
+
+   return true;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::generateItems
+ * @param random Seed service of the block
+ * @param conditions See generateConditions()
+ * @param from First trial of the block
+ * @param to Trial after the block
+ * @param previousItem Item of the trial before the block, -1: none
+ * @param indices Result: indices into the templates; the buffer is reused
+ *
+ * Step 2 of generate() for one block of a streamed run.
+ */
+void TrialSequenceGenerator::generateItems(const TrialRandom& random, const QVector<qint8>& conditions,
+                                           int from, int to, int previousItem,
+                                           QVector<int>& indices) const
+{
+   indices.clear();
+   if (from >= to) { return; }
+
+   SplitMix64 itemRng = random.stream(TrialRandom::ItemStream);
+   assignItems(conditions.constData() + from, to - from, previousItem, itemRng, indices);
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::generateBlocked
+ * @param random Seed service of the run
+ * @param conditionCounts Exact number of trials per condition
+ * @param blockOrder One block per condition in this order (see
+ *        StudyPlan::williamsSquare()); conditions not listed are left out
+ * @param indices Result: indices into the templates
+ * @param error
+ * @return
+ *
+ * Run length and transition balance do not apply to blocks; items still
+ * avoid word and ink repeats, also across block borders.
+ */
+bool TrialSequenceGenerator::generateBlocked(const TrialRandom& random,
+                                             const QVector<int>& conditionCounts,
+                                             const QVector<int>& blockOrder,
+                                             QVector<int>& indices, QString* error) const
+{
+   indices.clear();
+
+   QVector<int> conditions;
+   for (int cond : blockOrder)
+   {
+      if (cond < 0 || cond >= NumStroopConditions)
+      {
+         if (error) { *error = QString("Invalid condition %1 in block order.").arg(cond); }
+         return false;
+      }
+      if (conditionCounts.value(cond) > 0 && m_qvecConditionItems.at(cond).isEmpty())
+      {
+         if (error) { *error = QString("No items for condition %1.").arg(cond); }
+         return false;
+      }
+
+      conditions.append(QVector<int>(conditionCounts.value(cond), cond));
+   }
+
+   SplitMix64 itemRng = random.stream(TrialRandom::ItemStream);
+   assignItems(conditions.constData(), conditions.count(), -1, itemRng, indices);
+
+   return true;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::createTransitions
+ * @param counts Trials per condition
+ * @param first Condition of the first trial
+ * @param last Condition of the last trial
+ * @param rng Breaks ties between equal rounding remainders
+ * @param transitions Result: number of transitions [from][to]
+ * @param error
+ * @return
+ *
+ * Controlled rounding of out(i) * in(j) / (N-1): row sums out(i) and column
+ * sums in(j) stay exact. Repetitions exceeding the run length limit are
+ * moved to other cells afterwards, again without changing the sums.
+ */
+bool TrialSequenceGenerator::createTransitions(const QVector<int>& counts, int first, int last,
+                                               SplitMix64& rng, TransitionMatrix& transitions,
+                                               QString* error) const
+{
+   int numTrials = 0;
+   for (int count : counts) { numTrials += count; }
+
+   const double numEdges = numTrials - 1;
+
+   int rowDeficit[NumStroopConditions];
+   int colDeficit[NumStroopConditions];
+   double target[NumStroopConditions][NumStroopConditions];
+   double priority[NumStroopConditions][NumStroopConditions];
+
+   for (int i=0; i<NumStroopConditions; i++)
+   {
+      rowDeficit[i] = counts.at(i) - (i == last ? 1 : 0);
+      colDeficit[i] = counts.at(i) - (i == first ? 1 : 0);
+   }
+
+   for (int i=0; i<NumStroopConditions; i++)
+   {
+      const int out = counts.at(i) - (i == last ? 1 : 0);
+
+      for (int j=0; j<NumStroopConditions; j++)
+      {
+         const int in = counts.at(j) - (j == first ? 1 : 0);
+
+         target[i][j] = out * in / numEdges;
+         transitions[i][j] = static_cast<int>(std::floor(target[i][j]));
+         priority[i][j] = target[i][j] - transitions[i][j] + 1e-9 * rng.bounded(1024);
+
+         rowDeficit[i] -= transitions[i][j];
+         colDeficit[j] -= transitions[i][j];
+      }
+   }
+
+   // Round up the cells with the largest remainders (each cell at most
+   // once) while their row and column still need transitions
+   bool roundedUp[NumStroopConditions][NumStroopConditions] = {};
+
+   for (;;)
+   {
+      int bestI = -1;
+      int bestJ = -1;
+
+      for (int i=0; i<NumStroopConditions; i++)
+      {
+         if (rowDeficit[i] <= 0) { continue; }
+
+         for (int j=0; j<NumStroopConditions; j++)
+         {
+            if (colDeficit[j] <= 0 || roundedUp[i][j]) { continue; }
+
+            if (bestI < 0 || priority[i][j] > priority[bestI][bestJ])
+            {
+               bestI = i;
+               bestJ = j;
+            }
+         }
+      }
+
+      if (bestI < 0) { break; }
+
+      transitions[bestI][bestJ]++;
+      roundedUp[bestI][bestJ] = true;
+      rowDeficit[bestI]--;
+      colDeficit[bestJ]--;
+   }
+
+   // The greedy pass can get stuck; the remaining deficits are resolved with
+   // augmenting paths (rows 0..3 and columns 4..7 of a bipartite graph), so
+   // every cell ends up at its floor or ceiling.
+   constexpr int NumNodes = 2 * NumStroopConditions;
+
+   for (;;)
+   {
+      int parent[NumNodes];
+      std::fill(parent, parent + NumNodes, -2);
+
+      QVector<int> queue;
+      for (int i=0; i<NumStroopConditions; i++)
+      {
+         if (rowDeficit[i] > 0) { queue.append(i); parent[i] = -1; }
+      }
+      if (queue.isEmpty()) { break; }
+
+      int end = -1;
+      for (int q=0; q<queue.count() && end<0; q++)
+      {
+         const int node = queue.at(q);
+
+         for (int other=0; other<NumStroopConditions; other++)
+         {
+            // Row -> column via a cell that may still be rounded up,
+            // column -> row via a cell that may be rounded down again
+            const bool rowNode = node < NumStroopConditions;
+            const int next = rowNode ? other + NumStroopConditions : other;
+            const bool usable = rowNode ? !roundedUp[node][other]
+                                        : roundedUp[other][node - NumStroopConditions];
+
+            if (!usable || parent[next] != -2) { continue; }
+
+            parent[next] = node;
+            if (!rowNode || colDeficit[other] <= 0) { queue.append(next); continue; }
+
+            end = next;
+            break;
+         }
+      }
+
+      if (end < 0) { break; }
+
+      colDeficit[end - NumStroopConditions]--;
+
+      int node = end;
+      while (parent[node] >= 0)
+      {
+         const int prev = parent[node];
+         if (prev < NumStroopConditions)
+         {
+            transitions[prev][node - NumStroopConditions]++;
+            roundedUp[prev][node - NumStroopConditions] = true;
+         }
+         else
+         {
+            transitions[node][prev - NumStroopConditions]--;
+            roundedUp[node][prev - NumStroopConditions] = false;
+         }
+         node = prev;
+      }
+
+      rowDeficit[node]--;
+   }
+
+   // Limit repetitions: with v = count - loops visits of a condition, loops
+   // must not exceed v * (maxRunLength - 1).
+   const int maxRun = m_constraints.m_nMaxRunLength;
+   if (maxRun <= 0) { return true; }
+
+   for (int i=0; i<NumStroopConditions; i++)
+   {
+      const int maxLoops = counts.at(i) * (maxRun - 1) / maxRun;
+
+      while (transitions[i][i] > maxLoops)
+      {
+         // i->i and j->k become i->k and j->i
+         int bestJ = -1;
+         int bestK = -1;
+
+         for (int j=0; j<NumStroopConditions; j++)
+         {
+            if (j == i) { continue; }
+
+            for (int k=0; k<NumStroopConditions; k++)
+            {
+               if (k == i || transitions[j][k] <= 0) { continue; }
+
+               if (bestJ < 0 || transitions[j][k] - target[j][k] > transitions[bestJ][bestK] - target[bestJ][bestK])
+               {
+                  bestJ = j;
+                  bestK = k;
+               }
+            }
+         }
+
+         if (bestJ < 0)
+         {
+            if (error)
+            {
+               *error = QString("Condition %1 cannot be spread to runs of at most %2 trials.")
+                           .arg(i).arg(maxRun);
+            }
+            return false;
+         }
+
+         transitions[i][i]--;
+         transitions[bestJ][bestK]--;
+         transitions[i][bestK]++;
+         transitions[bestJ][i]++;
+      }
+   }
+
+   return true;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::createConditionSequence
+ * @param counts Trials per condition
+ * @param rng
+ * @param conditions Result
+ * @param error
+ * @return
+ */
+bool TrialSequenceGenerator::createConditionSequence(const QVector<int>& counts, SplitMix64& rng,
+                                                     QVector<int>& conditions, QString* error) const
+{
+   int numTrials = 0;
+   for (int count : counts) { numTrials += count; }
+
+   conditions.clear();
+   conditions.reserve(numTrials);
+   if (numTrials == 0) { return true; }
+
+   // Draws a condition with probability proportional to its weight
+   auto drawWeighted = [&rng](const int* weights) -> int
+   {
+      int total = 0;
+      for (int i=0; i<NumStroopConditions; i++) { total += weights[i]; }
+
+      int r = rng.bounded(total);
+      for (int i=0; i<NumStroopConditions; i++)
+      {
+         if (r < weights[i]) { return i; }
+         r -= weights[i];
+      }
+      return NumStroopConditions - 1;
+   };
+
+   const int maxExtra = (m_constraints.m_nMaxRunLength > 0)
+                      ? m_constraints.m_nMaxRunLength - 1 : numTrials;
+
+   for (int attempt=0; attempt<MaxAttempts; attempt++)
+   {
+      int weights[NumStroopConditions];
+      for (int i=0; i<NumStroopConditions; i++) { weights[i] = counts.at(i); }
+      const int first = drawWeighted(weights);
+
+      weights[first]--;
+      const int last = (numTrials > 1) ? drawWeighted(weights) : first;
+
+      TransitionMatrix transitions;
+      if (!createTransitions(counts, first, last, rng, transitions, error))
+      {
+         continue;
+      }
+
+      // Hierholzer's algorithm on the graph without self-loops; the next
+      // edge is drawn at random, weighted by its remaining multiplicity.
+      int remaining[NumStroopConditions][NumStroopConditions];
+      int outDegree[NumStroopConditions] = {};
+      int numEdges = 0;
+
+      for (int i=0; i<NumStroopConditions; i++)
+      {
+         for (int j=0; j<NumStroopConditions; j++)
+         {
+            remaining[i][j] = (i == j) ? 0 : transitions[i][j];
+            outDegree[i] += remaining[i][j];
+            numEdges += remaining[i][j];
+         }
+      }
+
+      QVector<int> stack;
+      QVector<int> path;
+      stack.reserve(numEdges + 1);
+      path.reserve(numEdges + 1);
+      stack.append(first);
+
+      while (!stack.isEmpty())
+      {
+         const int v = stack.last();
+
+         if (outDegree[v] > 0)
+         {
+            const int w = drawWeighted(remaining[v]);
+            remaining[v][w]--;
+            outDegree[v]--;
+            stack.append(w);
+         }
+         else
+         {
+            path.append(v);
+            stack.removeLast();
+         }
+      }
+
+      // Disconnected transition graph: try another rounding
+      if (path.count() != numEdges + 1) { continue; }
+
+      std::reverse(path.begin(), path.end());
+
+      // Spread the repetitions of each condition over its visits
+      QVector<int> extra(path.count(), 0);
+      bool spread = true;
+
+      for (int cond=0; cond<NumStroopConditions && spread; cond++)
+      {
+         QVector<int> open;
+         for (int p=0; p<path.count(); p++)
+         {
+            if (path.at(p) == cond) { open.append(p); }
+         }
+
+         for (int loop=0; loop<transitions[cond][cond]; loop++)
+         {
+            if (open.isEmpty()) { spread = false; break; }
+
+            const int k = rng.bounded(open.count());
+            if (++extra[open.at(k)] >= maxExtra)
+            {
+               open[k] = open.last();
+               open.removeLast();
+            }
+         }
+      }
+
+      if (!spread) { continue; }
+
+      for (int p=0; p<path.count(); p++)
+      {
+         for (int r=0; r<=extra.at(p); r++) { conditions.append(path.at(p)); }
+      }
+
+      return true;
+   }
+
+   if (error && error->isEmpty())
+   {
+      *error = QString("No condition sequence found for the given counts.");
+   }
+
+   return false;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::conflicts
+ * @param item
+ * @param previousItem
+ * @return True if item must not follow previousItem
+ */
+bool TrialSequenceGenerator::conflicts(int item, int previousItem) const
+{
+   if (previousItem < 0) { return false; }
+
+   const bool sameWord = m_qvecWord.at(item) >= 0 && m_qvecWord.at(item) == m_qvecWord.at(previousItem);
+   const bool sameInk = m_qvecInk.at(item) == m_qvecInk.at(previousItem);
+
+   return (m_constraints.m_bNoWordRepeats && sameWord)
+       || (m_constraints.m_bNoInkRepeats && sameInk);
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::assignItems
+ * @param conditions Condition sequence
+ * @param numConditions
+ * @param previousItem Item of the trial before the sequence, -1: none
+ * @param rng
+ * @param indices Result, appended
+ *
+ * Every condition draws from its own shuffled deck, so all items of a
+ * condition are used equally often. An item that conflicts with the
+ * previous trial is skipped and stays in the deck for later.
+ */
+template <typename Condition>
+void TrialSequenceGenerator::assignItems(const Condition* conditions, int numConditions,
+                                         int previousItem, SplitMix64& rng,
+                                         QVector<int>& indices) const
+{
+   QVector<QVector<int>> decks(NumStroopConditions);
+   QVector<int> deckPos(NumStroopConditions, 0);
+
+   auto refill = [this, &rng, &decks, &deckPos](int cond)
+   {
+      QVector<int> fresh = m_qvecConditionItems.at(cond);
+      rng.shuffle(fresh);
+
+      QVector<int>& deck = decks[cond];
+      deck.remove(0, deckPos.at(cond));
+      deck.append(fresh);
+      deckPos[cond] = 0;
+   };
+
+   indices.reserve(indices.count() + numConditions);
+
+   int previous = previousItem;
+   for (int c=0; c<numConditions; c++)
+   {
+      const int cond = conditions[c];
+
+      if (deckPos.at(cond) >= decks.at(cond).count()) { refill(cond); }
+
+      QVector<int>& deck = decks[cond];
+      int found = -1;
+
+      for (int pass=0; pass<2 && found<0; pass++)
+      {
+         for (int k=deckPos.at(cond); k<deck.count(); k++)
+         {
+            if (!conflicts(deck.at(k), previous)) { found = k; break; }
+         }
+
+         // Nothing suitable left in this deck: add the next one
+         if (found < 0 && pass == 0) { refill(cond); }
+      }
+
+      // Only possible with item sets that cannot satisfy the constraints
+      if (found < 0) { found = deckPos.at(cond); }
+
+      std::swap(deck[deckPos.at(cond)], deck[found]);
+      previous = deck.at(deckPos.at(cond));
+      deckPos[cond]++;
+
+      indices.append(previous);
+   }
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::validate
+ * @param indices
+ * @param conditionCounts Expected trials per condition
+ * @return Violated constraints, empty if the sequence is valid
+ */
+QStringList TrialSequenceGenerator::validate(const QVector<int>& indices,
+                                             const QVector<int>& conditionCounts) const
+{
+   const int numItems = m_qvecCondition.count();
+
+   for (int i=0; i<indices.count(); i++)
+   {
+      if (indices.at(i) < 0 || indices.at(i) >= numItems)
+      {
+         return QStringList(QString("Invalid index %1 at position %2.").arg(indices.at(i)).arg(i));
+      }
+   }
+
+   QVector<qint8> conditions;
+   conditions.reserve(indices.count());
+   for (int idx : indices) { conditions.append(static_cast<qint8>(m_qvecCondition.at(idx))); }
+
+   QStringList violations = validateConditions(conditions, conditionCounts);
+   violations.append(validateItems(conditions, 0, indices, -1));
+
+   return violations;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::validateConditions
+ * @param conditions Condition of every trial
+ * @param conditionCounts Expected trials per condition
+ * @return Violated counts, run lengths and transitions, empty if valid
+ */
+QStringList TrialSequenceGenerator::validateConditions(const QVector<qint8>& conditions,
+                                                       const QVector<int>& conditionCounts) const
+{
+   QStringList violations;
+
+   const int numTrials = conditions.count();
+
+   for (int i=0; i<numTrials; i++)
+   {
+      if (conditions.at(i) < 0 || conditions.at(i) >= NumStroopConditions)
+      {
+         violations.append(QString("Invalid condition %1 at position %2.").arg(conditions.at(i)).arg(i));
+         return violations;
+      }
+   }
+
+   // Exact counts
+   QVector<int> counts(NumStroopConditions, 0);
+   for (qint8 cond : conditions) { counts[cond]++; }
+
+   for (int cond=0; cond<NumStroopConditions; cond++)
+   {
+      if (counts.at(cond) != conditionCounts.value(cond))
+      {
+         violations.append(QString("Condition %1: %2 trials instead of %3.")
+                              .arg(cond).arg(counts.at(cond)).arg(conditionCounts.value(cond)));
+      }
+   }
+
+   // Run lengths and transitions
+   int transitions[NumStroopConditions][NumStroopConditions] = {};
+   int run = 1;
+   int maxRun = (numTrials > 0) ? 1 : 0;
+
+   for (int i=1; i<numTrials; i++)
+   {
+      const int prev = conditions.at(i-1);
+      const int curr = conditions.at(i);
+
+      transitions[prev][curr]++;
+
+      run = (prev == curr) ? run + 1 : 1;
+      maxRun = std::max(maxRun, run);
+   }
+
+   if (m_constraints.m_nMaxRunLength > 0 && maxRun > m_constraints.m_nMaxRunLength)
+   {
+      violations.append(QString("Run of %1 trials of one condition (max. %2).")
+                           .arg(maxRun).arg(m_constraints.m_nMaxRunLength));
+   }
+
+   // Congruent/incongruent transitions within one of their balanced targets
+   if (m_constraints.m_bBalancedTransitions && numTrials > 1)
+   {
+      const int first = conditions.first();
+      const int last = conditions.last();
+      const int balanced[2] = { static_cast<int>(StroopTrialModes::ColoredTextMatched),
+                                static_cast<int>(StroopTrialModes::ColorTextConflicted) };
+
+      for (int i : balanced)
+      {
+         for (int j : balanced)
+         {
+            const double target = (counts.at(i) - (i == last ? 1 : 0))
+                                * (counts.at(j) - (j == first ? 1 : 0))
+                                / static_cast<double>(numTrials - 1);
+
+            if (std::fabs(transitions[i][j] - target) > 1.0)
+            {
+               violations.append(QString("Transition %1->%2: %3 (balanced: %4).")
+                                    .arg(i).arg(j).arg(transitions[i][j])
+                                    .arg(QString::number(target, 'f', 1)));
+            }
+         }
+      }
+   }
+
+   return violations;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::validateItems
+ * @param conditions Condition of every trial
+ * @param from Position of indices.first() in conditions
+ * @param indices Items of a whole sequence or of one block
+ * @param previousItem Item of the trial before indices, -1: none
+ * @return Items of the wrong condition and word/ink repeats, empty if valid
+ */
+QStringList TrialSequenceGenerator::validateItems(const QVector<qint8>& conditions, int from,
+                                                  const QVector<int>& indices, int previousItem) const
+{
+   QStringList violations;
+
+   const int numItems = m_qvecCondition.count();
+   int wrongConditions = 0;
+   int wordRepeats = 0;
+   int inkRepeats = 0;
+
+   int prev = previousItem;
+   for (int i=0; i<indices.count(); i++)
+   {
+      const int curr = indices.at(i);
+      if (curr < 0 || curr >= numItems)
+      {
+         violations.append(QString("Invalid index %1 at position %2.").arg(curr).arg(from + i));
+         return violations;
+      }
+
+      if (m_qvecCondition.at(curr) != conditions.value(from + i, -1)) { wrongConditions++; }
+
+      if (prev >= 0)
+      {
+         if (m_qvecWord.at(curr) >= 0 && m_qvecWord.at(curr) == m_qvecWord.at(prev)) { wordRepeats++; }
+         if (m_qvecInk.at(curr) == m_qvecInk.at(prev)) { inkRepeats++; }
+      }
+
+      prev = curr;
+   }
+
+   if (wrongConditions > 0)
+   {
+      violations.append(QString("%1 items of the wrong condition.").arg(wrongConditions));
+   }
+   if (m_constraints.m_bNoWordRepeats && wordRepeats > 0)
+   {
+      violations.append(QString("%1 word repetitions.").arg(wordRepeats));
+   }
+   if (m_constraints.m_bNoInkRepeats && inkRepeats > 0)
+   {
+      violations.append(QString("%1 ink color repetitions.").arg(inkRepeats));
+   }
+
+   return violations;
+}
+
+
+/**
+ * @brief TrialSequenceGenerator::runBenchmark
+ * @param numTrials Length of each sequence
+ * @param repetitions Number of sequences (seeds 1..repetitions)
+ * @return True if all sequences were generated and valid
+ *
+ * Prints timing and validation results to stdout. Sequences longer than
+ * StroopExperiment::StreamingThreshold are generated block by block like
+ * streamed runs and validated as a whole, i.e. across the blocks.
+ */
+bool TrialSequenceGenerator::runBenchmark(int numTrials, int repetitions)
+{
+   const TrialSequenceGenerator generator(StroopExperiment::createStroopTrials());
+   const QVector<int> counts = equalCounts(numTrials);
+   const bool streamed = numTrials > StroopExperiment::StreamingThreshold;
+
+   qint64 totalNs = 0LL;
+   qint64 maxNs = 0LL;
+   int numInvalid = 0;
+
+   for (int r=1; r<=repetitions; r++)
+   {
+      QVector<int> indices;
+      QString error;
+
+      QElapsedTimer timer;
+      timer.start();
+      bool generated = true;
+      if (streamed)
+      {
+         indices = StroopExperiment::createStreamedTrialIndices(static_cast<quint64>(r), numTrials, true);
+      }
+      else
+      {
+         generated = generator.generate(TrialRandom(static_cast<quint64>(r)), counts, indices, &error);
+      }
+      const qint64 ns = timer.nsecsElapsed();
+
+      totalNs += ns;
+      maxNs = std::max(maxNs, ns);
+
+      const QStringList violations = generated ? generator.validate(indices, counts)
+                                               : QStringList(error);
+      if (!violations.isEmpty())
+      {
+         if (numInvalid == 0)
+         {
+            std::cout << "Seed " << r << ": " << violations.join(" ").toStdString() << std::endl;
+         }
+         numInvalid++;
+      }
+   }
+
+   std::cout << "Generated " << repetitions << " sequences of " << numTrials << " trials: "
+             << "mean " << (totalNs / std::max(1, repetitions)) / 1000.0 << " us, "
+             << "max " << maxNs / 1000.0 << " us, "
+             << numInvalid << " invalid." << std::endl;
+
+   return numInvalid == 0;
+}
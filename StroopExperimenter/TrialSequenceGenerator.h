@@ -0,0 +1,101 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include "StroopExperiment.h"
+#include <QVector>
+#include <QStringList>
+
+// Forward declarations
+class TrialRandom;
+class SplitMix64;
+
+
+/**
+ * @brief The SequenceConstraints struct
+ */
+struct SequenceConstraints
+{
+   SequenceConstraints();
+
+   int  m_nMaxRunLength;   // Max. consecutive trials of one condition, 0: unlimited
+   bool m_bNoWordRepeats;  // The word must change between consecutive trials
+   bool m_bNoInkRepeats;   // The ink color must change between consecutive trials
+   bool m_bBalancedTransitions; // Validate the transitions (mixed sequences only)
+};
+
+
+/**
+ * @brief The TrialSequenceGenerator class
+ *
+ * Generates trial sequences with exact condition counts in two steps:
+ *
+ * 1. Condition sequence: the numbers of transitions between the conditions
+ *    are set to the rounded products of the condition frequencies (so e.g.
+ *    congruent->incongruent and incongruent->congruent occur equally often)
+ *    while keeping the row and column sums exact. The sequence is an
+ *    Eulerian path through this transition multigraph, found with
+ *    Hierholzer's algorithm and random edge selection. Repetitions of a
+ *    condition are inserted afterwards, spread over its visits so that no
+ *    run exceeds the maximum run length.
+ * 2. Items: each condition draws its word/ink items from a shuffled deck,
+ *    skipping items that would repeat the previous word or ink color.
+ *
+ * Both steps are linear in the number of trials. Streamed runs generate
+ * the condition sequence of the whole run at its start and the items one
+ * block at a time (generateConditions(), generateItems()), so the
+ * constraints also hold across the blocks.
+ */
+class TrialSequenceGenerator
+{
+   public:
+      explicit TrialSequenceGenerator(const QVector<StroopTrial>& templates,
+                                      const SequenceConstraints& constraints = SequenceConstraints());
+
+      static QVector<int> equalCounts(int numTrials);
+      QVector<int> proportionalCounts(int numTrials) const;
+
+      bool generate(const TrialRandom& random, const QVector<int>& conditionCounts,
+                    QVector<int>& indices, QString* error = nullptr) const;
+      bool generateBlocked(const TrialRandom& random, const QVector<int>& conditionCounts,
+                           const QVector<int>& blockOrder, QVector<int>& indices,
+                           QString* error = nullptr) const;
+      bool generateConditions(const TrialRandom& random, const QVector<int>& conditionCounts,
+                              QVector<qint8>& conditions, QString* error = nullptr) const;
+      void generateItems(const TrialRandom& random, const QVector<qint8>& conditions,
+                         int from, int to, int previousItem, QVector<int>& indices) const;
+
+      QStringList validate(const QVector<int>& indices, const QVector<int>& conditionCounts) const;
+      QStringList validateConditions(const QVector<qint8>& conditions,
+                                     const QVector<int>& conditionCounts) const;
+      QStringList validateItems(const QVector<qint8>& conditions, int from,
+                                const QVector<int>& indices, int previousItem) const;
+
+      static bool runBenchmark(int numTrials, int repetitions);
+
+   private:
+      typedef int TransitionMatrix[NumStroopConditions][NumStroopConditions];
+
+      bool createTransitions(const QVector<int>& counts, int first, int last,
+                             SplitMix64& rng, TransitionMatrix& transitions,
+                             QString* error) const;
+      bool createConditionSequence(const QVector<int>& counts, SplitMix64& rng,
+                                   QVector<int>& conditions, QString* error) const;
+      template <typename Condition>
+      void assignItems(const Condition* conditions, int numConditions, int previousItem,
+                       SplitMix64& rng, QVector<int>& indices) const;
+      bool conflicts(int item, int previousItem) const;
+
+      QVector<QVector<int>> m_qvecConditionItems; // Template indices per condition
+      QVector<int> m_qvecCondition;               // Per template
+      QVector<int> m_qvecWord;                    // Per template, -1: no word shown
+      QVector<int> m_qvecInk;                     // Per template
+      SequenceConstraints m_constraints;
+};
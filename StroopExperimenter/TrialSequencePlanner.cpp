@@ -0,0 +1,306 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#include "TrialSequencePlanner.h"
+#include "DataReaderWriter.h"
+#include "StroopExperiment.h"
+#include "StroopProtocol.h"
+#include "TrialRandom.h"
+#include "TrialSequenceGenerator.h"
+#include "StudyPlan.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QtConcurrent>
+
+#include <iostream>
+#include <numeric>
+#include <algorithm>
+
+
+/**
+ * @brief TrialSequencePlanner::TrialSequencePlanner
+ * @param wpDataRW
+ * @param parent
+ */
+TrialSequencePlanner::TrialSequencePlanner(std::weak_ptr<DataReaderWriter> wpDataRW,
+                                           QObject* parent)
+   : QObject(parent)
+   , m_wpDataRW(wpDataRW)
+{
+}
+
+
+/**
+ * @brief TrialSequencePlanner::sequenceToRows
+ * @param prefix Leading columns of every row
+ * @param indices Indices into StroopExperiment::createStroopTrials()
+ * @return One row per trial: prefix, position, index, mode, text, color
+ */
+QVector<QStringList> TrialSequencePlanner::sequenceToRows(const QStringList& prefix,
+                                                          const QVector<int>& indices)
+{
+   const QVector<StroopTrial> trials = StroopExperiment::createStroopTrials();
+
+   QVector<QStringList> rows;
+   rows.reserve(indices.count());
+
+   for (int i=0; i<indices.count(); i++)
+   {
+      const StroopTrial& trial = trials.at(indices.at(i));
+
+      QStringList row = prefix;
+      row << QString::number(i+1) << QString::number(indices.at(i))
+          << StroopTrial::modeToString(trial.m_nMode) << trial.m_strText
+          << Experiment::convertColorToString(trial.m_nColor, true);
+
+      rows.append(row);
+   }
+
+   return rows;
+}
+
+
+/**
+ * @brief TrialSequencePlanner::regenerateDirectory
+ * @param dirPath Directory containing the *.stroop files of a study
+ * @return
+ *
+ * Writes "study_sequences.csv". A session counts as verified if its stored
+ * trials appear in the regenerated sequence in the same order (aborted
+ * runs only contain a prefix).
+ */
+bool TrialSequencePlanner::regenerateDirectory(const QString& dirPath)
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   const QVector<StroopTrial> trials = StroopExperiment::createStroopTrials();
+
+   QVector<QStringList> dataToExport;
+
+   QStringList headers;
+   headers << "Versuchsperson" << "Sitzung" << "Seed" << "Erzeugung" << "Bestaetigt"
+           << "Position" << "Index" << "Modus" << "Text" << "Farbe";
+   dataToExport.append(headers);
+
+   int numRegenerated = 0;
+   int numVerified = 0;
+   int numWithoutSeed = 0;
+
+   QDir dir(dirPath);
+   const QFileInfoList files = dir.entryInfoList(QStringList("*.stroop"),
+                                                 QDir::Files, QDir::Name);
+
+   for (const QFileInfo& fileInfo : files)
+   {
+      QMap<QString, QVariant> data;
+      spDataRW->loadData(fileInfo.absoluteFilePath(), data);
+
+      const int numSessions = StroopExperiment::countSessions(data);
+      for (int n=1; n<=numSessions; n++)
+      {
+         quint64 seed = 0ULL;
+         const QString seedStr = data.value(StroopExperiment::sessionKey(n, "seed")).toString();
+         if (!TrialRandom::seedFromString(seedStr, seed))
+         {
+            numWithoutSeed++;
+            continue;
+         }
+
+         const int numTrials = data.value(StroopExperiment::sessionKey(n, "numTrials")).toInt();
+         const bool equal = data.value(StroopExperiment::sessionKey(n, "indexCreationMode")).toString() != "random";
+
+         // Sessions recorded before the key existed used the legacy generator
+         const int generator = data.value(StroopExperiment::sessionKey(n, "sequenceGenerator"),
+                                          int(StroopExperiment::LegacySequenceGenerator)).toInt();
+
+         QVector<int> indices;
+         if (generator == StroopExperiment::ProtocolSequenceGenerator)
+         {
+            // Compiled again from the stored definition; the practice is not in the results
+            StroopProtocol protocol;
+            QVector<StroopTimelineEvent> timeline;
+            if (StroopProtocol::fromStringList(data.value(StroopExperiment::sessionKey(n, "protocol")).toStringList(),
+                                               protocol))
+            {
+               protocol.compile(seed, timeline, &indices);
+               indices.remove(0, qMin(protocol.getNumPracticeTrials(), indices.count()));
+            }
+         }
+         else if (generator == StroopExperiment::BlockedSequenceGenerator)
+         {
+            QVector<int> order;
+            const QStringList orderStr = data.value(StroopExperiment::sessionKey(n, "conditionOrder"))
+                                             .toString().split(",", Qt::SkipEmptyParts);
+            for (const QString& cond : orderStr) { order.append(cond.toInt()); }
+
+            indices = StroopExperiment::createBlockedTrialIndices(seed, numTrials, equal, order);
+         }
+         else
+         {
+            indices = StroopExperiment::createTrialIndices(seed, numTrials, equal, generator);
+         }
+
+         // Stored trials: "Mode&Text&Color&..." after the time stamp
+         QStringList stored = StroopExperiment::sessionResults(data, n);
+         if (!stored.isEmpty() && stored.first().contains(":")) { stored.removeFirst(); }
+
+         int matched = 0;
+         for (int i=0; i<indices.count() && matched<stored.count(); i++)
+         {
+            const StroopTrial& trial = trials.at(indices.at(i));
+            const QStringList fields = stored.at(matched).split("&");
+
+            if (fields.count() >= 3
+                && fields.at(0) == StroopTrial::modeToString(trial.m_nMode)
+                && fields.at(1) == trial.m_strText
+                && fields.at(2) == Experiment::convertColorToString(trial.m_nColor, true))
+            {
+               matched++;
+            }
+         }
+
+         const bool verified = (matched == stored.count());
+
+         numRegenerated++;
+         if (verified) { numVerified++; }
+
+         QStringList prefix;
+         prefix << fileInfo.completeBaseName() << QString::number(n)
+                << TrialRandom::seedToString(seed) << (equal ? "equal" : "random")
+                << (verified ? "1" : "0");
+
+         dataToExport.append(sequenceToRows(prefix, indices));
+      }
+   }
+
+   std::cout << "Regenerated " << numRegenerated << " sessions, "
+             << numVerified << " verified, "
+             << numWithoutSeed << " without stored seed." << std::endl;
+
+   return spDataRW->writeCSV(dir.absoluteFilePath("study_sequences.csv"), dataToExport);
+}
+
+
+/**
+ * @brief TrialSequencePlanner::precomputeStudy
+ * @param studySeed Master seed of the study
+ * @param numParticipants
+ * @param numTrials
+ * @param equallyDistributed
+ * @param dirPath Target directory
+ * @return
+ *
+ * Participant p (ID "P001", ...) gets row (p-1) of a Williams square as the
+ * order of the condition blocks and the seed derived from the study seed
+ * and stream ParticipantStream + p. Writes "study_plan.stplan", which is
+ * looked up by participant ID when an experiment file is loaded, and
+ * "study_plan.csv" to audit the assignments before data collection.
+ */
+bool TrialSequencePlanner::precomputeStudy(quint64 studySeed, int numParticipants, int numTrials,
+                                           bool equallyDistributed, const QString& dirPath)
+{
+   std::shared_ptr<DataReaderWriter> spDataRW = m_wpDataRW.lock();
+   if (!spDataRW) { return false; }
+
+   const TrialRandom studyRandom(studySeed);
+   const QVector<QVector<int>> square = StudyPlan::williamsSquare(NumStroopConditions);
+
+   QVector<int> participants(numParticipants);
+   std::iota(participants.begin(), participants.end(), 1);
+
+   std::function<StudyPlanEntry(int)> planParticipant =
+         [&studyRandom, &square, numTrials, equallyDistributed](int p)
+   {
+      StudyPlanEntry entry;
+      entry.m_strParticipantID = QString("P%1").arg(p, 3, 10, QChar('0'));
+      entry.m_u64Seed = studyRandom.deriveSeed(TrialRandom::ParticipantStream + p);
+      entry.m_bEquallyDistributed = equallyDistributed;
+      entry.m_qvecConditionOrder = square.at((p - 1) % square.count());
+      entry.m_qvecTrialIndices =
+            StroopExperiment::createBlockedTrialIndices(entry.m_u64Seed, numTrials,
+                                                        equallyDistributed,
+                                                        entry.m_qvecConditionOrder);
+      return entry;
+   };
+
+   const QVector<StudyPlanEntry> entries =
+         QtConcurrent::blockingMapped< QVector<StudyPlanEntry> >(participants, planParticipant);
+
+   // Audit: counts and repeats of every sequence, positions of the blocks
+   SequenceConstraints blockConstraints;
+   blockConstraints.m_nMaxRunLength = 0;
+   blockConstraints.m_bBalancedTransitions = false;
+
+   const TrialSequenceGenerator validator(StroopExperiment::createStroopTrials(), blockConstraints);
+   const QVector<int> counts = equallyDistributed ? TrialSequenceGenerator::equalCounts(numTrials)
+                                                  : validator.proportionalCounts(numTrials);
+
+   int numInvalid = 0;
+   int positionCounts[NumStroopConditions][NumStroopConditions] = {};
+
+   QVector<QStringList> dataToExport;
+
+   QStringList headers;
+   headers << "Versuchsperson" << "Seed" << "Reihenfolge"
+           << "Position" << "Index" << "Modus" << "Text" << "Farbe";
+   dataToExport.append(headers);
+
+   for (const StudyPlanEntry& entry : entries)
+   {
+      const QStringList violations = validator.validate(entry.m_qvecTrialIndices, counts);
+      if (!violations.isEmpty())
+      {
+         std::cout << entry.m_strParticipantID.toStdString() << ": "
+                   << violations.join(" ").toStdString() << std::endl;
+         numInvalid++;
+      }
+
+      QStringList order;
+      for (int pos=0; pos<entry.m_qvecConditionOrder.count(); pos++)
+      {
+         const int cond = entry.m_qvecConditionOrder.at(pos);
+         positionCounts[pos][cond]++;
+         order.append(StroopTrial::modeToString(static_cast<StroopTrialModes>(cond)));
+      }
+
+      QStringList prefix;
+      prefix << entry.m_strParticipantID << TrialRandom::seedToString(entry.m_u64Seed)
+             << order.join(" > ");
+
+      dataToExport.append(sequenceToRows(prefix, entry.m_qvecTrialIndices));
+   }
+
+   int minPerPosition = numParticipants;
+   int maxPerPosition = 0;
+   for (int pos=0; pos<NumStroopConditions; pos++)
+   {
+      for (int cond=0; cond<NumStroopConditions; cond++)
+      {
+         minPerPosition = std::min(minPerPosition, positionCounts[pos][cond]);
+         maxPerPosition = std::max(maxPerPosition, positionCounts[pos][cond]);
+      }
+   }
+
+   std::cout << "Planned " << numParticipants << " participants ("
+             << square.count() << " block orders), "
+             << numInvalid << " invalid sequences, every condition "
+             << minPerPosition << "-" << maxPerPosition << " times at every block position."
+             << std::endl;
+
+   const QDir dir(dirPath);
+
+   const bool planWritten = StudyPlan::write(dir.absoluteFilePath("study_plan.stplan"),
+                                             studySeed, equallyDistributed, entries);
+   const bool csvWritten = spDataRW->writeCSV(dir.absoluteFilePath("study_plan.csv"),
+                                              dataToExport);
+
+   return planWritten && csvWritten && numInvalid == 0;
+}
@@ -0,0 +1,44 @@
+/*****************************************************************************
+ * Copyright (C) 2026 The StroopExperimenter contributors                    *
+ *                                                                           *
+ * This file is part of the StroopExperimenter.                              *
+ *                                                                           *
+ * Author: The StroopExperimenter contributors                               *
+ * Revision date: 18 Oct. 2026                                               *
+ *****************************************************************************/
+
+#pragma once
+
+#include <QObject>
+#include <QVector>
+#include <QStringList>
+
+// Forward declarations
+class DataReaderWriter;
+
+
+/**
+ * @brief The TrialSequencePlanner class
+ *
+ * Offline use of the seeded trial sequences: regenerates the sequences of
+ * recorded sessions from their stored seeds (and checks them against the
+ * stored trials) and precomputes the counterbalanced plan of a whole study.
+ */
+class TrialSequencePlanner : public QObject
+{
+      Q_OBJECT
+
+   public:
+      explicit TrialSequencePlanner(std::weak_ptr<DataReaderWriter> wpDataRW,
+                                    QObject* parent = nullptr);
+
+      bool regenerateDirectory(const QString& dirPath);
+      bool precomputeStudy(quint64 studySeed, int numParticipants, int numTrials,
+                           bool equallyDistributed, const QString& dirPath);
+
+      static QVector<QStringList> sequenceToRows(const QStringList& prefix,
+                                                 const QVector<int>& indices);
+
+   private:
+      std::weak_ptr<DataReaderWriter> m_wpDataRW;
+};
@@ -11,10 +11,21 @@
 #include "DataReaderWriter.h"
 #include "Experimenter.h"
 #include "MainWindow.h"
+#include "StudyAnalyzer.h"
+#include "StroopReEvaluation.h"
+#include "StroopExperiment.h"
+#include "StroopProtocol.h"
+#include "TimingCalibration.h"
+#include "StationController.h"
+#include "EvdevInput.h"
+#include "TrialSequenceGenerator.h"
+#include "TrialSequencePlanner.h"
+#include "TrialRandom.h"
 
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QDir>
+#include <QElapsedTimer>
 #include <iostream>
 
 
@@ -26,6 +37,10 @@
  */
 int main(int argc, char* argv[])
 {
+   // Startup time, printed by the main window (see MainWindow::measureStartup())
+   QElapsedTimer startupTimer;
+   startupTimer.start();
+
    QApplication app(argc, argv);
    QApplication::setApplicationName("Stroop Experimenter");
    QApplication::setApplicationVersion("1.0");
@@ -34,7 +49,10 @@ int main(int argc, char* argv[])
    // Here, "Dependency Injection" is implemented by using "Constructor Injection"
    std::shared_ptr<DataReaderWriter> spDataRW = std::make_shared<DataReaderWriter>();
    std::shared_ptr<Experimenter> spExperimenter = std::make_shared<Experimenter>(spDataRW);
-   std::shared_ptr<MainWindow> spMainWindow = std::make_shared<MainWindow>(spExperimenter);
+
+   // Further paradigms, only loaded once a file of their type is opened
+   const QString pluginPath = QCoreApplication::applicationDirPath() + "/plugins";
+   if (QDir(pluginPath).exists()) { spExperimenter->loadExperimentPlugins(pluginPath); }
 
    // Configure command line parser
    QCommandLineParser parser;
@@ -51,9 +69,113 @@ int main(int argc, char* argv[])
    QCommandLineOption fileOption("f", "<name>.stroop file - <name> is used to identify the participant.");
    parser.addOption(fileOption);
 
+   QCommandLineOption analyzeOption("a", "<folder> - Analyzes all *.stroop files in <folder> and exits (batch mode).", "folder");
+   parser.addOption(analyzeOption);
+
+   QCommandLineOption wienerOption("w", "Batch mode only: additionally fits the diffusion model by maximum likelihood.");
+   parser.addOption(wienerOption);
+
+   QCommandLineOption reEvalOption("r", "Batch mode only: re-evaluates all sessions with the comma-separated filter <policies> "
+                                        "(all, correct, [correct-]window:<min>:<max>, [correct-]outlier:<k> or default; "
+                                        "prefix nostall- drops trials flagged by the event loop watchdog).", "policies");
+   parser.addOption(reEvalOption);
+
+   QCommandLineOption seedOption("s", "<seed> - Hex master seed of the first run (or of the study with -p).", "seed");
+   parser.addOption(seedOption);
+
+   QCommandLineOption regenerateOption("g", "<folder> - Regenerates the trial sequences of all *.stroop files in <folder> from their stored seeds and exits.", "folder");
+   parser.addOption(regenerateOption);
+
+   QCommandLineOption planOption("p", "<count> - Precomputes the counterbalanced plan of <count> participants into study_plan.stplan/.csv in the -o folder and exits.", "count");
+   parser.addOption(planOption);
+
+   QCommandLineOption studyPlanOption("l", "<file> - Loads a study plan (*.stplan): participants listed in it run their precomputed sequence.", "file");
+   parser.addOption(studyPlanOption);
+
+   QCommandLineOption deadlineOption("d", "<accuracy> - Adaptive response deadline per condition that converges to the target <accuracy> (e.g. 0.8).", "accuracy");
+   parser.addOption(deadlineOption);
+
+   QCommandLineOption realtimeOption("t", "<cpu> - Real-time mode: times the response deadline on a SCHED_FIFO thread pinned to <cpu> (-1: no pinning) and locks the memory during runs (Linux, needs permission).", "cpu");
+   parser.addOption(realtimeOption);
+
+   QCommandLineOption inputOption("i", "<sources> - Reads the color keys from the comma-separated evdev devices (auto: all keyboards) "
+                                       "or replays a recording of input events, timed by the kernel (Linux, needs read access).", "sources");
+   parser.addOption(inputOption);
+
+   QCommandLineOption protocolOption("c", "<file> - Runs the experiment protocol <file> (*.ini): blocks, practice, breaks, fixation/ISI ranges, deadlines and condition mixes (replaces -n).", "file");
+   parser.addOption(protocolOption);
+
+   QCommandLineOption frameOption("e", "Frame timing: measures the refresh interval when the experiment window is shown, times fixation point, ISI, breaks "
+                                       "and stimuli in whole frames changed on the swaps (OpenGL, vsync) and logs intended/shown and dropped frames per trial.");
+   parser.addOption(frameOption);
+
+   QCommandLineOption calibrationOption("k", "<limits> - Thresholds of the timing calibration before each run, comma-separated "
+                                             "(resolution:<ns>, timer:<ms>, jitter:<ms>, frame:<ms>, update:<ms>); stations beyond them are warned about.", "limits");
+   parser.addOption(calibrationOption);
+
+   QCommandLineOption stationOption("m", "<file> - Multi-station session: runs one participant per screen as listed in the station file <file> (*.ini), "
+                                         "each with its own participant file, keyboards (evdev) and deadline thread; no main window.", "file");
+   parser.addOption(stationOption);
+
+   QCommandLineOption benchmarkOption("b", "<count> - Generates and validates 100 trial sequences of <count> trials, prints the timing and exits.", "count");
+   parser.addOption(benchmarkOption);
+
    // Process the given command line arguments
    parser.process(app);
 
+   // Batch mode: no GUI is created at all
+   if (parser.isSet(analyzeOption))
+   {
+      StudyAnalyzer analyzer(spDataRW);
+      analyzer.setFullDiffusionFit(parser.isSet(wienerOption));
+
+      if (parser.isSet(reEvalOption))
+      {
+         QVector<StroopFilterPolicy> policies;
+         const QStringList specs = parser.value(reEvalOption).split(",", Qt::SkipEmptyParts);
+         for (const QString& spec : specs)
+         {
+            StroopFilterPolicy policy;
+            if (spec.trimmed().toLower() == "default")
+            {
+               policies.append(StroopReEvaluation::defaultPolicies());
+            }
+            else if (StroopFilterPolicy::fromString(spec, policy))
+            {
+               policies.append(policy);
+            }
+            else
+            {
+               std::cout << "Unknown filter policy: " << spec.toStdString() << std::endl;
+               return 1;
+            }
+         }
+         analyzer.setFilterPolicies(policies);
+      }
+      return analyzer.run(parser.value(analyzeOption)) ? 0 : 1;
+   }
+
+   // Sequence generator benchmark: no GUI either
+   if (parser.isSet(benchmarkOption))
+   {
+      return TrialSequenceGenerator::runBenchmark(parser.value(benchmarkOption).toInt(), 100) ? 0 : 1;
+   }
+
+   // Regenerate recorded sequences from their seeds: no GUI either
+   if (parser.isSet(regenerateOption))
+   {
+      TrialSequencePlanner planner(spDataRW);
+      return planner.regenerateDirectory(parser.value(regenerateOption)) ? 0 : 1;
+   }
+
+   quint64 seed = 0ULL;
+   if (parser.isSet(seedOption) && !TrialRandom::seedFromString(parser.value(seedOption), seed))
+   {
+      std::cout << "Invalid seed: " << parser.value(seedOption).toStdString() << std::endl;
+      return 1;
+   }
+
+   int numTrials = 12; // 100
    if (parser.isSet(numTrialsOption))
    {
       QString numRunStr = parser.value(numTrialsOption);
@@ -63,17 +185,11 @@ int main(int argc, char* argv[])
       }
 
       bool converted;
-      int numTrials = numRunStr.toInt(&converted);
+      numTrials = numRunStr.toInt(&converted);
       if (!converted)
       {
          numTrials = 100;
       }
-
-      spMainWindow->setNumExperimentRuns(numTrials);
-   }
-   else
-   {
-      spMainWindow->setNumExperimentRuns(12); // 100
    }
 
    // Specifiy folder for .stroop file
@@ -87,7 +203,163 @@ int main(int argc, char* argv[])
       }
    }
 
-   // Specifiy .stroop file
+   // Precompute the sequences of a study: no GUI either
+   if (parser.isSet(planOption))
+   {
+      if (!parser.isSet(seedOption)) { seed = TrialRandom::createMasterSeed(); }
+
+      std::cout << "Study seed: " << TrialRandom::seedToString(seed).toStdString() << std::endl;
+
+      TrialSequencePlanner planner(spDataRW);
+      return planner.precomputeStudy(seed, parser.value(planOption).toInt(), numTrials, true,
+                                     QDir(folderPath).absolutePath()) ? 0 : 1;
+   }
+
+   // Multi-station session: the stations have their own windows (see StationController)
+   const bool stationMode = parser.isSet(stationOption);
+
+   std::shared_ptr<MainWindow> spMainWindow;
+   if (!stationMode)
+   {
+      spMainWindow = std::make_shared<MainWindow>(spExperimenter);
+      spMainWindow->setNumExperimentRuns(numTrials);
+      spMainWindow->measureStartup(startupTimer);
+   }
+
+   if (parser.isSet(seedOption))
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp) { spExp->setNextSeed(seed); }
+   }
+
+   // Adaptive response deadline
+   if (parser.isSet(deadlineOption))
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp) { spExp->setTargetAccuracy(parser.value(deadlineOption).toDouble()); }
+
+      if (spMainWindow) { spMainWindow->setAdaptiveDeadline(true); }
+      else if (spExp)   { spExp->setAdaptiveDeadline(true); }
+   }
+
+   // Real-time mode: what is not permitted is logged and skipped
+   // (stations have their own, see the station file)
+   if (parser.isSet(realtimeOption) && !stationMode)
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      bool converted = false;
+      const int cpu = parser.value(realtimeOption).toInt(&converted);
+
+      if (spExp) { spExp->setRealtimeMode(true, converted ? cpu : -1); }
+   }
+
+   // Kernel-level key input: falls back to Qt key events if no source can be opened
+   // (stations have their own, see the station file)
+   if (parser.isSet(inputOption) && !stationMode)
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      QStringList sources = parser.value(inputOption).split(",", Qt::SkipEmptyParts);
+      if (sources.count() == 1 && sources.first().trimmed().toLower() == "auto")
+      {
+         sources = EvdevInputThread::findKeyboards();
+      }
+
+      if (spExp && !spExp->setKernelInput(sources))
+      {
+         std::cout << "No evdev input available, using Qt key events." << std::endl;
+      }
+   }
+
+   // Experiment protocol: compiled into a timeline at the start of each run
+   if (parser.isSet(protocolOption))
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      StroopProtocol protocol;
+      QString error;
+      if (!protocol.load(parser.value(protocolOption), &error))
+      {
+         std::cout << "Invalid protocol: " << error.toStdString() << std::endl;
+         return 1;
+      }
+
+      std::cout << "Protocol " << protocol.getName().toStdString()
+                << " (version " << protocol.getVersion() << "): "
+                << protocol.getBlocks().count() << " blocks, "
+                << protocol.getNumTrials() << " trials, SHA-256 "
+                << protocol.getHash().toStdString() << std::endl;
+
+      if (spExp) { spExp->setProtocol(protocol); }
+   }
+
+   // Frame timing: the experiment dialog is created after this (see MainWindow::finishStartup())
+   if (parser.isSet(frameOption))
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      if (spExp) { spExp->setFrameTiming(true); }
+   }
+
+   // Thresholds of the timing calibration of the station
+   if (parser.isSet(calibrationOption))
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      TimingThresholds thresholds;
+      if (!TimingThresholds::fromString(parser.value(calibrationOption), thresholds))
+      {
+         std::cout << "Invalid calibration limits: " << parser.value(calibrationOption).toStdString() << std::endl;
+         return 1;
+      }
+
+      if (spExp) { spExp->setCalibrationThresholds(thresholds); }
+   }
+
+   // Multi-station session: the stations use the experiment configured
+   // above as template; the application ends with the last run
+   if (stationMode)
+   {
+      std::shared_ptr<StroopExperiment> spExp =
+            spExperimenter->getExperimentAs<StroopExperiment>("stroop");
+
+      StationController controller;
+      QString error;
+      if (!controller.load(parser.value(stationOption), folderPath, &error))
+      {
+         std::cout << "Invalid station file: " << error.toStdString() << std::endl;
+         return 1;
+      }
+
+      if (!spExp || !controller.start(*spExp, numTrials, parser.value(studyPlanOption), &error))
+      {
+         std::cout << "Stations not started: " << error.toStdString() << std::endl;
+         return 1;
+      }
+
+      QObject::connect(&controller, &StationController::allStopped, &app, &QApplication::quit);
+
+      return app.exec();
+   }
+
+   // Study plan: must be set before the .stroop file is loaded
+   if (parser.isSet(studyPlanOption) && !spExperimenter->setStudyPlan(parser.value(studyPlanOption)))
+   {
+      std::cout << "Invalid study plan: " << parser.value(studyPlanOption).toStdString() << std::endl;
+      return 1;
+   }
+
+   // Specifiy .stroop file: read in the background while the window is shown
    if (parser.isSet(fileOption))
    {
       QString fileName = parser.value(fileOption);